@@ -0,0 +1 @@
+DXRVoxelizerBench.exe golden %*
@@ -0,0 +1 @@
+DXRVoxelizerBench.exe voxelize -csv VoxelizeBench.csv -json VoxelizeBench.json %*
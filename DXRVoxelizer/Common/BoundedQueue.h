@@ -0,0 +1,101 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+//--------------------------------------------------------------------------------------
+// Lock-free multi-producer multi-consumer ring of a fixed capacity (a power of two),
+// after Vyukov: each cell carries a sequence number that tells the producers and the
+// consumers whose turn it is, so a push or pop is a single CAS on its own position.
+// Close() marks that no more items come; the items in the ring can still be popped.
+//--------------------------------------------------------------------------------------
+template<typename T>
+class BoundedQueue
+{
+public:
+	BoundedQueue(uint32_t capacity) :
+		m_isClosed(false)
+	{
+		auto size = 2u;
+		while (size < capacity) size <<= 1;
+		m_cells.reset(new Cell[size]);
+		m_mask = size - 1;
+		for (auto i = 0u; i < size; ++i) m_cells[i].Sequence.store(i, std::memory_order_relaxed);
+		m_enqueuePos.store(0, std::memory_order_relaxed);
+		m_dequeuePos.store(0, std::memory_order_relaxed);
+	}
+
+	// Moves from value on success; fails if the ring is full
+	bool TryPush(T& value)
+	{
+		auto pos = m_enqueuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			auto& cell = m_cells[pos & m_mask];
+			const auto sequence = cell.Sequence.load(std::memory_order_acquire);
+			const auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+			if (diff == 0)
+			{
+				if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					cell.Value = std::move(value);
+					cell.Sequence.store(pos + 1, std::memory_order_release);
+
+					return true;
+				}
+			}
+			else if (diff < 0) return false;
+			else pos = m_enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	// Fails if the ring is empty
+	bool TryPop(T& value)
+	{
+		auto pos = m_dequeuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			auto& cell = m_cells[pos & m_mask];
+			const auto sequence = cell.Sequence.load(std::memory_order_acquire);
+			const auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+			if (diff == 0)
+			{
+				if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					value = std::move(cell.Value);
+					cell.Sequence.store(pos + m_mask + 1, std::memory_order_release);
+
+					return true;
+				}
+			}
+			else if (diff < 0) return false;
+			else pos = m_dequeuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	void Close() { m_isClosed.store(true, std::memory_order_release); }
+	bool IsClosed() const { return m_isClosed.load(std::memory_order_acquire); }
+
+	uint32_t GetCapacity() const { return static_cast<uint32_t>(m_mask + 1); }
+
+protected:
+	struct Cell
+	{
+		std::atomic<size_t> Sequence;
+		T Value;
+	};
+
+	std::unique_ptr<Cell[]> m_cells;
+	size_t m_mask;
+
+	// On their own cache lines, as the producers and the consumers contend on each
+	alignas(64) std::atomic<size_t> m_enqueuePos;
+	alignas(64) std::atomic<size_t> m_dequeuePos;
+	alignas(64) std::atomic<bool> m_isClosed;
+};
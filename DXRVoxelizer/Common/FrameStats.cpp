@@ -0,0 +1,158 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include "FrameStats.h"
+
+using namespace std;
+
+namespace
+{
+	const double g_firstBucketBound = 0.25e-3;
+
+	// Nearest rank of the sorted samples
+	double getPercentile(const vector<float>& sorted, double percentile)
+	{
+		const auto rank = static_cast<size_t>(ceil(percentile * sorted.size()));
+
+		return sorted[(max)(rank, static_cast<size_t>(1)) - 1];
+	}
+}
+
+FrameStats::FrameStats(uint32_t windowSize) :
+	m_windowSize((max)(windowSize, 1u))
+{
+}
+
+FrameStats::~FrameStats()
+{
+}
+
+uint32_t FrameStats::AddStage(const char* name)
+{
+	m_stages.push_back({ name, vector<float>(m_windowSize), 0 });
+
+	return static_cast<uint32_t>(m_stages.size() - 1);
+}
+
+void FrameStats::Record(uint32_t stage, double seconds)
+{
+	auto& s = m_stages[stage];
+	s.Samples[s.NumRecorded++ % m_windowSize] = static_cast<float>(seconds);
+}
+
+void FrameStats::Clear()
+{
+	for (auto& stage : m_stages) stage.NumRecorded = 0;
+}
+
+FrameStats::Summary FrameStats::GetSummary(uint32_t stage) const
+{
+	const auto& s = m_stages[stage];
+	const auto numSamples = static_cast<uint32_t>((min)(s.NumRecorded, static_cast<uint64_t>(m_windowSize)));
+	Summary summary = {};
+	summary.NumSamples = numSamples;
+	if (!numSamples) return summary;
+
+	vector<float> sorted(s.Samples.cbegin(), s.Samples.cbegin() + numSamples);
+	sort(sorted.begin(), sorted.end());
+
+	auto sum = 0.0;
+	for (const auto sample : sorted) sum += sample;
+	summary.Mean = sum / numSamples;
+	summary.P50 = getPercentile(sorted, 0.50);
+	summary.P95 = getPercentile(sorted, 0.95);
+	summary.P99 = getPercentile(sorted, 0.99);
+	summary.Max = sorted.back();
+
+	return summary;
+}
+
+void FrameStats::GetHistogram(uint32_t stage, uint32_t counts[]) const
+{
+	fill(counts, counts + NumBuckets, 0u);
+
+	const auto& s = m_stages[stage];
+	const auto numSamples = static_cast<uint32_t>((min)(s.NumRecorded, static_cast<uint64_t>(m_windowSize)));
+	for (auto i = 0u; i < numSamples; ++i)
+	{
+		auto bucket = 0u;
+		while (bucket + 1 < NumBuckets && s.Samples[i] >= GetBucketBound(bucket)) ++bucket;
+		++counts[bucket];
+	}
+}
+
+uint32_t FrameStats::GetNumStages() const
+{
+	return static_cast<uint32_t>(m_stages.size());
+}
+
+const char* FrameStats::GetStageName(uint32_t stage) const
+{
+	return m_stages[stage].Name.c_str();
+}
+
+uint32_t FrameStats::GetWindowSize() const
+{
+	return m_windowSize;
+}
+
+bool FrameStats::WriteCSV(const char* fileName) const
+{
+	ofstream file(fileName, ios::trunc);
+	if (!file) return false;
+
+	char buffer[256];
+	file << "stage,samples,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+	for (auto i = 0u; i < GetNumStages(); ++i)
+	{
+		const auto summary = GetSummary(i);
+		snprintf(buffer, sizeof(buffer), "%s,%u,%.4f,%.4f,%.4f,%.4f,%.4f\n", GetStageName(i), summary.NumSamples,
+			summary.Mean * 1.0e3, summary.P50 * 1.0e3, summary.P95 * 1.0e3, summary.P99 * 1.0e3, summary.Max * 1.0e3);
+		file << buffer;
+	}
+
+	return static_cast<bool>(file);
+}
+
+bool FrameStats::WriteJSON(const char* fileName) const
+{
+	ofstream file(fileName, ios::trunc);
+	if (!file) return false;
+
+	char buffer[256];
+	file << "{\"window\":" << m_windowSize << ",\"bucketBoundsMs\":[";
+	for (auto b = 0u; b + 1 < NumBuckets; ++b)
+	{
+		snprintf(buffer, sizeof(buffer), "%s%g", b ? "," : "", GetBucketBound(b) * 1.0e3);
+		file << buffer;
+	}
+	file << "],\"stages\":[";
+
+	uint32_t counts[NumBuckets];
+	for (auto i = 0u; i < GetNumStages(); ++i)
+	{
+		const auto summary = GetSummary(i);
+		snprintf(buffer, sizeof(buffer), "%s\n{\"name\":\"%s\",\"samples\":%u,\"meanMs\":%.4f,\"p50Ms\":%.4f,"
+			"\"p95Ms\":%.4f,\"p99Ms\":%.4f,\"maxMs\":%.4f,\"histogram\":[", i ? "," : "", GetStageName(i),
+			summary.NumSamples, summary.Mean * 1.0e3, summary.P50 * 1.0e3, summary.P95 * 1.0e3,
+			summary.P99 * 1.0e3, summary.Max * 1.0e3);
+		file << buffer;
+
+		GetHistogram(i, counts);
+		for (auto b = 0u; b < NumBuckets; ++b) file << (b ? "," : "") << counts[b];
+		file << "]}";
+	}
+	file << "\n]}\n";
+
+	return static_cast<bool>(file);
+}
+
+double FrameStats::GetBucketBound(uint32_t bucket)
+{
+	return bucket + 1 < NumBuckets ? ldexp(g_firstBucketBound, static_cast<int>(bucket)) : INFINITY;
+}
@@ -0,0 +1,83 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "FrameTimer.h"
+
+//--------------------------------------------------------------------------------------
+// Times of the frame and of its stages over a sliding window of the latest frames, as
+// percentiles and as a histogram. The window keeps the samples, so the percentiles are
+// exact, and a single stall shows in the max and, within the window, in the tail, where
+// the average frame rate of a second would hide it. The histogram buckets double from
+// 0.25 ms, so that 60, 30 and 15 Hz frames fall into buckets of their own.
+//--------------------------------------------------------------------------------------
+class FrameStats
+{
+public:
+	struct Summary	// In seconds
+	{
+		uint32_t NumSamples;
+		double Mean;
+		double P50;
+		double P95;
+		double P99;
+		double Max;
+	};
+
+	// Records the time of its scope into a stage
+	class Scope
+	{
+	public:
+		Scope(FrameStats& stats, uint32_t stage) :
+			m_stats(stats), m_stage(stage), m_begin(FrameTimer::GetNanoseconds()) {}
+		~Scope() { m_stats.Record(m_stage, (FrameTimer::GetNanoseconds() - m_begin) / 1.0e9); }
+
+	protected:
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+		FrameStats& m_stats;
+		uint32_t m_stage;
+		uint64_t m_begin;
+	};
+
+	FrameStats(uint32_t windowSize = DefaultWindowSize);
+	virtual ~FrameStats();
+
+	uint32_t AddStage(const char* name);	// Returns the index of the stage
+	void Record(uint32_t stage, double seconds);
+	void Clear();
+
+	Summary GetSummary(uint32_t stage) const;
+	// NumBuckets counts; bucket 0 is below 0.25 ms, bucket i up to 0.25 * 2^i ms, and the
+	// last one is unbounded
+	void GetHistogram(uint32_t stage, uint32_t counts[]) const;
+
+	uint32_t GetNumStages() const;
+	const char* GetStageName(uint32_t stage) const;
+	uint32_t GetWindowSize() const;
+
+	// One row or object per stage, in milliseconds
+	bool WriteCSV(const char* fileName) const;
+	bool WriteJSON(const char* fileName) const;
+
+	static double GetBucketBound(uint32_t bucket);	// Upper, in seconds
+
+	static const uint32_t DefaultWindowSize = 1024;
+	static const uint32_t NumBuckets = 16;
+
+protected:
+	struct Stage
+	{
+		std::string Name;
+		std::vector<float> Samples;	// Ring of the window
+		uint64_t NumRecorded;
+	};
+
+	std::vector<Stage> m_stages;
+	uint32_t m_windowSize;
+};
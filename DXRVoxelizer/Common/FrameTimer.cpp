@@ -0,0 +1,88 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include "FrameTimer.h"
+
+using namespace std;
+
+namespace
+{
+	const uint64_t g_nsPerSecond = 1000000000;
+}
+
+FrameTimer::FrameTimer() :
+	m_lastTime(GetNanoseconds()),
+	m_rawElapsed(0),
+	m_elapsed(0),
+	m_total(0),
+	m_frameCount(0),
+	m_framesPerSecond(0),
+	m_framesThisSecond(0),
+	m_secondCounter(0)
+{
+}
+
+FrameTimer::~FrameTimer()
+{
+}
+
+void FrameTimer::Tick()
+{
+	const auto currentTime = GetNanoseconds();
+	m_rawElapsed = currentTime - m_lastTime;
+	m_lastTime = currentTime;
+
+	m_elapsed = (min)(m_rawElapsed, g_nsPerSecond);
+	m_total += m_elapsed;
+	++m_frameCount;
+
+	++m_framesThisSecond;
+	m_secondCounter += m_rawElapsed;
+	if (m_secondCounter >= g_nsPerSecond)
+	{
+		m_framesPerSecond = m_framesThisSecond;
+		m_framesThisSecond = 0;
+		m_secondCounter %= g_nsPerSecond;
+	}
+}
+
+void FrameTimer::ResetElapsedTime()
+{
+	m_lastTime = GetNanoseconds();
+	m_framesPerSecond = 0;
+	m_framesThisSecond = 0;
+	m_secondCounter = 0;
+}
+
+double FrameTimer::GetElapsedSeconds() const
+{
+	return m_elapsed / 1.0e9;
+}
+
+double FrameTimer::GetRawElapsedSeconds() const
+{
+	return m_rawElapsed / 1.0e9;
+}
+
+double FrameTimer::GetTotalSeconds() const
+{
+	return m_total / 1.0e9;
+}
+
+uint32_t FrameTimer::GetFrameCount() const
+{
+	return m_frameCount;
+}
+
+uint32_t FrameTimer::GetFramesPerSecond() const
+{
+	return m_framesPerSecond;
+}
+
+uint64_t FrameTimer::GetNanoseconds()
+{
+	return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+		chrono::steady_clock::now().time_since_epoch()).count());
+}
@@ -0,0 +1,43 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+//--------------------------------------------------------------------------------------
+// Variable time step timer on steady_clock, in place of the QueryPerformanceCounter
+// StepTimer: Tick once per frame, then read the time of that frame and the total. As
+// StepTimer, a frame counts for at most 1 second in the total, so that a debugger break
+// does not jump the animation; GetRawElapsedSeconds is the unclamped time, for stats.
+//--------------------------------------------------------------------------------------
+class FrameTimer
+{
+public:
+	FrameTimer();
+	virtual ~FrameTimer();
+
+	void Tick();
+	void ResetElapsedTime();	// After a long pause, so that the next frame is not one
+
+	double GetElapsedSeconds() const;
+	double GetRawElapsedSeconds() const;
+	double GetTotalSeconds() const;
+	uint32_t GetFrameCount() const;
+	uint32_t GetFramesPerSecond() const;	// Of the last whole second
+
+	static uint64_t GetNanoseconds();
+
+protected:
+	uint64_t m_lastTime;	// ns
+	uint64_t m_rawElapsed;	// ns
+	uint64_t m_elapsed;		// ns
+	uint64_t m_total;		// ns
+
+	uint32_t m_frameCount;
+	uint32_t m_framesPerSecond;
+	uint32_t m_framesThisSecond;
+	uint64_t m_secondCounter;	// ns
+};
@@ -0,0 +1,38 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//--------------------------------------------------------------------------------------
+// Read-only memory-mapped file on Win32 and POSIX
+//--------------------------------------------------------------------------------------
+class MappedFile
+{
+public:
+	MappedFile();
+	virtual ~MappedFile();
+
+	bool Open(const char* fileName);
+	void Close();
+
+	const uint8_t* GetData() const;
+	size_t GetSize() const;
+
+protected:
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+#ifdef _WIN32
+	void*	m_hFile;
+	void*	m_hMapping;
+#else
+	int		m_fd;
+#endif
+
+	const uint8_t*	m_pData;
+	size_t			m_size;
+};
@@ -0,0 +1,152 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstring>
+#include "MemoryRegistry.h"
+
+using namespace std;
+
+atomic<uint64_t> MemoryRegistry::s_live[NUM_SUBSYSTEM];
+atomic<uint64_t> MemoryRegistry::s_peak[NUM_SUBSYSTEM];
+atomic<uint64_t> MemoryRegistry::s_budget[NUM_SUBSYSTEM];
+atomic<uint32_t> MemoryRegistry::s_numAllocations[NUM_SUBSYSTEM];
+
+atomic<uint64_t> MemoryRegistry::s_totalLive(0);
+atomic<uint64_t> MemoryRegistry::s_totalPeak(0);
+
+MemoryRegistry::Allocation& MemoryRegistry::Allocation::operator=(const Allocation& other)
+{
+	Set(other.m_bytes);
+
+	return *this;
+}
+
+MemoryRegistry::Allocation& MemoryRegistry::Allocation::operator=(Allocation&& other) noexcept
+{
+	if (this == &other) return *this;
+
+	// Within a subsystem the bytes change hands, without a transient sum in the peak
+	if (m_subsystem == other.m_subsystem)
+	{
+		Set(0);
+		m_bytes = other.m_bytes;
+		other.m_bytes = 0;
+	}
+	else
+	{
+		Set(other.m_bytes);
+		other.Set(0);
+	}
+
+	return *this;
+}
+
+void MemoryRegistry::Allocation::Set(uint64_t bytes)
+{
+	if (bytes == m_bytes) return;
+
+	const auto numAllocations = (bytes ? 1 : 0) - (m_bytes ? 1 : 0);
+	Add(m_subsystem, static_cast<int64_t>(bytes - m_bytes), numAllocations);
+	m_bytes = bytes;
+}
+
+void MemoryRegistry::Add(Subsystem subsystem, int64_t bytes, int32_t numAllocations)
+{
+	// Releases wrap around in unsigned arithmetic
+	const auto delta = static_cast<uint64_t>(bytes);
+	updatePeak(s_peak[subsystem], s_live[subsystem].fetch_add(delta, memory_order_relaxed) + delta);
+	updatePeak(s_totalPeak, s_totalLive.fetch_add(delta, memory_order_relaxed) + delta);
+	if (numAllocations) s_numAllocations[subsystem].fetch_add(numAllocations, memory_order_relaxed);
+}
+
+MemoryRegistry::Usage MemoryRegistry::GetUsage(Subsystem subsystem)
+{
+	return
+	{
+		s_live[subsystem].load(memory_order_relaxed),
+		s_peak[subsystem].load(memory_order_relaxed),
+		s_budget[subsystem].load(memory_order_relaxed),
+		s_numAllocations[subsystem].load(memory_order_relaxed)
+	};
+}
+
+MemoryRegistry::Usage MemoryRegistry::GetTotalUsage()
+{
+	Usage usage = { s_totalLive.load(memory_order_relaxed), s_totalPeak.load(memory_order_relaxed), 0, 0 };
+	for (auto i = 0u; i < NUM_SUBSYSTEM; ++i)
+	{
+		usage.Budget += s_budget[i].load(memory_order_relaxed);
+		usage.NumAllocations += s_numAllocations[i].load(memory_order_relaxed);
+	}
+
+	return usage;
+}
+
+void MemoryRegistry::SetBudget(Subsystem subsystem, uint64_t bytes)
+{
+	s_budget[subsystem].store(bytes, memory_order_relaxed);
+}
+
+bool MemoryRegistry::IsOverBudget(Subsystem subsystem)
+{
+	const auto usage = GetUsage(subsystem);
+
+	return usage.Budget && usage.Peak > usage.Budget;
+}
+
+string MemoryRegistry::GetReport()
+{
+	string report;
+	char line[128];
+	snprintf(line, sizeof(line), "%-16s %8s %10s %10s %10s\n", "Memory", "Objects", "Live MB", "Peak MB", "Budget MB");
+	report += line;
+
+	const auto appendLine = [&](const char* name, const Usage& usage, bool isOverBudget)
+	{
+		const auto budget = usage.Budget / 1048576.0;
+		if (usage.Budget) snprintf(line, sizeof(line), "%-16s %8u %10.2f %10.2f %10.2f%s\n", name, usage.NumAllocations,
+			usage.Live / 1048576.0, usage.Peak / 1048576.0, budget, isOverBudget ? " over" : "");
+		else snprintf(line, sizeof(line), "%-16s %8u %10.2f %10.2f %10s\n", name, usage.NumAllocations,
+			usage.Live / 1048576.0, usage.Peak / 1048576.0, "-");
+		report += line;
+	};
+
+	for (auto i = 0u; i < NUM_SUBSYSTEM; ++i)
+	{
+		const auto subsystem = static_cast<Subsystem>(i);
+		const auto usage = GetUsage(subsystem);
+		if (usage.Peak || usage.Budget) appendLine(GetSubsystemName(subsystem), usage, IsOverBudget(subsystem));
+	}
+	appendLine("total", GetTotalUsage(), false);
+
+	return report;
+}
+
+const char* MemoryRegistry::GetSubsystemName(Subsystem subsystem)
+{
+	static const char* names[] =
+	{
+		"mesh", "bvh", "dense-grid", "sparse-grid", "gpu-texture", "gpu-geometry",
+		"gpu-ray-tracing", "gpu-constant", "gpu-upload", "gpu-readback"
+	};
+	static_assert(sizeof(names) / sizeof(names[0]) == NUM_SUBSYSTEM, "A subsystem has no name");
+
+	return subsystem < NUM_SUBSYSTEM ? names[subsystem] : "unknown";
+}
+
+MemoryRegistry::Subsystem MemoryRegistry::FindSubsystem(const char* name)
+{
+	auto subsystem = MESH;
+	while (subsystem < NUM_SUBSYSTEM && strcmp(name, GetSubsystemName(subsystem)))
+		subsystem = static_cast<Subsystem>(subsystem + 1);
+
+	return subsystem;
+}
+
+void MemoryRegistry::updatePeak(atomic<uint64_t>& peak, uint64_t live)
+{
+	auto expected = peak.load(memory_order_relaxed);
+	while (live > expected && !peak.compare_exchange_weak(expected, live, memory_order_relaxed));
+}
@@ -0,0 +1,91 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+//--------------------------------------------------------------------------------------
+// Live and peak bytes per subsystem, CPU and GPU, against optional budgets. Objects hold
+// an Allocation for their storage and set it whenever the storage changes size, so that
+// the registry follows them without knowing their types; the counters are atomic, so
+// objects on any thread may. GPU bytes are as requested at creation, before any
+// alignment of the heap.
+//--------------------------------------------------------------------------------------
+class MemoryRegistry
+{
+public:
+	enum Subsystem : uint8_t
+	{
+		MESH,			// Vertices and indices of the loaders and the CPU voxelizer
+		BVH,
+		DENSE_GRID,		// VoxelGrid, including mip levels and transmittance volumes
+		SPARSE_GRID,	// RLEGrid runs and macro cells
+		GPU_TEXTURE,	// The voxel grid and the persistent image
+		GPU_GEOMETRY,	// Vertex and index buffers
+		GPU_RAY_TRACING,	// Acceleration structures, their scratch and instances
+		GPU_CONSTANT,
+		GPU_UPLOAD,		// Upload buffers, until the initial copies complete
+		GPU_READBACK,
+
+		NUM_SUBSYSTEM
+	};
+
+	struct Usage
+	{
+		uint64_t Live;
+		uint64_t Peak;
+		uint64_t Budget;	// 0 if none
+		uint32_t NumAllocations;	// Live
+	};
+
+	// Bytes of an object in a subsystem, registered for as long as the object lives;
+	// copies register their own
+	class Allocation
+	{
+	public:
+		Allocation(Subsystem subsystem, uint64_t bytes = 0) : m_subsystem(subsystem), m_bytes(0) { Set(bytes); }
+		Allocation(const Allocation& other) : m_subsystem(other.m_subsystem), m_bytes(0) { Set(other.m_bytes); }
+		Allocation(Allocation&& other) noexcept : m_subsystem(other.m_subsystem), m_bytes(other.m_bytes) { other.m_bytes = 0; }
+		~Allocation() { Set(0); }
+
+		Allocation& operator=(const Allocation& other);
+		Allocation& operator=(Allocation&& other) noexcept;
+
+		void Set(uint64_t bytes);
+		uint64_t Get() const { return m_bytes; }
+
+	protected:
+		Subsystem m_subsystem;
+		uint64_t m_bytes;
+	};
+
+	// Bytes may be negative to release; numAllocations counts the objects in use
+	static void Add(Subsystem subsystem, int64_t bytes, int32_t numAllocations = 0);
+
+	static Usage GetUsage(Subsystem subsystem);
+	static Usage GetTotalUsage();	// Over all subsystems; the peak is of the sum
+
+	static void SetBudget(Subsystem subsystem, uint64_t bytes);
+	static bool IsOverBudget(Subsystem subsystem);	// By its peak
+
+	// One line per subsystem in use or with a budget, and the total, in MB
+	static std::string GetReport();
+
+	static const char* GetSubsystemName(Subsystem subsystem);
+	static Subsystem FindSubsystem(const char* name);	// NUM_SUBSYSTEM if none
+
+protected:
+	static void updatePeak(std::atomic<uint64_t>& peak, uint64_t live);
+
+	static std::atomic<uint64_t> s_live[NUM_SUBSYSTEM];
+	static std::atomic<uint64_t> s_peak[NUM_SUBSYSTEM];
+	static std::atomic<uint64_t> s_budget[NUM_SUBSYSTEM];
+	static std::atomic<uint32_t> s_numAllocations[NUM_SUBSYSTEM];
+
+	static std::atomic<uint64_t> s_totalLive;
+	static std::atomic<uint64_t> s_totalPeak;
+};
@@ -0,0 +1,50 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include "TaskScheduler.h"
+
+//--------------------------------------------------------------------------------------
+// Runs fn(i) for every i in [begin, end) on up to numThreads threads of TaskScheduler
+// (0 for all of its workers), the caller being one of them, and returns when all are
+// done; it may be called from inside fn or any other task. Indices are handed out in
+// chunks of a share of those left, so that the first chunks are large and the last
+// ones single indices that even out the tail; each index should still carry enough
+// work, e.g. a slice or a column block rather than a single voxel.
+//--------------------------------------------------------------------------------------
+template<typename Fn>
+void ParallelFor(uint32_t begin, uint32_t end, uint32_t numThreads, const Fn& fn)
+{
+	if (begin >= end) return;
+	if (!numThreads) numThreads = TaskScheduler::GetNumWorkers() + 1;
+	numThreads = (std::min)(numThreads, end - begin);
+
+	if (numThreads <= 1)
+	{
+		for (auto i = begin; i < end; ++i) fn(i);
+		return;
+	}
+
+	std::atomic<uint32_t> next(begin);
+	const auto worker = [&]()
+	{
+		for (auto first = next.load(std::memory_order_relaxed); first < end;)
+		{
+			const auto grain = (std::max)((end - first) / (2 * numThreads), 1u);
+			if (!next.compare_exchange_weak(first, first + grain, std::memory_order_relaxed)) continue;
+			for (auto i = first; i < first + grain; ++i) fn(i);
+			first = next.load(std::memory_order_relaxed);
+		}
+	};
+
+	// The threads that find the range drained by the time they start return at once
+	TaskScheduler::TaskGroup group;
+	for (auto i = 1u; i < numThreads; ++i) group.Run(worker);
+	worker();
+	group.Wait();
+}
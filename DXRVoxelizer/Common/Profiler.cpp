@@ -0,0 +1,176 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include "Profiler.h"
+
+using namespace std;
+
+thread_local Profiler::ThreadRing Profiler::s_threadRing;
+
+const uint64_t Profiler::s_originTicks = Profiler::GetTicks();
+const uint64_t Profiler::s_originNanoseconds = Profiler::GetNanoseconds();
+
+mutex Profiler::s_mutex;
+vector<unique_ptr<Profiler::Ring>> Profiler::s_rings;
+vector<Profiler::Ring*> Profiler::s_freeRings;
+
+namespace
+{
+	void appendName(string& text, const char* name)
+	{
+		for (auto p = name; *p; ++p)
+		{
+			if (*p == '"' || *p == '\\') text += '\\';
+			text += *p;
+		}
+	}
+}
+
+bool Profiler::WriteChromeTrace(const char* fileName)
+{
+	vector<Event> events;
+	vector<uint32_t> tids;
+	copyEvents(events, tids);
+
+	ofstream file(fileName, ios::trunc);
+	if (!file) return false;
+
+	// Microseconds from the first event, to the nanosecond
+	auto origin = UINT64_MAX;
+	for (const auto& event : events) origin = (min)(origin, event.Begin);
+	const auto usPerTick = GetNanosecondsPerTick() / 1.0e3;
+
+	// Formatted in memory, as the stream is slow per call
+	string text = "{\"traceEvents\":[";
+	text.reserve(events.size() * 96);
+	char buffer[96];
+	for (size_t i = 0; i < events.size(); ++i)
+	{
+		const auto& event = events[i];
+		text += i ? ",\n{\"name\":\"" : "\n{\"name\":\"";
+		appendName(text, event.Name);
+		snprintf(buffer, sizeof(buffer), "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+			(event.Begin - origin) * usPerTick, (event.End - event.Begin) * usPerTick, tids[i]);
+		text += buffer;
+	}
+	text += "\n],\"displayTimeUnit\":\"ns\"}\n";
+	file.write(text.data(), text.size());
+
+	return static_cast<bool>(file);
+}
+
+void Profiler::Clear()
+{
+	lock_guard<mutex> lock(s_mutex);
+	for (const auto& pRing : s_rings) pRing->Count.store(0, memory_order_relaxed);
+}
+
+uint32_t Profiler::GetNumRings()
+{
+	lock_guard<mutex> lock(s_mutex);
+
+	return static_cast<uint32_t>(s_rings.size());
+}
+
+uint64_t Profiler::GetNumEvents()
+{
+	lock_guard<mutex> lock(s_mutex);
+	uint64_t numEvents = 0;
+	for (const auto& pRing : s_rings) numEvents += pRing->Count.load(memory_order_acquire);
+
+	return numEvents;
+}
+
+double Profiler::GetZoneSeconds(const char* name, uint32_t* pNumEvents)
+{
+	vector<Event> events;
+	vector<uint32_t> tids;
+	copyEvents(events, tids);
+
+	uint64_t ticks = 0;
+	auto numEvents = 0u;
+	for (const auto& event : events)
+	{
+		if (strcmp(event.Name, name)) continue;
+		ticks += event.End - event.Begin;
+		++numEvents;
+	}
+	if (pNumEvents) *pNumEvents = numEvents;
+
+	return ticks * GetNanosecondsPerTick() / 1.0e9;
+}
+
+double Profiler::GetNanosecondsPerTick()
+{
+#if PROFILER_USE_TSC
+	// Over at least 10 ms, for a rate within 0.01%
+	auto nanoseconds = GetNanoseconds();
+	while (nanoseconds < s_originNanoseconds + 10000000) nanoseconds = GetNanoseconds();
+	const auto ticks = GetTicks();
+
+	return static_cast<double>(nanoseconds - s_originNanoseconds) / static_cast<double>(ticks - s_originTicks);
+#else
+	return 1.0;
+#endif
+}
+
+// Copies the events out, keeping those that no writer can have reached since
+void Profiler::copyEvents(vector<Event>& events, vector<uint32_t>& tids)
+{
+	lock_guard<mutex> lock(s_mutex);
+	for (const auto& pRing : s_rings)
+	{
+		const auto count = pRing->Count.load(memory_order_acquire);
+		const auto first = count > RingSize ? count - RingSize : 0;
+		const auto offset = events.size();
+		for (auto i = first; i < count; ++i) events.push_back(pRing->Events[i & (RingSize - 1)]);
+
+		const auto newCount = pRing->Count.load(memory_order_acquire);
+		const auto safeFirst = newCount >= RingSize ? newCount - RingSize + 1 : 0;
+		if (safeFirst > first)
+		{
+			const auto numLost = static_cast<size_t>((min)(safeFirst, count) - first);
+			events.erase(events.begin() + offset, events.begin() + offset + numLost);
+		}
+		tids.resize(events.size(), pRing->Index);
+	}
+}
+
+Profiler::Ring* Profiler::acquireRing()
+{
+	lock_guard<mutex> lock(s_mutex);
+	if (!s_freeRings.empty())
+	{
+		const auto pRing = s_freeRings.back();
+		s_freeRings.pop_back();
+
+		return pRing;
+	}
+
+	s_rings.emplace_back(new Ring);
+	const auto pRing = s_rings.back().get();
+	pRing->Count.store(0, memory_order_relaxed);
+	pRing->Index = static_cast<uint32_t>(s_rings.size());
+
+	return pRing;
+}
+
+Profiler::Ring* Profiler::acquireThreadRing()
+{
+	s_threadRing.pRing = acquireRing();
+	s_pThreadRing = s_threadRing.pRing;
+
+	return s_pThreadRing;
+}
+
+void Profiler::releaseRing(Ring* pRing)
+{
+	lock_guard<mutex> lock(s_mutex);
+	s_freeRings.push_back(pRing);
+}
@@ -0,0 +1,160 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__x86_64__)
+#define PROFILER_USE_TSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#define PROFILER_USE_TSC 0
+#endif
+
+// Zones are recorded only with ENABLE_PROFILER defined to 1; otherwise PROFILE_ZONE
+// expands to nothing
+#ifndef ENABLE_PROFILER
+#define ENABLE_PROFILER 0
+#endif
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#if ENABLE_PROFILER
+#define PROFILE_ZONE(name) const Profiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
+
+//--------------------------------------------------------------------------------------
+// Scoped CPU zones, each recorded as its begin and end in nanoseconds into a ring of
+// the thread that ran it. A thread takes a ring at its first zone and gives it back
+// when it exits, so short-lived threads, e.g. of StagePipeline, share a few rings rather
+// than leaving one each; only taking and giving back lock. The owning thread is the
+// only writer, and publishes each event by its count, so recording never waits.
+// Timestamps are ticks of the invariant TSC on x64, which is read several times faster
+// than steady_clock, and nanoseconds of steady_clock elsewhere; WriteChromeTrace
+// converts them to nanoseconds against steady_clock, and exports the events still in
+// the rings as Chrome trace JSON, which chrome://tracing and Perfetto load. Names are
+// not copied, so they must be literals.
+//--------------------------------------------------------------------------------------
+class Profiler
+{
+public:
+	struct Event
+	{
+		const char* Name;
+		uint64_t Begin;	// Ticks
+		uint64_t End;	// Ticks
+	};
+
+	class Zone
+	{
+	public:
+		Zone(const char* name) : m_name(name), m_begin(GetTicks()) {}
+		~Zone() { Record(m_name, m_begin, GetTicks()); }
+
+	protected:
+		Zone(const Zone&) = delete;
+		Zone& operator=(const Zone&) = delete;
+
+		const char* m_name;
+		uint64_t m_begin;
+	};
+
+	static uint64_t GetTicks()
+	{
+#if PROFILER_USE_TSC
+		return __rdtsc();
+#else
+		return GetNanoseconds();
+#endif
+	}
+
+	static uint64_t GetNanoseconds()
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	// Measured against steady_clock since the start of the process
+	static double GetNanosecondsPerTick();
+
+	static void Record(const char* name, uint64_t begin, uint64_t end)
+	{
+		auto pRing = s_pThreadRing;
+		if (!pRing) pRing = acquireThreadRing();
+
+		// Only this thread writes the ring, so the count is published after the event; a
+		// release store is a plain one on x64
+		const auto count = pRing->Count.load(std::memory_order_relaxed);
+		auto& event = pRing->Events[count & (RingSize - 1)];
+		event.Name = name;
+		event.Begin = begin;
+		event.End = end;
+		pRing->Count.store(count + 1, std::memory_order_release);
+	}
+
+	// Safe while other threads record; events being overwritten meanwhile are left out
+	static bool WriteChromeTrace(const char* fileName);
+	static void Clear();	// Only while no zone is open
+
+	// Total time and number of the events of a zone still in the rings, e.g. the passes of
+	// a load since the last Clear; names are compared by content
+	static double GetZoneSeconds(const char* name, uint32_t* pNumEvents = nullptr);
+
+	static uint32_t GetNumRings();
+	static uint64_t GetNumEvents();	// Recorded since the last Clear, including overwritten ones
+
+	static const uint32_t RingSize = 1 << 16;	// Events per ring; must be a power of 2
+
+protected:
+	struct Ring
+	{
+		Event Events[RingSize];
+		std::atomic<uint64_t> Count;	// Events written
+		uint32_t Index;					// The tid of the trace
+	};
+
+	// The ring of the calling thread, given back when the thread exits
+	struct ThreadRing
+	{
+		Ring* pRing;
+
+		ThreadRing() : pRing(nullptr) {}
+		~ThreadRing()
+		{
+			s_pThreadRing = nullptr;
+			if (pRing) releaseRing(pRing);
+		}
+	};
+
+	static void copyEvents(std::vector<Event>& events, std::vector<uint32_t>& tids);
+	static Ring* acquireRing();
+	static Ring* acquireThreadRing();
+	static void releaseRing(Ring* pRing);
+
+	static thread_local ThreadRing s_threadRing;
+
+	// The same ring, read by every zone; constant-initialized in the header, so that it is
+	// read directly rather than through the initialization check of s_threadRing
+	static inline thread_local Ring* s_pThreadRing = nullptr;
+
+	static const uint64_t s_originTicks;
+	static const uint64_t s_originNanoseconds;
+
+	static std::mutex s_mutex;
+	static std::vector<std::unique_ptr<Ring>> s_rings;	// In the order of creation
+	static std::vector<Ring*> s_freeRings;				// Of no thread
+};
@@ -0,0 +1,183 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BoundedQueue.h"
+
+//--------------------------------------------------------------------------------------
+// Runs items through a chain of stages, each with its own workers, so that different
+// items are in different stages at once. Stages are connected by bounded queues: a
+// worker whose output queue is full waits, which holds back the stages before it and
+// so bounds the number of items in flight (back-pressure).
+//--------------------------------------------------------------------------------------
+template<typename T>
+class StagePipeline
+{
+public:
+	// Returns false to drop the item, e.g. on a failure
+	using StageFn = std::function<bool(T&)>;
+
+	struct StageStats
+	{
+		std::string	Name;
+		uint32_t	NumWorkers;
+		uint32_t	NumItems;		// Passed on
+		uint32_t	NumDropped;
+		double		BusySeconds;	// Over all workers
+		double		StarvedSeconds;	// Waiting on an empty input queue
+		double		BlockedSeconds;	// Waiting on a full output queue
+	};
+
+	StagePipeline(uint32_t queueCapacity = 4) : m_queueCapacity(queueCapacity), m_seconds(0.0) {}
+
+	void AddStage(const char* name, uint32_t numWorkers, StageFn fn)
+	{
+		m_stages.push_back({ name, (std::max)(numWorkers, 1u), fn });
+	}
+
+	// Moves the items into the first stage, in order, and returns once the last stage has
+	// taken every item that was not dropped; returns the wall time in seconds
+	double Run(std::vector<T>& items)
+	{
+		const auto numStages = static_cast<uint32_t>(m_stages.size());
+		m_stats.assign(numStages, StageStats());
+		if (!numStages) return 0.0;
+
+		std::vector<std::unique_ptr<BoundedQueue<T>>> queues(numStages - 1);
+		for (auto& queue : queues) queue.reset(new BoundedQueue<T>(m_queueCapacity));
+
+		std::vector<std::atomic<uint32_t>> numActiveWorkers(numStages);
+		for (auto s = 0u; s < numStages; ++s)
+		{
+			numActiveWorkers[s].store(m_stages[s].NumWorkers, std::memory_order_relaxed);
+			m_stats[s].Name = m_stages[s].Name;
+			m_stats[s].NumWorkers = m_stages[s].NumWorkers;
+		}
+
+		std::mutex statsMutex;
+		std::atomic<size_t> nextItem(0);
+		const auto worker = [&](uint32_t s)
+		{
+			const auto pInput = s > 0 ? queues[s - 1].get() : nullptr;
+			const auto pOutput = s + 1 < numStages ? queues[s].get() : nullptr;
+			StageStats stats = {};
+			for (;;)
+			{
+				T item;
+				auto start = std::chrono::steady_clock::now();
+				if (pInput)
+				{
+					const auto isPopped = pop(*pInput, item);
+					stats.StarvedSeconds += getSeconds(start);
+					if (!isPopped) break;
+				}
+				else
+				{
+					const auto i = nextItem++;
+					if (i >= items.size()) break;
+					item = std::move(items[i]);
+				}
+
+				start = std::chrono::steady_clock::now();
+				const auto isDone = m_stages[s].Fn(item);
+				stats.BusySeconds += getSeconds(start);
+				if (!isDone)
+				{
+					++stats.NumDropped;
+					continue;
+				}
+				++stats.NumItems;
+
+				if (pOutput)
+				{
+					start = std::chrono::steady_clock::now();
+					push(*pOutput, item);
+					stats.BlockedSeconds += getSeconds(start);
+				}
+			}
+
+			// The last worker of a stage tells the next that no more items come
+			if (pOutput && numActiveWorkers[s].fetch_sub(1) == 1) pOutput->Close();
+
+			std::lock_guard<std::mutex> lock(statsMutex);
+			auto& total = m_stats[s];
+			total.NumItems += stats.NumItems;
+			total.NumDropped += stats.NumDropped;
+			total.BusySeconds += stats.BusySeconds;
+			total.StarvedSeconds += stats.StarvedSeconds;
+			total.BlockedSeconds += stats.BlockedSeconds;
+		};
+
+		const auto start = std::chrono::steady_clock::now();
+		std::vector<std::thread> threads;
+		for (auto s = 0u; s < numStages; ++s)
+			for (auto i = 0u; i < m_stages[s].NumWorkers; ++i) threads.emplace_back(worker, s);
+		for (auto& thread : threads) thread.join();
+		m_seconds = getSeconds(start);
+
+		return m_seconds;
+	}
+
+	// Of the latest run
+	const std::vector<StageStats>& GetStats() const { return m_stats; }
+
+	// Busy time over the wall time of all workers of the stage, in [0, 1]
+	double GetUtilization(uint32_t stage) const
+	{
+		const auto& stats = m_stats[stage];
+
+		return m_seconds > 0.0 ? stats.BusySeconds / (stats.NumWorkers * m_seconds) : 0.0;
+	}
+
+protected:
+	struct Stage
+	{
+		std::string	Name;
+		uint32_t	NumWorkers;
+		StageFn		Fn;
+	};
+
+	static double getSeconds(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// Yields first, then sleeps, so that a long wait does not take a core from the busy stages
+	static void backOff(uint32_t& numTries)
+	{
+		if (++numTries < 16) std::this_thread::yield();
+		else std::this_thread::sleep_for(std::chrono::microseconds(200));
+	}
+
+	static void push(BoundedQueue<T>& queue, T& item)
+	{
+		for (auto numTries = 0u; !queue.TryPush(item);) backOff(numTries);
+	}
+
+	// Fails once the queue is closed and empty
+	static bool pop(BoundedQueue<T>& queue, T& item)
+	{
+		for (auto numTries = 0u; !queue.TryPop(item);)
+		{
+			// Every push precedes the closing, so a closed queue that is empty stays so
+			if (queue.IsClosed()) return queue.TryPop(item);
+			backOff(numTries);
+		}
+
+		return true;
+	}
+
+	std::vector<Stage>		m_stages;
+	std::vector<StageStats>	m_stats;
+	uint32_t	m_queueCapacity;
+	double		m_seconds;
+};
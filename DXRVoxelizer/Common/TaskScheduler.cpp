@@ -0,0 +1,413 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include "TaskScheduler.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace std;
+
+thread_local TaskScheduler::Worker* TaskScheduler::s_pWorker = nullptr;
+
+vector<unique_ptr<TaskScheduler::Worker>>& TaskScheduler::s_workers = *new vector<unique_ptr<Worker>>;
+TaskScheduler::Worker& TaskScheduler::s_external = *new Worker;
+
+mutex& TaskScheduler::s_mutex = *new mutex;
+condition_variable& TaskScheduler::s_wakeUp = *new condition_variable;
+deque<TaskScheduler::Task*>& TaskScheduler::s_sharedTasks = *new deque<Task*>;
+mutex TaskScheduler::s_startMutex;
+atomic<uint32_t> TaskScheduler::s_numSharedTasks(0);
+atomic<uint32_t> TaskScheduler::s_numSleeping(0);
+atomic<bool> TaskScheduler::s_isStarted(false);
+atomic<bool> TaskScheduler::s_isStopping(false);
+bool TaskScheduler::s_isPinned = false;
+
+namespace
+{
+	// Tries before a worker without tasks goes to sleep, and the longest sleep, which
+	// bounds the delay of a wake-up that is missed
+	const uint32_t g_numSpins = 64;
+	const auto g_maxSleep = chrono::milliseconds(2);
+
+	uint64_t getNanoseconds()
+	{
+		return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
+
+TaskScheduler::TaskGroup::TaskGroup() :
+	m_numPending(0)
+{
+}
+
+TaskScheduler::TaskGroup::~TaskGroup()
+{
+	Wait();
+}
+
+void TaskScheduler::TaskGroup::Run(function<void()> fn)
+{
+	m_numPending.fetch_add(1, memory_order_relaxed);
+	submit(new Task{ move(fn), this });
+}
+
+void TaskScheduler::TaskGroup::Wait()
+{
+	const auto pWorker = s_pWorker ? s_pWorker : &s_external;
+	auto idleStart = 0ull;
+	for (auto numTries = 0u; m_numPending.load(memory_order_acquire);)
+	{
+		const auto pTask = findTask(pWorker);
+		if (pTask)
+		{
+			if (idleStart) pWorker->IdleNanoseconds.fetch_add(getNanoseconds() - idleStart, memory_order_relaxed);
+			idleStart = 0;
+			numTries = 0;
+			runTask(pTask, pWorker);
+			continue;
+		}
+
+		// The tasks left are running elsewhere
+		if (!idleStart) idleStart = getNanoseconds();
+		if (++numTries < g_numSpins) this_thread::yield();
+		else this_thread::sleep_for(chrono::microseconds(50));
+	}
+	if (idleStart) pWorker->IdleNanoseconds.fetch_add(getNanoseconds() - idleStart, memory_order_relaxed);
+}
+
+void TaskScheduler::Init(uint32_t numWorkers, bool isPinned)
+{
+	lock_guard<mutex> lock(s_startMutex);
+	stop();
+	start(numWorkers, isPinned);
+}
+
+uint32_t TaskScheduler::GetNumWorkers()
+{
+	ensureStarted();
+
+	return static_cast<uint32_t>(s_workers.size());
+}
+
+bool TaskScheduler::IsPinned()
+{
+	return s_isPinned;
+}
+
+void TaskScheduler::GetStats(vector<WorkerStats>& stats)
+{
+	ensureStarted();
+
+	const auto getStats = [](const Worker& worker)
+	{
+		WorkerStats stats;
+		stats.NumTasks = worker.NumTasks.load(memory_order_relaxed);
+		stats.NumSteals = worker.NumSteals.load(memory_order_relaxed);
+		stats.NumFailedSteals = worker.NumFailedSteals.load(memory_order_relaxed);
+		stats.IdleSeconds = worker.IdleNanoseconds.load(memory_order_relaxed) / 1.0e9;
+		stats.QueueDepth = worker.Tasks.GetSize();
+		stats.MaxQueueDepth = worker.MaxQueueDepth.load(memory_order_relaxed);
+
+		return stats;
+	};
+
+	stats.clear();
+	for (const auto& pWorker : s_workers) stats.push_back(getStats(*pWorker));
+	stats.push_back(getStats(s_external));
+	stats.back().QueueDepth = s_numSharedTasks.load(memory_order_relaxed);
+}
+
+void TaskScheduler::ResetStats()
+{
+	ensureStarted();
+	for (const auto& pWorker : s_workers) resetStats(*pWorker);
+	resetStats(s_external);
+}
+
+TaskScheduler::Deque::Deque() :
+	m_top(0),
+	m_bottom(0)
+{
+	for (auto& task : m_tasks) task.store(nullptr, memory_order_relaxed);
+}
+
+bool TaskScheduler::Deque::Push(Task* pTask)
+{
+	const auto bottom = m_bottom.load(memory_order_relaxed);
+	const auto top = m_top.load(memory_order_acquire);
+	if (bottom - top >= Capacity) return false;
+
+	// Publishes the task to the thieves, which read the bottom with acquire
+	m_tasks[bottom & (Capacity - 1)].store(pTask, memory_order_relaxed);
+	m_bottom.store(bottom + 1, memory_order_release);
+
+	return true;
+}
+
+TaskScheduler::Task* TaskScheduler::Deque::Pop()
+{
+	const auto bottom = m_bottom.load(memory_order_relaxed) - 1;
+	m_bottom.store(bottom, memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+	auto top = m_top.load(memory_order_relaxed);
+
+	if (top > bottom)
+	{
+		// Empty
+		m_bottom.store(bottom + 1, memory_order_release);
+
+		return nullptr;
+	}
+
+	auto pTask = m_tasks[bottom & (Capacity - 1)].load(memory_order_relaxed);
+	if (top == bottom)
+	{
+		// The last task, which a thief may take first
+		if (!m_top.compare_exchange_strong(top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+			pTask = nullptr;
+		m_bottom.store(bottom + 1, memory_order_release);
+	}
+
+	return pTask;
+}
+
+TaskScheduler::Task* TaskScheduler::Deque::Steal(bool& isContended)
+{
+	auto top = m_top.load(memory_order_acquire);
+	atomic_thread_fence(memory_order_seq_cst);
+	const auto bottom = m_bottom.load(memory_order_acquire);
+	isContended = false;
+	if (top >= bottom) return nullptr;
+
+	const auto pTask = m_tasks[top & (Capacity - 1)].load(memory_order_relaxed);
+	if (m_top.compare_exchange_strong(top, top + 1, memory_order_seq_cst, memory_order_relaxed)) return pTask;
+	isContended = true;
+
+	return nullptr;
+}
+
+uint32_t TaskScheduler::Deque::GetSize() const
+{
+	const auto size = m_bottom.load(memory_order_relaxed) - m_top.load(memory_order_relaxed);
+
+	return size > 0 ? static_cast<uint32_t>(size) : 0;
+}
+
+void TaskScheduler::ensureStarted()
+{
+	if (s_isStarted.load(memory_order_acquire)) return;
+
+	lock_guard<mutex> lock(s_startMutex);
+	if (!s_isStarted.load(memory_order_relaxed)) start(DefaultNumWorkers, false);
+}
+
+void TaskScheduler::start(uint32_t numWorkers, bool isPinned)
+{
+	const auto numCores = (max)(thread::hardware_concurrency(), 1u);
+	if (numWorkers == DefaultNumWorkers) numWorkers = numCores - 1;
+	s_isPinned = isPinned;
+	s_isStopping.store(false, memory_order_relaxed);
+
+	// All workers exist before any runs, as each may steal from any other
+	s_workers.resize(numWorkers);
+	for (auto i = 0u; i < numWorkers; ++i)
+	{
+		s_workers[i].reset(new Worker);
+		resetStats(*s_workers[i]);
+	}
+	resetStats(s_external);
+
+	for (auto i = 0u; i < numWorkers; ++i)
+	{
+		s_workers[i]->Thread = thread(workerMain, s_workers[i].get());
+		if (isPinned) pin(s_workers[i]->Thread, (i + 1) % numCores);
+	}
+	s_isStarted.store(true, memory_order_release);
+}
+
+void TaskScheduler::stop()
+{
+	if (!s_isStarted.load(memory_order_acquire)) return;
+
+	{
+		lock_guard<mutex> lock(s_mutex);
+		s_isStopping.store(true, memory_order_relaxed);
+	}
+	s_wakeUp.notify_all();
+	for (const auto& pWorker : s_workers) pWorker->Thread.join();
+	s_workers.clear();
+	s_isStarted.store(false, memory_order_release);
+}
+
+void TaskScheduler::pin(thread& thread, uint32_t core)
+{
+#ifdef _WIN32
+	SetThreadAffinityMask(thread.native_handle(), static_cast<DWORD_PTR>(1) << (core % (sizeof(DWORD_PTR) * 8)));
+#elif defined(__linux__)
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	CPU_SET(core, &cpuSet);
+	pthread_setaffinity_np(thread.native_handle(), sizeof(cpuSet), &cpuSet);
+#else
+	(void)thread;
+	(void)core;
+#endif
+}
+
+void TaskScheduler::workerMain(Worker* pWorker)
+{
+	s_pWorker = pWorker;
+	while (!s_isStopping.load(memory_order_relaxed))
+	{
+		auto pTask = findTask(pWorker);
+		if (!pTask)
+		{
+			const auto idleStart = getNanoseconds();
+			for (auto i = 0u; i < g_numSpins && !pTask; ++i)
+			{
+				this_thread::yield();
+				pTask = findTask(pWorker);
+			}
+
+			// Announces the sleep before looking once more, so that a task submitted
+			// meanwhile either is seen here or sees the sleeper and wakes it
+			if (!pTask)
+			{
+				unique_lock<mutex> lock(s_mutex);
+				s_numSleeping.fetch_add(1, memory_order_seq_cst);
+				if (!hasWork() && !s_isStopping.load(memory_order_relaxed)) s_wakeUp.wait_for(lock, g_maxSleep);
+				s_numSleeping.fetch_sub(1, memory_order_relaxed);
+			}
+			pWorker->IdleNanoseconds.fetch_add(getNanoseconds() - idleStart, memory_order_relaxed);
+			if (!pTask) continue;
+		}
+
+		runTask(pTask, pWorker);
+	}
+}
+
+void TaskScheduler::submit(Task* pTask)
+{
+	ensureStarted();
+
+	const auto pWorker = s_pWorker;
+	if (pWorker)
+	{
+		// A full deque has enough work for the thieves; the task runs at once
+		if (!pWorker->Tasks.Push(pTask))
+		{
+			runTask(pTask, pWorker);
+
+			return;
+		}
+
+		const auto depth = pWorker->Tasks.GetSize();
+		if (depth > pWorker->MaxQueueDepth.load(memory_order_relaxed))
+			pWorker->MaxQueueDepth.store(depth, memory_order_relaxed);
+	}
+	else
+	{
+		lock_guard<mutex> lock(s_mutex);
+		s_sharedTasks.push_back(pTask);
+		const auto depth = s_numSharedTasks.fetch_add(1, memory_order_relaxed) + 1;
+		if (depth > s_external.MaxQueueDepth.load(memory_order_relaxed))
+			s_external.MaxQueueDepth.store(depth, memory_order_relaxed);
+	}
+
+	atomic_thread_fence(memory_order_seq_cst);
+	if (s_numSleeping.load(memory_order_relaxed))
+	{
+		lock_guard<mutex> lock(s_mutex);
+		s_wakeUp.notify_one();
+	}
+}
+
+TaskScheduler::Task* TaskScheduler::findTask(Worker* pWorker)
+{
+	// The own deque first, then the shared queue, then the other workers from a random one
+	if (pWorker != &s_external)
+	{
+		const auto pTask = pWorker->Tasks.Pop();
+		if (pTask) return pTask;
+	}
+
+	if (s_numSharedTasks.load(memory_order_relaxed))
+	{
+		lock_guard<mutex> lock(s_mutex);
+		if (!s_sharedTasks.empty())
+		{
+			const auto pTask = s_sharedTasks.front();
+			s_sharedTasks.pop_front();
+			s_numSharedTasks.fetch_sub(1, memory_order_relaxed);
+
+			return pTask;
+		}
+	}
+
+	const auto numWorkers = static_cast<uint32_t>(s_workers.size());
+	if (!numWorkers) return nullptr;
+
+	// Xorshift, per thread, for the first victim
+	static thread_local auto seed = static_cast<uint32_t>(hash<thread::id>()(this_thread::get_id())) | 1;
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+
+	for (auto i = 0u; i < numWorkers; ++i)
+	{
+		auto& victim = *s_workers[(seed + i) % numWorkers];
+		if (&victim == pWorker) continue;
+
+		bool isContended;
+		const auto pTask = victim.Tasks.Steal(isContended);
+		if (pTask)
+		{
+			pWorker->NumSteals.fetch_add(1, memory_order_relaxed);
+
+			return pTask;
+		}
+		if (isContended) pWorker->NumFailedSteals.fetch_add(1, memory_order_relaxed);
+	}
+
+	return nullptr;
+}
+
+void TaskScheduler::runTask(Task* pTask, Worker* pWorker)
+{
+	const auto pGroup = pTask->pGroup;
+	pTask->Fn();
+	delete pTask;
+	pWorker->NumTasks.fetch_add(1, memory_order_relaxed);
+
+	// The group may be gone as soon as it sees its last task done
+	pGroup->m_numPending.fetch_sub(1, memory_order_release);
+}
+
+bool TaskScheduler::hasWork()
+{
+	if (s_numSharedTasks.load(memory_order_relaxed)) return true;
+	for (const auto& pWorker : s_workers)
+		if (pWorker->Tasks.GetSize()) return true;
+
+	return false;
+}
+
+void TaskScheduler::resetStats(Worker& worker)
+{
+	worker.NumTasks.store(0, memory_order_relaxed);
+	worker.NumSteals.store(0, memory_order_relaxed);
+	worker.NumFailedSteals.store(0, memory_order_relaxed);
+	worker.IdleNanoseconds.store(0, memory_order_relaxed);
+	worker.MaxQueueDepth.store(0, memory_order_relaxed);
+}
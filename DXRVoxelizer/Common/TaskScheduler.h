@@ -0,0 +1,136 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//--------------------------------------------------------------------------------------
+// Work-stealing thread pool, started at its first task. Each worker owns a Chase-Lev
+// deque: it pushes and pops its tasks at the bottom, newest first for locality, while
+// idle workers steal from the top, oldest first, which is usually the largest work.
+// Threads outside the pool submit through a shared queue. A thread that waits on a
+// task group runs tasks meanwhile, so groups nest inside tasks without blocking a
+// worker, and the waiting thread counts as one more worker.
+//--------------------------------------------------------------------------------------
+class TaskScheduler
+{
+public:
+	struct WorkerStats
+	{
+		uint64_t	NumTasks;
+		uint64_t	NumSteals;
+		uint64_t	NumFailedSteals;	// Of a victim that had tasks, lost to another thief
+		double		IdleSeconds;		// Looking for a task or asleep
+		uint32_t	QueueDepth;			// Tasks in the deque now
+		uint32_t	MaxQueueDepth;		// Since the latest reset
+	};
+
+	// Tasks that are waited for together; may be waited on from inside a task
+	class TaskGroup
+	{
+	public:
+		TaskGroup();
+		~TaskGroup();	// Waits
+
+		void Run(std::function<void()> fn);
+		void Wait();
+
+	protected:
+		friend class TaskScheduler;
+
+		std::atomic<uint32_t> m_numPending;
+	};
+
+	// Restarts the pool with numWorkers threads, DefaultNumWorkers for one per hardware
+	// thread but the caller's, or 0 to run every task on the thread that waits for it;
+	// pinned, worker i runs on core i + 1, leaving core 0 to the caller. Only while no
+	// task is in flight.
+	static void Init(uint32_t numWorkers = DefaultNumWorkers, bool isPinned = false);
+
+	static uint32_t GetNumWorkers();
+	static bool IsPinned();
+
+	// One per worker, then one of the threads outside the pool while they wait
+	static void GetStats(std::vector<WorkerStats>& stats);
+	static void ResetStats();
+
+	static const uint32_t DefaultNumWorkers = UINT32_MAX;
+
+protected:
+	struct Task
+	{
+		std::function<void()> Fn;
+		TaskGroup* pGroup;
+	};
+
+	// Chase-Lev deque of a fixed capacity, after Le et al. for weak memory models; a
+	// push to a full deque fails and the owner runs the task at once
+	class Deque
+	{
+	public:
+		Deque();
+
+		bool Push(Task* pTask);	// Owner only
+		Task* Pop();			// Owner only
+		Task* Steal(bool& isContended);
+		uint32_t GetSize() const;
+
+		static const uint32_t Capacity = 1024;
+
+	protected:
+		alignas(64) std::atomic<int64_t> m_top;
+		alignas(64) std::atomic<int64_t> m_bottom;
+		std::atomic<Task*> m_tasks[Capacity];
+	};
+
+	struct Worker
+	{
+		Deque Tasks;
+		std::thread Thread;
+
+		// Those of s_external are of all threads outside the pool
+		std::atomic<uint64_t> NumTasks;
+		std::atomic<uint64_t> NumSteals;
+		std::atomic<uint64_t> NumFailedSteals;
+		std::atomic<uint64_t> IdleNanoseconds;
+		std::atomic<uint32_t> MaxQueueDepth;
+	};
+
+	static void ensureStarted();
+	static void start(uint32_t numWorkers, bool isPinned);
+	static void stop();
+	static void pin(std::thread& thread, uint32_t core);
+	static void workerMain(Worker* pWorker);
+
+	static void submit(Task* pTask);
+	static Task* findTask(Worker* pWorker);
+	static void runTask(Task* pTask, Worker* pWorker);
+	static bool hasWork();
+	static void resetStats(Worker& worker);
+
+	static thread_local Worker* s_pWorker;	// Of this thread, nullptr outside the pool
+
+	// Never destroyed, as the workers may still wait on them at exit
+	static std::vector<std::unique_ptr<Worker>>& s_workers;
+	static Worker& s_external;
+
+	static std::mutex& s_mutex;	// Of the shared queue and the sleep
+	static std::condition_variable& s_wakeUp;
+	static std::deque<Task*>& s_sharedTasks;
+	static std::mutex s_startMutex;
+	static std::atomic<uint32_t> s_numSharedTasks;
+	static std::atomic<uint32_t> s_numSleeping;
+	static std::atomic<bool> s_isStarted;
+	static std::atomic<bool> s_isStopping;
+	static bool s_isPinned;
+};
@@ -0,0 +1,345 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cfloat>
+#include <numeric>
+#include "BVH.h"
+#include "Profiler.h"
+
+using namespace std;
+
+static float surfaceArea(const Float3& boundMin, const Float3& boundMax)
+{
+	const auto ext = boundMax - boundMin;
+
+	return ext.x < 0.0f ? 0.0f : 2.0f * (ext.x * ext.y + ext.y * ext.z + ext.z * ext.x);
+}
+
+BVH::BVH() :
+	m_memory(MemoryRegistry::BVH)
+{
+}
+
+BVH::~BVH()
+{
+}
+
+bool BVH::Build(const uint8_t* pVertices, uint32_t stride, uint32_t numVertices,
+	const uint32_t* pIndices, uint32_t numIndices)
+{
+	PROFILE_ZONE("BVH build");
+	const auto numTri = numIndices / 3;
+	if (!pVertices || !pIndices || !numTri) return false;
+
+	const auto getPosition = [pVertices, stride](uint32_t i)
+	{
+		return Float3(reinterpret_cast<const float*>(&pVertices[static_cast<size_t>(stride) * i]));
+	};
+
+	// Per-triangle bounds and centroids
+	vector<Float3> boundMins(numTri), boundMaxs(numTri), centroids(numTri);
+	for (auto i = 0u; i < numTri; ++i)
+	{
+		const auto i0 = pIndices[i * 3], i1 = pIndices[i * 3 + 1], i2 = pIndices[i * 3 + 2];
+		if (i0 >= numVertices || i1 >= numVertices || i2 >= numVertices) return false;
+
+		const auto v0 = getPosition(i0), v1 = getPosition(i1), v2 = getPosition(i2);
+		boundMins[i] = Min(v0, Min(v1, v2));
+		boundMaxs[i] = Max(v0, Max(v1, v2));
+		centroids[i] = (boundMins[i] + boundMaxs[i]) * 0.5f;
+	}
+
+	m_primIndices.resize(numTri);
+	iota(m_primIndices.begin(), m_primIndices.end(), 0u);
+
+	m_nodes.clear();
+	m_nodes.reserve(2 * static_cast<size_t>(numTri));
+	m_nodes.push_back({ Float3(0.0f, 0.0f, 0.0f), 0, Float3(0.0f, 0.0f, 0.0f), numTri });
+	updateBound(m_nodes[0], boundMins, boundMaxs);
+
+	// Top-down build with an explicit stack of (node, depth)
+	vector<pair<uint32_t, uint32_t>> stack(1, make_pair(0u, 1u));
+	while (!stack.empty())
+	{
+		const auto nodeIdx = stack.back().first;
+		const auto depth = stack.back().second;
+		stack.pop_back();
+
+		const auto node = m_nodes[nodeIdx];
+		if (node.Count <= MaxLeafSize || depth >= MaxDepth) continue;
+
+		uint8_t axis;
+		float splitPos;
+		if (!findSplit(node, centroids, boundMins, boundMaxs, axis, splitPos)) continue;
+
+		const auto first = m_primIndices.begin() + node.LeftFirst;
+		const auto mid = partition(first, first + node.Count,
+			[&centroids, axis, splitPos](uint32_t i) { return centroids[i][axis] < splitPos; });
+		const auto leftCount = static_cast<uint32_t>(mid - first);
+		if (leftCount == 0 || leftCount == node.Count) continue;
+
+		const auto leftIdx = static_cast<uint32_t>(m_nodes.size());
+		m_nodes.push_back({ Float3(0.0f, 0.0f, 0.0f), node.LeftFirst, Float3(0.0f, 0.0f, 0.0f), leftCount });
+		m_nodes.push_back({ Float3(0.0f, 0.0f, 0.0f), node.LeftFirst + leftCount, Float3(0.0f, 0.0f, 0.0f), node.Count - leftCount });
+		updateBound(m_nodes[leftIdx], boundMins, boundMaxs);
+		updateBound(m_nodes[leftIdx + 1], boundMins, boundMaxs);
+
+		m_nodes[nodeIdx].LeftFirst = leftIdx;
+		m_nodes[nodeIdx].Count = 0;
+
+		stack.emplace_back(leftIdx, depth + 1);
+		stack.emplace_back(leftIdx + 1, depth + 1);
+	}
+
+	// Gather the triangles in leaf order for the traversal
+	m_triangles.resize(numTri);
+	for (auto i = 0u; i < numTri; ++i)
+	{
+		const auto prim = m_primIndices[i];
+		const auto v0 = getPosition(pIndices[prim * 3]);
+		m_triangles[i].V0 = v0;
+		m_triangles[i].E1 = getPosition(pIndices[prim * 3 + 1]) - v0;
+		m_triangles[i].E2 = getPosition(pIndices[prim * 3 + 2]) - v0;
+	}
+	m_memory.Set(sizeof(Node) * m_nodes.capacity() + sizeof(Triangle) * m_triangles.capacity() +
+		sizeof(uint32_t) * m_primIndices.capacity());
+
+	return true;
+}
+
+bool BVH::Intersect(const Float3& origin, const Float3& dir, float tMin, float tMax, Hit& hit) const
+{
+	if (m_nodes.empty()) return false;
+
+	const auto safeInv = [](float f) { return 1.0f / (fabsf(f) > 1.0e-30f ? f : 1.0e-30f); };
+	const Ray ray = { origin, dir, Float3(safeInv(dir.x), safeInv(dir.y), safeInv(dir.z)) };
+
+	float tNear;
+	if (!intersectBound(m_nodes[0], ray, tMin, tMax, tNear)) return false;
+
+	struct Entry { uint32_t Node; float TNear; };
+	Entry stack[MaxDepth];
+	auto stackSize = 0u;
+
+	auto isHit = false;
+	auto nodeIdx = 0u;
+	for (;;)
+	{
+		const auto& node = m_nodes[nodeIdx];
+		if (node.Count)
+		{
+			for (auto i = node.LeftFirst; i < node.LeftFirst + node.Count; ++i)
+			{
+				if (intersectTriangle(m_triangles[i], ray, tMin, tMax, hit))
+				{
+					hit.PrimitiveIndex = m_primIndices[i];
+					tMax = hit.T;
+					isHit = true;
+				}
+			}
+		}
+		else
+		{
+			float tLeft, tRight;
+			const auto left = node.LeftFirst, right = node.LeftFirst + 1;
+			const auto hitLeft = intersectBound(m_nodes[left], ray, tMin, tMax, tLeft);
+			const auto hitRight = intersectBound(m_nodes[right], ray, tMin, tMax, tRight);
+
+			if (hitLeft && hitRight)
+			{
+				const auto isLeftNear = tLeft <= tRight;
+				stack[stackSize++] = { isLeftNear ? right : left, isLeftNear ? tRight : tLeft };
+				nodeIdx = isLeftNear ? left : right;
+				continue;
+			}
+			else if (hitLeft || hitRight)
+			{
+				nodeIdx = hitLeft ? left : right;
+				continue;
+			}
+		}
+
+		// Pop the next node that is still in front of the closest hit
+		do
+		{
+			if (!stackSize) return isHit;
+			--stackSize;
+		} while (stack[stackSize].TNear > tMax);
+		nodeIdx = stack[stackSize].Node;
+	}
+}
+
+void BVH::IntersectAll(const Float3& origin, const Float3& dir, float tMin, float tMax, vector<Hit>& hits) const
+{
+	if (m_nodes.empty()) return;
+
+	const auto safeInv = [](float f) { return 1.0f / (fabsf(f) > 1.0e-30f ? f : 1.0e-30f); };
+	const Ray ray = { origin, dir, Float3(safeInv(dir.x), safeInv(dir.y), safeInv(dir.z)) };
+
+	uint32_t stack[MaxDepth];
+	auto stackSize = 0u;
+	stack[stackSize++] = 0;
+
+	while (stackSize)
+	{
+		const auto& node = m_nodes[stack[--stackSize]];
+
+		float tNear;
+		if (!intersectBound(node, ray, tMin, tMax, tNear)) continue;
+
+		if (node.Count)
+		{
+			Hit hit;
+			for (auto i = node.LeftFirst; i < node.LeftFirst + node.Count; ++i)
+			{
+				if (intersectTriangle(m_triangles[i], ray, tMin, tMax, hit))
+				{
+					hit.PrimitiveIndex = m_primIndices[i];
+					hits.push_back(hit);
+				}
+			}
+		}
+		else
+		{
+			stack[stackSize++] = node.LeftFirst + 1;
+			stack[stackSize++] = node.LeftFirst;
+		}
+	}
+}
+
+uint32_t BVH::GetNumNodes() const
+{
+	return static_cast<uint32_t>(m_nodes.size());
+}
+
+uint32_t BVH::GetNumTriangles() const
+{
+	return static_cast<uint32_t>(m_triangles.size());
+}
+
+void BVH::updateBound(Node& node, const vector<Float3>& boundMins, const vector<Float3>& boundMaxs) const
+{
+	node.BoundMin = Float3(FLT_MAX, FLT_MAX, FLT_MAX);
+	node.BoundMax = Float3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for (auto i = node.LeftFirst; i < node.LeftFirst + node.Count; ++i)
+	{
+		const auto prim = m_primIndices[i];
+		node.BoundMin = Min(node.BoundMin, boundMins[prim]);
+		node.BoundMax = Max(node.BoundMax, boundMaxs[prim]);
+	}
+}
+
+bool BVH::findSplit(const Node& node, const vector<Float3>& centroids, const vector<Float3>& boundMins,
+	const vector<Float3>& boundMaxs, uint8_t& axis, float& splitPos) const
+{
+	// Bound of the centroids
+	auto cMin = Float3(FLT_MAX, FLT_MAX, FLT_MAX);
+	auto cMax = Float3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for (auto i = node.LeftFirst; i < node.LeftFirst + node.Count; ++i)
+	{
+		cMin = Min(cMin, centroids[m_primIndices[i]]);
+		cMax = Max(cMax, centroids[m_primIndices[i]]);
+	}
+
+	struct Bin
+	{
+		Float3		BoundMin;
+		Float3		BoundMax;
+		uint32_t	Count;
+	};
+
+	auto bestCost = FLT_MAX;
+	for (uint8_t a = 0; a < 3; ++a)
+	{
+		const auto extent = cMax[a] - cMin[a];
+		if (extent <= 0.0f) continue;
+
+		Bin bins[NumBins];
+		for (auto& bin : bins) bin = { Float3(FLT_MAX, FLT_MAX, FLT_MAX), Float3(-FLT_MAX, -FLT_MAX, -FLT_MAX), 0 };
+
+		const auto scale = NumBins / extent;
+		for (auto i = node.LeftFirst; i < node.LeftFirst + node.Count; ++i)
+		{
+			const auto prim = m_primIndices[i];
+			const auto b = (min)(static_cast<uint32_t>((centroids[prim][a] - cMin[a]) * scale), NumBins - 1);
+			bins[b].BoundMin = Min(bins[b].BoundMin, boundMins[prim]);
+			bins[b].BoundMax = Max(bins[b].BoundMax, boundMaxs[prim]);
+			++bins[b].Count;
+		}
+
+		// Sweep from both sides to get the SAH cost of every bin boundary
+		float leftCosts[NumBins - 1];
+		auto boundMin = Float3(FLT_MAX, FLT_MAX, FLT_MAX);
+		auto boundMax = Float3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		auto count = 0u;
+		for (auto b = 0u; b < NumBins - 1; ++b)
+		{
+			boundMin = Min(boundMin, bins[b].BoundMin);
+			boundMax = Max(boundMax, bins[b].BoundMax);
+			count += bins[b].Count;
+			leftCosts[b] = count * surfaceArea(boundMin, boundMax);
+		}
+
+		boundMin = Float3(FLT_MAX, FLT_MAX, FLT_MAX);
+		boundMax = Float3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		count = 0;
+		for (auto b = NumBins - 1; b > 0; --b)
+		{
+			boundMin = Min(boundMin, bins[b].BoundMin);
+			boundMax = Max(boundMax, bins[b].BoundMax);
+			count += bins[b].Count;
+			const auto cost = leftCosts[b - 1] + count * surfaceArea(boundMin, boundMax);
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				axis = a;
+				splitPos = cMin[a] + b / scale;
+			}
+		}
+	}
+
+	// Keep small nodes as leaves when splitting does not pay off
+	const auto leafCost = node.Count * surfaceArea(node.BoundMin, node.BoundMax);
+
+	return bestCost < FLT_MAX && (bestCost < leafCost || node.Count > 4 * MaxLeafSize);
+}
+
+bool BVH::intersectTriangle(const Triangle& tri, const Ray& ray, float tMin, float tMax, Hit& hit)
+{
+	// Moller-Trumbore
+	const auto p = Cross(ray.Dir, tri.E2);
+	const auto det = Dot(tri.E1, p);
+	if (fabsf(det) < 1.0e-12f) return false;
+
+	const auto invDet = 1.0f / det;
+	const auto s = ray.Origin - tri.V0;
+	const auto u = Dot(s, p) * invDet;
+	if (u < 0.0f || u > 1.0f) return false;
+
+	const auto q = Cross(s, tri.E1);
+	const auto v = Dot(ray.Dir, q) * invDet;
+	if (v < 0.0f || u + v > 1.0f) return false;
+
+	const auto t = Dot(tri.E2, q) * invDet;
+	if (t < tMin || t > tMax) return false;
+
+	hit.T = t;
+	hit.U = u;
+	hit.V = v;
+
+	return true;
+}
+
+bool BVH::intersectBound(const Node& node, const Ray& ray, float tMin, float tMax, float& tNear)
+{
+	const auto t0 = (node.BoundMin - ray.Origin) * ray.InvDir;
+	const auto t1 = (node.BoundMax - ray.Origin) * ray.InvDir;
+	const auto tSmall = Min(t0, t1);
+	const auto tLarge = Max(t0, t1);
+	tNear = (max)((max)(tSmall.x, tSmall.y), (max)(tSmall.z, tMin));
+	const auto tFar = (min)((min)(tLarge.x, tLarge.y), (min)(tLarge.z, tMax));
+
+	return tNear <= tFar;
+}
@@ -0,0 +1,79 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "MemoryRegistry.h"
+#include "VectorMath.h"
+
+//--------------------------------------------------------------------------------------
+// Binned-SAH bounding volume hierarchy over an indexed triangle list, the CPU
+// counterpart of the bottom-level acceleration structure
+//--------------------------------------------------------------------------------------
+class BVH
+{
+public:
+	struct Hit
+	{
+		float		T;
+		float		U;	// Barycentric weight of the 2nd vertex, as in DXR
+		float		V;	// Barycentric weight of the 3rd vertex, as in DXR
+		uint32_t	PrimitiveIndex;
+	};
+
+	BVH();
+	virtual ~BVH();
+
+	// Positions are the first 3 floats of each vertex
+	bool Build(const uint8_t* pVertices, uint32_t stride, uint32_t numVertices,
+		const uint32_t* pIndices, uint32_t numIndices);
+
+	bool Intersect(const Float3& origin, const Float3& dir, float tMin, float tMax, Hit& hit) const;
+	void IntersectAll(const Float3& origin, const Float3& dir, float tMin, float tMax, std::vector<Hit>& hits) const;
+
+	uint32_t GetNumNodes() const;
+	uint32_t GetNumTriangles() const;
+
+protected:
+	struct Node
+	{
+		Float3		BoundMin;
+		uint32_t	LeftFirst;	// Left child for inner nodes (right is next), first triangle for leaves
+		Float3		BoundMax;
+		uint32_t	Count;		// Number of triangles, 0 for inner nodes
+	};
+
+	struct Triangle
+	{
+		Float3 V0;
+		Float3 E1;
+		Float3 E2;
+	};
+
+	struct Ray
+	{
+		Float3 Origin;
+		Float3 Dir;
+		Float3 InvDir;
+	};
+
+	static const uint32_t MaxLeafSize = 4;
+	static const uint32_t NumBins = 16;
+	static const uint32_t MaxDepth = 64;
+
+	void updateBound(Node& node, const std::vector<Float3>& boundMins, const std::vector<Float3>& boundMaxs) const;
+	bool findSplit(const Node& node, const std::vector<Float3>& centroids, const std::vector<Float3>& boundMins,
+		const std::vector<Float3>& boundMaxs, uint8_t& axis, float& splitPos) const;
+
+	static bool intersectTriangle(const Triangle& tri, const Ray& ray, float tMin, float tMax, Hit& hit);
+	static bool intersectBound(const Node& node, const Ray& ray, float tMin, float tMax, float& tNear);
+
+	std::vector<Node>		m_nodes;
+	std::vector<Triangle>	m_triangles;	// In leaf order
+	std::vector<uint32_t>	m_primIndices;	// Leaf order to input primitive index
+
+	MemoryRegistry::Allocation m_memory;
+};
@@ -0,0 +1,156 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <random>
+#include "BlueNoise.h"
+#include "BlueNoiseTexture.h"
+
+using namespace std;
+
+static_assert(sizeof(BlueNoise::Texture) == BlueNoise::TextureSize * BlueNoise::TextureSize,
+	"BlueNoiseTexture.h does not match BlueNoise::TextureSize");
+
+namespace
+{
+	// Energy of every texel from the points of a binary pattern, filtered by a Gaussian
+	// on the torus
+	class EnergyField
+	{
+	public:
+		EnergyField(uint32_t size, float sigma) :
+			m_size(size),
+			m_kernel(static_cast<size_t>(size) * size),
+			m_energy(static_cast<size_t>(size) * size, 0.0f)
+		{
+			for (auto y = 0u; y < size; ++y)
+				for (auto x = 0u; x < size; ++x)
+				{
+					const auto dx = static_cast<float>((min)(x, size - x));
+					const auto dy = static_cast<float>((min)(y, size - y));
+					m_kernel[static_cast<size_t>(size) * y + x] = expf(-(dx * dx + dy * dy) / (2.0f * sigma * sigma));
+				}
+		}
+
+		void Add(uint32_t i, float weight)
+		{
+			const auto px = i % m_size, py = i / m_size;
+			for (auto y = 0u; y < m_size; ++y)
+			{
+				const auto pKernel = &m_kernel[static_cast<size_t>(m_size) * ((y + m_size - py) % m_size)];
+				const auto pEnergy = &m_energy[static_cast<size_t>(m_size) * y];
+				for (auto x = 0u; x < m_size; ++x) pEnergy[x] += weight * pKernel[(x + m_size - px) % m_size];
+			}
+		}
+
+		// The point with the highest energy, or the empty texel with the lowest
+		uint32_t FindTightestCluster(const vector<uint8_t>& pattern) const
+		{
+			auto result = 0u;
+			auto energy = -FLT_MAX;
+			for (auto i = 0u; i < pattern.size(); ++i)
+				if (pattern[i] && m_energy[i] > energy)
+				{
+					energy = m_energy[i];
+					result = i;
+				}
+
+			return result;
+		}
+
+		uint32_t FindLargestVoid(const vector<uint8_t>& pattern) const
+		{
+			auto result = 0u;
+			auto energy = FLT_MAX;
+			for (auto i = 0u; i < pattern.size(); ++i)
+				if (!pattern[i] && m_energy[i] < energy)
+				{
+					energy = m_energy[i];
+					result = i;
+				}
+
+			return result;
+		}
+
+	protected:
+		uint32_t		m_size;
+		vector<float>	m_kernel;
+		vector<float>	m_energy;
+	};
+}
+
+bool BlueNoise::Generate(vector<uint8_t>& texture, uint32_t size, float sigma, uint32_t seed)
+{
+	if (size < 4 || size > 256 || sigma <= 0.0f) return false;
+
+	const auto numTexels = size * size;
+	EnergyField field(size, sigma);
+
+	// Initial binary pattern of a tenth of the texels at random
+	vector<uint8_t> pattern(numTexels, 0);
+	const auto numPoints = (max)(numTexels / 10, 1u);
+	mt19937 rng(seed);
+	for (auto n = 0u; n < numPoints;)
+	{
+		const auto i = static_cast<uint32_t>(rng() % numTexels);
+		if (pattern[i]) continue;
+		pattern[i] = 1;
+		field.Add(i, 1.0f);
+		++n;
+	}
+
+	// Move the point of the tightest cluster into the largest void until it stays
+	for (auto n = 0u; n < numTexels; ++n)
+	{
+		const auto cluster = field.FindTightestCluster(pattern);
+		pattern[cluster] = 0;
+		field.Add(cluster, -1.0f);
+
+		const auto largestVoid = field.FindLargestVoid(pattern);
+		pattern[largestVoid] = 1;
+		field.Add(largestVoid, 1.0f);
+		if (largestVoid == cluster) break;
+	}
+
+	// Rank the points of the pattern by removing the tightest clusters first...
+	vector<uint32_t> ranks(numTexels);
+	const auto prototype = pattern;
+	const auto prototypeField = field;
+	for (auto rank = numPoints; rank > 0;)
+	{
+		const auto cluster = field.FindTightestCluster(pattern);
+		pattern[cluster] = 0;
+		field.Add(cluster, -1.0f);
+		ranks[cluster] = --rank;
+	}
+
+	// ...and the remaining texels by filling the largest voids. Past half of the texels,
+	// the tightest cluster of the empty texels is the largest void as well, since the
+	// energies of the points and of the empty texels add up to a constant.
+	pattern = prototype;
+	field = prototypeField;
+	for (auto rank = numPoints; rank < numTexels; ++rank)
+	{
+		const auto largestVoid = field.FindLargestVoid(pattern);
+		pattern[largestVoid] = 1;
+		field.Add(largestVoid, 1.0f);
+		ranks[largestVoid] = rank;
+	}
+
+	texture.resize(numTexels);
+	for (auto i = 0u; i < numTexels; ++i)
+		texture[i] = static_cast<uint8_t>(static_cast<uint64_t>(ranks[i]) * 256 / numTexels);
+
+	return true;
+}
+
+float BlueNoise::GetOffset(uint32_t x, uint32_t y, uint32_t dimension)
+{
+	x = (x + 37 * dimension) % TextureSize;
+	y = (y + 23 * dimension) % TextureSize;
+
+	return (Texture[TextureSize * y + x] + 0.5f) / 256.0f;
+}
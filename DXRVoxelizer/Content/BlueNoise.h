@@ -0,0 +1,27 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//--------------------------------------------------------------------------------------
+// Tileable blue-noise dither textures by the void-and-cluster method (Ulichney 1993):
+// every texel is ranked by the order in which it fills the largest void of a Gaussian
+// energy on the torus, so that any threshold of the ranks is evenly spread. The texture
+// of BlueNoiseTexture.h is generated offline by DXRVoxelizerBench bluenoise.
+//--------------------------------------------------------------------------------------
+namespace BlueNoise
+{
+	static const uint32_t TextureSize = 64;
+
+	// Ranks of size x size texels, scaled to 0-255; sigma is the width of the energy
+	// filter in texels
+	bool Generate(std::vector<uint8_t>& texture, uint32_t size, float sigma = 1.5f, uint32_t seed = 1);
+
+	// Offset in [0, 1) of pixel (x, y) from the precomputed texture, which repeats every
+	// TextureSize pixels; each dimension reads the texture at its own toroidal shift
+	float GetOffset(uint32_t x, uint32_t y, uint32_t dimension = 0);
+}
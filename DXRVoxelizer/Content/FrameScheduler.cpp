@@ -0,0 +1,95 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <cstring>
+#include "FrameScheduler.h"
+
+using namespace std;
+
+// Version 0 is never set, so that the first frame runs every pass
+FrameScheduler::FrameScheduler() :
+	m_geometryVersion(1),
+	m_viewVersion(1),
+	m_gridVersion(0),
+	m_imageGeometryVersion(0),
+	m_imageViewVersion(0),
+	m_numFrames(0),
+	m_numVoxelizations(0),
+	m_numRayCasts(0)
+{
+}
+
+FrameScheduler::~FrameScheduler()
+{
+}
+
+void FrameScheduler::SetGeometry(const void* pState, size_t size)
+{
+	if (update(m_geometryState, pState, size)) ++m_geometryVersion;
+}
+
+void FrameScheduler::SetView(const void* pState, size_t size)
+{
+	if (update(m_viewState, pState, size)) ++m_viewVersion;
+}
+
+void FrameScheduler::Invalidate()
+{
+	m_gridVersion = 0;
+	m_imageGeometryVersion = 0;
+	m_imageViewVersion = 0;
+}
+
+uint8_t FrameScheduler::Schedule(CommandRecorder* pRecorder)
+{
+	uint8_t passes = 0;
+
+	if (m_gridVersion != m_geometryVersion)
+	{
+		pRecorder->Voxelize();
+		m_gridVersion = m_geometryVersion;
+		++m_numVoxelizations;
+		passes |= VOXELIZE;
+	}
+
+	if (m_imageGeometryVersion != m_gridVersion || m_imageViewVersion != m_viewVersion)
+	{
+		pRecorder->RayCast();
+		m_imageGeometryVersion = m_gridVersion;
+		m_imageViewVersion = m_viewVersion;
+		++m_numRayCasts;
+		passes |= RAY_CAST;
+	}
+
+	// The back buffers of a flip-model swap chain do not keep their contents
+	pRecorder->CopyImage();
+	++m_numFrames;
+
+	return passes | COPY_IMAGE;
+}
+
+uint32_t FrameScheduler::GetNumFrames() const
+{
+	return m_numFrames;
+}
+
+uint32_t FrameScheduler::GetNumVoxelizations() const
+{
+	return m_numVoxelizations;
+}
+
+uint32_t FrameScheduler::GetNumRayCasts() const
+{
+	return m_numRayCasts;
+}
+
+bool FrameScheduler::update(vector<uint8_t>& state, const void* pState, size_t size)
+{
+	if (state.size() == size && (!size || !memcmp(state.data(), pState, size))) return false;
+
+	const auto pBytes = static_cast<const uint8_t*>(pState);
+	state.assign(pBytes, pBytes + size);
+
+	return true;
+}
@@ -0,0 +1,69 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//--------------------------------------------------------------------------------------
+// Decides which passes a frame needs from what changed since the passes last ran. The
+// geometry state (mesh and grid parameters) feeds the voxelization, and the view state
+// (camera, light and object transform) feeds the ray cast, which renders into a
+// persistent image; a frame with neither change only copies that image to the back
+// buffer. The passes are recorded through a CommandRecorder, so the scheduling can run
+// against a stand-in that records the calls instead of a command list.
+//--------------------------------------------------------------------------------------
+class FrameScheduler
+{
+public:
+	class CommandRecorder
+	{
+	public:
+		virtual ~CommandRecorder() {};
+
+		virtual void Voxelize() = 0;	// Into the grid
+		virtual void RayCast() = 0;		// From the grid into the image
+		virtual void CopyImage() = 0;	// From the image to the back buffer
+	};
+
+	enum Pass : uint8_t
+	{
+		VOXELIZE = (1 << 0),
+		RAY_CAST = (1 << 1),
+		COPY_IMAGE = (1 << 2)
+	};
+
+	FrameScheduler();
+	virtual ~FrameScheduler();
+
+	// The states are compared byte for byte with the previous ones
+	void SetGeometry(const void* pState, size_t size);
+	void SetView(const void* pState, size_t size);
+	void Invalidate();	// The grid and the image are lost, e.g. after a device reset
+
+	// Records the passes that the frame needs and returns them as a combination of Pass
+	uint8_t Schedule(CommandRecorder* pRecorder);
+
+	uint32_t GetNumFrames() const;
+	uint32_t GetNumVoxelizations() const;
+	uint32_t GetNumRayCasts() const;
+
+protected:
+	static bool update(std::vector<uint8_t>& state, const void* pState, size_t size);
+
+	std::vector<uint8_t> m_geometryState;
+	std::vector<uint8_t> m_viewState;
+
+	// Versions of the states, and the versions that the grid and the image hold
+	uint32_t	m_geometryVersion;
+	uint32_t	m_viewVersion;
+	uint32_t	m_gridVersion;
+	uint32_t	m_imageGeometryVersion;
+	uint32_t	m_imageViewVersion;
+
+	uint32_t	m_numFrames;
+	uint32_t	m_numVoxelizations;
+	uint32_t	m_numRayCasts;
+};
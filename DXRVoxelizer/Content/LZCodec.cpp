@@ -0,0 +1,217 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstring>
+#include "LZCodec.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+	const uint32_t MinMatch = 4;
+	const uint32_t MaxOffset = 65535;
+	const uint32_t HashLog = 12;
+
+	// The last match must start this far before the end, and the last bytes are literals
+	const size_t MatchSafeDistance = 12;
+	const size_t LastLiterals = 5;
+
+	inline uint32_t read32(const uint8_t* p)
+	{
+		uint32_t value;
+		memcpy(&value, p, sizeof(value));
+
+		return value;
+	}
+
+	inline uint64_t read64(const uint8_t* p)
+	{
+		uint64_t value;
+		memcpy(&value, p, sizeof(value));
+
+		return value;
+	}
+
+	inline uint32_t hashSequence(uint32_t sequence)
+	{
+		return (sequence * 2654435761u) >> (32 - HashLog);
+	}
+
+	inline uint32_t countTrailingZeros(uint64_t value)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward64(&index, value);
+
+		return index;
+#else
+		return __builtin_ctzll(value);
+#endif
+	}
+
+	// Length of the common prefix of a and b, comparing up to pLimit on b
+	inline size_t countMatch(const uint8_t* a, const uint8_t* b, const uint8_t* pLimit)
+	{
+		const auto pStart = b;
+		while (b + sizeof(uint64_t) <= pLimit)
+		{
+			const auto diff = read64(a) ^ read64(b);
+			if (diff) return b - pStart + (countTrailingZeros(diff) >> 3);
+			a += sizeof(uint64_t);
+			b += sizeof(uint64_t);
+		}
+		while (b < pLimit && *a == *b) ++a, ++b;
+
+		return b - pStart;
+	}
+
+	inline uint8_t* writeLength(uint8_t* pDst, size_t length)
+	{
+		for (; length >= 255; length -= 255) *pDst++ = 255;
+		*pDst++ = static_cast<uint8_t>(length);
+
+		return pDst;
+	}
+
+	inline bool readLength(const uint8_t*& pSrc, const uint8_t* pSrcEnd, size_t& length)
+	{
+		uint8_t byte;
+		do
+		{
+			if (pSrc >= pSrcEnd) return false;
+			byte = *pSrc++;
+			length += byte;
+		} while (byte == 255);
+
+		return true;
+	}
+
+	uint8_t* emitSequence(uint8_t* pDst, const uint8_t* pDstEnd, const uint8_t* pLiterals,
+		size_t numLiterals, uint32_t offset, size_t matchLength)
+	{
+		// Token, literals, offset and the worst-case length bytes
+		if (static_cast<size_t>(pDstEnd - pDst) < 1 + numLiterals + numLiterals / 255 + 1 + 2 + matchLength / 255 + 1)
+			return nullptr;
+
+		auto& token = *pDst++;
+		token = static_cast<uint8_t>((numLiterals < 15 ? numLiterals : 15) << 4);
+		if (numLiterals >= 15) pDst = writeLength(pDst, numLiterals - 15);
+		memcpy(pDst, pLiterals, numLiterals);
+		pDst += numLiterals;
+
+		if (matchLength)
+		{
+			*pDst++ = static_cast<uint8_t>(offset);
+			*pDst++ = static_cast<uint8_t>(offset >> 8);
+			matchLength -= MinMatch;
+			token |= static_cast<uint8_t>(matchLength < 15 ? matchLength : 15);
+			if (matchLength >= 15) pDst = writeLength(pDst, matchLength - 15);
+		}
+
+		return pDst;
+	}
+}
+
+size_t LZCodec::GetMaxCompressedSize(size_t srcSize)
+{
+	return srcSize + srcSize / 255 + 16;
+}
+
+size_t LZCodec::Compress(const uint8_t* pSrc, size_t srcSize, uint8_t* pDst, size_t dstCapacity)
+{
+	const auto pDstBegin = pDst;
+	const auto pDstEnd = pDst + dstCapacity;
+	const auto pSrcEnd = pSrc + srcSize;
+	auto pAnchor = pSrc;
+
+	if (srcSize > MatchSafeDistance)
+	{
+		uint32_t table[1 << HashLog] = {};
+		const auto pMatchLimit = pSrcEnd - LastLiterals;
+		const auto pSearchEnd = pSrcEnd - MatchSafeDistance;
+
+		// Stale and colliding table entries are rejected by comparing the actual bytes
+		for (auto p = pSrc; p < pSearchEnd;)
+		{
+			const auto sequence = read32(p);
+			const auto h = hashSequence(sequence);
+			const auto pRef = pSrc + table[h];
+			table[h] = static_cast<uint32_t>(p - pSrc);
+
+			if (pRef >= p || p - pRef > MaxOffset || read32(pRef) != sequence)
+			{
+				// Skip faster over incompressible data
+				p += 1 + ((p - pAnchor) >> 6);
+				continue;
+			}
+
+			const auto matchLength = MinMatch + countMatch(pRef + MinMatch, p + MinMatch, pMatchLimit);
+			pDst = emitSequence(pDst, pDstEnd, pAnchor, p - pAnchor, static_cast<uint32_t>(p - pRef), matchLength);
+			if (!pDst) return 0;
+
+			p += matchLength;
+			pAnchor = p;
+
+			// Seed the table at the end of the match, so that runs continue with offset 1
+			if (p < pSearchEnd) table[hashSequence(read32(p - 2))] = static_cast<uint32_t>(p - 2 - pSrc);
+		}
+	}
+
+	pDst = emitSequence(pDst, pDstEnd, pAnchor, pSrcEnd - pAnchor, 0, 0);
+
+	return pDst ? pDst - pDstBegin : 0;
+}
+
+bool LZCodec::Decompress(const uint8_t* pSrc, size_t srcSize, uint8_t* pDst, size_t dstSize)
+{
+	const auto pSrcEnd = pSrc + srcSize;
+	const auto pDstBegin = pDst;
+	const auto pDstEnd = pDst + dstSize;
+
+	while (pSrc < pSrcEnd)
+	{
+		const auto token = *pSrc++;
+
+		// Literals
+		size_t numLiterals = token >> 4;
+		if (numLiterals == 15 && !readLength(pSrc, pSrcEnd, numLiterals)) return false;
+		if (numLiterals > static_cast<size_t>(pSrcEnd - pSrc) ||
+			numLiterals > static_cast<size_t>(pDstEnd - pDst)) return false;
+		memcpy(pDst, pSrc, numLiterals);
+		pSrc += numLiterals;
+		pDst += numLiterals;
+
+		// The last sequence has no match
+		if (pSrc == pSrcEnd) break;
+
+		// Match
+		if (pSrcEnd - pSrc < 2) return false;
+		const size_t offset = pSrc[0] | (pSrc[1] << 8);
+		pSrc += 2;
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !readLength(pSrc, pSrcEnd, matchLength)) return false;
+		matchLength += MinMatch;
+		if (!offset || offset > static_cast<size_t>(pDst - pDstBegin) ||
+			matchLength > static_cast<size_t>(pDstEnd - pDst)) return false;
+
+		const auto pRef = pDst - offset;
+		if (offset == 1) memset(pDst, *pRef, matchLength);
+		else if (offset >= matchLength) memcpy(pDst, pRef, matchLength);
+		else if (offset >= sizeof(uint64_t))
+		{
+			// Overlapping copy in steps that never read ahead of what has been written
+			for (size_t i = 0; i < matchLength; i += offset)
+				memcpy(pDst + i, pRef + i, (min)(offset, matchLength - i));
+		}
+		else for (size_t i = 0; i < matchLength; ++i) pDst[i] = pRef[i];
+		pDst += matchLength;
+	}
+
+	return pDst == pDstEnd;
+}
@@ -0,0 +1,28 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//--------------------------------------------------------------------------------------
+// Byte-oriented LZ77 block codec in the spirit of LZ4: greedy hash-chain-free matching,
+// 64 KB window, no entropy stage. Tuned for voxel chunks, which are dominated by long
+// runs, so offset-1 matches decode as memset.
+//
+// Sequence: token (literal length << 4 | (match length - 4)), extra literal length
+// bytes, literals, 16-bit little-endian offset, extra match length bytes. Lengths of
+// 15 continue with bytes of 255 until a smaller byte. The last sequence has literals only.
+//--------------------------------------------------------------------------------------
+namespace LZCodec
+{
+	size_t GetMaxCompressedSize(size_t srcSize);
+
+	// Returns the compressed size, or 0 if dstCapacity is too small
+	size_t Compress(const uint8_t* pSrc, size_t srcSize, uint8_t* pDst, size_t dstCapacity);
+
+	// Succeeds only if the block decodes to exactly dstSize bytes
+	bool Decompress(const uint8_t* pSrc, size_t srcSize, uint8_t* pDst, size_t dstSize);
+}
@@ -0,0 +1,134 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <atomic>
+#include "MacroCellGrid.h"
+#include "ParallelFor.h"
+
+using namespace std;
+
+MacroCellGrid::MacroCellGrid() :
+	m_memory(MemoryRegistry::SPARSE_GRID),
+	m_cellSize(0),
+	m_width(0),
+	m_height(0),
+	m_depth(0),
+	m_numEmptyCells(0)
+{
+}
+
+MacroCellGrid::~MacroCellGrid()
+{
+}
+
+bool MacroCellGrid::Create(const VoxelGrid& grid, uint32_t cellSize, uint32_t numThreads)
+{
+	const auto width = grid.GetWidth();
+	const auto height = grid.GetHeight();
+	const auto depth = grid.GetDepth();
+	if (!cellSize || !grid.GetNumVoxels()) return false;
+
+	m_cellSize = cellSize;
+	m_width = (width + cellSize - 1) / cellSize;
+	m_height = (height + cellSize - 1) / cellSize;
+	m_depth = (depth + cellSize - 1) / cellSize;
+	m_min.resize(static_cast<size_t>(m_width) * m_height * m_depth);
+	m_max.resize(m_min.size());
+	m_memory.Set(m_min.capacity() + m_max.capacity());
+
+	// One row of cells along x per task
+	atomic<uint32_t> numEmptyCells(0);
+	ParallelFor(0, m_height * m_depth, numThreads, [&](uint32_t i)
+	{
+		const auto cy = i % m_height;
+		const auto cz = i / m_height;
+		const auto yBegin = cy * cellSize > 0 ? cy * cellSize - 1 : 0;
+		const auto zBegin = cz * cellSize > 0 ? cz * cellSize - 1 : 0;
+		const auto yEnd = (min)((cy + 1) * cellSize + 1, height);
+		const auto zEnd = (min)((cz + 1) * cellSize + 1, depth);
+
+		auto numEmpty = 0u;
+		for (auto cx = 0u; cx < m_width; ++cx)
+		{
+			const auto xBegin = cx * cellSize > 0 ? cx * cellSize - 1 : 0;
+			const auto xEnd = (min)((cx + 1) * cellSize + 1, width);
+
+			uint8_t minValue = 0xff, maxValue = 0;
+			for (auto z = zBegin; z < zEnd; ++z)
+			{
+				for (auto y = yBegin; y < yEnd; ++y)
+				{
+					if (grid.GetLayout() == VoxelGrid::LINEAR)
+					{
+						const auto pRow = &grid.GetData()[grid.GetIndex(0, y, z)];
+						const auto range = minmax_element(&pRow[xBegin], &pRow[xEnd]);
+						minValue = (min)(minValue, *range.first);
+						maxValue = (max)(maxValue, *range.second);
+					}
+					else for (auto x = xBegin; x < xEnd; ++x)
+					{
+						const auto value = grid.Get(x, y, z);
+						minValue = (min)(minValue, value);
+						maxValue = (max)(maxValue, value);
+					}
+				}
+			}
+
+			const auto index = getIndex(cx, cy, cz);
+			m_min[index] = minValue;
+			m_max[index] = maxValue;
+			numEmpty += maxValue ? 0 : 1;
+		}
+		numEmptyCells += numEmpty;
+	});
+	m_numEmptyCells = numEmptyCells;
+
+	return true;
+}
+
+uint8_t MacroCellGrid::GetMin(uint32_t cx, uint32_t cy, uint32_t cz) const
+{
+	return m_min[getIndex(cx, cy, cz)];
+}
+
+uint8_t MacroCellGrid::GetMax(uint32_t cx, uint32_t cy, uint32_t cz) const
+{
+	return m_max[getIndex(cx, cy, cz)];
+}
+
+bool MacroCellGrid::IsEmpty(uint32_t cx, uint32_t cy, uint32_t cz) const
+{
+	return !GetMax(cx, cy, cz);
+}
+
+uint32_t MacroCellGrid::GetCellSize() const
+{
+	return m_cellSize;
+}
+
+uint32_t MacroCellGrid::GetWidth() const
+{
+	return m_width;
+}
+
+uint32_t MacroCellGrid::GetHeight() const
+{
+	return m_height;
+}
+
+uint32_t MacroCellGrid::GetDepth() const
+{
+	return m_depth;
+}
+
+uint32_t MacroCellGrid::GetNumEmptyCells() const
+{
+	return m_numEmptyCells;
+}
+
+size_t MacroCellGrid::getIndex(uint32_t cx, uint32_t cy, uint32_t cz) const
+{
+	return (static_cast<size_t>(m_height) * cz + cy) * m_width + cx;
+}
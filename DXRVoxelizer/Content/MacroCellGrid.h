@@ -0,0 +1,44 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "VoxelGrid.h"
+
+//--------------------------------------------------------------------------------------
+// Coarse min/max density grid over cells of CellSize^3 voxels. Each cell covers every
+// voxel that a trilinear sample inside the cell can read, i.e. its footprint is dilated
+// by one voxel, so a cell with a zero maximum guarantees zero density anywhere inside.
+//--------------------------------------------------------------------------------------
+class MacroCellGrid
+{
+public:
+	MacroCellGrid();
+	virtual ~MacroCellGrid();
+
+	bool Create(const VoxelGrid& grid, uint32_t cellSize = 4, uint32_t numThreads = 0);
+
+	uint8_t GetMin(uint32_t cx, uint32_t cy, uint32_t cz) const;
+	uint8_t GetMax(uint32_t cx, uint32_t cy, uint32_t cz) const;
+	bool IsEmpty(uint32_t cx, uint32_t cy, uint32_t cz) const;
+
+	uint32_t GetCellSize() const;
+	uint32_t GetWidth() const;	// In cells
+	uint32_t GetHeight() const;
+	uint32_t GetDepth() const;
+	uint32_t GetNumEmptyCells() const;
+
+protected:
+	size_t getIndex(uint32_t cx, uint32_t cy, uint32_t cz) const;
+
+	std::vector<uint8_t> m_min;
+	std::vector<uint8_t> m_max;
+	MemoryRegistry::Allocation m_memory;
+
+	uint32_t	m_cellSize;
+	uint32_t	m_width;
+	uint32_t	m_height;
+	uint32_t	m_depth;
+	uint32_t	m_numEmptyCells;
+};
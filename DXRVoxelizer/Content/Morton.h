@@ -0,0 +1,91 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define MORTON_USE_BMI2 1
+#include <immintrin.h>
+#else
+#define MORTON_USE_BMI2 0
+#endif
+
+//--------------------------------------------------------------------------------------
+// 3D Morton (Z-curve) codes with 10 bits per axis, i.e. up to 1024^3 voxels.
+// Bit i of x, y and z goes to bit 3i, 3i + 1 and 3i + 2 of the code, respectively.
+//--------------------------------------------------------------------------------------
+namespace Morton
+{
+	static const uint32_t MaskX = 0x09249249;
+	static const uint32_t MaskY = 0x12492492;
+	static const uint32_t MaskZ = 0x24924924;
+
+	// Spread the lower 10 bits of v to every 3rd bit
+	inline uint32_t Part1By2(uint32_t v)
+	{
+#if MORTON_USE_BMI2
+		return _pdep_u32(v, MaskX);
+#else
+		v &= 0x000003ff;
+		v = (v ^ (v << 16)) & 0xff0000ff;
+		v = (v ^ (v << 8)) & 0x0300f00f;
+		v = (v ^ (v << 4)) & 0x030c30c3;
+		v = (v ^ (v << 2)) & 0x09249249;
+
+		return v;
+#endif
+	}
+
+	// Inverse of Part1By2
+	inline uint32_t Compact1By2(uint32_t v)
+	{
+#if MORTON_USE_BMI2
+		return _pext_u32(v, MaskX);
+#else
+		v &= 0x09249249;
+		v = (v ^ (v >> 2)) & 0x030c30c3;
+		v = (v ^ (v >> 4)) & 0x0300f00f;
+		v = (v ^ (v >> 8)) & 0xff0000ff;
+		v = (v ^ (v >> 16)) & 0x000003ff;
+
+		return v;
+#endif
+	}
+
+	inline uint32_t Encode(uint32_t x, uint32_t y, uint32_t z)
+	{
+#if MORTON_USE_BMI2
+		return _pdep_u32(x, MaskX) | _pdep_u32(y, MaskY) | _pdep_u32(z, MaskZ);
+#else
+		return Part1By2(x) | (Part1By2(y) << 1) | (Part1By2(z) << 2);
+#endif
+	}
+
+	inline void Decode(uint32_t code, uint32_t& x, uint32_t& y, uint32_t& z)
+	{
+#if MORTON_USE_BMI2
+		x = _pext_u32(code, MaskX);
+		y = _pext_u32(code, MaskY);
+		z = _pext_u32(code, MaskZ);
+#else
+		x = Compact1By2(code);
+		y = Compact1By2(code >> 1);
+		z = Compact1By2(code >> 2);
+#endif
+	}
+
+	// Step one voxel along the axis selected by mask without decoding, e.g. for
+	// stencil neighbourhoods. Wrap-around must be handled by the caller.
+	inline uint32_t Inc(uint32_t code, uint32_t mask)
+	{
+		return (((code | ~mask) + 1) & mask) | (code & ~mask);
+	}
+
+	inline uint32_t Dec(uint32_t code, uint32_t mask)
+	{
+		return (((code & mask) - 1) & mask) | (code & ~mask);
+	}
+}
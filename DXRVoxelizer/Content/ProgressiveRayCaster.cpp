@@ -0,0 +1,306 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include "BlueNoise.h"
+#include "ParallelFor.h"
+#include "ProgressiveRayCaster.h"
+#include "SharedConst.h"
+
+#define ABSORPTION			1.0f
+#define ZERO_THRESHOLD		0.01f
+
+using namespace std;
+
+namespace
+{
+	const float g_stepScale = 2.0f * sqrtf(3.0f) / RayCasterCPU::NumSamples;
+
+	const Float3 g_clearColor(CLEAR_COLOR);
+
+	inline float saturate(float x)
+	{
+		return (min)((max)(x, 0.0f), 1.0f);
+	}
+
+	inline bool isOutside(const Float3& pos)
+	{
+		return fabsf(pos.x) > 1.0f || fabsf(pos.y) > 1.0f || fabsf(pos.z) > 1.0f;
+	}
+
+	inline uint8_t toUnorm8(float x)
+	{
+		return static_cast<uint8_t>(saturate(x) * 255.0f + 0.5f);
+	}
+
+	// Integer hash with good avalanche (lowbias32)
+	inline uint32_t hashPixel(uint32_t x)
+	{
+		x ^= x >> 16;
+		x *= 0x7feb352d;
+		x ^= x >> 15;
+		x *= 0x846ca68b;
+		x ^= x >> 16;
+
+		return x;
+	}
+}
+
+const float ProgressiveRayCaster::MotionThreshold = 8.0f;
+
+ProgressiveRayCaster::ProgressiveRayCaster() :
+	RayCasterCPU(),
+	m_historyIndex(0),
+	m_prevLocalToScreen(Float4x4::Identity()),
+	m_samplesPerFrame(0),
+	m_maxFrames(0),
+	m_frameIndex(0),
+	m_numFrames(0),
+	m_numResets(0),
+	m_numStillFrames(0),
+	m_gridGeneration(0),
+	m_lighting(LIGHT_MARCH)
+{
+}
+
+ProgressiveRayCaster::~ProgressiveRayCaster()
+{
+}
+
+bool ProgressiveRayCaster::Init(uint32_t width, uint32_t height, const VoxelGrid& grid, const float bound[4],
+	const float posScale[4], const MacroCellGrid* pMacroCells, const TransmittanceVolume* pTransmittance,
+	uint32_t numSamples, uint32_t maxFrames)
+{
+	if (!numSamples || numSamples > NumSamples || NumSamples % numSamples || !maxFrames) return false;
+	if (!RayCasterCPU::Init(width, height, grid, bound, posScale, pMacroCells, pTransmittance)) return false;
+
+	m_samplesPerFrame = numSamples;
+	m_maxFrames = maxFrames;
+	for (auto& history : m_history) history.assign(static_cast<size_t>(width) * height, HistoryTexel());
+	m_historyIndex = 0;
+	m_frameIndex = 0;
+	m_numFrames = 0;
+	m_numResets = 0;
+	m_numStillFrames = 0;
+
+	return true;
+}
+
+void ProgressiveRayCaster::RenderFrame(uint8_t* pImage, Lighting lighting, uint32_t numThreads)
+{
+	if (!m_pGrid) return;
+
+	m_numSamples = 0;
+	lighting = getValidLighting(lighting);
+
+	const auto motion = m_numFrames ? getMotion() : FLT_MAX;
+	if (m_numFrames && motion > MotionThreshold) Reset();
+
+	const auto gridGeneration = m_pGrid->GetGeneration();
+	const auto isStill = m_numFrames && motion == 0.0f && gridGeneration == m_gridGeneration && lighting == m_lighting;
+	m_numStillFrames = isStill ? m_numStillFrames + 1 : 0;
+	m_gridGeneration = gridGeneration;
+	m_lighting = lighting;
+
+	const auto isComplete = IsComplete();
+	const auto numTilesX = (m_width + TileSize - 1) / TileSize;
+	const auto numTilesY = (m_height + TileSize - 1) / TileSize;
+	ParallelFor(0, numTilesX * numTilesY, numThreads, [&](uint32_t i)
+	{
+		const auto x0 = i % numTilesX * TileSize;
+		const auto y0 = i / numTilesX * TileSize;
+		const auto xEnd = (min)(x0 + TileSize, m_width);
+		const auto yEnd = (min)(y0 + TileSize, m_height);
+
+		uint64_t numSamples = 0;
+		for (auto y = y0; y < yEnd; ++y)
+			for (auto x = x0; x < xEnd; ++x)
+			{
+				const auto pPixel = &pImage[(static_cast<size_t>(m_width) * y + x) * 4];
+				if (isComplete) resolvePixel(pPixel, m_history[m_historyIndex][static_cast<size_t>(m_width) * y + x]);
+				else marchPixel(pPixel, x, y, lighting, numSamples);
+			}
+		m_numSamples += numSamples;
+	});
+	if (isComplete)
+	{
+		++m_numFrames;
+
+		return;
+	}
+
+	// The next frame reads this one through the current camera
+	m_historyIndex ^= 1;
+	Inverse(m_prevLocalToScreen, m_screenToLocal);
+	++m_frameIndex;
+	++m_numFrames;
+}
+
+void ProgressiveRayCaster::Reset()
+{
+	m_numFrames = 0;
+	m_numStillFrames = 0;
+	++m_numResets;
+}
+
+uint32_t ProgressiveRayCaster::GetNumFrames() const
+{
+	return m_numFrames;
+}
+
+// Every subset of the pixels has marched its full ray in the still frames after the first
+// at the camera, which may have blended into a history of other cameras
+bool ProgressiveRayCaster::IsComplete() const
+{
+	return m_numStillFrames > NumSamples / m_samplesPerFrame;
+}
+
+uint32_t ProgressiveRayCaster::GetNumResets() const
+{
+	return m_numResets;
+}
+
+// A per-pixel random offset advanced by the golden ratio every frame, so that each pixel
+// walks a low-discrepancy sequence over its strata
+float ProgressiveRayCaster::getJitter(uint32_t x, uint32_t y) const
+{
+	const auto sequence = hashPixel(m_width * y + x) + 0x9e3779b9u * m_frameIndex;
+
+	return (sequence >> 8) * (1.0f / (1 << 24));
+}
+
+// Largest screen-space displacement of the grid box corners since the previous frame
+float ProgressiveRayCaster::getMotion() const
+{
+	Float4x4 localToScreen;
+	if (!Inverse(localToScreen, m_screenToLocal)) return FLT_MAX;
+
+	auto motion = 0.0f;
+	for (auto i = 0; i < 8; ++i)
+	{
+		const Float3 corner(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f);
+		const auto offset = TransformCoord(corner, localToScreen) - TransformCoord(corner, m_prevLocalToScreen);
+		motion = (max)(motion, sqrtf(offset.x * offset.x + offset.y * offset.y));
+	}
+
+	return motion == motion ? motion : FLT_MAX;
+}
+
+// Stratified estimate of a ray from its entry point: a sample at a jittered point of each
+// stratum stands for its fine steps, which attenuate by a^n and scatter a * (1 - a^n) of
+// the throughput together. It is biased, as a^n of one sample is not the product over
+// the steps, so it only stands in until the full ray of the pixel.
+void ProgressiveRayCaster::estimateRay(Float3 pos, const Float3& rayDir, uint32_t x, uint32_t y,
+	Lighting lighting, float& transmit, float& scatter, float& depth, uint64_t& numSamples) const
+{
+	const auto stepsPerSample = static_cast<float>(NumSamples / m_samplesPerFrame);
+	const auto step = rayDir * (g_stepScale * stepsPerSample);
+	const auto isSkipping = m_pMacroCells != nullptr;
+	auto samplePos = pos + step * getJitter(x, y);
+
+	transmit = 1.0f;
+	scatter = 0.0f;
+	depth = FLT_MAX;
+	for (auto i = 0u; i < m_samplesPerFrame; ++i)
+	{
+		if (isOutside(samplePos)) break;
+
+		const auto tex = Float3(0.5f, -0.5f, 0.5f) * samplePos + Float3(0.5f, 0.5f, 0.5f);
+		const auto density = getSample(tex);
+		++numSamples;
+
+		if (density > ZERO_THRESHOLD)
+		{
+			depth = depth < FLT_MAX ? depth : Length(samplePos - m_localSpaceEyePt);
+
+			const auto atten = saturate(1.0f - density * g_stepScale * ABSORPTION);
+			const auto transmitIn = transmit;
+			transmit *= powf(atten, stepsPerSample);
+
+			const auto lightTrans = getLightTransmittance(samplePos, lighting, isSkipping, numSamples);
+			scatter += lightTrans * atten * (transmitIn - transmit);
+			if (transmit < ZERO_THRESHOLD) break;
+		}
+
+		samplePos += step;
+	}
+}
+
+void ProgressiveRayCaster::marchPixel(uint8_t* pPixel, uint32_t x, uint32_t y, Lighting lighting,
+	uint64_t& numSamples)
+{
+	const auto index = static_cast<size_t>(m_width) * y + x;
+	auto& texel = m_history[m_historyIndex ^ 1][index];
+
+	// The point on the near plane through the pixel center, as SV_POSITION
+	auto pos = TransformCoord(Float3(x + 0.5f, y + 0.5f, 0.0f), m_screenToLocal);
+	const auto rayDir = Normalize(pos - m_localSpaceEyePt);
+	if (!computeStartPoint(pos, rayDir))
+	{
+		texel.Count = -1.0f;
+		texel.Depth = FLT_MAX;
+		resolvePixel(pPixel, texel);
+
+		return;
+	}
+
+	// Every pixel marches its full ray once in the frames of a cycle, in the order of the
+	// blue noise, so that the pixels of a frame spread evenly
+	const auto numSubsets = NumSamples / m_samplesPerFrame;
+	const auto subset = (min)(static_cast<uint32_t>(BlueNoise::GetOffset(x, y, 2) * numSubsets), numSubsets - 1);
+	const auto isMarched = (subset + m_frameIndex) % numSubsets == 0;
+
+	auto transmit = 1.0f, scatter = 0.0f, depth = FLT_MAX;
+	if (isMarched) marchRay(x + 0.5f, y + 0.5f, FIXED_STEP, lighting, transmit, scatter, depth, numSamples);
+	else if (m_numFrames) depth = m_history[m_historyIndex][index].Depth;	// Of the last frame, for reprojection
+
+	// The history at the previous position of the first occupied sample, or of the entry point
+	const HistoryTexel* pPrev = nullptr;
+	if (m_numFrames)
+	{
+		const auto depthPt = depth < FLT_MAX ? m_localSpaceEyePt + rayDir * depth : pos;
+		const auto prevPt = TransformCoord(depthPt, m_prevLocalToScreen);
+		if (prevPt.x >= 0.0f && prevPt.y >= 0.0f && prevPt.x < m_width && prevPt.y < m_height)
+			pPrev = &m_history[m_historyIndex][static_cast<size_t>(m_width) * static_cast<uint32_t>(prevPt.y) +
+				static_cast<uint32_t>(prevPt.x)];
+	}
+
+	if (isMarched || !pPrev || pPrev->Count < 0.0f)
+	{
+		// A full ray blends into the full rays of the history, and replaces an estimate, or
+		// any history at a still camera, of which it is exact
+		if (!isMarched) estimateRay(pos, rayDir, x, y, lighting, transmit, scatter, depth, numSamples);
+		const auto count = isMarched && !m_numStillFrames && pPrev && pPrev->Count > 0.0f ?
+			(min)(pPrev->Count, m_maxFrames - 1.0f) : 0.0f;
+		const auto weight = 1.0f / (count + 1.0f);
+		const auto result = scatter * 0.8f + 0.2f;
+		for (auto i = 0; i < 3; ++i)
+		{
+			const auto clear = g_clearColor[i] * g_clearColor[i];
+			const auto color = result + (clear - result) * transmit;
+			texel.Color[i] = count > 0.0f ? pPrev->Color[i] + (color - pPrev->Color[i]) * weight : color;
+		}
+		texel.Count = isMarched ? count + 1.0f : 0.0f;
+		texel.Depth = depth;
+	}
+	else texel = *pPrev;
+
+	resolvePixel(pPixel, texel);
+}
+
+void ProgressiveRayCaster::resolvePixel(uint8_t* pPixel, const HistoryTexel& texel) const
+{
+	if (texel.Count < 0.0f)
+	{
+		for (auto i = 0; i < 3; ++i) pPixel[i] = toUnorm8(g_clearColor[i]);
+		pPixel[3] = 0;
+
+		return;
+	}
+
+	for (auto i = 0; i < 3; ++i) pPixel[i] = toUnorm8(sqrtf(texel.Color[i]));
+	pPixel[3] = 0xff;
+}
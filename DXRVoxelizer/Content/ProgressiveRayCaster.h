@@ -0,0 +1,75 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "RayCasterCPU.h"
+
+//--------------------------------------------------------------------------------------
+// Progressive mode of the CPU ray caster. Each frame marches the full fixed-step ray of
+// a rotating blue-noise subset of the pixels, NumSamples / numSamples frames apart, and
+// blends it into a history that is reprojected from the previous frame; the other pixels
+// keep their history. A pixel with no history shows an estimate of a jittered sample
+// per stratum until its first full ray replaces it. With a still camera the image
+// converges to that of RayCasterCPU::Render; a motion of more than MotionThreshold pixels
+// restarts the accumulation. The full rays are deterministic, so once every pixel has
+// one at a still camera, grid and lighting, frames only resolve the history.
+//--------------------------------------------------------------------------------------
+class ProgressiveRayCaster :
+	public RayCasterCPU
+{
+public:
+	ProgressiveRayCaster();
+	virtual ~ProgressiveRayCaster();
+
+	// numSamples, the samples per pixel of a frame on average, divides RayCasterCPU::NumSamples;
+	// maxFrames bounds the weight of the history
+	bool Init(uint32_t width, uint32_t height, const VoxelGrid& grid, const float bound[4],
+		const float posScale[4], const MacroCellGrid* pMacroCells = nullptr,
+		const TransmittanceVolume* pTransmittance = nullptr, uint32_t numSamples = 16,
+		uint32_t maxFrames = 256);
+
+	// Marches a frame at the camera of the last UpdateFrame into the history and resolves
+	// it to pImage, width * height * 4 bytes
+	void RenderFrame(uint8_t* pImage, Lighting lighting = LIGHT_MARCH, uint32_t numThreads = 0);
+	void Reset();
+
+	uint32_t GetNumFrames() const;	// Accumulated since the last reset
+	bool IsComplete() const;		// Whether the next frame at the same camera only resolves
+	uint32_t GetNumResets() const;
+
+	static const float MotionThreshold;	// Pixels
+
+protected:
+	struct HistoryTexel
+	{
+		float Color[3];	// Before the square root of the blend
+		float Count;	// Of full rays; 0 for an estimate, negative for a ray missing the grid
+		float Depth;	// From the eye to the first occupied sample, FLT_MAX if none
+	};
+
+	float getJitter(uint32_t x, uint32_t y) const;
+	float getMotion() const;
+	void estimateRay(Float3 pos, const Float3& rayDir, uint32_t x, uint32_t y, Lighting lighting,
+		float& transmit, float& scatter, float& depth, uint64_t& numSamples) const;
+	void marchPixel(uint8_t* pPixel, uint32_t x, uint32_t y, Lighting lighting, uint64_t& numSamples);
+	void resolvePixel(uint8_t* pPixel, const HistoryTexel& texel) const;
+
+	std::vector<HistoryTexel> m_history[2];
+	uint32_t	m_historyIndex;
+
+	Float4x4	m_prevLocalToScreen;
+
+	uint32_t	m_samplesPerFrame;
+	uint32_t	m_maxFrames;
+	uint32_t	m_frameIndex;
+	uint32_t	m_numFrames;
+	uint32_t	m_numResets;
+
+	// Frames at the camera, grid and lighting of the last one, which replace the history
+	// of a pixel with its full ray rather than blend it in
+	uint32_t	m_numStillFrames;
+	uint64_t	m_gridGeneration;
+	Lighting	m_lighting;
+};
@@ -0,0 +1,301 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstring>
+#include "RLEGrid.h"
+#include "VoxelGrid.h"
+
+using namespace std;
+
+RLEGrid::RLEGrid() :
+	m_memory(MemoryRegistry::SPARSE_GRID),
+	m_width(0),
+	m_height(0),
+	m_depth(0)
+{
+}
+
+RLEGrid::~RLEGrid()
+{
+}
+
+bool RLEGrid::Create(uint32_t width, uint32_t height, uint32_t depth)
+{
+	if (!width || !height || !depth || width > UINT16_MAX) return false;
+
+	m_width = width;
+	m_height = height;
+	m_depth = depth;
+	m_runs.clear();
+	m_columnOffsets.clear();
+	m_columnOffsets.reserve(static_cast<size_t>(height) * depth + 1);
+	m_columnOffsets.push_back(0);
+	updateMemory();
+
+	return true;
+}
+
+void RLEGrid::AppendRun(uint16_t begin, uint16_t end)
+{
+	if (begin >= end) return;
+
+	// Coalesce with the previous run of the same column when touching
+	if (m_runs.size() > m_columnOffsets.back() && m_runs.back().End >= begin)
+		m_runs.back().End = (max)(m_runs.back().End, end);
+	else m_runs.push_back({ begin, end });
+}
+
+void RLEGrid::EndColumn()
+{
+	m_columnOffsets.push_back(static_cast<uint32_t>(m_runs.size()));
+	updateMemory();	// Registers only when a capacity grows
+}
+
+void RLEGrid::SetColumns(vector<vector<Run>>& columns)
+{
+	size_t numRuns = 0;
+	for (const auto& column : columns) numRuns += column.size();
+
+	m_runs.clear();
+	m_runs.reserve(numRuns);
+	m_columnOffsets.resize(1);
+	for (auto& column : columns)
+	{
+		m_runs.insert(m_runs.end(), column.cbegin(), column.cend());
+		m_columnOffsets.push_back(static_cast<uint32_t>(m_runs.size()));
+		vector<Run>().swap(column);
+	}
+	updateMemory();
+}
+
+bool RLEGrid::Get(uint32_t x, uint32_t y, uint32_t z) const
+{
+	uint32_t numRuns;
+	const auto pRuns = GetRuns(y, z, numRuns);
+
+	// The last run starting at or before x
+	const auto pRun = upper_bound(pRuns, pRuns + numRuns, x,
+		[](uint32_t x, const Run& run) { return x < run.Begin; });
+
+	return pRun != pRuns && x < (pRun - 1)->End;
+}
+
+const RLEGrid::Run* RLEGrid::GetRuns(uint32_t y, uint32_t z, uint32_t& numRuns) const
+{
+	const auto column = static_cast<size_t>(m_height) * z + y;
+	const auto offset = m_columnOffsets[column];
+	numRuns = m_columnOffsets[column + 1] - offset;
+
+	return m_runs.data() + offset;
+}
+
+bool RLEGrid::FromDense(const VoxelGrid& grid, uint8_t threshold)
+{
+	if (!Create(grid.GetWidth(), grid.GetHeight(), grid.GetDepth())) return false;
+
+	const auto isLinear = grid.GetLayout() == VoxelGrid::LINEAR;
+	for (auto z = 0u; z < m_depth; ++z)
+	{
+		for (auto y = 0u; y < m_height; ++y)
+		{
+			const auto pRow = isLinear ? &grid.GetData()[grid.GetIndex(0, y, z)] : nullptr;
+			auto begin = 0u;
+			auto isInRun = false;
+			for (auto x = 0u; x < m_width; ++x)
+			{
+				const auto isOccupied = (pRow ? pRow[x] : grid.Get(x, y, z)) > threshold;
+				if (isOccupied && !isInRun) begin = x;
+				else if (!isOccupied && isInRun) AppendRun(static_cast<uint16_t>(begin), static_cast<uint16_t>(x));
+				isInRun = isOccupied;
+			}
+			if (isInRun) AppendRun(static_cast<uint16_t>(begin), static_cast<uint16_t>(m_width));
+			EndColumn();
+		}
+	}
+
+	return true;
+}
+
+bool RLEGrid::ToDense(VoxelGrid& grid, uint8_t value) const
+{
+	if (grid.GetWidth() != m_width || grid.GetHeight() != m_height || grid.GetDepth() != m_depth)
+	{
+		if (!grid.Create(m_width, m_height, m_depth)) return false;
+	}
+	else grid.Clear();
+
+	const auto isLinear = grid.GetLayout() == VoxelGrid::LINEAR;
+	for (auto z = 0u; z < m_depth; ++z)
+	{
+		for (auto y = 0u; y < m_height; ++y)
+		{
+			uint32_t numRuns;
+			const auto pRuns = GetRuns(y, z, numRuns);
+			const auto pRow = isLinear ? &grid.GetData()[grid.GetIndex(0, y, z)] : nullptr;
+			for (auto i = 0u; i < numRuns; ++i)
+			{
+				const auto& run = pRuns[i];
+				if (pRow) memset(&pRow[run.Begin], value, run.End - run.Begin);
+				else for (uint32_t x = run.Begin; x < run.End; ++x) grid.Set(x, y, z, value);
+			}
+		}
+	}
+
+	return true;
+}
+
+bool RLEGrid::Union(RLEGrid& result, const RLEGrid& a, const RLEGrid& b)
+{
+	if (!a.isCompatible(b) || !result.Create(a.m_width, a.m_height, a.m_depth)) return false;
+
+	result.m_runs.reserve((max)(a.m_runs.size(), b.m_runs.size()));
+	const auto numColumns = a.GetNumColumns();
+	for (size_t c = 0; c < numColumns; ++c)
+	{
+		auto i = a.m_columnOffsets[c], j = b.m_columnOffsets[c];
+		const auto iEnd = a.m_columnOffsets[c + 1], jEnd = b.m_columnOffsets[c + 1];
+
+		// Emit the runs in order of their beginnings; AppendRun coalesces overlaps
+		while (i < iEnd || j < jEnd)
+		{
+			const auto& run = j >= jEnd || (i < iEnd && a.m_runs[i].Begin <= b.m_runs[j].Begin) ?
+				a.m_runs[i++] : b.m_runs[j++];
+			result.AppendRun(run.Begin, run.End);
+		}
+		result.EndColumn();
+	}
+
+	return true;
+}
+
+bool RLEGrid::Intersect(RLEGrid& result, const RLEGrid& a, const RLEGrid& b)
+{
+	if (!a.isCompatible(b) || !result.Create(a.m_width, a.m_height, a.m_depth)) return false;
+
+	const auto numColumns = a.GetNumColumns();
+	for (size_t c = 0; c < numColumns; ++c)
+	{
+		auto i = a.m_columnOffsets[c], j = b.m_columnOffsets[c];
+		const auto iEnd = a.m_columnOffsets[c + 1], jEnd = b.m_columnOffsets[c + 1];
+		while (i < iEnd && j < jEnd)
+		{
+			const auto& runA = a.m_runs[i];
+			const auto& runB = b.m_runs[j];
+			result.AppendRun((max)(runA.Begin, runB.Begin), (min)(runA.End, runB.End));
+
+			// Advance the run that ends first
+			if (runA.End < runB.End) ++i;
+			else ++j;
+		}
+		result.EndColumn();
+	}
+
+	return true;
+}
+
+void RLEGrid::Serialize(vector<uint8_t>& data) const
+{
+	const uint32_t header[] =
+	{
+		FourCC, Version, m_width, m_height, m_depth,
+		static_cast<uint32_t>(m_runs.size())
+	};
+
+	const auto offsetsSize = sizeof(uint32_t) * m_columnOffsets.size();
+	const auto runsSize = sizeof(Run) * m_runs.size();
+	data.resize(sizeof(header) + offsetsSize + runsSize);
+
+	auto pDst = data.data();
+	memcpy(pDst, header, sizeof(header));
+	pDst += sizeof(header);
+	memcpy(pDst, m_columnOffsets.data(), offsetsSize);
+	pDst += offsetsSize;
+	if (runsSize) memcpy(pDst, m_runs.data(), runsSize);
+}
+
+bool RLEGrid::Deserialize(const uint8_t* pData, size_t size)
+{
+	uint32_t header[6];
+	if (!pData || size < sizeof(header)) return false;
+	memcpy(header, pData, sizeof(header));
+	if (header[0] != FourCC || header[1] != Version) return false;
+
+	// The sizes the header claims must be in the data before anything is allocated for them
+	const auto available = static_cast<uint64_t>(size - sizeof(header));
+	const auto numOffsets = static_cast<uint64_t>(header[3]) * header[4] + 1;
+	const size_t numRuns = header[5];
+	if (numOffsets > available / sizeof(uint32_t) ||
+		numRuns > (available - sizeof(uint32_t) * numOffsets) / sizeof(Run)) return false;
+	if (!Create(header[2], header[3], header[4])) return false;
+
+	const auto offsetsSize = sizeof(uint32_t) * static_cast<size_t>(numOffsets);
+	const auto runsSize = sizeof(Run) * numRuns;
+	m_columnOffsets.resize(static_cast<size_t>(numOffsets));
+	m_runs.resize(numRuns);
+	updateMemory();
+	memcpy(m_columnOffsets.data(), pData + sizeof(header), offsetsSize);
+	if (runsSize) memcpy(m_runs.data(), pData + sizeof(header) + offsetsSize, runsSize);
+
+	// Validate, as the data may come from another process
+	if (m_columnOffsets.front() != 0 || m_columnOffsets.back() != numRuns) return false;
+	for (size_t c = 0; c + 1 < m_columnOffsets.size(); ++c)
+	{
+		if (m_columnOffsets[c] > m_columnOffsets[c + 1]) return false;
+		auto prevEnd = 0u;
+		for (auto i = m_columnOffsets[c]; i < m_columnOffsets[c + 1]; ++i)
+		{
+			const auto& run = m_runs[i];
+			if (run.Begin < prevEnd || run.Begin >= run.End || run.End > m_width) return false;
+			prevEnd = run.End;
+		}
+	}
+
+	return true;
+}
+
+uint32_t RLEGrid::GetWidth() const
+{
+	return m_width;
+}
+
+uint32_t RLEGrid::GetHeight() const
+{
+	return m_height;
+}
+
+uint32_t RLEGrid::GetDepth() const
+{
+	return m_depth;
+}
+
+size_t RLEGrid::GetNumColumns() const
+{
+	return static_cast<size_t>(m_height) * m_depth;
+}
+
+size_t RLEGrid::GetNumRuns() const
+{
+	return m_runs.size();
+}
+
+size_t RLEGrid::GetNumOccupied() const
+{
+	size_t numOccupied = 0;
+	for (const auto& run : m_runs) numOccupied += run.End - run.Begin;
+
+	return numOccupied;
+}
+
+bool RLEGrid::isCompatible(const RLEGrid& other) const
+{
+	return m_width == other.m_width && m_height == other.m_height && m_depth == other.m_depth &&
+		m_columnOffsets.size() == GetNumColumns() + 1 &&
+		other.m_columnOffsets.size() == other.GetNumColumns() + 1;
+}
+
+void RLEGrid::updateMemory()
+{
+	m_memory.Set(sizeof(uint32_t) * m_columnOffsets.capacity() + sizeof(Run) * m_runs.capacity());
+}
@@ -0,0 +1,74 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MemoryRegistry.h"
+
+class VoxelGrid;
+
+//--------------------------------------------------------------------------------------
+// Run-length encoded occupancy grid for solid voxelization. Each column along x,
+// indexed by (y, z), keeps a sorted list of disjoint runs of occupied voxels.
+//--------------------------------------------------------------------------------------
+class RLEGrid
+{
+public:
+	struct Run
+	{
+		uint16_t Begin;	// First occupied voxel
+		uint16_t End;	// One past the last occupied voxel
+	};
+
+	RLEGrid();
+	virtual ~RLEGrid();
+
+	bool Create(uint32_t width, uint32_t height, uint32_t depth);
+
+	// Building in column order; columns must be appended from (0, 0) to (height - 1, depth - 1)
+	void AppendRun(uint16_t begin, uint16_t end);
+	void EndColumn();
+
+	// Building columns out of order, e.g. from parallel workers
+	void SetColumns(std::vector<std::vector<Run>>& columns);
+
+	bool Get(uint32_t x, uint32_t y, uint32_t z) const;
+	const Run* GetRuns(uint32_t y, uint32_t z, uint32_t& numRuns) const;
+
+	bool FromDense(const VoxelGrid& grid, uint8_t threshold = 0);
+	bool ToDense(VoxelGrid& grid, uint8_t value = 0xff) const;
+
+	// Per-column merges of the runs
+	static bool Union(RLEGrid& result, const RLEGrid& a, const RLEGrid& b);
+	static bool Intersect(RLEGrid& result, const RLEGrid& a, const RLEGrid& b);
+
+	// Compact little-endian wire format
+	void Serialize(std::vector<uint8_t>& data) const;
+	bool Deserialize(const uint8_t* pData, size_t size);
+
+	uint32_t GetWidth() const;
+	uint32_t GetHeight() const;
+	uint32_t GetDepth() const;
+	size_t GetNumColumns() const;
+	size_t GetNumRuns() const;
+	size_t GetNumOccupied() const;
+
+protected:
+	static const uint32_t FourCC = 0x564c4552; // "RLEV"
+	static const uint32_t Version = 1;
+
+	bool isCompatible(const RLEGrid& other) const;
+	void updateMemory();
+
+	std::vector<uint32_t>	m_columnOffsets;	// First run of each column, plus the total count
+	std::vector<Run>		m_runs;
+	MemoryRegistry::Allocation m_memory;
+
+	uint32_t	m_width;
+	uint32_t	m_height;
+	uint32_t	m_depth;
+};
@@ -0,0 +1,980 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <bitset>
+#include <cfloat>
+#include <cstring>
+#include "BlueNoise.h"
+#include "ParallelFor.h"
+#include "Profiler.h"
+#include "RayCasterCPU.h"
+#include "SharedConst.h"
+
+#if defined(__AVX2__)
+#define RAYCASTER_USE_AVX2 1
+#include <immintrin.h>
+#else
+#define RAYCASTER_USE_AVX2 0
+#endif
+
+#define ABSORPTION			1.0f
+#define ZERO_THRESHOLD		0.01f
+
+using namespace std;
+
+namespace
+{
+	const float g_maxDist = 2.0f * sqrtf(3.0f);
+	const float g_stepScale = g_maxDist / RayCasterCPU::NumSamples;
+	const float g_lightStepScale = g_maxDist / RayCasterCPU::NumLightSamples;
+
+	const Float3 g_clearColor(CLEAR_COLOR);
+
+	inline float sign(float x)
+	{
+		return x > 0.0f ? 1.0f : (x < 0.0f ? -1.0f : 0.0f);
+	}
+
+	inline float saturate(float x)
+	{
+		return (min)((max)(x, 0.0f), 1.0f);
+	}
+
+	inline bool isOutside(const Float3& pos)
+	{
+		return fabsf(pos.x) > 1.0f || fabsf(pos.y) > 1.0f || fabsf(pos.z) > 1.0f;
+	}
+
+	// UNORM conversion of the render target
+	inline uint8_t toUnorm8(float x)
+	{
+		return static_cast<uint8_t>(saturate(x) * 255.0f + 0.5f);
+	}
+
+	// Blends the scattered light over the clear color, or writes the clear color on a miss
+	void writePixel(uint8_t* pPixel, bool isHit, float transmit, float scatter)
+	{
+		if (!isHit)
+		{
+			for (auto i = 0; i < 3; ++i) pPixel[i] = toUnorm8(g_clearColor[i]);
+			pPixel[3] = 0;
+
+			return;
+		}
+
+		const auto result = scatter * 0.8f + 0.2f;
+		for (auto i = 0; i < 3; ++i)
+		{
+			const auto clear = g_clearColor[i] * g_clearColor[i];
+			pPixel[i] = toUnorm8(sqrtf(result + (clear - result) * transmit));
+		}
+		pPixel[3] = 0xff;
+	}
+}
+
+#if RAYCASTER_USE_AVX2
+namespace
+{
+	struct Float3x8
+	{
+		__m256 x, y, z;
+	};
+
+	inline __m256 saturate(__m256 x)
+	{
+		return _mm256_min_ps(_mm256_max_ps(x, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+	}
+
+	inline __m256 abs8(__m256 x)
+	{
+		return _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)));
+	}
+
+	inline __m256 isOutside(const Float3x8& pos)
+	{
+		const auto one = _mm256_set1_ps(1.0f);
+
+		return _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(abs8(pos.x), one, _CMP_GT_OQ),
+			_mm256_cmp_ps(abs8(pos.y), one, _CMP_GT_OQ)), _mm256_cmp_ps(abs8(pos.z), one, _CMP_GT_OQ));
+	}
+
+	inline Float3x8 toTex(const Float3x8& pos)
+	{
+		const auto half = _mm256_set1_ps(0.5f);
+
+		return { _mm256_add_ps(_mm256_mul_ps(pos.x, half), half),
+			_mm256_add_ps(_mm256_mul_ps(pos.y, _mm256_set1_ps(-0.5f)), half),
+			_mm256_add_ps(_mm256_mul_ps(pos.z, half), half) };
+	}
+
+	// powf of each lane, which has no AVX2 instruction
+	inline __m256 pow8(__m256 x, float y)
+	{
+		alignas(32) float lanes[8];
+		_mm256_store_ps(lanes, x);
+		for (auto& lane : lanes) lane = powf(lane, y);
+
+		return _mm256_load_ps(lanes);
+	}
+
+	inline uint32_t countLanes(__m256 mask)
+	{
+		return static_cast<uint32_t>(bitset<8>(_mm256_movemask_ps(mask)).count());
+	}
+
+	// VoxelGrid::Sample of the lanes in the mask on a linear grid, in the same arithmetic
+	// order; the corners are loaded per lane since bytes cannot be gathered safely, and
+	// their offsets are size_t, as int32 ones overflow from 2^31 voxels
+	__m256 sample(const VoxelGrid& grid, const Float3x8& tex, __m256 mask)
+	{
+		const size_t width = grid.GetWidth();
+		const auto slice = width * grid.GetHeight();
+
+		const auto axis = [](__m256 u, uint32_t n, __m256& t, __m256i& i0, __m256i& i1)
+		{
+			const auto f = _mm256_sub_ps(_mm256_mul_ps(u, _mm256_set1_ps(static_cast<float>(n))), _mm256_set1_ps(0.5f));
+			const auto fl = _mm256_floor_ps(f);
+			t = _mm256_sub_ps(f, fl);
+
+			const auto zero = _mm256_setzero_ps(), last = _mm256_set1_ps(n - 1.0f);
+			i0 = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(fl, zero), last));
+			i1 = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_add_ps(fl, _mm256_set1_ps(1.0f)), zero), last));
+		};
+
+		__m256 tx, ty, tz;
+		__m256i x0, x1, y0, y1, z0, z1;
+		axis(tex.x, grid.GetWidth(), tx, x0, x1);
+		axis(tex.y, grid.GetHeight(), ty, y0, y1);
+		axis(tex.z, grid.GetDepth(), tz, z0, z1);
+
+		alignas(32) int32_t ix[2][8], iy[2][8], iz[2][8];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(ix[0]), x0);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(ix[1]), x1);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(iy[0]), y0);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(iy[1]), y1);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(iz[0]), z0);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(iz[1]), z1);
+
+		alignas(32) float corners[8][8] = {};
+		const auto pData = grid.GetData();
+		const auto lanes = _mm256_movemask_ps(mask);
+		for (auto i = 0; i < 8; ++i)
+		{
+			if (!(lanes >> i & 1)) continue;
+			const size_t dx = ix[1][i] - ix[0][i];
+			const auto dy = (iy[1][i] - iy[0][i]) * width;
+			const auto dz = (iz[1][i] - iz[0][i]) * slice;
+			const auto p = &pData[ix[0][i] + iy[0][i] * width + iz[0][i] * slice];
+			corners[0][i] = p[0];
+			corners[1][i] = p[dx];
+			corners[2][i] = p[dy];
+			corners[3][i] = p[dy + dx];
+			corners[4][i] = p[dz];
+			corners[5][i] = p[dz + dx];
+			corners[6][i] = p[dz + dy];
+			corners[7][i] = p[dz + dy + dx];
+		}
+
+		__m256 c[8];
+		for (auto i = 0; i < 8; ++i) c[i] = _mm256_load_ps(corners[i]);
+		const auto lerp = [](__m256 a, __m256 b, __m256 t) { return _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), t)); };
+		const auto c00 = lerp(c[0], c[1], tx);
+		const auto c10 = lerp(c[2], c[3], tx);
+		const auto c01 = lerp(c[4], c[5], tx);
+		const auto c11 = lerp(c[6], c[7], tx);
+
+		return _mm256_div_ps(lerp(lerp(c00, c10, ty), lerp(c01, c11, ty), tz), _mm256_set1_ps(255.0f));
+	}
+
+	// RayCasterCPU::computeStartPoint of each lane; returns the mask of lanes that hit
+	__m256 computeStartPoints(Float3x8& pos, const Float3x8& rayDir)
+	{
+		const auto zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+		const auto isInside = _mm256_andnot_ps(isOutside(pos), _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+		if (_mm256_movemask_ps(isInside) == 0xff) return isInside;
+
+		const __m256* p = &pos.x;
+		const __m256* d = &rayDir.x;
+		auto U = _mm256_set1_ps(FLT_MAX);
+		auto isHit = zero;
+
+		for (auto i = 0; i < 3; ++i)
+		{
+			const auto sign = _mm256_sub_ps(_mm256_and_ps(_mm256_cmp_ps(d[i], zero, _CMP_GT_OQ), one),
+				_mm256_and_ps(_mm256_cmp_ps(d[i], zero, _CMP_LT_OQ), one));
+			const auto u = _mm256_div_ps(_mm256_sub_ps(_mm256_sub_ps(zero, sign), p[i]), d[i]);
+
+			// Unordered compares keep NaNs, as the negated tests of the scalar code
+			const auto j = (i + 1) % 3, k = (i + 2) % 3;
+			auto isValid = _mm256_cmp_ps(u, zero, _CMP_NLT_UQ);
+			isValid = _mm256_and_ps(isValid, _mm256_cmp_ps(abs8(_mm256_add_ps(_mm256_mul_ps(d[j], u), p[j])), one, _CMP_NGT_UQ));
+			isValid = _mm256_and_ps(isValid, _mm256_cmp_ps(abs8(_mm256_add_ps(_mm256_mul_ps(d[k], u), p[k])), one, _CMP_NGT_UQ));
+			isValid = _mm256_and_ps(isValid, _mm256_cmp_ps(u, U, _CMP_LT_OQ));
+			U = _mm256_blendv_ps(U, u, isValid);
+			isHit = _mm256_or_ps(isHit, isValid);
+		}
+
+		const auto minusOne = _mm256_set1_ps(-1.0f);
+		const auto clampPos = [&](__m256 d, __m256 p)
+		{
+			return _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(_mm256_mul_ps(d, U), p), minusOne), one);
+		};
+		pos.x = _mm256_blendv_ps(clampPos(rayDir.x, pos.x), pos.x, isInside);
+		pos.y = _mm256_blendv_ps(clampPos(rayDir.y, pos.y), pos.y, isInside);
+		pos.z = _mm256_blendv_ps(clampPos(rayDir.z, pos.z), pos.z, isInside);
+
+		return _mm256_or_ps(isInside, isHit);
+	}
+
+	// The light march of the lanes in the mask, each lane stopping on its own; the first
+	// sample of each lane is its jitter of a step in
+	__m256 marchLight(const VoxelGrid& grid, Float3x8 lightPos, const Float3& lightStep, float lightStepRatio,
+		uint32_t numLightSteps, __m256 jitter, __m256 mask, uint64_t& numSamples)
+	{
+		const auto lightStepX = _mm256_set1_ps(lightStep.x);
+		const auto lightStepY = _mm256_set1_ps(lightStep.y);
+		const auto lightStepZ = _mm256_set1_ps(lightStep.z);
+		const auto attenScale = _mm256_set1_ps(ABSORPTION * g_lightStepScale);
+		const auto one = _mm256_set1_ps(1.0f);
+		auto lightTrans = one;
+
+		lightPos.x = _mm256_add_ps(lightPos.x, _mm256_mul_ps(lightStepX, jitter));
+		lightPos.y = _mm256_add_ps(lightPos.y, _mm256_mul_ps(lightStepY, jitter));
+		lightPos.z = _mm256_add_ps(lightPos.z, _mm256_mul_ps(lightStepZ, jitter));
+		for (auto j = 0u; j < numLightSteps; ++j)
+		{
+			mask = _mm256_andnot_ps(isOutside(lightPos), mask);
+			if (!_mm256_movemask_ps(mask)) break;
+
+			const auto lightDens = _mm256_min_ps(_mm256_mul_ps(sample(grid, toTex(lightPos), mask),
+				_mm256_set1_ps(8.0f)), _mm256_set1_ps(16.0f));
+			numSamples += countLanes(mask);
+
+			auto lightAtten = saturate(_mm256_sub_ps(one, _mm256_mul_ps(attenScale, lightDens)));
+			lightAtten = lightStepRatio == 1.0f ? lightAtten : pow8(lightAtten, lightStepRatio);
+			lightTrans = _mm256_blendv_ps(lightTrans, _mm256_mul_ps(lightTrans, lightAtten), mask);
+			mask = _mm256_andnot_ps(_mm256_cmp_ps(lightTrans, _mm256_set1_ps(ZERO_THRESHOLD), _CMP_LT_OQ), mask);
+
+			lightPos.x = _mm256_add_ps(lightPos.x, lightStepX);
+			lightPos.y = _mm256_add_ps(lightPos.y, lightStepY);
+			lightPos.z = _mm256_add_ps(lightPos.z, lightStepZ);
+		}
+
+		return lightTrans;
+	}
+}
+#endif
+
+const Float3 RayCasterCPU::LightPt(-10.0f, 45.0f, -75.0f);
+
+RayCasterCPU::RayCasterCPU() :
+	m_pGrid(nullptr),
+	m_pMacroCells(nullptr),
+	m_pTransmittance(nullptr),
+	m_width(0),
+	m_height(0),
+	m_bound(),
+	m_posScale(),
+	m_localSpaceLightPt(0.0f, 0.0f, 0.0f),
+	m_localSpaceEyePt(0.0f, 0.0f, 0.0f),
+	m_screenToLocal(Float4x4::Identity()),
+	m_numSteps(NumSamples),
+	m_numLightSteps(NumLightSamples),
+	m_stepScale(g_maxDist / NumSamples),
+	m_lightStepScale(g_maxDist / NumLightSamples),
+	m_stepRatio(1.0f),
+	m_lightStepRatio(1.0f),
+	m_isJittered(false),
+	m_isLightJittered(false),
+	m_pMips(nullptr),
+	m_lodScale(1.0f),
+	m_pixelSpread(0.0f),
+	m_voxelScale(0.0f),
+	m_isCountingBricks(false),
+	m_gridSize(0.0f, 0.0f, 0.0f),
+	m_cellScale(0.0f),
+	m_numCells(),
+	m_numSamples(0)
+{
+}
+
+RayCasterCPU::~RayCasterCPU()
+{
+}
+
+bool RayCasterCPU::Init(uint32_t width, uint32_t height, const VoxelGrid& grid, const float bound[4],
+	const float posScale[4], const MacroCellGrid* pMacroCells, const TransmittanceVolume* pTransmittance)
+{
+	if (!width || !height || !grid.GetNumVoxels() || bound[3] <= 0.0f || posScale[3] <= 0.0f) return false;
+
+	m_pGrid = &grid;
+	m_pMacroCells = pMacroCells;
+	m_pTransmittance = pTransmittance;
+	m_gridSize = Float3(static_cast<float>(grid.GetWidth()), static_cast<float>(grid.GetHeight()),
+		static_cast<float>(grid.GetDepth()));
+	if (pMacroCells)
+	{
+		m_cellScale = 1.0f / pMacroCells->GetCellSize();
+		m_numCells[0] = pMacroCells->GetWidth();
+		m_numCells[1] = pMacroCells->GetHeight();
+		m_numCells[2] = pMacroCells->GetDepth();
+	}
+	m_voxelScale = 0.5f * (max)(m_gridSize.x, (max)(m_gridSize.y, m_gridSize.z));
+	m_width = width;
+	m_height = height;
+	memcpy(m_bound, bound, sizeof(m_bound));
+	memcpy(m_posScale, posScale, sizeof(m_posScale));
+
+	return true;
+}
+
+void RayCasterCPU::UpdateFrame(const Float3& eyePt, const Float4x4& viewProj, const Float3& lightPt)
+{
+	// General matrices
+	const auto world = Scaling(m_bound[3]) * Translation(Float3(m_bound)) *
+		Scaling(m_posScale[3]) * Translation(Float3(m_posScale));
+	Float4x4 worldI;
+	Inverse(worldI, world);
+	const auto worldViewProj = world * viewProj;
+
+	// Screen space matrices
+	m_localSpaceLightPt = TransformCoord(lightPt, worldI);
+	m_localSpaceEyePt = TransformCoord(eyePt, worldI);
+
+	const auto w = static_cast<float>(m_width);
+	const auto h = static_cast<float>(m_height);
+	const Float4x4 toScreen = { {
+		{ 0.5f * w, 0.0f, 0.0f, 0.0f },
+		{ 0.0f, -0.5f * h, 0.0f, 0.0f },
+		{ 0.0f, 0.0f, 1.0f, 0.0f },
+		{ 0.5f * w, 0.5f * h, 0.0f, 1.0f } } };
+	Inverse(m_screenToLocal, worldViewProj * toScreen);
+
+	// Spread of the rays through the neighboring pixels at the center of the screen
+	const auto pos = TransformCoord(Float3(0.5f * w, 0.5f * h, 0.0f), m_screenToLocal);
+	const auto posX = TransformCoord(Float3(0.5f * w + 1.0f, 0.5f * h, 0.0f), m_screenToLocal);
+	m_pixelSpread = Length(posX - pos) / Length(pos - m_localSpaceEyePt);
+}
+
+bool RayCasterCPU::SetSampling(uint32_t numSamples, uint32_t numLightSamples, bool isJittered,
+	bool isLightJittered)
+{
+	if (!numSamples || !numLightSamples) return false;
+
+	m_numSteps = numSamples;
+	m_numLightSteps = numLightSamples;
+	m_stepScale = g_maxDist / numSamples;
+	m_lightStepScale = g_maxDist / numLightSamples;
+	m_stepRatio = static_cast<float>(NumSamples) / numSamples;
+	m_lightStepRatio = static_cast<float>(NumLightSamples) / numLightSamples;
+	m_isJittered = isJittered;
+	m_isLightJittered = isLightJittered;
+
+	return true;
+}
+
+void RayCasterCPU::SetLevelOfDetail(const VoxelMipChain* pMips, float lodBias)
+{
+	m_pMips = pMips && pMips->GetNumLevels() > 1 ? pMips : nullptr;
+	m_lodScale = exp2f(lodBias);
+}
+
+void RayCasterCPU::SetBrickCounting(bool isCounting)
+{
+	m_isCountingBricks = isCounting;
+}
+
+void RayCasterCPU::Render(uint8_t* pImage, Marcher marcher, Lighting lighting, uint32_t numThreads) const
+{
+	PROFILE_ZONE("ray cast");
+	if (!m_pGrid) return;
+
+	m_numSamples = 0;
+	if (m_isCountingBricks) resetBricks();
+
+	lighting = getValidLighting(lighting);
+
+	const auto numTilesX = (m_width + TileSize - 1) / TileSize;
+	const auto numTilesY = (m_height + TileSize - 1) / TileSize;
+	ParallelFor(0, numTilesX * numTilesY, numThreads, [&](uint32_t i)
+	{
+		PROFILE_ZONE("ray cast tile");
+		const auto x0 = i % numTilesX * TileSize;
+		const auto y0 = i / numTilesX * TileSize;
+		const auto xEnd = (min)(x0 + TileSize, m_width);
+		const auto yEnd = (min)(y0 + TileSize, m_height);
+
+		uint64_t numSamples = 0;
+		if (marcher == FIXED_STEP_X8)
+		{
+			for (auto y = y0; y < yEnd; y += PacketHeight)
+				for (auto x = x0; x < xEnd; x += PacketWidth)
+					renderPacket(pImage, x, y, lighting, numSamples);
+		}
+		else
+		{
+			for (auto y = y0; y < yEnd; ++y)
+				for (auto x = x0; x < xEnd; ++x)
+					renderPixel(&pImage[(static_cast<size_t>(m_width) * y + x) * 4], x, y, marcher, lighting, numSamples);
+		}
+		m_numSamples += numSamples;
+	});
+}
+
+uint32_t RayCasterCPU::GetWidth() const
+{
+	return m_width;
+}
+
+uint32_t RayCasterCPU::GetHeight() const
+{
+	return m_height;
+}
+
+uint64_t RayCasterCPU::GetNumSamples() const
+{
+	return m_numSamples;
+}
+
+uint64_t RayCasterCPU::GetNumBricks(uint32_t level) const
+{
+	if (level + 1 >= m_brickOffsets.size()) return 0;
+
+	uint64_t numBricks = 0;
+	for (auto i = m_brickOffsets[level]; i < m_brickOffsets[level + 1]; ++i)
+		numBricks += m_bricks[i].load(memory_order_relaxed);
+
+	return numBricks;
+}
+
+const Float3& RayCasterCPU::GetLocalSpaceLightPt() const
+{
+	return m_localSpaceLightPt;
+}
+
+const char* RayCasterCPU::GetMarcherName(Marcher marcher)
+{
+	static const char* names[] = { "fixed step", "skip empty", "voxel DDA", "fixed step x8" };
+
+	return marcher < NUM_MARCHER ? names[marcher] : "unknown";
+}
+
+const char* RayCasterCPU::GetLightingName(Lighting lighting)
+{
+	static const char* names[] = { "light march", "light volume" };
+
+	return lighting < NUM_LIGHTING ? names[lighting] : "unknown";
+}
+
+bool RayCasterCPU::computeStartPoint(Float3& pos, const Float3& rayDir) const
+{
+	if (fabsf(pos.x) <= 1.0f && fabsf(pos.y) <= 1.0f && fabsf(pos.z) <= 1.0f) return true;
+
+	auto U = FLT_MAX;
+	auto isHit = false;
+
+	for (auto i = 0; i < 3; ++i)
+	{
+		const auto u = (-sign(rayDir[i]) - pos[i]) / rayDir[i];
+		if (u < 0.0f) continue;
+
+		const auto j = (i + 1) % 3, k = (i + 2) % 3;
+		if (fabsf(rayDir[j] * u + pos[j]) > 1.0f) continue;
+		if (fabsf(rayDir[k] * u + pos[k]) > 1.0f) continue;
+		if (u < U)
+		{
+			U = u;
+			isHit = true;
+		}
+	}
+
+	pos = Min(Max(rayDir * U + pos, Float3(-1.0f, -1.0f, -1.0f)), Float3(1.0f, 1.0f, 1.0f));
+
+	return isHit;
+}
+
+float RayCasterCPU::getSample(const Float3& tex, uint32_t level) const
+{
+	const auto& grid = level ? m_pMips->GetLevel(level) : *m_pGrid;
+	const auto density = grid.Sample(tex.x, tex.y, tex.z);
+	if (m_isCountingBricks) countBricks(grid, tex, level);
+
+	return (min)(density * 8.0f, 16.0f);
+}
+
+// Flags the bricks of the 8 voxels that VoxelGrid::Sample reads at tex
+void RayCasterCPU::countBricks(const VoxelGrid& grid, const Float3& tex, uint32_t level) const
+{
+	if (level + 1 >= m_brickOffsets.size()) return;
+
+	const uint32_t size[] = { grid.GetWidth(), grid.GetHeight(), grid.GetDepth() };
+	uint32_t first[3], last[3], numBricks[3];
+	for (auto i = 0; i < 3; ++i)
+	{
+		const auto f = floorf(tex[i] * size[i] - 0.5f);
+		first[i] = static_cast<uint32_t>((min)((max)(f, 0.0f), size[i] - 1.0f)) / BrickSize;
+		last[i] = static_cast<uint32_t>((min)((max)(f + 1.0f, 0.0f), size[i] - 1.0f)) / BrickSize;
+		numBricks[i] = (size[i] + BrickSize - 1) / BrickSize;
+	}
+
+	for (auto z = first[2]; z <= last[2]; ++z)
+		for (auto y = first[1]; y <= last[1]; ++y)
+		{
+			const auto row = m_brickOffsets[level] + (static_cast<size_t>(numBricks[1]) * z + y) * numBricks[0];
+			for (auto x = first[0]; x <= last[0]; ++x) m_bricks[row + x].store(1, memory_order_relaxed);
+		}
+}
+
+void RayCasterCPU::resetBricks() const
+{
+	const auto numLevels = m_pMips ? m_pMips->GetNumLevels() : 1;
+	m_brickOffsets.assign(1, 0);
+	for (auto level = 0u; level < numLevels; ++level)
+	{
+		const auto& grid = level ? m_pMips->GetLevel(level) : *m_pGrid;
+		const auto numBricks = static_cast<size_t>((grid.GetWidth() + BrickSize - 1) / BrickSize) *
+			((grid.GetHeight() + BrickSize - 1) / BrickSize) * ((grid.GetDepth() + BrickSize - 1) / BrickSize);
+		m_brickOffsets.push_back(m_brickOffsets.back() + numBricks);
+	}
+
+	if (m_bricks.size() != m_brickOffsets.back()) m_bricks = vector<atomic<uint8_t>>(m_brickOffsets.back());
+	for (auto& brick : m_bricks) brick.store(0, memory_order_relaxed);
+}
+
+// Number of steps from pos that stay inside its macro cell, and whether that cell is empty
+uint32_t RayCasterCPU::getCellSteps(const Float3& pos, const Float3& step, bool& isEmpty) const
+{
+	// Voxel space of the grid, in which macro cells are axis aligned
+	const auto voxelPos = (Float3(0.5f, -0.5f, 0.5f) * pos + Float3(0.5f, 0.5f, 0.5f)) * m_gridSize;
+	const auto voxelStep = Float3(0.5f, -0.5f, 0.5f) * step * m_gridSize;
+
+	uint32_t cell[3];
+	for (auto i = 0; i < 3; ++i)
+		cell[i] = (min)(static_cast<uint32_t>((max)(voxelPos[i], 0.0f) * m_cellScale), m_numCells[i] - 1);
+	isEmpty = m_pMacroCells->IsEmpty(cell[0], cell[1], cell[2]);
+
+	// Steps to the exit of the cell; the dilated cell footprint absorbs rounding
+	const auto cellSize = 1.0f / m_cellScale;
+	auto exitSteps = FLT_MAX;
+	for (auto i = 0; i < 3; ++i)
+	{
+		if (voxelStep[i] > 0.0f) exitSteps = (min)(exitSteps, ((cell[i] + 1) * cellSize - voxelPos[i]) / voxelStep[i]);
+		else if (voxelStep[i] < 0.0f) exitSteps = (min)(exitSteps, (cell[i] * cellSize - voxelPos[i]) / voxelStep[i]);
+	}
+
+	return exitSteps > 0.0f ? static_cast<uint32_t>((min)(ceilf(exitSteps), static_cast<float>(NumSamples))) : 0;
+}
+
+// A volume of another grid or light would be wrong rather than approximate
+RayCasterCPU::Lighting RayCasterCPU::getValidLighting(Lighting lighting) const
+{
+	if (lighting == LIGHT_VOLUME && !(m_pTransmittance && m_pTransmittance->IsValid(*m_pGrid, m_localSpaceLightPt)))
+		return LIGHT_MARCH;
+
+	return lighting;
+}
+
+// Transmittance from pos toward the light, marched as PSRayCast.hlsl or looked up; the
+// march takes its first sample lightJitter of a step from pos, on the mip level of pos
+float RayCasterCPU::getLightTransmittance(const Float3& pos, Lighting lighting, bool isSkipping,
+	uint64_t& numSamples, float lightJitter, uint32_t level) const
+{
+	if (lighting == LIGHT_VOLUME)
+	{
+		// Precomputed for the voxel centers toward the light
+		const auto tex = Float3(0.5f, -0.5f, 0.5f) * pos + Float3(0.5f, 0.5f, 0.5f);
+		++numSamples;
+
+		return m_pTransmittance->Sample(tex.x, tex.y, tex.z);
+	}
+
+	const auto lightStepLength = getStepLength(level, m_lightStepScale);
+	const auto lightStep = Normalize(m_localSpaceLightPt) * m_lightStepScale * lightStepLength;
+	auto lightTrans = 1.0f;	// Transmittance along light ray
+	auto lightPos = pos + lightStep * lightJitter;
+	auto lightCellSteps = 0u;	// Remaining steps in an occupied macro cell
+
+	for (auto j = 0u; j < m_numLightSteps; ++j)
+	{
+		if (isOutside(lightPos)) break;
+
+		if (isSkipping && !lightCellSteps)
+		{
+			auto isEmpty = false;
+			lightCellSteps = (min)(getCellSteps(lightPos, lightStep, isEmpty), m_numLightSteps - j);
+			if (isEmpty && lightCellSteps > 0)
+			{
+				for (auto n = 0u; n < lightCellSteps; ++n) lightPos += lightStep;
+				j += lightCellSteps - 1;
+				lightCellSteps = 0;
+				continue;
+			}
+		}
+		lightCellSteps -= lightCellSteps > 0 ? 1 : 0;
+
+		const auto tex = Float3(0.5f, -0.5f, 0.5f) * lightPos + Float3(0.5f, 0.5f, 0.5f);
+
+		// Get a sample along light ray
+		const auto lightDens = getSample(tex, level);
+		++numSamples;
+
+		// Attenuate ray-throughput along light direction
+		lightTrans *= getLightAttenuation(lightDens, m_lightStepRatio * lightStepLength);
+		if (lightTrans < ZERO_THRESHOLD) break;
+
+		// Update position along light ray
+		lightPos += lightStep;
+	}
+
+	return lightTrans;
+}
+
+// The coarsest mip level whose voxels are no larger than the biased pixel footprint at
+// the distance from the eye
+uint32_t RayCasterCPU::getLevelOfDetail(float distance) const
+{
+	const auto footprint = distance * m_pixelSpread * m_voxelScale * m_lodScale;	// In voxels of level 0
+	if (footprint < 2.0f) return 0;
+
+	return (min)(static_cast<uint32_t>(log2f(footprint)), m_pMips->GetNumLevels() - 1);
+}
+
+// Distance from the eye from which the footprint covers the voxels of the first level
+// that span two steps. Nearer, the steps would take nearly as many samples of a blurrier
+// density, which scatters over more of them, and attenuate in powf, so they stay on level 0.
+float RayCasterCPU::getLevelDistance() const
+{
+	const auto level = (max)(static_cast<int32_t>(ceilf(log2f(2.0f * m_voxelScale * m_stepScale))), 1);
+	if (static_cast<uint32_t>(level) >= m_pMips->GetNumLevels()) return FLT_MAX;
+
+	return static_cast<float>(1u << level) / (m_pixelSpread * m_voxelScale * m_lodScale);
+}
+
+// Length of a step on a mip level, in steps of stepScale: as long as a voxel of the level
+// once those are longer
+float RayCasterCPU::getStepLength(uint32_t level, float stepScale) const
+{
+	return level ? (max)(static_cast<float>(1u << level) / (m_voxelScale * stepScale), 1.0f) : 1.0f;
+}
+
+// Transmittance of a primary step through the density, and the in-scattered light per
+// unit of the throughput that leaves it. Steps of PSRayCast.hlsl attenuate as there;
+// others as the number of its steps that they span, stepRatio, in the closed form of the
+// voxel DDA, so that fewer samples approximate the same medium instead of a denser one.
+void RayCasterCPU::getStepAttenuation(float density, float stepRatio, float& atten, float& scaledDens) const
+{
+	if (stepRatio == 1.0f)
+	{
+		scaledDens = density * g_stepScale;
+		atten = saturate(1.0f - scaledDens * ABSORPTION);
+
+		return;
+	}
+
+	const auto baseAtten = saturate(1.0f - density * g_stepScale * ABSORPTION);
+	atten = powf(baseAtten, stepRatio);
+	scaledDens = atten > 0.0f ? baseAtten * (1.0f - atten) / atten : 0.0f;
+}
+
+float RayCasterCPU::getLightAttenuation(float lightDens, float stepRatio) const
+{
+	const auto atten = saturate(1.0f - ABSORPTION * g_lightStepScale * lightDens);
+
+	return stepRatio == 1.0f ? atten : powf(atten, stepRatio);
+}
+
+void RayCasterCPU::marchSteps(Float3 pos, const Float3& rayDir, Marcher marcher, Lighting lighting,
+	float lightJitter, float& transmit, float& scatter, float& depth, uint64_t& numSamples) const
+{
+	const auto step = rayDir * m_stepScale;
+	const auto isSkipping = marcher == SKIP_EMPTY && m_pMacroCells;
+	const auto hasLevels = marcher == FIXED_STEP && m_pMips;
+	auto distance = hasLevels ? Length(pos - m_localSpaceEyePt) : 0.0f;
+	const auto levelDistance = hasLevels ? getLevelDistance() : FLT_MAX;
+	auto cellSteps = 0u;	// Remaining steps in an occupied macro cell
+
+	for (auto i = 0u; i < m_numSteps; ++i)
+	{
+		if (isOutside(pos)) break;
+
+		// Advance through an empty macro cell on the positions of the fixed-step marcher;
+		// the cell is looked up again only after leaving an occupied one
+		if (isSkipping && !cellSteps)
+		{
+			auto isEmpty = false;
+			cellSteps = (min)(getCellSteps(pos, step, isEmpty), m_numSteps - i);
+			if (isEmpty && cellSteps > 0)
+			{
+				for (auto n = 0u; n < cellSteps; ++n) pos += step;
+				i += cellSteps - 1;
+				cellSteps = 0;
+				continue;
+			}
+		}
+		cellSteps -= cellSteps > 0 ? 1 : 0;
+
+		const auto tex = Float3(0.5f, -0.5f, 0.5f) * pos + Float3(0.5f, 0.5f, 0.5f);
+
+		// Footprints of several voxels read a coarser level, and the steps lengthen to its voxels
+		const auto level = distance < levelDistance ? 0 : getLevelOfDetail(distance);
+		const auto stepLength = getStepLength(level, m_stepScale);
+
+		// Get a sample
+		const auto density = getSample(tex, level);
+		++numSamples;
+
+		// Skip empty space
+		if (density > ZERO_THRESHOLD)
+		{
+			if (depth == FLT_MAX) depth = Length(pos - m_localSpaceEyePt);
+
+			// Attenuate ray-throughput
+			float atten, scaledDens;
+			getStepAttenuation(density, m_stepRatio * stepLength, atten, scaledDens);
+			transmit *= atten;
+			if (transmit < ZERO_THRESHOLD) break;
+
+			// Sample light
+			const auto lightTrans = getLightTransmittance(pos, lighting, isSkipping, numSamples, lightJitter, level);
+			scatter += lightTrans * transmit * scaledDens;
+		}
+
+		if (level)
+		{
+			pos += step * stepLength;
+			distance += m_stepScale * stepLength;
+		}
+		else
+		{
+			pos += step;
+			distance += m_stepScale;
+		}
+	}
+}
+
+// Amanatides-Woo traversal in voxel space. The density is constant over a voxel, so its
+// segment is integrated in closed form: n = length / g_stepScale fixed steps of attenuation
+// a scale the throughput by a^n and scatter a * (1 - a^n) of it, which is what the
+// fixed-step marcher sums over those steps.
+void RayCasterCPU::traverseVoxels(const Float3& pos, const Float3& rayDir, Lighting lighting, float lightJitter,
+	float& transmit, float& scatter, float& depth, uint64_t& numSamples) const
+{
+	const auto voxelPos = (Float3(0.5f, -0.5f, 0.5f) * pos + Float3(0.5f, 0.5f, 0.5f)) * m_gridSize;
+	const auto voxelDir = Float3(0.5f, -0.5f, 0.5f) * rayDir * m_gridSize;	// Voxels per unit of t
+	const uint32_t size[] = { m_pGrid->GetWidth(), m_pGrid->GetHeight(), m_pGrid->GetDepth() };
+
+	int32_t voxel[3], voxelStep[3];
+	float tMax[3], tDelta[3];
+	for (auto i = 0; i < 3; ++i)
+	{
+		voxel[i] = static_cast<int32_t>((min)((max)(floorf(voxelPos[i]), 0.0f), size[i] - 1.0f));
+		voxelStep[i] = voxelDir[i] > 0.0f ? 1 : (voxelDir[i] < 0.0f ? -1 : 0);
+		tDelta[i] = voxelStep[i] ? 1.0f / fabsf(voxelDir[i]) : FLT_MAX;
+		tMax[i] = voxelStep[i] ? ((voxel[i] + (voxelStep[i] > 0 ? 1.0f : 0.0f)) - voxelPos[i]) / voxelDir[i] : FLT_MAX;
+	}
+
+	const auto isSkipping = m_pMacroCells != nullptr;
+	auto t = 0.0f;
+	for (;;)
+	{
+		// Segment of the ray in the current voxel
+		const auto axis = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+		const auto tExit = (max)(tMax[axis], t);
+		const auto length = tExit - t;
+
+		const auto density = (min)(m_pGrid->Get(voxel[0], voxel[1], voxel[2]) / 255.0f * 8.0f, 16.0f);
+		++numSamples;
+
+		if (density > ZERO_THRESHOLD && length > 0.0f)
+		{
+			if (depth == FLT_MAX) depth = Length(pos + rayDir * t - m_localSpaceEyePt);
+
+			const auto atten = saturate(1.0f - density * g_stepScale * ABSORPTION);
+			const auto transmitIn = transmit;
+			transmit *= powf(atten, length / g_stepScale);
+
+			// Light at the middle of the segment
+			const auto lightTrans = getLightTransmittance(pos + rayDir * (0.5f * (t + tExit)), lighting,
+				isSkipping, numSamples, lightJitter);
+			scatter += lightTrans * atten * (transmitIn - transmit);
+			if (transmit < ZERO_THRESHOLD) break;
+		}
+
+		// Step into the next voxel
+		t = tExit;
+		voxel[axis] += voxelStep[axis];
+		if (voxel[axis] < 0 || voxel[axis] >= static_cast<int32_t>(size[axis])) break;
+		tMax[axis] += tDelta[axis];
+	}
+}
+
+// Fixed-step marching of a packet of PacketWidth x PacketHeight pixels from (x, y), one
+// pixel per lane; lanes leave the packet as their rays exit or saturate
+void RayCasterCPU::renderPacket(uint8_t* pImage, uint32_t x, uint32_t y, Lighting lighting, uint64_t& numSamples) const
+{
+#if RAYCASTER_USE_AVX2
+	if (m_pGrid->GetLayout() == VoxelGrid::LINEAR)
+	{
+		alignas(32) float pixelX[8], pixelY[8], jitters[8], lightJitters[8];
+		auto lanes = 0;
+		for (auto i = 0u; i < 8; ++i)
+		{
+			const auto px = x + i % PacketWidth, py = y + i / PacketWidth;
+			pixelX[i] = px + 0.5f;
+			pixelY[i] = py + 0.5f;
+			jitters[i] = m_isJittered ? BlueNoise::GetOffset(px, py, 0) : 0.0f;
+			lightJitters[i] = m_isLightJittered ? BlueNoise::GetOffset(px, py, 1) + 0.5f : 1.0f;
+			lanes |= px < m_width && py < m_height ? 1 << i : 0;
+		}
+
+		// The points on the near plane through the pixel centers, as TransformCoord
+		const auto& m = m_screenToLocal;
+		const auto sx = _mm256_load_ps(pixelX), sy = _mm256_load_ps(pixelY);
+		__m256 r[4];
+		for (auto j = 0; j < 4; ++j)
+			r[j] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, _mm256_set1_ps(m[0][j])),
+				_mm256_mul_ps(sy, _mm256_set1_ps(m[1][j]))), _mm256_set1_ps(m[3][j]));
+		const auto invW = _mm256_div_ps(_mm256_set1_ps(1.0f), r[3]);
+		Float3x8 pos = { _mm256_mul_ps(r[0], invW), _mm256_mul_ps(r[1], invW), _mm256_mul_ps(r[2], invW) };
+
+		Float3x8 rayDir = { _mm256_sub_ps(pos.x, _mm256_set1_ps(m_localSpaceEyePt.x)),
+			_mm256_sub_ps(pos.y, _mm256_set1_ps(m_localSpaceEyePt.y)),
+			_mm256_sub_ps(pos.z, _mm256_set1_ps(m_localSpaceEyePt.z)) };
+		const auto invLen = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(
+			_mm256_mul_ps(rayDir.x, rayDir.x), _mm256_mul_ps(rayDir.y, rayDir.y)), _mm256_mul_ps(rayDir.z, rayDir.z))));
+		rayDir = { _mm256_mul_ps(rayDir.x, invLen), _mm256_mul_ps(rayDir.y, invLen), _mm256_mul_ps(rayDir.z, invLen) };
+
+		const auto isHit = computeStartPoints(pos, rayDir);
+		const auto laneMask = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_and_si256(_mm256_set1_epi32(lanes),
+			_mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128)), _mm256_setzero_si256()));
+		auto active = _mm256_and_ps(isHit, laneMask);
+
+		const auto stepScale = _mm256_set1_ps(m_stepScale);
+		const Float3x8 step = { _mm256_mul_ps(rayDir.x, stepScale), _mm256_mul_ps(rayDir.y, stepScale),
+			_mm256_mul_ps(rayDir.z, stepScale) };
+		const auto lightStep = Normalize(m_localSpaceLightPt) * m_lightStepScale;
+		const auto lightJitter = _mm256_load_ps(lightJitters);
+		const auto one = _mm256_set1_ps(1.0f), zeroThreshold = _mm256_set1_ps(ZERO_THRESHOLD);
+		if (m_isJittered)
+		{
+			const auto jitter = _mm256_load_ps(jitters);
+			pos.x = _mm256_add_ps(pos.x, _mm256_mul_ps(step.x, jitter));
+			pos.y = _mm256_add_ps(pos.y, _mm256_mul_ps(step.y, jitter));
+			pos.z = _mm256_add_ps(pos.z, _mm256_mul_ps(step.z, jitter));
+		}
+
+		auto transmit = one;
+		auto scatter = _mm256_setzero_ps();
+		for (auto i = 0u; i < m_numSteps; ++i)
+		{
+			active = _mm256_andnot_ps(isOutside(pos), active);
+			if (!_mm256_movemask_ps(active)) break;
+
+			const auto density = _mm256_min_ps(_mm256_mul_ps(sample(*m_pGrid, toTex(pos), active),
+				_mm256_set1_ps(8.0f)), _mm256_set1_ps(16.0f));
+			numSamples += countLanes(active);
+
+			// Attenuate ray-throughput where occupied, and retire the saturated lanes
+			auto isOccupied = _mm256_and_ps(active, _mm256_cmp_ps(density, zeroThreshold, _CMP_GT_OQ));
+			__m256 atten, scaledDens;
+			if (m_stepRatio == 1.0f)
+			{
+				scaledDens = _mm256_mul_ps(density, stepScale);
+				atten = saturate(_mm256_sub_ps(one, _mm256_mul_ps(scaledDens, _mm256_set1_ps(ABSORPTION))));
+			}
+			else
+			{
+				// As getStepAttenuation
+				const auto baseAtten = saturate(_mm256_sub_ps(one, _mm256_mul_ps(density,
+					_mm256_set1_ps(g_stepScale * ABSORPTION))));
+				atten = pow8(baseAtten, m_stepRatio);
+				scaledDens = _mm256_div_ps(_mm256_mul_ps(baseAtten, _mm256_sub_ps(one, atten)),
+					_mm256_max_ps(atten, _mm256_set1_ps(FLT_MIN)));
+			}
+			transmit = _mm256_blendv_ps(transmit, _mm256_mul_ps(transmit, atten), isOccupied);
+			const auto isSaturated = _mm256_and_ps(isOccupied, _mm256_cmp_ps(transmit, zeroThreshold, _CMP_LT_OQ));
+			active = _mm256_andnot_ps(isSaturated, active);
+			isOccupied = _mm256_andnot_ps(isSaturated, isOccupied);
+
+			if (_mm256_movemask_ps(isOccupied))
+			{
+				__m256 lightTrans;
+				if (lighting == LIGHT_VOLUME)
+				{
+					lightTrans = sample(m_pTransmittance->GetVolume(), toTex(pos), isOccupied);
+					numSamples += countLanes(isOccupied);
+				}
+				else lightTrans = marchLight(*m_pGrid, pos, lightStep, m_lightStepRatio, m_numLightSteps, lightJitter,
+					isOccupied, numSamples);
+
+				scatter = _mm256_blendv_ps(scatter, _mm256_add_ps(scatter,
+					_mm256_mul_ps(_mm256_mul_ps(lightTrans, transmit), scaledDens)), isOccupied);
+			}
+
+			pos.x = _mm256_add_ps(pos.x, step.x);
+			pos.y = _mm256_add_ps(pos.y, step.y);
+			pos.z = _mm256_add_ps(pos.z, step.z);
+		}
+
+		alignas(32) float transmits[8], scatters[8];
+		_mm256_store_ps(transmits, transmit);
+		_mm256_store_ps(scatters, scatter);
+		const auto hits = _mm256_movemask_ps(isHit);
+		for (auto i = 0u; i < 8; ++i)
+		{
+			if (!(lanes >> i & 1)) continue;
+			const auto pPixel = &pImage[(static_cast<size_t>(m_width) * (y + i / PacketWidth) + x + i % PacketWidth) * 4];
+			writePixel(pPixel, hits >> i & 1, transmits[i], scatters[i]);
+		}
+
+		return;
+	}
+#endif
+
+	// Scalar fallback
+	const auto xEnd = (min)(x + PacketWidth, m_width);
+	const auto yEnd = (min)(y + PacketHeight, m_height);
+	for (auto py = y; py < yEnd; ++py)
+		for (auto px = x; px < xEnd; ++px)
+			renderPixel(&pImage[(static_cast<size_t>(m_width) * py + px) * 4], px, py, FIXED_STEP, lighting, numSamples);
+}
+
+// Marches the ray through the screen position (x, y); the depth is the distance from the
+// eye to the first occupied sample, and stays FLT_MAX if there is none. Jittered rays
+// read the blue noise of the pixel that contains the position.
+bool RayCasterCPU::marchRay(float x, float y, Marcher marcher, Lighting lighting, float& transmit, float& scatter,
+	float& depth, uint64_t& numSamples) const
+{
+	// The point on the near plane through the position, as SV_POSITION
+	auto pos = TransformCoord(Float3(x, y, 0.0f), m_screenToLocal);
+	const auto rayDir = Normalize(pos - m_localSpaceEyePt);
+
+	// Transmittance
+	transmit = 1.0f;
+	// In-scattered radiance
+	scatter = 0.0f;
+	depth = FLT_MAX;
+	if (!computeStartPoint(pos, rayDir)) return false;
+
+	// The first light sample stays a step away on average, since that distance sets the
+	// self-shadowing of the occupied samples
+	const auto px = static_cast<uint32_t>(x), py = static_cast<uint32_t>(y);
+	const auto lightJitter = m_isLightJittered ? BlueNoise::GetOffset(px, py, 1) + 0.5f : 1.0f;
+	if (m_isJittered && marcher != VOXEL_DDA) pos += rayDir * m_stepScale * BlueNoise::GetOffset(px, py, 0);
+
+	if (marcher == VOXEL_DDA) traverseVoxels(pos, rayDir, lighting, lightJitter, transmit, scatter, depth, numSamples);
+	else marchSteps(pos, rayDir, marcher, lighting, lightJitter, transmit, scatter, depth, numSamples);
+
+	return true;
+}
+
+void RayCasterCPU::renderPixel(uint8_t* pPixel, uint32_t x, uint32_t y, Marcher marcher, Lighting lighting,
+	uint64_t& numSamples) const
+{
+	float transmit, scatter, depth;
+	const auto isHit = marchRay(x + 0.5f, y + 0.5f, marcher, lighting, transmit, scatter, depth, numSamples);
+
+	writePixel(pPixel, isHit, transmit, scatter);
+}
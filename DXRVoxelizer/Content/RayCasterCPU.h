@@ -0,0 +1,161 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "MacroCellGrid.h"
+#include "TransmittanceVolume.h"
+#include "VectorMath.h"
+#include "VoxelMipChain.h"
+
+//--------------------------------------------------------------------------------------
+// CPU reference of PSRayCast.hlsl for headless rendering: the same slab test, 128
+// primary and 32 light samples per pixel, rendered tile by tile in parallel into an
+// RGBA8 image that matches the swap chain of the app. With a macro-cell grid, the
+// marcher can skip the steps in empty cells; the skipped samples are exactly zero, so
+// the image is unchanged. The voxel DDA instead integrates the nearest density over the
+// exact segment of every voxel crossed. With a transmittance volume built for the light,
+// each occupied sample looks its light up instead of marching toward it. Built with AVX2,
+// fixed stepping also runs on 8-pixel packets; otherwise those fall back to scalar code.
+// With fewer samples, the steps can be jittered per pixel by a blue-noise offset, which
+// trades the banding of the coarse steps for fine noise that is hardly visible. With a
+// mip chain, fixed steps whose pixel footprint spans several voxels read a coarser level
+// and lengthen in proportion.
+//--------------------------------------------------------------------------------------
+class RayCasterCPU
+{
+public:
+	enum Marcher : uint8_t
+	{
+		FIXED_STEP,	// Samples at every step, as PSRayCast.hlsl
+		SKIP_EMPTY,	// Advances through empty macro cells without sampling
+		VOXEL_DDA,	// Visits each voxel that the ray crosses once
+		FIXED_STEP_X8,	// FIXED_STEP on packets of 8 pixels, one per AVX2 lane
+
+		NUM_MARCHER
+	};
+
+	enum Lighting : uint8_t
+	{
+		LIGHT_MARCH,	// Marches toward the light, as PSRayCast.hlsl
+		LIGHT_VOLUME,	// Looks the transmittance volume up
+
+		NUM_LIGHTING
+	};
+
+	RayCasterCPU();
+	virtual ~RayCasterCPU();
+
+	// The grids are referenced, not copied; bound and posScale place them in world space
+	// as in Voxelizer::UpdateFrame
+	bool Init(uint32_t width, uint32_t height, const VoxelGrid& grid, const float bound[4],
+		const float posScale[4], const MacroCellGrid* pMacroCells = nullptr,
+		const TransmittanceVolume* pTransmittance = nullptr);
+
+	void UpdateFrame(const Float3& eyePt, const Float4x4& viewProj, const Float3& lightPt = LightPt);
+	// Samples over the diagonal of the grid for the primary and the light rays, each step
+	// attenuating as the steps of PSRayCast.hlsl that it spans. Jittered primary steps
+	// start a blue-noise fraction of a step in, except those of the voxel DDA; jittered
+	// light steps start between half a step and one and a half steps away.
+	bool SetSampling(uint32_t numSamples = NumSamples, uint32_t numLightSamples = NumLightSamples,
+		bool isJittered = false, bool isLightJittered = false);
+	// Level of detail of FIXED_STEP: log2 of the pixel footprint in voxels plus the bias,
+	// rounded down, or level 0 throughout without a mip chain. A level is only taken where
+	// its voxels span two steps or more, which lengthen to them. The light is marched on
+	// the level of the sample. The chain is referenced, not copied.
+	void SetLevelOfDetail(const VoxelMipChain* pMips, float lodBias = 0.0f);
+	// Counts the distinct bricks of each level that the samples of Render read, at a cost
+	void SetBrickCounting(bool isCounting);
+	// width * height * 4 bytes; the light is marched unless the volume is valid for it
+	void Render(uint8_t* pImage, Marcher marcher = FIXED_STEP, Lighting lighting = LIGHT_MARCH,
+		uint32_t numThreads = 0) const;
+
+	uint32_t GetWidth() const;
+	uint32_t GetHeight() const;
+	// Grid samples, primary and light, taken by the last Render; a sample between two mip
+	// levels counts as one of each
+	uint64_t GetNumSamples() const;
+	// Bricks of a level, 0 for the grid, read by the last Render while counting
+	uint64_t GetNumBricks(uint32_t level) const;
+	const Float3& GetLocalSpaceLightPt() const;	// For TransmittanceVolume::Update
+
+	static const char* GetMarcherName(Marcher marcher);
+	static const char* GetLightingName(Lighting lighting);
+
+	static const uint32_t TileSize = 16;
+	static const uint32_t PacketWidth = 4;
+	static const uint32_t PacketHeight = 2;
+	static const uint32_t NumSamples = 128;
+	static const uint32_t NumLightSamples = 32;
+	static const uint32_t BrickSize = 4;	// Voxels across a brick, a cache line of the Morton layout
+	static const Float3 LightPt;	// World space, as hard-coded in Voxelizer::UpdateFrame
+
+protected:
+	bool computeStartPoint(Float3& pos, const Float3& rayDir) const;
+	float getSample(const Float3& tex, uint32_t level = 0) const;
+	void countBricks(const VoxelGrid& grid, const Float3& tex, uint32_t level) const;
+	void resetBricks() const;
+	uint32_t getCellSteps(const Float3& pos, const Float3& step, bool& isEmpty) const;
+	Lighting getValidLighting(Lighting lighting) const;
+	uint32_t getLevelOfDetail(float distance) const;
+	float getLevelDistance() const;
+	float getStepLength(uint32_t level, float stepScale) const;
+	void getStepAttenuation(float density, float stepRatio, float& atten, float& scaledDens) const;
+	float getLightAttenuation(float lightDens, float stepRatio) const;
+	float getLightTransmittance(const Float3& pos, Lighting lighting, bool isSkipping, uint64_t& numSamples,
+		float lightJitter = 1.0f, uint32_t level = 0) const;
+	void marchSteps(Float3 pos, const Float3& rayDir, Marcher marcher, Lighting lighting, float lightJitter,
+		float& transmit, float& scatter, float& depth, uint64_t& numSamples) const;
+	void traverseVoxels(const Float3& pos, const Float3& rayDir, Lighting lighting, float lightJitter,
+		float& transmit, float& scatter, float& depth, uint64_t& numSamples) const;
+	bool marchRay(float x, float y, Marcher marcher, Lighting lighting, float& transmit, float& scatter,
+		float& depth, uint64_t& numSamples) const;
+	void renderPacket(uint8_t* pImage, uint32_t x, uint32_t y, Lighting lighting, uint64_t& numSamples) const;
+	void renderPixel(uint8_t* pPixel, uint32_t x, uint32_t y, Marcher marcher, Lighting lighting,
+		uint64_t& numSamples) const;
+
+	const VoxelGrid* m_pGrid;
+	const MacroCellGrid* m_pMacroCells;
+	const TransmittanceVolume* m_pTransmittance;
+
+	uint32_t	m_width;
+	uint32_t	m_height;
+	float		m_bound[4];
+	float		m_posScale[4];
+
+	// Per-frame constants of cbPerObject
+	Float3		m_localSpaceLightPt;
+	Float3		m_localSpaceEyePt;
+	Float4x4	m_screenToLocal;
+
+	// Sampling
+	uint32_t	m_numSteps;
+	uint32_t	m_numLightSteps;
+	float		m_stepScale;
+	float		m_lightStepScale;
+	float		m_stepRatio;		// Steps of PSRayCast.hlsl per step
+	float		m_lightStepRatio;
+	bool		m_isJittered;
+	bool		m_isLightJittered;
+
+	// Level of detail
+	const VoxelMipChain* m_pMips;
+	float		m_lodScale;		// 2 to the bias
+	float		m_pixelSpread;	// Footprint of a pixel per unit of distance from the eye
+	float		m_voxelScale;	// Voxels per unit of the local space
+
+	// Brick counting, a flag per brick of each level
+	bool		m_isCountingBricks;
+	mutable std::vector<std::atomic<uint8_t>> m_bricks;
+	mutable std::vector<size_t> m_brickOffsets;
+
+	// Macro-cell traversal
+	Float3		m_gridSize;
+	float		m_cellScale;
+	uint32_t	m_numCells[3];
+
+	mutable std::atomic<uint64_t> m_numSamples;
+};
@@ -0,0 +1,213 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include "ParallelFor.h"
+#include "ScaledRayCaster.h"
+#include "SharedConst.h"
+
+// Opacity difference that halves a weight, and the differences of an edge
+#define OPACITY_SCALE		0.1f
+#define EDGE_DEPTH			4.0f	// Voxels
+#define EDGE_OPACITY		0.25f
+
+using namespace std;
+
+namespace
+{
+	const Float3 g_clearColor(CLEAR_COLOR);
+
+	inline float saturate(float x)
+	{
+		return (min)((max)(x, 0.0f), 1.0f);
+	}
+
+	inline uint8_t toUnorm8(float x)
+	{
+		return static_cast<uint8_t>(saturate(x) * 255.0f + 0.5f);
+	}
+
+	// 2^-(d * scale), which is 0 for a difference to FLT_MAX
+	inline float falloff(float d, float scale)
+	{
+		return d < FLT_MAX ? exp2f(-d * scale) : 0.0f;
+	}
+}
+
+ScaledRayCaster::ScaledRayCaster() :
+	RayCasterCPU(),
+	m_texelWidth(0),
+	m_texelHeight(0),
+	m_renderScale(1),
+	m_refineEdges(false),
+	m_depthScale(0.0f),
+	m_numRefined(0)
+{
+}
+
+ScaledRayCaster::~ScaledRayCaster()
+{
+}
+
+bool ScaledRayCaster::Init(uint32_t width, uint32_t height, const VoxelGrid& grid, const float bound[4],
+	const float posScale[4], const MacroCellGrid* pMacroCells, const TransmittanceVolume* pTransmittance,
+	uint32_t renderScale, bool refineEdges)
+{
+	if (renderScale != 1 && renderScale != 2 && renderScale != 4) return false;
+	if (!RayCasterCPU::Init(width, height, grid, bound, posScale, pMacroCells, pTransmittance)) return false;
+
+	m_renderScale = renderScale;
+	m_refineEdges = refineEdges;
+	m_texelWidth = (width + renderScale - 1) / renderScale;
+	m_texelHeight = (height + renderScale - 1) / renderScale;
+	m_texels.resize(static_cast<size_t>(m_texelWidth) * m_texelHeight);
+
+	// The grid spans 2 units of the local space, where the depths are measured
+	const auto voxelSize = 2.0f / (max)(grid.GetWidth(), (max)(grid.GetHeight(), grid.GetDepth()));
+	m_depthScale = 1.0f / voxelSize;
+
+	return true;
+}
+
+void ScaledRayCaster::RenderScaled(uint8_t* pImage, Marcher marcher, Lighting lighting, uint32_t numThreads)
+{
+	if (!m_pGrid) return;
+
+	m_numSamples = 0;
+	m_numRefined = 0;
+	lighting = getValidLighting(lighting);
+	marcher = marcher == FIXED_STEP_X8 ? FIXED_STEP : marcher;
+
+	// March the texels
+	const auto numTexelTilesX = (m_texelWidth + TileSize - 1) / TileSize;
+	const auto numTexelTilesY = (m_texelHeight + TileSize - 1) / TileSize;
+	ParallelFor(0, numTexelTilesX * numTexelTilesY, numThreads, [&](uint32_t t)
+	{
+		const auto i0 = t % numTexelTilesX * TileSize;
+		const auto j0 = t / numTexelTilesX * TileSize;
+		const auto iEnd = (min)(i0 + TileSize, m_texelWidth);
+		const auto jEnd = (min)(j0 + TileSize, m_texelHeight);
+
+		uint64_t numSamples = 0;
+		for (auto j = j0; j < jEnd; ++j)
+			for (auto i = i0; i < iEnd; ++i)
+				marchTexel(m_texels[static_cast<size_t>(m_texelWidth) * j + i], i, j, marcher, lighting, numSamples);
+		m_numSamples += numSamples;
+	});
+
+	// Upsample them to the pixels
+	const auto numTilesX = (m_width + TileSize - 1) / TileSize;
+	const auto numTilesY = (m_height + TileSize - 1) / TileSize;
+	ParallelFor(0, numTilesX * numTilesY, numThreads, [&](uint32_t t)
+	{
+		const auto x0 = t % numTilesX * TileSize;
+		const auto y0 = t / numTilesX * TileSize;
+		const auto xEnd = (min)(x0 + TileSize, m_width);
+		const auto yEnd = (min)(y0 + TileSize, m_height);
+
+		uint64_t numSamples = 0;
+		auto numRefined = 0u;
+		for (auto y = y0; y < yEnd; ++y)
+			for (auto x = x0; x < xEnd; ++x)
+				resolvePixel(&pImage[(static_cast<size_t>(m_width) * y + x) * 4], x, y, marcher, lighting,
+					numSamples, numRefined);
+		m_numSamples += numSamples;
+		m_numRefined += numRefined;
+	});
+}
+
+uint32_t ScaledRayCaster::GetRenderScale() const
+{
+	return m_renderScale;
+}
+
+uint32_t ScaledRayCaster::GetNumRefinedPixels() const
+{
+	return m_numRefined;
+}
+
+// Marches the ray through the center of the block of texel (i, j)
+void ScaledRayCaster::marchTexel(Texel& texel, uint32_t i, uint32_t j, Marcher marcher, Lighting lighting,
+	uint64_t& numSamples) const
+{
+	const auto s = static_cast<float>(m_renderScale);
+
+	float transmit, scatter;
+	texel.IsHit = marchRay((i + 0.5f) * s, (j + 0.5f) * s, marcher, lighting, transmit, scatter, texel.Depth,
+		numSamples);
+
+	const auto result = scatter * 0.8f + 0.2f;
+	for (auto k = 0; k < 3; ++k)
+	{
+		const auto clear = g_clearColor[k] * g_clearColor[k];
+		texel.Color[k] = result + (clear - result) * transmit;
+	}
+	texel.Opacity = 1.0f - transmit;
+}
+
+void ScaledRayCaster::resolvePixel(uint8_t* pPixel, uint32_t x, uint32_t y, Marcher marcher, Lighting lighting,
+	uint64_t& numSamples, uint32_t& numRefined) const
+{
+	// Bilinear footprint in the texels, clamped to the edges
+	const auto s = static_cast<float>(m_renderScale);
+	const auto u = (x + 0.5f) / s - 0.5f;
+	const auto v = (y + 0.5f) / s - 0.5f;
+	const auto fu = floorf(u), fv = floorf(v);
+	const auto wu = u - fu, wv = v - fv;
+	const auto lastI = static_cast<int32_t>(m_texelWidth) - 1;
+	const auto lastJ = static_cast<int32_t>(m_texelHeight) - 1;
+	const int32_t i[] = { (max)(static_cast<int32_t>(fu), 0), (min)(static_cast<int32_t>(fu) + 1, lastI) };
+	const int32_t j[] = { (max)(static_cast<int32_t>(fv), 0), (min)(static_cast<int32_t>(fv) + 1, lastJ) };
+
+	const Texel* pTexels[4];
+	float weights[4];
+	for (auto k = 0; k < 4; ++k)
+	{
+		pTexels[k] = &m_texels[static_cast<size_t>(m_texelWidth) * j[k >> 1] + i[k & 1]];
+		weights[k] = (k & 1 ? wu : 1.0f - wu) * (k >> 1 ? wv : 1.0f - wv);
+	}
+
+	// The nearest texel guides the weights of the others
+	const auto& ref = *pTexels[(wv >= 0.5f ? 2 : 0) | (wu >= 0.5f ? 1 : 0)];
+	auto isEdge = false;
+	for (auto k = 0; k < 4; ++k)
+	{
+		const auto& texel = *pTexels[k];
+		const auto depthDiff = texel.Depth == ref.Depth ? 0.0f : fabsf(texel.Depth - ref.Depth);
+		const auto opacityDiff = fabsf(texel.Opacity - ref.Opacity);
+		isEdge = isEdge || depthDiff * m_depthScale > EDGE_DEPTH || opacityDiff > EDGE_OPACITY;
+		weights[k] *= falloff(depthDiff, m_depthScale) * falloff(opacityDiff, 1.0f / OPACITY_SCALE);
+	}
+
+	float color[3];
+	auto isHit = ref.IsHit;
+	if (isEdge && m_refineEdges && m_renderScale > 1)
+	{
+		float transmit, scatter, depth;
+		isHit = marchRay(x + 0.5f, y + 0.5f, marcher, lighting, transmit, scatter, depth, numSamples);
+		++numRefined;
+
+		const auto result = scatter * 0.8f + 0.2f;
+		for (auto k = 0; k < 3; ++k)
+		{
+			const auto clear = g_clearColor[k] * g_clearColor[k];
+			color[k] = result + (clear - result) * transmit;
+		}
+	}
+	else
+	{
+		const auto weightSum = weights[0] + weights[1] + weights[2] + weights[3];
+		for (auto k = 0; k < 3; ++k)
+		{
+			auto c = 0.0f;
+			for (auto n = 0; n < 4; ++n) c += pTexels[n]->Color[k] * weights[n];
+			color[k] = c / weightSum;
+		}
+	}
+
+	for (auto k = 0; k < 3; ++k) pPixel[k] = toUnorm8(sqrtf(color[k]));
+	pPixel[3] = isHit ? 0xff : 0;
+}
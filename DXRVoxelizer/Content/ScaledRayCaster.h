@@ -0,0 +1,60 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "RayCasterCPU.h"
+
+//--------------------------------------------------------------------------------------
+// Reduced-resolution mode of the CPU ray caster. The rays are marched at the centers of
+// blocks of renderScale x renderScale pixels, keeping the depth of the first occupied
+// sample and the opacity of each besides its color, and the result is upsampled to the
+// full resolution with bilinear weights that fall off with the difference in depth and
+// opacity from the nearest texel. Pixels whose texels straddle an edge can be marched at
+// the full resolution instead.
+//--------------------------------------------------------------------------------------
+class ScaledRayCaster :
+	public RayCasterCPU
+{
+public:
+	ScaledRayCaster();
+	virtual ~ScaledRayCaster();
+
+	// renderScale is 1, 2 or 4; the size is of the upsampled image
+	bool Init(uint32_t width, uint32_t height, const VoxelGrid& grid, const float bound[4],
+		const float posScale[4], const MacroCellGrid* pMacroCells = nullptr,
+		const TransmittanceVolume* pTransmittance = nullptr, uint32_t renderScale = 2,
+		bool refineEdges = true);
+
+	// width * height * 4 bytes; FIXED_STEP_X8 marches the texels as FIXED_STEP
+	void RenderScaled(uint8_t* pImage, Marcher marcher = FIXED_STEP, Lighting lighting = LIGHT_MARCH,
+		uint32_t numThreads = 0);
+
+	uint32_t GetRenderScale() const;
+	uint32_t GetNumRefinedPixels() const;	// Marched at the full resolution by the last RenderScaled
+
+protected:
+	struct Texel
+	{
+		float Color[3];	// Before the square root of the blend
+		float Opacity;
+		float Depth;	// FLT_MAX without an occupied sample
+		bool IsHit;		// The ray enters the grid
+	};
+
+	void marchTexel(Texel& texel, uint32_t i, uint32_t j, Marcher marcher, Lighting lighting,
+		uint64_t& numSamples) const;
+	void resolvePixel(uint8_t* pPixel, uint32_t x, uint32_t y, Marcher marcher, Lighting lighting,
+		uint64_t& numSamples, uint32_t& numRefined) const;
+
+	std::vector<Texel> m_texels;
+	uint32_t	m_texelWidth;
+	uint32_t	m_texelHeight;
+
+	uint32_t	m_renderScale;
+	bool		m_refineEdges;
+	float		m_depthScale;	// Reciprocal of the depth difference that halves a weight
+
+	std::atomic<uint32_t> m_numRefined;
+};
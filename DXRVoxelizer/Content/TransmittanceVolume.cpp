@@ -0,0 +1,255 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include "ParallelFor.h"
+#include "TransmittanceVolume.h"
+
+#if defined(__AVX2__)
+#define TRANSMITTANCE_USE_AVX2 1
+#include <immintrin.h>
+#else
+#define TRANSMITTANCE_USE_AVX2 0
+#endif
+
+#define ABSORPTION			1.0f
+
+using namespace std;
+
+namespace
+{
+	// Light step of PSRayCast.hlsl, which the attenuation per unit length follows
+	const float g_lightStepScale = 2.0f * sqrtf(3.0f) / 32.0f;
+
+	const uint32_t g_rowsPerTask = 8;
+
+	// Bilinear reads of the previous slice, at a constant offset of the row and with the
+	// weights of the two rows folded into w0 and w1; texels past the edges are clamped,
+	// and the positions outside the grid see the light unoccluded
+	void sweepRow(float* pT, const float* pU0, const float* pU1, uint32_t n, float offset, float w0, float w1)
+	{
+		const auto fo = floorf(offset);
+		const auto o = static_cast<int32_t>(fo);
+		const auto f = offset - fo;
+		const auto w00 = w0 * (1.0f - f), w10 = w0 * f;
+		const auto w01 = w1 * (1.0f - f), w11 = w1 * f;
+		const auto last = static_cast<int32_t>(n) - 1;
+
+		const auto sample = [&](int32_t b)
+		{
+			const auto q = b + 0.5f + offset;
+			if (q < 0.0f || q > static_cast<float>(n)) return 1.0f;
+
+			const auto b0 = (min)((max)(b + o, 0), last);
+			const auto b1 = (min)((max)(b + o + 1, 0), last);
+
+			return w00 * pU0[b0] + w10 * pU0[b1] + w01 * pU1[b0] + w11 * pU1[b1];
+		};
+
+		// Both texels of the interior are in the row
+		const auto bBegin = (min)((max)(-o, 0), static_cast<int32_t>(n));
+		const auto bEnd = (max)((min)(last - o, static_cast<int32_t>(n)), bBegin);
+
+		auto b = 0;
+		for (; b < bBegin; ++b) pT[b] = sample(b);
+#if TRANSMITTANCE_USE_AVX2
+		const auto v00 = _mm256_set1_ps(w00), v10 = _mm256_set1_ps(w10);
+		const auto v01 = _mm256_set1_ps(w01), v11 = _mm256_set1_ps(w11);
+		for (; b + 8 <= bEnd; b += 8)
+		{
+			const auto t0 = _mm256_add_ps(_mm256_mul_ps(v00, _mm256_loadu_ps(&pU0[b + o])),
+				_mm256_mul_ps(v10, _mm256_loadu_ps(&pU0[b + o + 1])));
+			const auto t1 = _mm256_add_ps(_mm256_mul_ps(v01, _mm256_loadu_ps(&pU1[b + o])),
+				_mm256_mul_ps(v11, _mm256_loadu_ps(&pU1[b + o + 1])));
+			_mm256_storeu_ps(&pT[b], _mm256_add_ps(t0, t1));
+		}
+#endif
+		for (; b < bEnd; ++b)
+			pT[b] = w00 * pU0[b + o] + w10 * pU0[b + o + 1] + w01 * pU1[b + o] + w11 * pU1[b + o + 1];
+		for (; b < static_cast<int32_t>(n); ++b) pT[b] = sample(b);
+	}
+
+	// Stores the transmittance of a row as UNORM, and what passes through each voxel to
+	// the next slice
+	void finishRow(uint8_t* pDst, float* pU, const float* pT, const uint8_t* pDensity, const float* pAtten, uint32_t n)
+	{
+		auto b = 0u;
+#if TRANSMITTANCE_USE_AVX2
+		const auto scale = _mm256_set1_ps(255.0f), half = _mm256_set1_ps(0.5f);
+		for (; b + 8 <= n; b += 8)
+		{
+			const auto density = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&pDensity[b])));
+			const auto atten = _mm256_i32gather_ps(pAtten, density, 4);
+			const auto t = _mm256_loadu_ps(&pT[b]);
+			_mm256_storeu_ps(&pU[b], _mm256_mul_ps(atten, t));
+
+			const auto unorm = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(t, scale), half));
+			const auto words = _mm_packus_epi32(_mm256_castsi256_si128(unorm), _mm256_extracti128_si256(unorm, 1));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(&pDst[b]), _mm_packus_epi16(words, words));
+		}
+#endif
+		for (; b < n; ++b)
+		{
+			pU[b] = pAtten[pDensity[b]] * pT[b];
+			pDst[b] = static_cast<uint8_t>((min)(pT[b], 1.0f) * 255.0f + 0.5f);
+		}
+	}
+}
+
+TransmittanceVolume::TransmittanceVolume() :
+	m_gridGeneration(0),
+	m_lightDir(0.0f, 0.0f, 0.0f),
+	m_isValid(false),
+	m_numBuilds(0)
+{
+}
+
+TransmittanceVolume::~TransmittanceVolume()
+{
+}
+
+bool TransmittanceVolume::Update(const VoxelGrid& grid, const Float3& localSpaceLightPt, uint32_t numThreads)
+{
+	if (!grid.GetNumVoxels() || Length(localSpaceLightPt) <= 0.0f) return false;
+	if (IsValid(grid, localSpaceLightPt)) return true;
+
+	m_isValid = false;
+	const auto gridGeneration = grid.GetGeneration();
+	if (!m_volume.Create(grid.GetWidth(), grid.GetHeight(), grid.GetDepth())) return false;
+
+	m_lightDir = Normalize(localSpaceLightPt);
+	build(grid, m_lightDir, numThreads);
+
+	m_gridGeneration = gridGeneration;
+	m_isValid = true;
+	++m_numBuilds;
+
+	return true;
+}
+
+void TransmittanceVolume::Invalidate()
+{
+	m_isValid = false;
+}
+
+bool TransmittanceVolume::IsValid(const VoxelGrid& grid, const Float3& localSpaceLightPt) const
+{
+	if (!m_isValid || grid.GetGeneration() != m_gridGeneration) return false;
+	if (grid.GetWidth() != m_volume.GetWidth() || grid.GetHeight() != m_volume.GetHeight() ||
+		grid.GetDepth() != m_volume.GetDepth()) return false;
+
+	const auto lightDir = Normalize(localSpaceLightPt);
+
+	return lightDir.x == m_lightDir.x && lightDir.y == m_lightDir.y && lightDir.z == m_lightDir.z;
+}
+
+float TransmittanceVolume::Sample(float u, float v, float w) const
+{
+	return m_volume.Sample(u, v, w);
+}
+
+const VoxelGrid& TransmittanceVolume::GetVolume() const
+{
+	return m_volume;
+}
+
+uint32_t TransmittanceVolume::GetNumBuilds() const
+{
+	return m_numBuilds;
+}
+
+void TransmittanceVolume::build(const VoxelGrid& grid, const Float3& lightDir, uint32_t numThreads)
+{
+	const uint32_t n[] = { grid.GetWidth(), grid.GetHeight(), grid.GetDepth() };
+
+	// Light direction in voxel space (texture space flips y); one sweep step moves a voxel
+	// along the dominant axis a, within the slice of axes b and c
+	const Float3 dir(0.5f * n[0] * lightDir.x, -0.5f * n[1] * lightDir.y, 0.5f * n[2] * lightDir.z);
+	const auto absDir = Abs(dir);
+	const auto a = absDir.x >= absDir.y && absDir.x >= absDir.z ? 0 : (absDir.y >= absDir.z ? 1 : 2);
+	const auto b = a ? 0 : 1;
+	const auto c = a == 2 ? 1 : 2;
+	const auto step = dir / absDir[a];
+
+	// Attenuation over a step, which is 1 / |dir[a]| long in local space, with the same
+	// absorption per unit length as the light samples of the shader
+	float atten[256];
+	const auto exponent = 1.0f / (absDir[a] * g_lightStepScale);
+	for (auto i = 0u; i < 256; ++i)
+	{
+		const auto density = (min)(i / 255.0f * 8.0f, 16.0f);
+		const auto lightTrans = (min)((max)(1.0f - ABSORPTION * g_lightStepScale * density, 0.0f), 1.0f);
+		atten[i] = powf(lightTrans, exponent);
+	}
+
+	// Light passing through each voxel of the previous and the current slice; the sweep
+	// starts at the slice facing the light, which sees it unoccluded
+	const auto sliceSize = static_cast<size_t>(n[b]) * n[c];
+	vector<float> passes[2] = { vector<float>(sliceSize, 1.0f), vector<float>(sliceSize) };
+
+	const auto isContiguous = b == 0 && grid.GetLayout() == VoxelGrid::LINEAR;
+	const auto pDstData = m_volume.GetData();
+	const auto rowOffset = step[c];
+	const auto numTasks = (n[c] + g_rowsPerTask - 1) / g_rowsPerTask;
+
+	for (auto i = 0u; i < n[a]; ++i)
+	{
+		const auto s = step[a] > 0.0f ? n[a] - 1 - i : i;
+		const auto pPrev = passes[i & 1].data();
+		const auto pCur = passes[(i & 1) ^ 1].data();
+
+		ParallelFor(0, numTasks, numThreads, [&](uint32_t task)
+		{
+			vector<float> trans(n[b]);
+			vector<uint8_t> densities(isContiguous ? 0 : n[b]);
+			vector<uint8_t> dst(isContiguous ? 0 : n[b]);
+
+			const auto rowEnd = (min)((task + 1) * g_rowsPerTask, n[c]);
+			for (auto r = task * g_rowsPerTask; r < rowEnd; ++r)
+			{
+				// Rows of the previous slice around the position one step toward the light
+				const auto q = r + 0.5f + rowOffset;
+				if (!i || q < 0.0f || q > static_cast<float>(n[c])) fill(trans.begin(), trans.end(), 1.0f);
+				else
+				{
+					const auto t = q - 0.5f;
+					const auto ft = floorf(t);
+					const auto w1 = t - ft;
+					const auto r0 = static_cast<uint32_t>((min)((max)(ft, 0.0f), n[c] - 1.0f));
+					const auto r1 = static_cast<uint32_t>((min)((max)(ft + 1.0f, 0.0f), n[c] - 1.0f));
+					sweepRow(trans.data(), &pPrev[static_cast<size_t>(n[b]) * r0], &pPrev[static_cast<size_t>(n[b]) * r1],
+						n[b], step[b], 1.0f - w1, w1);
+				}
+
+				uint32_t xyz[3];
+				xyz[a] = s;
+				xyz[b] = 0;
+				xyz[c] = r;
+				const auto pU = &pCur[static_cast<size_t>(n[b]) * r];
+				if (isContiguous)
+				{
+					const auto index = grid.GetIndex(xyz[0], xyz[1], xyz[2]);
+					finishRow(&pDstData[index], pU, trans.data(), &grid.GetData()[index], atten, n[b]);
+				}
+				else
+				{
+					for (auto j = 0u; j < n[b]; ++j)
+					{
+						xyz[b] = j;
+						densities[j] = grid.Get(xyz[0], xyz[1], xyz[2]);
+					}
+
+					finishRow(dst.data(), pU, trans.data(), densities.data(), atten, n[b]);
+
+					for (auto j = 0u; j < n[b]; ++j)
+					{
+						xyz[b] = j;
+						pDstData[m_volume.GetIndex(xyz[0], xyz[1], xyz[2])] = dst[j];
+					}
+				}
+			}
+		});
+	}
+}
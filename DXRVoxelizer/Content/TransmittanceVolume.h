@@ -0,0 +1,47 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "VectorMath.h"
+#include "VoxelGrid.h"
+
+//--------------------------------------------------------------------------------------
+// Light transmittance at every voxel center of a grid toward a directional light, so a
+// single lookup replaces the light samples that PSRayCast.hlsl marches for each occupied
+// sample. It is built by a sweep of slices along the dominant axis of the light, each
+// slice reading the previous one bilinearly, and rebuilt only when the grid or the
+// light changes.
+//--------------------------------------------------------------------------------------
+class TransmittanceVolume
+{
+public:
+	TransmittanceVolume();
+	virtual ~TransmittanceVolume();
+
+	// Builds the volume unless it is valid for the grid and the light already; the light
+	// is in the local space of the grid, as g_localSpaceLightPt of the shader
+	bool Update(const VoxelGrid& grid, const Float3& localSpaceLightPt, uint32_t numThreads = 0);
+	void Invalidate();	// The grid was written through a pointer held across Update
+
+	bool IsValid(const VoxelGrid& grid, const Float3& localSpaceLightPt) const;
+
+	// Trilinear filtering in normalized texture space, as VoxelGrid::Sample
+	float Sample(float u, float v, float w) const;
+
+	const VoxelGrid& GetVolume() const;
+	uint32_t GetNumBuilds() const;
+
+protected:
+	void build(const VoxelGrid& grid, const Float3& lightDir, uint32_t numThreads);
+
+	VoxelGrid m_volume;
+
+	// What the volume was built for
+	uint64_t	m_gridGeneration;
+	Float3		m_lightDir;
+	bool		m_isValid;
+
+	uint32_t	m_numBuilds;
+};
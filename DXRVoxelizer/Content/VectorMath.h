@@ -0,0 +1,175 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cmath>
+
+//--------------------------------------------------------------------------------------
+// Minimal portable vector math for the CPU paths, which cannot depend on DirectXMath
+//--------------------------------------------------------------------------------------
+struct Float3
+{
+	float x;
+	float y;
+	float z;
+
+	Float3() = default;
+	constexpr Float3(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
+	explicit Float3(const float* pArray) : x(pArray[0]), y(pArray[1]), z(pArray[2]) {}
+
+	float& operator[](int i) { return (&x)[i]; }
+	float operator[](int i) const { return (&x)[i]; }
+};
+
+inline Float3 operator+(const Float3& a, const Float3& b) { return Float3(a.x + b.x, a.y + b.y, a.z + b.z); }
+inline Float3 operator-(const Float3& a, const Float3& b) { return Float3(a.x - b.x, a.y - b.y, a.z - b.z); }
+inline Float3 operator-(const Float3& a) { return Float3(-a.x, -a.y, -a.z); }
+inline Float3 operator*(const Float3& a, const Float3& b) { return Float3(a.x * b.x, a.y * b.y, a.z * b.z); }
+inline Float3 operator*(const Float3& a, float s) { return Float3(a.x * s, a.y * s, a.z * s); }
+inline Float3 operator*(float s, const Float3& a) { return a * s; }
+inline Float3 operator/(const Float3& a, float s) { return a * (1.0f / s); }
+inline Float3& operator+=(Float3& a, const Float3& b) { a = a + b; return a; }
+inline Float3& operator-=(Float3& a, const Float3& b) { a = a - b; return a; }
+inline Float3& operator*=(Float3& a, float s) { a = a * s; return a; }
+
+inline float Dot(const Float3& a, const Float3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float Length(const Float3& a) { return sqrtf(Dot(a, a)); }
+inline Float3 Normalize(const Float3& a) { return a / Length(a); }
+inline Float3 Abs(const Float3& a) { return Float3(fabsf(a.x), fabsf(a.y), fabsf(a.z)); }
+
+inline Float3 Cross(const Float3& a, const Float3& b)
+{
+	return Float3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+inline Float3 Min(const Float3& a, const Float3& b)
+{
+	return Float3((a.x < b.x ? a.x : b.x), (a.y < b.y ? a.y : b.y), (a.z < b.z ? a.z : b.z));
+}
+
+inline Float3 Max(const Float3& a, const Float3& b)
+{
+	return Float3((a.x > b.x ? a.x : b.x), (a.y > b.y ? a.y : b.y), (a.z > b.z ? a.z : b.z));
+}
+
+//--------------------------------------------------------------------------------------
+// Row-major 4x4 matrix for row vectors, with the conventions of the DirectXMath
+// functions of the same names
+//--------------------------------------------------------------------------------------
+struct Float4x4
+{
+	float m[4][4];
+
+	float* operator[](int i) { return m[i]; }
+	const float* operator[](int i) const { return m[i]; }
+
+	static Float4x4 Identity()
+	{
+		return Float4x4{ { { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f },
+			{ 0.0f, 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } } };
+	}
+};
+
+inline Float4x4 operator*(const Float4x4& a, const Float4x4& b)
+{
+	Float4x4 r;
+	for (auto i = 0; i < 4; ++i)
+		for (auto j = 0; j < 4; ++j)
+			r[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j] + a[i][3] * b[3][j];
+
+	return r;
+}
+
+inline Float4x4 Scaling(float s)
+{
+	auto r = Float4x4::Identity();
+	r[0][0] = r[1][1] = r[2][2] = s;
+
+	return r;
+}
+
+inline Float4x4 Translation(const Float3& t)
+{
+	auto r = Float4x4::Identity();
+	r[3][0] = t.x;
+	r[3][1] = t.y;
+	r[3][2] = t.z;
+
+	return r;
+}
+
+inline Float4x4 LookAtLH(const Float3& eyePt, const Float3& focusPt, const Float3& up)
+{
+	const auto zAxis = Normalize(focusPt - eyePt);
+	const auto xAxis = Normalize(Cross(up, zAxis));
+	const auto yAxis = Cross(zAxis, xAxis);
+
+	return Float4x4{ {
+		{ xAxis.x, yAxis.x, zAxis.x, 0.0f },
+		{ xAxis.y, yAxis.y, zAxis.y, 0.0f },
+		{ xAxis.z, yAxis.z, zAxis.z, 0.0f },
+		{ -Dot(xAxis, eyePt), -Dot(yAxis, eyePt), -Dot(zAxis, eyePt), 1.0f } } };
+}
+
+inline Float4x4 PerspectiveFovLH(float fovAngleY, float aspectRatio, float zNear, float zFar)
+{
+	const auto h = 1.0f / tanf(0.5f * fovAngleY);
+	const auto range = zFar / (zFar - zNear);
+
+	return Float4x4{ {
+		{ h / aspectRatio, 0.0f, 0.0f, 0.0f },
+		{ 0.0f, h, 0.0f, 0.0f },
+		{ 0.0f, 0.0f, range, 1.0f },
+		{ 0.0f, 0.0f, -range * zNear, 0.0f } } };
+}
+
+// Transforms (p, 1) and divides by w
+inline Float3 TransformCoord(const Float3& p, const Float4x4& a)
+{
+	float r[4];
+	for (auto j = 0; j < 4; ++j) r[j] = p.x * a[0][j] + p.y * a[1][j] + p.z * a[2][j] + a[3][j];
+
+	return Float3(r[0], r[1], r[2]) / r[3];
+}
+
+// General inverse by cofactors; returns false for a singular matrix
+inline bool Inverse(Float4x4& r, const Float4x4& a)
+{
+	const auto s0 = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+	const auto s1 = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+	const auto s2 = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+	const auto s3 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+	const auto s4 = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+	const auto s5 = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+	const auto c5 = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+	const auto c4 = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+	const auto c3 = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+	const auto c2 = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+	const auto c1 = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+	const auto c0 = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+
+	const auto det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	if (det == 0.0f) return false;
+	const auto invDet = 1.0f / det;
+
+	r[0][0] = (a[1][1] * c5 - a[1][2] * c4 + a[1][3] * c3) * invDet;
+	r[0][1] = (-a[0][1] * c5 + a[0][2] * c4 - a[0][3] * c3) * invDet;
+	r[0][2] = (a[3][1] * s5 - a[3][2] * s4 + a[3][3] * s3) * invDet;
+	r[0][3] = (-a[2][1] * s5 + a[2][2] * s4 - a[2][3] * s3) * invDet;
+	r[1][0] = (-a[1][0] * c5 + a[1][2] * c2 - a[1][3] * c1) * invDet;
+	r[1][1] = (a[0][0] * c5 - a[0][2] * c2 + a[0][3] * c1) * invDet;
+	r[1][2] = (-a[3][0] * s5 + a[3][2] * s2 - a[3][3] * s1) * invDet;
+	r[1][3] = (a[2][0] * s5 - a[2][2] * s2 + a[2][3] * s1) * invDet;
+	r[2][0] = (a[1][0] * c4 - a[1][1] * c2 + a[1][3] * c0) * invDet;
+	r[2][1] = (-a[0][0] * c4 + a[0][1] * c2 - a[0][3] * c0) * invDet;
+	r[2][2] = (a[3][0] * s4 - a[3][1] * s2 + a[3][3] * s0) * invDet;
+	r[2][3] = (-a[2][0] * s4 + a[2][1] * s2 - a[2][3] * s0) * invDet;
+	r[3][0] = (-a[1][0] * c3 + a[1][1] * c1 - a[1][2] * c0) * invDet;
+	r[3][1] = (a[0][0] * c3 - a[0][1] * c1 + a[0][2] * c0) * invDet;
+	r[3][2] = (-a[3][0] * s3 + a[3][1] * s1 - a[3][2] * s0) * invDet;
+	r[3][3] = (a[2][0] * s3 - a[2][1] * s1 + a[2][2] * s0) * invDet;
+
+	return true;
+}
@@ -0,0 +1,296 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+#include <vector>
+#include "VoxelCache.h"
+#include "VoxelizerCPU.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace
+{
+	const char* const EntryExtension = ".vxgz";
+	const char* const TempExtension = ".tmp";
+
+	// XXH64
+	const uint64_t Prime1 = 0x9e3779b185ebca87ull;
+	const uint64_t Prime2 = 0xc2b2ae3d27d4eb4full;
+	const uint64_t Prime3 = 0x165667b19e3779f9ull;
+	const uint64_t Prime4 = 0x85ebca77c2b2ae63ull;
+	const uint64_t Prime5 = 0x27d4eb2f165667c5ull;
+
+	inline uint64_t rotl(uint64_t x, int r)
+	{
+		return (x << r) | (x >> (64 - r));
+	}
+
+	inline uint64_t read64(const uint8_t* p)
+	{
+		uint64_t x;
+		memcpy(&x, p, sizeof(x));
+
+		return x;
+	}
+
+	inline uint32_t read32(const uint8_t* p)
+	{
+		uint32_t x;
+		memcpy(&x, p, sizeof(x));
+
+		return x;
+	}
+
+	inline uint64_t hashRound(uint64_t acc, uint64_t input)
+	{
+		return rotl(acc + input * Prime2, 31) * Prime1;
+	}
+
+	inline uint64_t mergeRound(uint64_t acc, uint64_t val)
+	{
+		return (acc ^ hashRound(0, val)) * Prime1 + Prime4;
+	}
+
+	uint64_t hash64(const void* pData, size_t size, uint64_t seed)
+	{
+		auto p = static_cast<const uint8_t*>(pData);
+		const auto pEnd = p + size;
+
+		uint64_t h;
+		if (size >= 32)
+		{
+			uint64_t v[] = { seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1 };
+			for (; p + 32 <= pEnd; p += 32)
+				for (auto i = 0; i < 4; ++i) v[i] = hashRound(v[i], read64(&p[8 * i]));
+
+			h = rotl(v[0], 1) + rotl(v[1], 7) + rotl(v[2], 12) + rotl(v[3], 18);
+			for (const auto& lane : v) h = mergeRound(h, lane);
+		}
+		else h = seed + Prime5;
+
+		h += size;
+		for (; p + 8 <= pEnd; p += 8) h = rotl(h ^ hashRound(0, read64(p)), 27) * Prime1 + Prime4;
+		for (; p + 4 <= pEnd; p += 4) h = rotl(h ^ (read32(p) * Prime1), 23) * Prime2 + Prime3;
+		for (; p < pEnd; ++p) h = rotl(h ^ (*p * Prime5), 11) * Prime1;
+
+		h ^= h >> 33;
+		h *= Prime2;
+		h ^= h >> 29;
+		h *= Prime3;
+		h ^= h >> 32;
+
+		return h;
+	}
+}
+
+VoxelCache::VoxelCache() :
+	m_maxBytes(DefaultMaxBytes),
+	m_size(0),
+	m_numHits(0),
+	m_numMisses(0),
+	m_numStores(0),
+	m_numEvictions(0),
+	m_tempIndex(0)
+{
+}
+
+VoxelCache::~VoxelCache()
+{
+}
+
+bool VoxelCache::Init(const char* directory, uint64_t maxBytes)
+{
+	error_code ec;
+	fs::create_directories(directory, ec);
+	if (!fs::is_directory(directory, ec)) return false;
+
+	m_directory = directory;
+	m_maxBytes = maxBytes;
+
+	// Also accounts the existing entries and applies a lowered cap
+	evict();
+
+	return true;
+}
+
+bool VoxelCache::Find(const Key& key, VoxelGridReader& reader)
+{
+	const auto fileName = GetFileName(key);
+
+	// The modification time orders entries for eviction
+	error_code ec;
+	fs::last_write_time(fileName, fs::file_time_type::clock::now(), ec);
+	if (!ec && reader.Open(fileName.c_str()))
+	{
+		++m_numHits;
+
+		return true;
+	}
+
+	// Drop an entry that fails validation, such as one from an older file version
+	if (!ec) fs::remove(fileName, ec);
+	++m_numMisses;
+
+	return false;
+}
+
+bool VoxelCache::Store(const Key& key, const VoxelGrid& grid, const float bound[4], uint32_t numThreads)
+{
+	return store(key, bound, [&](VoxelGridWriter& writer, const char* fileName)
+	{
+		return writer.Write(fileName, grid, numThreads);
+	});
+}
+
+bool VoxelCache::Store(const Key& key, const RLEGrid& grid, const float bound[4], uint32_t numThreads)
+{
+	return store(key, bound, [&](VoxelGridWriter& writer, const char* fileName)
+	{
+		return writer.Write(fileName, grid, numThreads);
+	});
+}
+
+string VoxelCache::GetFileName(const Key& key) const
+{
+	char name[33];
+	snprintf(name, sizeof(name), "%016llx%016llx", static_cast<unsigned long long>(key.Hash[0]),
+		static_cast<unsigned long long>(key.Hash[1]));
+
+	return (fs::path(m_directory) / (string(name) + EntryExtension)).string();
+}
+
+VoxelCache::Stats VoxelCache::GetStats() const
+{
+	Stats stats;
+	stats.Hits = m_numHits;
+	stats.Misses = m_numMisses;
+	stats.Stores = m_numStores;
+	stats.Evictions = m_numEvictions;
+
+	return stats;
+}
+
+uint64_t VoxelCache::GetSize() const
+{
+	return m_size;
+}
+
+bool VoxelCache::MakeKey(Key& key, const char* meshFileName, uint32_t gridSize,
+	float threshold, const float posScale[4], uint8_t mode)
+{
+	MappedFile file;
+	if (!file.Open(meshFileName)) return false;
+	key = MakeKey(file.GetData(), file.GetSize(), gridSize, threshold, posScale, mode);
+
+	return true;
+}
+
+VoxelCache::Key VoxelCache::MakeKey(const void* pMesh, size_t meshSize, uint32_t gridSize,
+	float threshold, const float posScale[4], uint8_t mode)
+{
+	// Settings are hashed as 32-bit words to keep padding out of the key
+	uint32_t settings[9] = { VoxelGridFile::Version, VoxelizerCPU::AlgorithmVersion, gridSize, 0, 0, 0, 0, 0, mode };
+	memcpy(&settings[3], &threshold, sizeof(float));
+	memcpy(&settings[4], posScale, sizeof(float[4]));
+
+	Key key;
+	for (auto i = 0u; i < 2; ++i)
+	{
+		const auto meshHash = hash64(pMesh, meshSize, i);
+		key.Hash[i] = hash64(settings, sizeof(settings), meshHash);
+	}
+
+	return key;
+}
+
+bool VoxelCache::store(const Key& key, const float bound[4], const WriteFunc& write)
+{
+	if (m_directory.empty()) return false;
+
+	// Readers only ever see complete entries, as the rename replaces the file atomically
+	const auto fileName = GetFileName(key);
+	const auto tempName = fileName + "." + to_string(hash<thread::id>()(this_thread::get_id()) ^
+		chrono::steady_clock::now().time_since_epoch().count()) + "-" + to_string(m_tempIndex++) + TempExtension;
+
+	VoxelGridWriter writer;
+	writer.SetBound(bound);
+	error_code ec;
+	if (!write(writer, tempName.c_str()))
+	{
+		fs::remove(tempName, ec);
+
+		return false;
+	}
+
+	fs::rename(tempName, fileName, ec);
+	if (ec)
+	{
+		fs::remove(tempName, ec);
+
+		return false;
+	}
+	++m_numStores;
+
+	evict();
+
+	return true;
+}
+
+void VoxelCache::evict()
+{
+	struct Entry
+	{
+		fs::path Path;
+		fs::file_time_type Time;
+		uint64_t Size;
+	};
+
+	lock_guard<mutex> lock(m_evictMutex);
+
+	// Temporary files left behind by a crashed writer are removed after an hour
+	const auto staleTime = fs::file_time_type::clock::now() - chrono::hours(1);
+
+	vector<Entry> entries;
+	uint64_t size = 0;
+	error_code ec;
+	for (fs::directory_iterator it(m_directory, ec), end; !ec && it != end; it.increment(ec))
+	{
+		// Files may be renamed or removed by other processes meanwhile
+		error_code fileEc;
+		if (!it->is_regular_file(fileEc)) continue;
+
+		const auto& path = it->path();
+		const auto time = it->last_write_time(fileEc);
+		if (fileEc) continue;
+
+		if (path.extension() == EntryExtension)
+		{
+			const auto fileSize = it->file_size(fileEc);
+			if (fileEc) continue;
+			entries.push_back({ path, time, fileSize });
+			size += fileSize;
+		}
+		else if (path.extension() == TempExtension && time < staleTime)
+			fs::remove(path, fileEc);
+	}
+
+	// Least recently used first
+	sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.Time < b.Time; });
+	for (auto it = entries.cbegin(); size > m_maxBytes && it != entries.cend(); ++it)
+	{
+		// A mapped entry cannot be removed on Windows, and is kept until a later store
+		if (fs::remove(it->Path, ec))
+		{
+			size -= it->Size;
+			++m_numEvictions;
+		}
+	}
+
+	m_size = size;
+}
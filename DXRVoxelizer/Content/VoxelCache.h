@@ -0,0 +1,73 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include "VoxelGridIO.h"
+
+//--------------------------------------------------------------------------------------
+// Content-addressed cache of voxelization results. An entry is a VoxelGridFile named
+// after a 128-bit hash of the mesh bytes, every setting that affects the voxels and
+// VoxelizerCPU::AlgorithmVersion, so a hit is mapped straight from disk without parsing
+// or voxelizing the mesh. Entries are written to a temporary file and renamed into place,
+// and the least recently used ones are evicted once the directory exceeds the size cap.
+//--------------------------------------------------------------------------------------
+class VoxelCache
+{
+public:
+	struct Key
+	{
+		uint64_t Hash[2];
+	};
+
+	struct Stats
+	{
+		uint64_t Hits;
+		uint64_t Misses;
+		uint64_t Stores;
+		uint64_t Evictions;
+	};
+
+	VoxelCache();
+	virtual ~VoxelCache();
+
+	bool Init(const char* directory, uint64_t maxBytes = DefaultMaxBytes);
+
+	// Find and Store are safe to call concurrently; on a hit, reader maps the entry
+	bool Find(const Key& key, VoxelGridReader& reader);
+	bool Store(const Key& key, const VoxelGrid& grid, const float bound[4], uint32_t numThreads = 0);
+	bool Store(const Key& key, const RLEGrid& grid, const float bound[4], uint32_t numThreads = 0);
+
+	std::string GetFileName(const Key& key) const;
+	Stats GetStats() const;
+	uint64_t GetSize() const;	// Bytes of all entries as of the last store
+
+	static bool MakeKey(Key& key, const char* meshFileName, uint32_t gridSize,
+		float threshold, const float posScale[4], uint8_t mode);
+	static Key MakeKey(const void* pMesh, size_t meshSize, uint32_t gridSize,
+		float threshold, const float posScale[4], uint8_t mode);
+
+	static const uint64_t DefaultMaxBytes = 256ull << 20;
+
+protected:
+	using WriteFunc = std::function<bool(VoxelGridWriter& writer, const char* fileName)>;
+
+	bool store(const Key& key, const float bound[4], const WriteFunc& write);
+	void evict();
+
+	std::string m_directory;
+	uint64_t m_maxBytes;
+
+	std::mutex m_evictMutex;
+	std::atomic<uint64_t> m_size;
+	std::atomic<uint64_t> m_numHits;
+	std::atomic<uint64_t> m_numMisses;
+	std::atomic<uint64_t> m_numStores;
+	std::atomic<uint64_t> m_numEvictions;
+	std::atomic<uint32_t> m_tempIndex;
+};
@@ -0,0 +1,424 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+#include "ParallelFor.h"
+#include "Profiler.h"
+#include "VoxelExporter.h"
+
+using namespace std;
+
+// Deflate of stb_image_write (Common/stb_image_write.cpp); returns a zlib stream freed by free()
+extern "C" unsigned char* stbi_zlib_compress(unsigned char* data, int data_len, int* out_len, int quality);
+
+namespace
+{
+	const int GzipQuality = 5;
+
+	uint32_t crc32(const uint8_t* pData, size_t size)
+	{
+		static const auto table = []()
+		{
+			vector<uint32_t> table(256);
+			for (auto i = 0u; i < 256; ++i)
+			{
+				auto c = i;
+				for (auto k = 0; k < 8; ++k) c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+				table[i] = c;
+			}
+
+			return table;
+		}();
+
+		auto crc = 0xffffffffu;
+		for (size_t i = 0; i < size; ++i) crc = table[(crc ^ pData[i]) & 0xff] ^ (crc >> 8);
+
+		return ~crc;
+	}
+
+	// Wraps the deflate data of one slice into a gzip member (RFC 1952); readers inflate
+	// concatenated members as a single stream.
+	bool encodeGzipMember(vector<uint8_t>& member, const uint8_t* pData, size_t size)
+	{
+		auto zlibSize = 0;
+		const auto pZlib = stbi_zlib_compress(const_cast<uint8_t*>(pData), static_cast<int>(size), &zlibSize, GzipQuality);
+		if (!pZlib) return false;
+		if (zlibSize < 6)
+		{
+			free(pZlib);
+			return false;
+		}
+
+		// Strip the 2-byte zlib header and the Adler-32 trailer
+		static const uint8_t header[] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff };
+		const auto deflateSize = static_cast<size_t>(zlibSize) - 6;
+		member.resize(sizeof(header) + deflateSize + 8);
+		memcpy(member.data(), header, sizeof(header));
+		memcpy(&member[sizeof(header)], pZlib + 2, deflateSize);
+		free(pZlib);
+
+		const uint32_t trailer[] = { crc32(pData, size), static_cast<uint32_t>(size) };
+		memcpy(&member[sizeof(header) + deflateSize], trailer, sizeof(trailer));
+
+		return true;
+	}
+
+	// Little-endian builders of .vox chunks
+	void put32(vector<uint8_t>& buffer, uint32_t value)
+	{
+		const auto offset = buffer.size();
+		buffer.resize(offset + sizeof(value));
+		memcpy(&buffer[offset], &value, sizeof(value));
+	}
+
+	void putString(vector<uint8_t>& buffer, const string& str)
+	{
+		put32(buffer, static_cast<uint32_t>(str.size()));
+		buffer.insert(buffer.end(), str.cbegin(), str.cend());
+	}
+
+	void putChunk(vector<uint8_t>& buffer, const char* id, const void* pContent, size_t contentSize)
+	{
+		buffer.insert(buffer.end(), id, id + 4);
+		put32(buffer, static_cast<uint32_t>(contentSize));
+		put32(buffer, 0);
+		const auto pBytes = static_cast<const uint8_t*>(pContent);
+		buffer.insert(buffer.end(), pBytes, pBytes + contentSize);
+	}
+
+	void putChunk(vector<uint8_t>& buffer, const char* id, const vector<uint8_t>& content)
+	{
+		putChunk(buffer, id, content.data(), content.size());
+	}
+}
+
+VoxelExporter::VoxelExporter() :
+	m_fileSize(0),
+	m_numModels(0)
+{
+}
+
+VoxelExporter::~VoxelExporter()
+{
+}
+
+bool VoxelExporter::Export(const char* fileName, const VoxelSliceSource& source, Format format, uint32_t numThreads)
+{
+	PROFILE_ZONE("voxel export");
+	if (format >= NUM_FORMAT || !source.GetWidth() || !source.GetHeight() || !source.GetDepth()) return false;
+
+	ofstream stream(fileName, ios::binary | ios::trunc);
+	if (!stream) return false;
+
+	m_numModels = 0;
+	auto isSucceeded = false;
+	switch (format)
+	{
+	case NRRD:
+	case NRRD_GZIP:
+		// Attached header, ended by a blank line before the data
+		stream << "NRRD0004\n";
+		stream << "# Exported by DXRVoxelizer\n";
+		stream << "type: uint8\n";
+		stream << "dimension: 3\n";
+		stream << "sizes: " << source.GetWidth() << " " << source.GetHeight() << " " << source.GetDepth() << "\n";
+		stream << "kinds: domain domain domain\n";
+		stream << "encoding: " << (format == NRRD_GZIP ? "gzip" : "raw") << "\n\n";
+		isSucceeded = format == NRRD_GZIP ? exportGzip(stream, source, numThreads) : exportRaw(stream, source, numThreads);
+		break;
+	case VOX:
+		isSucceeded = exportVox(stream, source, numThreads);
+		break;
+	default:
+		isSucceeded = exportRaw(stream, source, numThreads);
+	}
+
+	m_fileSize = static_cast<uint64_t>(stream.tellp());
+	stream.close();
+
+	return isSucceeded && !stream.fail();
+}
+
+uint64_t VoxelExporter::GetFileSize() const
+{
+	return m_fileSize;
+}
+
+uint32_t VoxelExporter::GetNumModels() const
+{
+	return m_numModels;
+}
+
+const char* VoxelExporter::GetFormatName(Format format)
+{
+	static const char* names[] = { "raw", "nrrd", "nrrd-gzip", "vox" };
+
+	return format < NUM_FORMAT ? names[format] : "unknown";
+}
+
+const char* VoxelExporter::GetFileExtension(Format format)
+{
+	static const char* extensions[] = { ".raw", ".nrrd", ".nrrd", ".vox" };
+
+	return format < NUM_FORMAT ? extensions[format] : "";
+}
+
+bool VoxelExporter::exportRaw(ostream& stream, const VoxelSliceSource& source, uint32_t numThreads)
+{
+	const auto depth = source.GetDepth();
+	const auto sliceSize = source.GetSliceSize();
+	vector<uint8_t> slab(sliceSize * (min)(SlabDepth, depth));
+	for (auto z = 0u; z < depth; z += SlabDepth)
+	{
+		const auto numSlices = (min)(SlabDepth, depth - z);
+		if (!source.GetSlices(z, numSlices, slab.data(), numThreads)) return false;
+		stream.write(reinterpret_cast<const char*>(slab.data()), sliceSize * numSlices);
+		if (!stream) return false;
+	}
+
+	return true;
+}
+
+bool VoxelExporter::exportGzip(ostream& stream, const VoxelSliceSource& source, uint32_t numThreads)
+{
+	const auto depth = source.GetDepth();
+	const auto sliceSize = source.GetSliceSize();
+	if (sliceSize > INT32_MAX) return false;
+
+	vector<uint8_t> slab(sliceSize * (min)(SlabDepth, depth));
+	vector<vector<uint8_t>> members(SlabDepth);
+	for (auto z = 0u; z < depth; z += SlabDepth)
+	{
+		const auto numSlices = (min)(SlabDepth, depth - z);
+		if (!source.GetSlices(z, numSlices, slab.data(), numThreads)) return false;
+
+		atomic<bool> isSucceeded(true);
+		ParallelFor(0, numSlices, numThreads, [&](uint32_t i)
+		{
+			if (!encodeGzipMember(members[i], &slab[sliceSize * i], sliceSize)) isSucceeded = false;
+		});
+		if (!isSucceeded) return false;
+
+		for (auto i = 0u; i < numSlices; ++i)
+			stream.write(reinterpret_cast<const char*>(members[i].data()), members[i].size());
+		if (!stream) return false;
+	}
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------------
+// MagicaVoxel is Z-up, so the grid maps to .vox space as (x, z, height - 1 - y), given
+// that grid y grows downwards as in raygenMain. The grid is cut into models of at most
+// VoxModelSize^3, placed by a transform node each. The models of a layer of
+// VoxModelSize slices all grow with every slab, while each must be contiguous in the
+// file, so a layer is streamed twice: first counting the voxels of each model, which
+// places the models in the file, then writing the records of each slab at the end of
+// those of its models. Only one slab and its records are held in memory.
+//--------------------------------------------------------------------------------------
+bool VoxelExporter::exportVox(ostream& stream, const VoxelSliceSource& source, uint32_t numThreads)
+{
+	const auto width = source.GetWidth();
+	const auto height = source.GetHeight();
+	const auto depth = source.GetDepth();
+	const auto sliceSize = source.GetSliceSize();
+	const auto numTilesX = (width + VoxModelSize - 1) / VoxModelSize;
+	const auto numTilesZ = (height + VoxModelSize - 1) / VoxModelSize;
+	const auto numTiles = numTilesX * numTilesZ;
+
+	// Header and the MAIN chunk, whose children size is patched at the end
+	stream.write("VOX ", 4);
+	const uint32_t mainHeader[] = { 150, 0x4e49414d, 0, 0 }; // Version, "MAIN", content and children sizes
+	stream.write(reinterpret_cast<const char*>(mainHeader), sizeof(mainHeader));
+	const auto childrenOffset = stream.tellp();
+
+	vector<string> translations;
+	vector<uint8_t> chunks;
+	vector<uint8_t> slab(sliceSize * (min)(SlabDepth, depth));
+	vector<vector<vector<uint32_t>>> sliceRecords(SlabDepth, vector<vector<uint32_t>>(numTiles));
+	vector<vector<uint32_t>> sliceCounts(SlabDepth, vector<uint32_t>(numTiles));
+	vector<uint32_t> counts(numTiles);
+	vector<streamoff> offsets(numTiles);
+	auto layerOffset = static_cast<streamoff>(childrenOffset);
+	for (auto layerZ = 0u; layerZ < depth; layerZ += VoxModelSize)
+	{
+		const auto layerEnd = (min)(layerZ + VoxModelSize, depth);
+
+		// Calls fn(slice of the slab, z, vz, row) per row of each slice of the layer, in
+		// parallel over the slices of a slab, then onSlab(number of slices) after each slab
+		const auto forEachRow = [&](const function<void(uint32_t, uint32_t, uint32_t, const uint8_t*)>& fn,
+			const function<void(uint32_t)>& onSlab)
+		{
+			for (auto z = layerZ; z < layerEnd; z += SlabDepth)
+			{
+				const auto numSlices = (min)(SlabDepth, layerEnd - z);
+				if (!source.GetSlices(z, numSlices, slab.data(), numThreads)) return false;
+				ParallelFor(0, numSlices, numThreads, [&](uint32_t i)
+				{
+					for (auto y = 0u; y < height; ++y)
+						fn(i, z + i, height - 1 - y, &slab[sliceSize * i + static_cast<size_t>(width) * y]);
+				});
+				onSlab(numSlices);
+			}
+
+			return true;
+		};
+
+		// Count the voxels of each model
+		fill(counts.begin(), counts.end(), 0);
+		for (auto& tileCounts : sliceCounts) fill(tileCounts.begin(), tileCounts.end(), 0);
+		if (!forEachRow([&](uint32_t i, uint32_t, uint32_t vz, const uint8_t* pRow)
+		{
+			const auto pCounts = &sliceCounts[i][numTilesX * (vz / VoxModelSize)];
+			for (auto x = 0u; x < width; ++x) pCounts[x / VoxModelSize] += pRow[x] ? 1 : 0;
+		}, [&](uint32_t numSlices)
+		{
+			for (auto i = 0u; i < numSlices; ++i)
+				for (auto t = 0u; t < numTiles; ++t)
+				{
+					counts[t] += sliceCounts[i][t];
+					sliceCounts[i][t] = 0;
+				}
+		})) return false;
+
+		// Write the SIZE chunk and the XYZI header of each non-empty model, leaving room
+		// for its records
+		for (auto t = 0u; t < numTiles; ++t)
+		{
+			if (!counts[t]) continue;
+
+			const uint32_t origin[] = { t % numTilesX * VoxModelSize, layerZ, t / numTilesX * VoxModelSize };
+			const uint32_t extent[] = { width, depth, height };
+			uint32_t size[3];
+			for (auto i = 0; i < 3; ++i) size[i] = (min)(VoxModelSize, extent[i] - origin[i]);
+
+			chunks.clear();
+			putChunk(chunks, "SIZE", size, sizeof(size));
+			chunks.insert(chunks.end(), { 'X', 'Y', 'Z', 'I' });
+			put32(chunks, static_cast<uint32_t>(sizeof(uint32_t) * (counts[t] + static_cast<size_t>(1))));
+			put32(chunks, 0);
+			put32(chunks, counts[t]);
+			stream.seekp(layerOffset);
+			stream.write(reinterpret_cast<const char*>(chunks.data()), chunks.size());
+			offsets[t] = layerOffset + static_cast<streamoff>(chunks.size());
+			layerOffset = offsets[t] + static_cast<streamoff>(sizeof(uint32_t) * counts[t]);
+
+			// A model is centered on its translation; center the whole grid at the origin
+			string translation;
+			for (auto i = 0; i < 3; ++i)
+			{
+				const auto offset = static_cast<int>(origin[i] + size[i] / 2) - static_cast<int>(extent[i] / 2);
+				translation += (i ? " " : "") + to_string(offset);
+			}
+			translations.push_back(translation);
+		}
+
+		// Collect the XYZI records of each slice per model, then append those of the slab
+		// to each model in slice order
+		if (!forEachRow([&](uint32_t i, uint32_t sliceZ, uint32_t vz, const uint8_t* pRow)
+		{
+			auto& tileRecords = sliceRecords[i];
+			const auto pTiles = &tileRecords[numTilesX * (vz / VoxModelSize)];
+			const auto prefix = ((sliceZ % VoxModelSize) << 8) | ((vz % VoxModelSize) << 16);
+			for (auto x = 0u; x < width; ++x)
+				if (pRow[x]) pTiles[x / VoxModelSize].push_back(prefix | (x % VoxModelSize) | (static_cast<uint32_t>(pRow[x]) << 24));
+		}, [&](uint32_t numSlices)
+		{
+			for (auto t = 0u; t < numTiles; ++t)
+			{
+				if (!counts[t]) continue;
+
+				stream.seekp(offsets[t]);
+				for (auto i = 0u; i < numSlices; ++i)
+				{
+					auto& records = sliceRecords[i][t];
+					stream.write(reinterpret_cast<const char*>(records.data()), sizeof(uint32_t) * records.size());
+					offsets[t] += static_cast<streamoff>(sizeof(uint32_t) * records.size());
+					records.clear();
+				}
+			}
+		})) return false;
+		if (!stream) return false;
+	}
+	stream.seekp(layerOffset);
+
+	// MagicaVoxel expects at least one model
+	m_numModels = static_cast<uint32_t>(translations.size());
+	chunks.clear();
+	if (!m_numModels)
+	{
+		const uint32_t size[] = { 1, 1, 1 }, numVoxels = 0;
+		putChunk(chunks, "SIZE", size, sizeof(size));
+		putChunk(chunks, "XYZI", &numVoxels, sizeof(numVoxels));
+		m_numModels = 1;
+	}
+	else if (m_numModels > 1)
+	{
+		// Scene graph: root transform -> group -> (transform -> shape) per model
+		vector<uint8_t> content;
+		const auto putTransform = [&](uint32_t nodeId, uint32_t childId, int32_t layerId, const string* pTranslation)
+		{
+			content.clear();
+			put32(content, nodeId);
+			put32(content, 0);			// Node attributes
+			put32(content, childId);
+			put32(content, UINT32_MAX);	// Reserved
+			put32(content, static_cast<uint32_t>(layerId));
+			put32(content, 1);			// Frames
+			put32(content, pTranslation ? 1 : 0);
+			if (pTranslation)
+			{
+				putString(content, "_t");
+				putString(content, *pTranslation);
+			}
+			putChunk(chunks, "nTRN", content);
+		};
+
+		putTransform(0, 1, -1, nullptr);
+		content.clear();
+		put32(content, 1);
+		put32(content, 0);
+		put32(content, m_numModels);
+		for (auto i = 0u; i < m_numModels; ++i) put32(content, 2 + 2 * i);
+		putChunk(chunks, "nGRP", content);
+
+		for (auto i = 0u; i < m_numModels; ++i)
+		{
+			putTransform(2 + 2 * i, 3 + 2 * i, 0, &translations[i]);
+			content.clear();
+			put32(content, 3 + 2 * i);
+			put32(content, 0);
+			put32(content, 1);			// Models
+			put32(content, i);
+			put32(content, 0);			// Model attributes
+			putChunk(chunks, "nSHP", content);
+		}
+	}
+
+	// Grey-scale palette by density; entry i is the color of index i + 1
+	uint32_t palette[256];
+	for (auto i = 0u; i < 256; ++i)
+	{
+		const auto grey = (min)(i + 1, 255u);
+		palette[i] = grey | (grey << 8) | (grey << 16) | 0xff000000;
+	}
+	putChunk(chunks, "RGBA", palette, sizeof(palette));
+	stream.write(reinterpret_cast<const char*>(chunks.data()), chunks.size());
+
+	// Patch the children size of MAIN
+	const auto endOffset = stream.tellp();
+	const auto childrenSize = static_cast<uint32_t>(endOffset - childrenOffset);
+	stream.seekp(childrenOffset - static_cast<streamoff>(sizeof(uint32_t)));
+	stream.write(reinterpret_cast<const char*>(&childrenSize), sizeof(childrenSize));
+	stream.seekp(endOffset);
+
+	return !stream.fail();
+}
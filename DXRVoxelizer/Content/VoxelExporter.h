@@ -0,0 +1,48 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <iosfwd>
+#include "VoxelSliceSource.h"
+
+//--------------------------------------------------------------------------------------
+// Exports a grid streamed slab by slab from a VoxelSliceSource; the slices of a slab
+// are encoded in parallel and written in order.
+//--------------------------------------------------------------------------------------
+class VoxelExporter
+{
+public:
+	enum Format : uint8_t
+	{
+		RAW,		// Headerless X-major uint8
+		NRRD,		// NRRD with raw encoding
+		NRRD_GZIP,	// NRRD with gzip encoding, one gzip member per slice
+		VOX,		// MagicaVoxel .vox, split into models of at most 256^3
+
+		NUM_FORMAT
+	};
+
+	VoxelExporter();
+	virtual ~VoxelExporter();
+
+	bool Export(const char* fileName, const VoxelSliceSource& source, Format format, uint32_t numThreads = 0);
+
+	uint64_t GetFileSize() const;
+	uint32_t GetNumModels() const;
+
+	static const char* GetFormatName(Format format);
+	static const char* GetFileExtension(Format format);
+
+	static const uint32_t SlabDepth = 32;	// Slices fetched per step
+	static const uint32_t VoxModelSize = 256;
+
+protected:
+	bool exportRaw(std::ostream& stream, const VoxelSliceSource& source, uint32_t numThreads);
+	bool exportGzip(std::ostream& stream, const VoxelSliceSource& source, uint32_t numThreads);
+	bool exportVox(std::ostream& stream, const VoxelSliceSource& source, uint32_t numThreads);
+
+	uint64_t m_fileSize;
+	uint32_t m_numModels;
+};
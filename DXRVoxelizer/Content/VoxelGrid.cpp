@@ -0,0 +1,368 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "Morton.h"
+#include "VoxelGrid.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define VOXEL_GRID_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define VOXEL_GRID_USE_SSE2 0
+#endif
+
+using namespace std;
+
+atomic<uint64_t> VoxelGrid::s_generation(0);
+
+const uint64_t VoxelGrid::MaxVoxels = PTRDIFF_MAX;
+
+VoxelGrid::VoxelGrid() :
+	m_memory(MemoryRegistry::DENSE_GRID),
+	m_width(0),
+	m_height(0),
+	m_depth(0),
+	m_layout(LINEAR),
+	m_generation(0)
+{
+}
+
+VoxelGrid::VoxelGrid(const VoxelGrid& grid) :
+	m_data(grid.m_data),
+	m_memory(grid.m_memory),
+	m_width(grid.m_width),
+	m_height(grid.m_height),
+	m_depth(grid.m_depth),
+	m_layout(grid.m_layout),
+	m_generation(0)
+{
+}
+
+VoxelGrid::~VoxelGrid()
+{
+}
+
+VoxelGrid& VoxelGrid::operator=(const VoxelGrid& grid)
+{
+	if (this == &grid) return *this;
+
+	m_data = grid.m_data;
+	m_memory = grid.m_memory;
+	m_width = grid.m_width;
+	m_height = grid.m_height;
+	m_depth = grid.m_depth;
+	m_layout = grid.m_layout;
+	modify();
+
+	return *this;
+}
+
+bool VoxelGrid::Create(uint32_t width, uint32_t height, uint32_t depth, Layout layout)
+{
+	if (!width || !height || !depth) return false;
+	if (static_cast<uint64_t>(width) * height > MaxVoxels / depth) return false;
+	if (layout == MORTON && !IsMortonCompatible(width, height, depth)) return false;
+
+	m_width = width;
+	m_height = height;
+	m_depth = depth;
+	m_layout = layout;
+	m_data.assign(static_cast<size_t>(width) * height * depth, 0);
+	m_memory.Set(m_data.capacity());
+	modify();
+
+	return true;
+}
+
+bool VoxelGrid::SetLayout(Layout layout)
+{
+	if (layout == m_layout) return true;
+	if (layout == MORTON && !IsMortonCompatible(m_width, m_height, m_depth)) return false;
+
+	vector<uint8_t> data(m_data.size());
+	if (layout == MORTON) LinearToMorton(data.data(), m_data.data(), m_width);
+	else MortonToLinear(data.data(), m_data.data(), m_width);
+	m_data.swap(data);
+	m_layout = layout;
+	modify();
+
+	return true;
+}
+
+void VoxelGrid::Clear(uint8_t value)
+{
+	fill(m_data.begin(), m_data.end(), value);
+	modify();
+}
+
+uint8_t VoxelGrid::Get(uint32_t x, uint32_t y, uint32_t z) const
+{
+	return m_data[GetIndex(x, y, z)];
+}
+
+void VoxelGrid::Set(uint32_t x, uint32_t y, uint32_t z, uint8_t value)
+{
+	m_data[GetIndex(x, y, z)] = value;
+	modify();
+}
+
+float VoxelGrid::Sample(float u, float v, float w) const
+{
+	// Texel centers are at (i + 0.5) / n
+	const auto fx = u * m_width - 0.5f;
+	const auto fy = v * m_height - 0.5f;
+	const auto fz = w * m_depth - 0.5f;
+	const auto flx = floorf(fx), fly = floorf(fy), flz = floorf(fz);
+	const auto tx = fx - flx, ty = fy - fly, tz = fz - flz;
+
+	const auto clampi = [](float f, uint32_t n) { return static_cast<uint32_t>((min)((max)(f, 0.0f), n - 1.0f)); };
+	const auto x0 = clampi(flx, m_width), x1 = clampi(flx + 1.0f, m_width);
+	const auto y0 = clampi(fly, m_height), y1 = clampi(fly + 1.0f, m_height);
+	const auto z0 = clampi(flz, m_depth), z1 = clampi(flz + 1.0f, m_depth);
+
+	size_t i000, i100, i010, i110, i001, i101, i011, i111;
+	if (m_layout == MORTON)
+	{
+		// Encode each axis once and combine the partial codes
+		const uint32_t mx[] = { Morton::Part1By2(x0), Morton::Part1By2(x1) };
+		const uint32_t my[] = { Morton::Part1By2(y0) << 1, Morton::Part1By2(y1) << 1 };
+		const uint32_t mz[] = { Morton::Part1By2(z0) << 2, Morton::Part1By2(z1) << 2 };
+		i000 = mx[0] | my[0] | mz[0];
+		i100 = mx[1] | my[0] | mz[0];
+		i010 = mx[0] | my[1] | mz[0];
+		i110 = mx[1] | my[1] | mz[0];
+		i001 = mx[0] | my[0] | mz[1];
+		i101 = mx[1] | my[0] | mz[1];
+		i011 = mx[0] | my[1] | mz[1];
+		i111 = mx[1] | my[1] | mz[1];
+	}
+	else
+	{
+		const size_t slice = static_cast<size_t>(m_width) * m_height;
+		const size_t r00 = slice * z0 + static_cast<size_t>(m_width) * y0;
+		const size_t r10 = slice * z0 + static_cast<size_t>(m_width) * y1;
+		const size_t r01 = slice * z1 + static_cast<size_t>(m_width) * y0;
+		const size_t r11 = slice * z1 + static_cast<size_t>(m_width) * y1;
+		i000 = r00 + x0;
+		i100 = r00 + x1;
+		i010 = r10 + x0;
+		i110 = r10 + x1;
+		i001 = r01 + x0;
+		i101 = r01 + x1;
+		i011 = r11 + x0;
+		i111 = r11 + x1;
+	}
+
+	const auto pData = m_data.data();
+	const auto c00 = pData[i000] + (pData[i100] - pData[i000]) * tx;
+	const auto c10 = pData[i010] + (pData[i110] - pData[i010]) * tx;
+	const auto c01 = pData[i001] + (pData[i101] - pData[i001]) * tx;
+	const auto c11 = pData[i011] + (pData[i111] - pData[i011]) * tx;
+	const auto c0 = c00 + (c10 - c00) * ty;
+	const auto c1 = c01 + (c11 - c01) * ty;
+
+	return (c0 + (c1 - c0) * tz) / 255.0f;
+}
+
+size_t VoxelGrid::GetIndex(uint32_t x, uint32_t y, uint32_t z) const
+{
+	return m_layout == MORTON ? Morton::Encode(x, y, z) :
+		(static_cast<size_t>(m_height) * z + y) * m_width + x;
+}
+
+uint32_t VoxelGrid::GetWidth() const
+{
+	return m_width;
+}
+
+uint32_t VoxelGrid::GetHeight() const
+{
+	return m_height;
+}
+
+uint32_t VoxelGrid::GetDepth() const
+{
+	return m_depth;
+}
+
+VoxelGrid::Layout VoxelGrid::GetLayout() const
+{
+	return m_layout;
+}
+
+size_t VoxelGrid::GetNumVoxels() const
+{
+	return m_data.size();
+}
+
+uint8_t* VoxelGrid::GetData()
+{
+	modify();
+
+	return m_data.data();
+}
+
+const uint8_t* VoxelGrid::GetData() const
+{
+	return m_data.data();
+}
+
+uint64_t VoxelGrid::GetGeneration() const
+{
+	auto generation = m_generation.load(memory_order_relaxed);
+	if (generation) return generation;
+
+	// Concurrent readers agree on the first stamp
+	const auto next = s_generation.fetch_add(1, memory_order_relaxed) + 1;
+
+	return m_generation.compare_exchange_strong(generation, next, memory_order_relaxed) ? next : generation;
+}
+
+void VoxelGrid::modify()
+{
+	// Loads first, so that the parallel Set calls of a voxelization share the cache line
+	if (m_generation.load(memory_order_relaxed)) m_generation.store(0, memory_order_relaxed);
+}
+
+bool VoxelGrid::IsMortonCompatible(uint32_t width, uint32_t height, uint32_t depth)
+{
+	return width == height && width == depth && width <= 1024 && width && !(width & (width - 1));
+}
+
+//--------------------------------------------------------------------------------------
+// The kernels work on 2x2x2 cells, which are 8 contiguous bytes in Morton order.
+// Four 16-byte rows at (y, z), (y + 1, z), (y, z + 1) and (y + 1, z + 1) hold 8 cells;
+// two rounds of unpacking interleave them into cell order, and since cells 2i and
+// 2i + 1 are adjacent in Morton order, they leave as 16-byte stores.
+//--------------------------------------------------------------------------------------
+void VoxelGrid::LinearToMorton(uint8_t* pDst, const uint8_t* pSrc, uint32_t size)
+{
+#if VOXEL_GRID_USE_SSE2
+	if (size < 16) return linearToMortonScalar(pDst, pSrc, size);
+
+	const size_t pitch = size;
+	const size_t slicePitch = pitch * size;
+	for (auto z = 0u; z < size; z += 2)
+	{
+		for (auto y = 0u; y < size; y += 2)
+		{
+			const auto pRow = &pSrc[slicePitch * z + pitch * y];
+			const auto myz = Morton::Encode(0, y >> 1, z >> 1);
+			for (auto x = 0u; x < size; x += 16)
+			{
+				const auto r00 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&pRow[x]));
+				const auto r10 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&pRow[x + pitch]));
+				const auto r01 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&pRow[x + slicePitch]));
+				const auto r11 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&pRow[x + slicePitch + pitch]));
+
+				// 2x2 quads of the z and z + 1 planes
+				const auto q0lo = _mm_unpacklo_epi16(r00, r10);
+				const auto q0hi = _mm_unpackhi_epi16(r00, r10);
+				const auto q1lo = _mm_unpacklo_epi16(r01, r11);
+				const auto q1hi = _mm_unpackhi_epi16(r01, r11);
+
+				// Cells (x >> 1) + 0, ..., 7
+				const __m128i cells[] =
+				{
+					_mm_unpacklo_epi32(q0lo, q1lo),
+					_mm_unpackhi_epi32(q0lo, q1lo),
+					_mm_unpacklo_epi32(q0hi, q1hi),
+					_mm_unpackhi_epi32(q0hi, q1hi)
+				};
+
+				const auto cx = x >> 1;
+				for (uint8_t i = 0; i < 4; ++i)
+				{
+					const auto code = myz | Morton::Part1By2(cx + 2 * i);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(&pDst[static_cast<size_t>(code) * 8]), cells[i]);
+				}
+			}
+		}
+	}
+#else
+	linearToMortonScalar(pDst, pSrc, size);
+#endif
+}
+
+void VoxelGrid::MortonToLinear(uint8_t* pDst, const uint8_t* pSrc, uint32_t size)
+{
+#if VOXEL_GRID_USE_SSE2
+	if (size < 16) return mortonToLinearScalar(pDst, pSrc, size);
+
+	const size_t pitch = size;
+	const size_t slicePitch = pitch * size;
+	for (auto z = 0u; z < size; z += 2)
+	{
+		for (auto y = 0u; y < size; y += 2)
+		{
+			const auto pRow = &pDst[slicePitch * z + pitch * y];
+			const auto myz = Morton::Encode(0, y >> 1, z >> 1);
+			for (auto x = 0u; x < size; x += 16)
+			{
+				const auto cx = x >> 1;
+				__m128i cells[4];
+				for (uint8_t i = 0; i < 4; ++i)
+				{
+					const auto code = myz | Morton::Part1By2(cx + 2 * i);
+					cells[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&pSrc[static_cast<size_t>(code) * 8]));
+				}
+
+				// Split the cells back into the 2x2 quads of the z and z + 1 planes
+				const auto c0 = _mm_shuffle_epi32(cells[0], _MM_SHUFFLE(3, 1, 2, 0));
+				const auto c1 = _mm_shuffle_epi32(cells[1], _MM_SHUFFLE(3, 1, 2, 0));
+				const auto c2 = _mm_shuffle_epi32(cells[2], _MM_SHUFFLE(3, 1, 2, 0));
+				const auto c3 = _mm_shuffle_epi32(cells[3], _MM_SHUFFLE(3, 1, 2, 0));
+				const __m128i quads[] =
+				{
+					_mm_unpacklo_epi64(c0, c1),	// q0lo
+					_mm_unpacklo_epi64(c2, c3),	// q0hi
+					_mm_unpackhi_epi64(c0, c1),	// q1lo
+					_mm_unpackhi_epi64(c2, c3)	// q1hi
+				};
+
+				// De-interleave the 16-bit pairs of rows y and y + 1
+				__m128i rows[4];
+				for (uint8_t i = 0; i < 4; ++i)
+				{
+					auto q = _mm_shufflelo_epi16(quads[i], _MM_SHUFFLE(3, 1, 2, 0));
+					q = _mm_shufflehi_epi16(q, _MM_SHUFFLE(3, 1, 2, 0));
+					rows[i] = _mm_shuffle_epi32(q, _MM_SHUFFLE(3, 1, 2, 0));
+				}
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(&pRow[x]), _mm_unpacklo_epi64(rows[0], rows[1]));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(&pRow[x + pitch]), _mm_unpackhi_epi64(rows[0], rows[1]));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(&pRow[x + slicePitch]), _mm_unpacklo_epi64(rows[2], rows[3]));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(&pRow[x + slicePitch + pitch]), _mm_unpackhi_epi64(rows[2], rows[3]));
+			}
+		}
+	}
+#else
+	mortonToLinearScalar(pDst, pSrc, size);
+#endif
+}
+
+void VoxelGrid::linearToMortonScalar(uint8_t* pDst, const uint8_t* pSrc, uint32_t size)
+{
+	for (auto z = 0u; z < size; ++z)
+		for (auto y = 0u; y < size; ++y)
+		{
+			const auto myz = Morton::Encode(0, y, z);
+			const auto pRow = &pSrc[(static_cast<size_t>(size) * z + y) * size];
+			for (auto x = 0u; x < size; ++x) pDst[myz | Morton::Part1By2(x)] = pRow[x];
+		}
+}
+
+void VoxelGrid::mortonToLinearScalar(uint8_t* pDst, const uint8_t* pSrc, uint32_t size)
+{
+	for (auto z = 0u; z < size; ++z)
+		for (auto y = 0u; y < size; ++y)
+		{
+			const auto myz = Morton::Encode(0, y, z);
+			const auto pRow = &pDst[(static_cast<size_t>(size) * z + y) * size];
+			for (auto x = 0u; x < size; ++x) pRow[x] = pSrc[myz | Morton::Part1By2(x)];
+		}
+}
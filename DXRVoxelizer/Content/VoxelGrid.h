@@ -0,0 +1,84 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MemoryRegistry.h"
+
+//--------------------------------------------------------------------------------------
+// CPU-side dense voxel grid with 8-bit density (the alpha channel of the GPU grid).
+// The storage is either linear X-major or Morton (Z-curve) ordered; the latter
+// requires a cubic power-of-two extent of at most 1024.
+//--------------------------------------------------------------------------------------
+class VoxelGrid
+{
+public:
+	enum Layout : uint8_t
+	{
+		LINEAR,
+		MORTON
+	};
+
+	VoxelGrid();
+	VoxelGrid(const VoxelGrid& grid);
+	virtual ~VoxelGrid();
+
+	VoxelGrid& operator=(const VoxelGrid& grid);
+
+	bool Create(uint32_t width, uint32_t height, uint32_t depth, Layout layout = LINEAR);
+	bool SetLayout(Layout layout);
+	void Clear(uint8_t value = 0);
+
+	uint8_t Get(uint32_t x, uint32_t y, uint32_t z) const;
+	void Set(uint32_t x, uint32_t y, uint32_t z, uint8_t value);
+
+	// Trilinear filtering in normalized texture space with clamp addressing,
+	// equivalent to SampleLevel(LINEAR_CLAMP, tex, 0).w on the GPU grid
+	float Sample(float u, float v, float w) const;
+
+	size_t GetIndex(uint32_t x, uint32_t y, uint32_t z) const;
+	uint32_t GetWidth() const;
+	uint32_t GetHeight() const;
+	uint32_t GetDepth() const;
+	Layout GetLayout() const;
+	size_t GetNumVoxels() const;
+	uint8_t* GetData();
+	const uint8_t* GetData() const;
+
+	// Differs from any earlier one of any grid once the grid is modified, so that data
+	// derived from it can tell whether it is stale. Writes through a pointer of GetData()
+	// count as of the call, so the pointer must be fetched again after this is read.
+	uint64_t GetGeneration() const;
+
+	static bool IsMortonCompatible(uint32_t width, uint32_t height, uint32_t depth);
+
+	static const uint64_t MaxVoxels;	// That Create can allocate and size_t can index
+
+	// Transposition kernels between the layouts for a cubic grid of the given size
+	static void LinearToMorton(uint8_t* pDst, const uint8_t* pSrc, uint32_t size);
+	static void MortonToLinear(uint8_t* pDst, const uint8_t* pSrc, uint32_t size);
+
+protected:
+	static void linearToMortonScalar(uint8_t* pDst, const uint8_t* pSrc, uint32_t size);
+	static void mortonToLinearScalar(uint8_t* pDst, const uint8_t* pSrc, uint32_t size);
+
+	void modify();
+
+	std::vector<uint8_t> m_data;
+	MemoryRegistry::Allocation m_memory;
+
+	uint32_t	m_width;
+	uint32_t	m_height;
+	uint32_t	m_depth;
+	Layout		m_layout;
+
+	// 0 once modified, until GetGeneration takes the next of s_generation; a modification
+	// only stores, so that concurrent Set calls do not contend
+	mutable std::atomic<uint64_t> m_generation;
+	static std::atomic<uint64_t> s_generation;
+};
@@ -0,0 +1,401 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include "LZCodec.h"
+#include "Morton.h"
+#include "ParallelFor.h"
+#include "Profiler.h"
+#include "RLEGrid.h"
+#include "VoxelGrid.h"
+#include "VoxelGridIO.h"
+
+using namespace std;
+using namespace VoxelGridFile;
+
+namespace
+{
+	// In 64 bits, as the sum wraps for sizes near 2^32
+	inline uint64_t getNumChunks(uint32_t size)
+	{
+		return (static_cast<uint64_t>(size) + ChunkSize - 1) / ChunkSize;
+	}
+}
+
+//--------------------------------------------------------------------------------------
+// Writer
+//--------------------------------------------------------------------------------------
+
+VoxelGridWriter::VoxelGridWriter() :
+	m_fileSize(0),
+	m_numUniformChunks(0),
+	m_bound()
+{
+}
+
+VoxelGridWriter::~VoxelGridWriter()
+{
+}
+
+bool VoxelGridWriter::Write(const char* fileName, uint32_t width, uint32_t height, uint32_t depth,
+	const ChunkSource& source, uint32_t numThreads)
+{
+	PROFILE_ZONE("voxel grid write");
+	if (!width || !height || !depth || !source) return false;
+
+	Header header = {};
+	header.FourCC = FourCC;
+	header.Version = Version;
+	header.Width = width;
+	header.Height = height;
+	header.Depth = depth;
+	header.ChunkSize = ChunkSize;
+	header.NumChunks[0] = static_cast<uint32_t>(getNumChunks(width));
+	header.NumChunks[1] = static_cast<uint32_t>(getNumChunks(height));
+	header.NumChunks[2] = static_cast<uint32_t>(getNumChunks(depth));
+	header.IndexOffset = sizeof(Header);
+	memcpy(header.Bound, m_bound, sizeof(m_bound));
+
+	const auto numChunksPerSlab = header.NumChunks[0] * header.NumChunks[1];
+	vector<ChunkEntry> index(static_cast<size_t>(numChunksPerSlab) * header.NumChunks[2]);
+
+	ofstream file(fileName, ios::binary | ios::trunc);
+	if (!file) return false;
+
+	// Reserve the header and the index, which are known only at the end
+	const auto dataOffset = header.IndexOffset + sizeof(ChunkEntry) * index.size();
+	file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	file.write(reinterpret_cast<const char*>(index.data()), sizeof(ChunkEntry) * index.size());
+
+	const auto maxChunkSize = LZCodec::GetMaxCompressedSize(ChunkVoxels);
+	vector<vector<uint8_t>> slab(numChunksPerSlab);
+	auto offset = dataOffset;
+	m_numUniformChunks = 0;
+	for (auto cz = 0u; cz < header.NumChunks[2]; ++cz)
+	{
+		const auto pEntries = &index[static_cast<size_t>(numChunksPerSlab) * cz];
+		ParallelFor(0, numChunksPerSlab, numThreads, [&](uint32_t i)
+		{
+			vector<uint8_t> chunk(ChunkVoxels);
+			source(i % header.NumChunks[0], i / header.NumChunks[0], cz, chunk.data());
+
+			auto& entry = pEntries[i];
+			auto& data = slab[i];
+			entry.Value = chunk[0];
+			if (memcmp(chunk.data(), chunk.data() + 1, ChunkVoxels - 1) == 0)
+			{
+				entry.Encoding = UNIFORM;
+				data.clear();
+				return;
+			}
+
+			data.resize(maxChunkSize);
+			const auto size = LZCodec::Compress(chunk.data(), ChunkVoxels, data.data(), data.size());
+			if (size && size < ChunkVoxels)
+			{
+				entry.Encoding = LZ;
+				data.resize(size);
+			}
+			else
+			{
+				entry.Encoding = RAW;
+				data.swap(chunk);
+			}
+		});
+
+		// Stream the slab out in order
+		for (auto i = 0u; i < numChunksPerSlab; ++i)
+		{
+			auto& entry = pEntries[i];
+			const auto& data = slab[i];
+			entry.Offset = offset;
+			entry.Size = static_cast<uint32_t>(data.size());
+			if (entry.Encoding == UNIFORM) ++m_numUniformChunks;
+			else file.write(reinterpret_cast<const char*>(data.data()), data.size());
+			offset += data.size();
+		}
+		if (!file) return false;
+	}
+
+	header.DataSize = offset - dataOffset;
+	file.seekp(0);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	file.write(reinterpret_cast<const char*>(index.data()), sizeof(ChunkEntry) * index.size());
+	file.close();
+	m_fileSize = offset;
+
+	return !file.fail();
+}
+
+bool VoxelGridWriter::Write(const char* fileName, const VoxelGrid& grid, uint32_t numThreads)
+{
+	const auto width = grid.GetWidth();
+	const auto height = grid.GetHeight();
+	const auto depth = grid.GetDepth();
+
+	// An aligned chunk of a Morton grid is a contiguous block in Morton order
+	const auto isMortonChunk = grid.GetLayout() == VoxelGrid::MORTON && width >= ChunkSize;
+
+	return Write(fileName, width, height, depth, [&](uint32_t cx, uint32_t cy, uint32_t cz, uint8_t* pChunk)
+	{
+		const auto x0 = cx * ChunkSize, y0 = cy * ChunkSize, z0 = cz * ChunkSize;
+		if (isMortonChunk)
+		{
+			const auto pSrc = &grid.GetData()[Morton::Encode(x0, y0, z0)];
+			VoxelGrid::MortonToLinear(pChunk, pSrc, ChunkSize);
+			return;
+		}
+
+		const auto w = (min)(ChunkSize, width - x0);
+		const auto h = (min)(ChunkSize, height - y0);
+		const auto d = (min)(ChunkSize, depth - z0);
+		for (auto z = 0u; z < d; ++z)
+		{
+			for (auto y = 0u; y < h; ++y)
+			{
+				const auto pDst = &pChunk[ChunkSize * (ChunkSize * z + y)];
+				if (grid.GetLayout() == VoxelGrid::LINEAR)
+					memcpy(pDst, &grid.GetData()[grid.GetIndex(x0, y0 + y, z0 + z)], w);
+				else for (auto x = 0u; x < w; ++x) pDst[x] = grid.Get(x0 + x, y0 + y, z0 + z);
+			}
+		}
+	}, numThreads);
+}
+
+bool VoxelGridWriter::Write(const char* fileName, const RLEGrid& grid, uint32_t numThreads)
+{
+	const auto width = grid.GetWidth();
+	const auto height = grid.GetHeight();
+	const auto depth = grid.GetDepth();
+
+	return Write(fileName, width, height, depth, [&](uint32_t cx, uint32_t cy, uint32_t cz, uint8_t* pChunk)
+	{
+		const auto x0 = cx * ChunkSize, y0 = cy * ChunkSize, z0 = cz * ChunkSize;
+		const auto x1 = (min)(x0 + ChunkSize, width);
+		const auto h = (min)(ChunkSize, height - y0);
+		const auto d = (min)(ChunkSize, depth - z0);
+		for (auto z = 0u; z < d; ++z)
+		{
+			for (auto y = 0u; y < h; ++y)
+			{
+				uint32_t numRuns;
+				const auto pRuns = grid.GetRuns(y0 + y, z0 + z, numRuns);
+				const auto pDst = &pChunk[ChunkSize * (ChunkSize * z + y)];
+				for (auto i = 0u; i < numRuns; ++i)
+				{
+					const auto begin = (max)(static_cast<uint32_t>(pRuns[i].Begin), x0);
+					const auto end = (min)(static_cast<uint32_t>(pRuns[i].End), x1);
+					if (begin < end) memset(&pDst[begin - x0], 0xff, end - begin);
+				}
+			}
+		}
+	}, numThreads);
+}
+
+void VoxelGridWriter::SetBound(const float bound[4])
+{
+	memcpy(m_bound, bound, sizeof(m_bound));
+}
+
+uint64_t VoxelGridWriter::GetFileSize() const
+{
+	return m_fileSize;
+}
+
+uint32_t VoxelGridWriter::GetNumUniformChunks() const
+{
+	return m_numUniformChunks;
+}
+
+//--------------------------------------------------------------------------------------
+// Reader
+//--------------------------------------------------------------------------------------
+
+VoxelGridReader::VoxelGridReader() :
+	m_header(),
+	m_pIndex(nullptr)
+{
+}
+
+VoxelGridReader::~VoxelGridReader()
+{
+}
+
+bool VoxelGridReader::Open(const char* fileName)
+{
+	Close();
+	if (!m_file.Open(fileName)) return false;
+
+	// Validate everything once, so that chunk reads only need to check the codec
+	const auto pData = m_file.GetData();
+	const auto fileSize = m_file.GetSize();
+	if (fileSize < sizeof(Header))
+	{
+		Close();
+		return false;
+	}
+	memcpy(&m_header, pData, sizeof(Header));
+
+	const auto& h = m_header;
+	const auto numChunks = static_cast<uint64_t>(h.NumChunks[0]) * h.NumChunks[1] * h.NumChunks[2];
+	auto isValid = h.FourCC == FourCC && h.Version == Version && h.ChunkSize == ChunkSize &&
+		h.Width && h.Height && h.Depth && static_cast<uint64_t>(h.Width) * h.Height <= VoxelGrid::MaxVoxels / h.Depth &&
+		h.NumChunks[0] == getNumChunks(h.Width) && h.NumChunks[1] == getNumChunks(h.Height) &&
+		h.NumChunks[2] == getNumChunks(h.Depth) && numChunks && numChunks <= UINT32_MAX &&
+		h.IndexOffset % alignof(ChunkEntry) == 0 && h.IndexOffset <= fileSize &&
+		numChunks <= (fileSize - h.IndexOffset) / sizeof(ChunkEntry);
+
+	if (isValid)
+	{
+		m_pIndex = reinterpret_cast<const ChunkEntry*>(pData + h.IndexOffset);
+		for (uint64_t i = 0; i < numChunks && isValid; ++i)
+		{
+			const auto& entry = m_pIndex[i];
+			isValid = entry.Encoding <= UNIFORM && entry.Offset <= fileSize && entry.Size <= fileSize - entry.Offset &&
+				(entry.Encoding != RAW || entry.Size == ChunkVoxels);
+		}
+	}
+
+	if (!isValid)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void VoxelGridReader::Close()
+{
+	m_file.Close();
+	m_header = {};
+	m_pIndex = nullptr;
+}
+
+bool VoxelGridReader::ReadChunk(uint32_t cx, uint32_t cy, uint32_t cz, uint8_t* pChunk) const
+{
+	if (!m_pIndex || cx >= GetNumChunksX() || cy >= GetNumChunksY() || cz >= GetNumChunksZ()) return false;
+
+	const auto& entry = m_pIndex[getChunkIndex(cx, cy, cz)];
+	const auto pData = m_file.GetData() + entry.Offset;
+	switch (entry.Encoding)
+	{
+	case UNIFORM:
+		memset(pChunk, entry.Value, ChunkVoxels);
+		return true;
+	case RAW:
+		memcpy(pChunk, pData, ChunkVoxels);
+		return true;
+	default:
+		return LZCodec::Decompress(pData, entry.Size, pChunk, ChunkVoxels);
+	}
+}
+
+bool VoxelGridReader::Read(VoxelGrid& grid, uint32_t numThreads) const
+{
+	if (!m_pIndex) return false;
+
+	const auto width = GetWidth();
+	const auto height = GetHeight();
+	const auto depth = GetDepth();
+	const auto layout = VoxelGrid::IsMortonCompatible(width, height, depth) ? grid.GetLayout() : VoxelGrid::LINEAR;
+	if (!grid.Create(width, height, depth, layout)) return false;
+
+	const auto isMortonChunk = layout == VoxelGrid::MORTON && width >= ChunkSize;
+	atomic<bool> isSucceeded(true);
+	ParallelFor(0, GetNumChunks(), numThreads, [&](uint32_t i)
+	{
+		const auto cx = i % GetNumChunksX();
+		const auto cy = i / GetNumChunksX() % GetNumChunksY();
+		const auto cz = i / GetNumChunksX() / GetNumChunksY();
+		const auto x0 = cx * ChunkSize, y0 = cy * ChunkSize, z0 = cz * ChunkSize;
+
+		// The grid is created cleared
+		const auto& entry = m_pIndex[i];
+		if (entry.Encoding == UNIFORM && entry.Value == 0) return;
+
+		vector<uint8_t> chunk(ChunkVoxels);
+		if (!ReadChunk(cx, cy, cz, chunk.data()))
+		{
+			isSucceeded = false;
+			return;
+		}
+
+		if (isMortonChunk)
+		{
+			VoxelGrid::LinearToMorton(&grid.GetData()[Morton::Encode(x0, y0, z0)], chunk.data(), ChunkSize);
+			return;
+		}
+
+		const auto w = (min)(ChunkSize, width - x0);
+		const auto h = (min)(ChunkSize, height - y0);
+		const auto d = (min)(ChunkSize, depth - z0);
+		for (auto z = 0u; z < d; ++z)
+		{
+			for (auto y = 0u; y < h; ++y)
+			{
+				const auto pSrc = &chunk[ChunkSize * (ChunkSize * z + y)];
+				if (layout == VoxelGrid::LINEAR)
+					memcpy(&grid.GetData()[grid.GetIndex(x0, y0 + y, z0 + z)], pSrc, w);
+				else for (auto x = 0u; x < w; ++x) grid.Set(x0 + x, y0 + y, z0 + z, pSrc[x]);
+			}
+		}
+	});
+
+	return isSucceeded;
+}
+
+const ChunkEntry& VoxelGridReader::GetChunkEntry(uint32_t cx, uint32_t cy, uint32_t cz) const
+{
+	return m_pIndex[getChunkIndex(cx, cy, cz)];
+}
+
+const float* VoxelGridReader::GetBound() const
+{
+	return m_header.Bound;
+}
+
+uint32_t VoxelGridReader::GetWidth() const
+{
+	return m_header.Width;
+}
+
+uint32_t VoxelGridReader::GetHeight() const
+{
+	return m_header.Height;
+}
+
+uint32_t VoxelGridReader::GetDepth() const
+{
+	return m_header.Depth;
+}
+
+uint32_t VoxelGridReader::GetNumChunksX() const
+{
+	return m_header.NumChunks[0];
+}
+
+uint32_t VoxelGridReader::GetNumChunksY() const
+{
+	return m_header.NumChunks[1];
+}
+
+uint32_t VoxelGridReader::GetNumChunksZ() const
+{
+	return m_header.NumChunks[2];
+}
+
+uint32_t VoxelGridReader::GetNumChunks() const
+{
+	return GetNumChunksX() * GetNumChunksY() * GetNumChunksZ();
+}
+
+uint32_t VoxelGridReader::getChunkIndex(uint32_t cx, uint32_t cy, uint32_t cz) const
+{
+	return (GetNumChunksY() * cz + cy) * GetNumChunksX() + cx;
+}
@@ -0,0 +1,122 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <functional>
+#include "MappedFile.h"
+
+class RLEGrid;
+class VoxelGrid;
+
+//--------------------------------------------------------------------------------------
+// Chunked on-disk voxel grid: a header, an index of every chunk, then the chunks of
+// ChunkSize^3 voxels, each compressed independently with LZCodec. Chunks are ordered
+// x first, then y, then z; their voxels are X-major and padded with zeros at the
+// grid boundary. The header also carries the object-space bound the grid was
+// voxelized in (center xyz, half extent w), so that a consumer can place the grid
+// without the source mesh.
+//--------------------------------------------------------------------------------------
+namespace VoxelGridFile
+{
+	const uint32_t FourCC = 0x5a475856; // "VXGZ"
+	const uint32_t Version = 2;
+	const uint32_t ChunkSize = 32;
+	const uint32_t ChunkVoxels = ChunkSize * ChunkSize * ChunkSize;
+
+	enum Encoding : uint8_t
+	{
+		RAW,		// Stored, when LZ does not pay off
+		LZ,
+		UNIFORM		// Every voxel is Value, and no data is stored
+	};
+
+	struct Header
+	{
+		uint32_t FourCC;
+		uint32_t Version;
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t Depth;
+		uint32_t ChunkSize;
+		uint32_t NumChunks[3];
+		uint32_t Reserved;
+		uint64_t IndexOffset;
+		uint64_t DataSize;
+		float Bound[4];
+	};
+
+	struct ChunkEntry
+	{
+		uint64_t Offset;	// From the beginning of the file
+		uint32_t Size;		// Stored bytes
+		uint8_t Encoding;
+		uint8_t Value;
+		uint16_t Reserved;
+	};
+}
+
+//--------------------------------------------------------------------------------------
+// Compresses a slab of chunks at a time in parallel and streams it out, so the memory
+// footprint is bounded by one slab regardless of the source.
+//--------------------------------------------------------------------------------------
+class VoxelGridWriter
+{
+public:
+	// Fills the zero-initialized chunk at chunk coordinates (cx, cy, cz); may run concurrently
+	using ChunkSource = std::function<void(uint32_t cx, uint32_t cy, uint32_t cz, uint8_t* pChunk)>;
+
+	VoxelGridWriter();
+	virtual ~VoxelGridWriter();
+
+	bool Write(const char* fileName, uint32_t width, uint32_t height, uint32_t depth,
+		const ChunkSource& source, uint32_t numThreads = 0);
+	bool Write(const char* fileName, const VoxelGrid& grid, uint32_t numThreads = 0);
+	bool Write(const char* fileName, const RLEGrid& grid, uint32_t numThreads = 0);
+
+	// Bound stored in the header of the following writes
+	void SetBound(const float bound[4]);
+
+	uint64_t GetFileSize() const;
+	uint32_t GetNumUniformChunks() const;
+
+protected:
+	uint64_t m_fileSize;
+	uint32_t m_numUniformChunks;
+	float m_bound[4];
+};
+
+//--------------------------------------------------------------------------------------
+// Maps the file and decodes chunks on demand; ReadChunk is safe to call concurrently
+//--------------------------------------------------------------------------------------
+class VoxelGridReader
+{
+public:
+	VoxelGridReader();
+	virtual ~VoxelGridReader();
+
+	bool Open(const char* fileName);
+	void Close();
+
+	bool ReadChunk(uint32_t cx, uint32_t cy, uint32_t cz, uint8_t* pChunk) const;
+	bool Read(VoxelGrid& grid, uint32_t numThreads = 0) const;
+
+	const VoxelGridFile::ChunkEntry& GetChunkEntry(uint32_t cx, uint32_t cy, uint32_t cz) const;
+	const float* GetBound() const;
+	uint32_t GetWidth() const;
+	uint32_t GetHeight() const;
+	uint32_t GetDepth() const;
+	uint32_t GetNumChunksX() const;
+	uint32_t GetNumChunksY() const;
+	uint32_t GetNumChunksZ() const;
+	uint32_t GetNumChunks() const;
+
+protected:
+	uint32_t getChunkIndex(uint32_t cx, uint32_t cy, uint32_t cz) const;
+
+	MappedFile m_file;
+
+	VoxelGridFile::Header		m_header;
+	const VoxelGridFile::ChunkEntry* m_pIndex;
+};
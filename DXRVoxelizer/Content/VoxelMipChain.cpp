@@ -0,0 +1,181 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include "ParallelFor.h"
+#include "VoxelMipChain.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define MIP_CHAIN_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define MIP_CHAIN_USE_SSE2 0
+#endif
+
+using namespace std;
+
+VoxelMipChain::VoxelMipChain() :
+	m_pGrid(nullptr),
+	m_filter(BOX)
+{
+}
+
+VoxelMipChain::~VoxelMipChain()
+{
+}
+
+bool VoxelMipChain::Create(const VoxelGrid& grid, Filter filter, uint32_t numLevels, uint32_t numThreads)
+{
+	if (!grid.GetNumVoxels()) return false;
+
+	// Levels down to 1^3
+	auto maxLevels = 1u;
+	for (auto n = (max)(grid.GetWidth(), (max)(grid.GetHeight(), grid.GetDepth())); n > 1; n = (n + 1) / 2) ++maxLevels;
+	numLevels = numLevels ? (min)(numLevels, maxLevels) : maxLevels;
+
+	m_pGrid = &grid;
+	m_filter = filter;
+	m_levels.resize(numLevels - 1);
+
+	// The kernels read linear slices
+	VoxelGrid linearGrid;
+	const VoxelGrid* pSrc = &grid;
+	if (grid.GetLayout() != VoxelGrid::LINEAR)
+	{
+		linearGrid = grid;
+		linearGrid.SetLayout(VoxelGrid::LINEAR);
+		pSrc = &linearGrid;
+	}
+
+	for (auto& level : m_levels)
+	{
+		const auto width = pSrc->GetWidth(), height = pSrc->GetHeight(), depth = pSrc->GetDepth();
+		if (!level.Create((width + 1) / 2, (height + 1) / 2, (depth + 1) / 2)) return false;
+
+		const auto pDst = level.GetData();
+		const auto pSrcData = pSrc->GetData();
+		const auto slicePitch = static_cast<size_t>(level.GetWidth()) * level.GetHeight();
+		ParallelFor(0, level.GetDepth(), numThreads, [&](uint32_t z)
+		{
+			DownsampleSlice(&pDst[slicePitch * z], pSrcData, width, height, depth, z, filter);
+		});
+
+		pSrc = &level;
+	}
+
+	return true;
+}
+
+float VoxelMipChain::Sample(float u, float v, float w, float level) const
+{
+	const auto lastLevel = static_cast<float>(GetNumLevels() - 1);
+	level = (min)((max)(level, 0.0f), lastLevel);
+
+	const auto l0 = floorf(level);
+	const auto t = level - l0;
+	const auto s0 = GetLevel(static_cast<uint32_t>(l0)).Sample(u, v, w);
+
+	return t > 0.0f ? s0 + (GetLevel(static_cast<uint32_t>(l0) + 1).Sample(u, v, w) - s0) * t : s0;
+}
+
+const VoxelGrid& VoxelMipChain::GetLevel(uint32_t level) const
+{
+	return level ? m_levels[level - 1] : *m_pGrid;
+}
+
+uint32_t VoxelMipChain::GetNumLevels() const
+{
+	return m_pGrid ? static_cast<uint32_t>(m_levels.size()) + 1 : 0;
+}
+
+VoxelMipChain::Filter VoxelMipChain::GetFilter() const
+{
+	return m_filter;
+}
+
+size_t VoxelMipChain::GetNumBytes() const
+{
+	size_t numBytes = 0;
+	for (const auto& level : m_levels) numBytes += level.GetNumVoxels();
+
+	return numBytes;
+}
+
+//--------------------------------------------------------------------------------------
+// Each row of the smaller slice reduces four rows of the larger grid, at (2y, 2z),
+// (2y + 1, 2z), (2y, 2z + 1) and (2y + 1, 2z + 1), clamped to the last row and slice.
+// The kernel reduces 32 bytes of each row to 16: it first reduces the four rows, as
+// 16-bit sums for the box filter, then the even and odd bytes of the result.
+//--------------------------------------------------------------------------------------
+void VoxelMipChain::DownsampleSlice(uint8_t* pDst, const uint8_t* pSrc, uint32_t width, uint32_t height,
+	uint32_t depth, uint32_t z, Filter filter)
+{
+	const auto dstWidth = (width + 1) / 2;
+	const auto dstHeight = (height + 1) / 2;
+	const size_t pitch = width;
+	const size_t slicePitch = pitch * height;
+	const size_t z0 = 2 * z, z1 = (min)(2 * z + 1, depth - 1);
+
+	for (auto y = 0u; y < dstHeight; ++y)
+	{
+		const size_t y0 = 2 * y, y1 = (min)(2 * y + 1, height - 1);
+		const uint8_t* const pRows[] =
+		{
+			&pSrc[slicePitch * z0 + pitch * y0],
+			&pSrc[slicePitch * z0 + pitch * y1],
+			&pSrc[slicePitch * z1 + pitch * y0],
+			&pSrc[slicePitch * z1 + pitch * y1]
+		};
+		const auto pDstRow = &pDst[static_cast<size_t>(dstWidth) * y];
+
+		auto x = 0u;
+#if MIP_CHAIN_USE_SSE2
+		const auto lowBytes = _mm_set1_epi16(0x00ff);
+		for (; x + 16 <= width / 2; x += 16)
+		{
+			__m128i halves[2];
+			for (auto h = 0; h < 2; ++h)
+			{
+				__m128i r[4];
+				for (auto i = 0; i < 4; ++i)
+					r[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&pRows[i][2 * x + 16 * h]));
+
+				if (filter == MAX)
+				{
+					const auto m = _mm_max_epu8(_mm_max_epu8(r[0], r[1]), _mm_max_epu8(r[2], r[3]));
+					halves[h] = _mm_max_epi16(_mm_and_si128(m, lowBytes), _mm_srli_epi16(m, 8));
+				}
+				else
+				{
+					auto sum = _mm_set1_epi16(4);	// Rounds to nearest
+					for (auto i = 0; i < 4; ++i)
+						sum = _mm_add_epi16(sum, _mm_add_epi16(_mm_and_si128(r[i], lowBytes), _mm_srli_epi16(r[i], 8)));
+					halves[h] = _mm_srli_epi16(sum, 3);
+				}
+			}
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&pDstRow[x]), _mm_packus_epi16(halves[0], halves[1]));
+		}
+#endif
+		downsampleRowScalar(pDstRow, pRows, width, x, filter);
+	}
+}
+
+void VoxelMipChain::downsampleRowScalar(uint8_t* pDst, const uint8_t* const pRows[4], uint32_t width,
+	uint32_t xBegin, Filter filter)
+{
+	const auto dstWidth = (width + 1) / 2;
+	for (auto x = xBegin; x < dstWidth; ++x)
+	{
+		const auto x0 = 2 * x, x1 = (min)(2 * x + 1, width - 1);
+		auto value = 0u;
+		for (auto i = 0; i < 4; ++i)
+		{
+			const auto a = pRows[i][x0], b = pRows[i][x1];
+			value = filter == MAX ? (max)(value, static_cast<uint32_t>((max)(a, b))) : value + a + b;
+		}
+		pDst[x] = static_cast<uint8_t>(filter == MAX ? value : (value + 4) >> 3);
+	}
+}
@@ -0,0 +1,53 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "VoxelGrid.h"
+
+//--------------------------------------------------------------------------------------
+// Mip pyramid of a voxel grid, as the mip chain that g_txGrid of PSRayCast.hlsl would
+// have. Each level halves the extent of the previous one, rounding up, down to 1^3, and
+// reduces its 2x2x2 blocks by the average (a box filter, for shading) or the maximum (a
+// conservative bound, for occupancy); an odd last voxel is its own neighbor. Level 0 is
+// the grid itself, which is referenced rather than copied.
+//--------------------------------------------------------------------------------------
+class VoxelMipChain
+{
+public:
+	enum Filter : uint8_t
+	{
+		BOX,
+		MAX
+	};
+
+	VoxelMipChain();
+	virtual ~VoxelMipChain();
+
+	// numLevels includes level 0; 0 builds the full chain
+	bool Create(const VoxelGrid& grid, Filter filter = BOX, uint32_t numLevels = 0, uint32_t numThreads = 0);
+
+	// Trilinear filtering of the two levels around a fractional level, as
+	// SampleLevel(LINEAR_CLAMP, tex, level).w
+	float Sample(float u, float v, float w, float level) const;
+
+	const VoxelGrid& GetLevel(uint32_t level) const;
+	uint32_t GetNumLevels() const;
+	Filter GetFilter() const;
+	size_t GetNumBytes() const;	// Of the levels past 0
+
+	// One level from the previous one; pDst is (width + 1) / 2 x (height + 1) / 2 bytes
+	// for each slice z of the smaller grid, and reads slices 2z and 2z + 1 of pSrc
+	static void DownsampleSlice(uint8_t* pDst, const uint8_t* pSrc, uint32_t width, uint32_t height,
+		uint32_t depth, uint32_t z, Filter filter);
+
+protected:
+	static void downsampleRowScalar(uint8_t* pDst, const uint8_t* const pRows[4], uint32_t width,
+		uint32_t xBegin, Filter filter);
+
+	const VoxelGrid* m_pGrid;
+	std::vector<VoxelGrid> m_levels;	// Levels 1 and up
+
+	Filter		m_filter;
+};
@@ -0,0 +1,182 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+#include "ParallelFor.h"
+#include "RLEGrid.h"
+#include "VoxelGrid.h"
+#include "VoxelGridIO.h"
+#include "VoxelSliceSource.h"
+
+using namespace std;
+
+//--------------------------------------------------------------------------------------
+// Dense grid
+//--------------------------------------------------------------------------------------
+
+DenseSliceSource::DenseSliceSource(const VoxelGrid& grid) :
+	m_grid(grid)
+{
+}
+
+bool DenseSliceSource::GetSlices(uint32_t z, uint32_t numSlices, uint8_t* pDst, uint32_t numThreads) const
+{
+	if (!pDst || z + numSlices > GetDepth()) return false;
+
+	const auto width = GetWidth();
+	const auto height = GetHeight();
+	const auto sliceSize = GetSliceSize();
+	if (m_grid.GetLayout() == VoxelGrid::LINEAR)
+	{
+		memcpy(pDst, &m_grid.GetData()[m_grid.GetIndex(0, 0, z)], sliceSize * numSlices);
+
+		return true;
+	}
+
+	ParallelFor(0, numSlices, numThreads, [&](uint32_t i)
+	{
+		auto pSlice = &pDst[sliceSize * i];
+		for (auto y = 0u; y < height; ++y)
+			for (auto x = 0u; x < width; ++x) *pSlice++ = m_grid.Get(x, y, z + i);
+	});
+
+	return true;
+}
+
+uint32_t DenseSliceSource::GetWidth() const
+{
+	return m_grid.GetWidth();
+}
+
+uint32_t DenseSliceSource::GetHeight() const
+{
+	return m_grid.GetHeight();
+}
+
+uint32_t DenseSliceSource::GetDepth() const
+{
+	return m_grid.GetDepth();
+}
+
+//--------------------------------------------------------------------------------------
+// Run-length encoded grid
+//--------------------------------------------------------------------------------------
+
+RLESliceSource::RLESliceSource(const RLEGrid& grid, uint8_t value) :
+	m_grid(grid),
+	m_value(value)
+{
+}
+
+bool RLESliceSource::GetSlices(uint32_t z, uint32_t numSlices, uint8_t* pDst, uint32_t numThreads) const
+{
+	if (!pDst || z + numSlices > GetDepth()) return false;
+
+	const auto width = GetWidth();
+	const auto height = GetHeight();
+	const auto sliceSize = GetSliceSize();
+	ParallelFor(0, numSlices, numThreads, [&](uint32_t i)
+	{
+		const auto pSlice = &pDst[sliceSize * i];
+		memset(pSlice, 0, sliceSize);
+		for (auto y = 0u; y < height; ++y)
+		{
+			uint32_t numRuns;
+			const auto pRuns = m_grid.GetRuns(y, z + i, numRuns);
+			const auto pRow = &pSlice[static_cast<size_t>(width) * y];
+			for (auto j = 0u; j < numRuns; ++j)
+				memset(&pRow[pRuns[j].Begin], m_value, pRuns[j].End - pRuns[j].Begin);
+		}
+	});
+
+	return true;
+}
+
+uint32_t RLESliceSource::GetWidth() const
+{
+	return m_grid.GetWidth();
+}
+
+uint32_t RLESliceSource::GetHeight() const
+{
+	return m_grid.GetHeight();
+}
+
+uint32_t RLESliceSource::GetDepth() const
+{
+	return m_grid.GetDepth();
+}
+
+//--------------------------------------------------------------------------------------
+// Chunked file
+//--------------------------------------------------------------------------------------
+
+ChunkFileSliceSource::ChunkFileSliceSource(const VoxelGridReader& reader) :
+	m_reader(reader)
+{
+}
+
+bool ChunkFileSliceSource::GetSlices(uint32_t z, uint32_t numSlices, uint8_t* pDst, uint32_t numThreads) const
+{
+	using namespace VoxelGridFile;
+
+	if (!pDst || !numSlices || z + numSlices > GetDepth()) return false;
+
+	const auto width = GetWidth();
+	const auto height = GetHeight();
+	const auto sliceSize = GetSliceSize();
+	const auto numChunksX = m_reader.GetNumChunksX();
+	const auto numChunksXY = numChunksX * m_reader.GetNumChunksY();
+	const auto czBegin = z / ChunkSize;
+	const auto czEnd = (z + numSlices - 1) / ChunkSize + 1;
+
+	atomic<bool> isSucceeded(true);
+	ParallelFor(0, numChunksXY * (czEnd - czBegin), numThreads, [&](uint32_t i)
+	{
+		const auto cx = i % numChunksX;
+		const auto cy = i % numChunksXY / numChunksX;
+		const auto cz = czBegin + i / numChunksXY;
+
+		vector<uint8_t> chunk(ChunkVoxels);
+		if (!m_reader.ReadChunk(cx, cy, cz, chunk.data()))
+		{
+			isSucceeded = false;
+			return;
+		}
+
+		// Copy the rows within the requested slices
+		const auto x0 = cx * ChunkSize, y0 = cy * ChunkSize, z0 = cz * ChunkSize;
+		const auto w = (min)(ChunkSize, width - x0);
+		const auto h = (min)(ChunkSize, height - y0);
+		const auto zBegin = (max)(z0, z);
+		const auto zEnd = (min)(z0 + ChunkSize, z + numSlices);
+		for (auto k = zBegin; k < zEnd; ++k)
+		{
+			const auto pSlice = &pDst[sliceSize * (k - z)];
+			for (auto y = 0u; y < h; ++y)
+				memcpy(&pSlice[static_cast<size_t>(width) * (y0 + y) + x0],
+					&chunk[ChunkSize * (ChunkSize * (k - z0) + y)], w);
+		}
+	});
+
+	return isSucceeded;
+}
+
+uint32_t ChunkFileSliceSource::GetWidth() const
+{
+	return m_reader.GetWidth();
+}
+
+uint32_t ChunkFileSliceSource::GetHeight() const
+{
+	return m_reader.GetHeight();
+}
+
+uint32_t ChunkFileSliceSource::GetDepth() const
+{
+	return m_reader.GetDepth();
+}
@@ -0,0 +1,78 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class RLEGrid;
+class VoxelGrid;
+class VoxelGridReader;
+
+//--------------------------------------------------------------------------------------
+// Streams a voxel grid as z slices of X-major 8-bit voxels, so that consumers never
+// need a dense copy of the whole grid
+//--------------------------------------------------------------------------------------
+class VoxelSliceSource
+{
+public:
+	virtual ~VoxelSliceSource() {}
+
+	// Fills numSlices consecutive slices starting at z, using up to numThreads threads
+	virtual bool GetSlices(uint32_t z, uint32_t numSlices, uint8_t* pDst, uint32_t numThreads = 0) const = 0;
+
+	virtual uint32_t GetWidth() const = 0;
+	virtual uint32_t GetHeight() const = 0;
+	virtual uint32_t GetDepth() const = 0;
+
+	size_t GetSliceSize() const { return static_cast<size_t>(GetWidth()) * GetHeight(); }
+};
+
+class DenseSliceSource : public VoxelSliceSource
+{
+public:
+	DenseSliceSource(const VoxelGrid& grid);
+
+	bool GetSlices(uint32_t z, uint32_t numSlices, uint8_t* pDst, uint32_t numThreads = 0) const override;
+
+	uint32_t GetWidth() const override;
+	uint32_t GetHeight() const override;
+	uint32_t GetDepth() const override;
+
+protected:
+	const VoxelGrid& m_grid;
+};
+
+class RLESliceSource : public VoxelSliceSource
+{
+public:
+	RLESliceSource(const RLEGrid& grid, uint8_t value = 0xff);
+
+	bool GetSlices(uint32_t z, uint32_t numSlices, uint8_t* pDst, uint32_t numThreads = 0) const override;
+
+	uint32_t GetWidth() const override;
+	uint32_t GetHeight() const override;
+	uint32_t GetDepth() const override;
+
+protected:
+	const RLEGrid& m_grid;
+	uint8_t m_value;
+};
+
+// Decodes each chunk overlapped by the requested slices once
+class ChunkFileSliceSource : public VoxelSliceSource
+{
+public:
+	ChunkFileSliceSource(const VoxelGridReader& reader);
+
+	bool GetSlices(uint32_t z, uint32_t numSlices, uint8_t* pDst, uint32_t numThreads = 0) const override;
+
+	uint32_t GetWidth() const override;
+	uint32_t GetHeight() const override;
+	uint32_t GetDepth() const override;
+
+protected:
+	const VoxelGridReader& m_reader;
+};
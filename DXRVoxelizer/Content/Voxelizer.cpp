@@ -5,8 +5,6 @@
 #include "Optional/XUSGObjLoader.h"
 #include "Voxelizer.h"
 
-#define GRID_SIZE 64
-
 using namespace std;
 using namespace DirectX;
 using namespace XUSG;
@@ -18,6 +16,7 @@ const wchar_t* Voxelizer::ClosestHitShaderName = L"closestHitMain";
 const wchar_t* Voxelizer::MissShaderName = L"missMain";
 
 Voxelizer::Voxelizer() :
+	VoxelizerGPU(),
 	m_instances()
 {
 	m_shaderLib = ShaderLib::MakeUnique();
@@ -30,6 +29,20 @@ Voxelizer::~Voxelizer()
 bool Voxelizer::Init(RayTracing::CommandList* pCommandList, const XUSG::DescriptorTableLib::sptr& descriptorTableLib,
 	uint32_t width, uint32_t height, Format rtFormat, Format dsFormat, vector<Resource::uptr>& uploaders,
 	GeometryBuffer* pGeometry, const char* fileName, const XMFLOAT4& posScale)
+{
+	// Load inputs
+	ObjLoader objLoader;
+	if (!objLoader.Import(fileName, true, true)) return false;
+
+	return Init(pCommandList, descriptorTableLib, width, height, rtFormat, dsFormat, uploaders, pGeometry,
+		objLoader.GetVertices(), objLoader.GetNumVertices(), objLoader.GetVertexStride(),
+		objLoader.GetIndices(), objLoader.GetNumIndices(), posScale);
+}
+
+bool Voxelizer::Init(RayTracing::CommandList* pCommandList, const XUSG::DescriptorTableLib::sptr& descriptorTableLib,
+	uint32_t width, uint32_t height, Format rtFormat, Format dsFormat, vector<Resource::uptr>& uploaders,
+	GeometryBuffer* pGeometry, const uint8_t* pVertices, uint32_t numVertices, uint32_t stride,
+	const uint32_t* pIndices, uint32_t numIndices, const XMFLOAT4& posScale)
 {
 	const auto pDevice = pCommandList->GetRTDevice();
 	m_rayTracingPipelineLib = RayTracing::PipelineLib::MakeUnique(pDevice);
@@ -38,33 +51,10 @@ bool Voxelizer::Init(RayTracing::CommandList* pCommandList, const XUSG::Descript
 	m_pipelineLayoutLib = PipelineLayoutLib::MakeUnique(pDevice);
 	m_descriptorTableLib = descriptorTableLib;
 
-	m_viewport.x = static_cast<float>(width);
-	m_viewport.y = static_cast<float>(height);
-	m_posScale = posScale;
-
-	// Load inputs
-	ObjLoader objLoader;
-	if (!objLoader.Import(fileName, true, true)) return false;
-	XUSG_N_RETURN(createVB(pCommandList, objLoader.GetNumVertices(), objLoader.GetVertexStride(), objLoader.GetVertices(), uploaders), false);
-	XUSG_N_RETURN(createIB(pCommandList, objLoader.GetNumIndices(), objLoader.GetIndices(), uploaders), false);
-
-	// Extract boundary
-	const auto& aabb = objLoader.GetAABB();
-	const XMFLOAT3 ext(aabb.Max.x - aabb.Min.x, aabb.Max.y - aabb.Min.y, aabb.Max.z - aabb.Min.z);
-	m_bound.x = (aabb.Max.x + aabb.Min.x) / 2.0f;
-	m_bound.y = (aabb.Max.y + aabb.Min.y) / 2.0f;
-	m_bound.z = (aabb.Max.z + aabb.Min.z) / 2.0f;
-	m_bound.w = (max)(ext.x, (max)(ext.y, ext.z)) / 2.0f;
+	XUSG_N_RETURN(createVB(pCommandList, numVertices, stride, pVertices, uploaders), false);
+	XUSG_N_RETURN(createIB(pCommandList, numIndices, pIndices, uploaders), false);
 
-	XUSG_N_RETURN(createCB(pDevice), false);
-
-	// Create output grids and build acceleration structures
-	for (auto& grid : m_grids)
-	{
-		grid = Texture3D::MakeUnique();
-		XUSG_N_RETURN(grid->Create(pDevice, GRID_SIZE, GRID_SIZE, GRID_SIZE, Format::R10G10B10A2_UNORM,
-			ResourceFlag::ALLOW_UNORDERED_ACCESS), false);
-	}
+	XUSG_N_RETURN(createResources(pDevice, width, height, rtFormat, pVertices, numVertices, stride, posScale), false);
 
 	//m_depth = DepthStencil::MakeUnique();
 	//m_depth.Create(m_device, width, height, Format::D24_UNORM_S8_UINT, ResourceFlag::DENY_SHADER_RESOURCE);
@@ -78,38 +68,49 @@ bool Voxelizer::Init(RayTracing::CommandList* pCommandList, const XUSG::Descript
 	return buildShaderTables(pDevice);
 }
 
-void Voxelizer::UpdateFrame(uint8_t frameIndex, CXMVECTOR eyePt, CXMMATRIX viewProj)
+void Voxelizer::Render(RayTracing::CommandList* pCommandList, uint8_t frameIndex, RenderTarget* pRenderTarget)
 {
-	// General matrices
-	const auto world = XMMatrixScaling(m_bound.w, m_bound.w, m_bound.w) *
-		XMMatrixTranslation(m_bound.x, m_bound.y, m_bound.z) *
-		XMMatrixScaling(m_posScale.w, m_posScale.w, m_posScale.w) *
-		XMMatrixTranslation(m_posScale.x, m_posScale.y, m_posScale.z);
-	const auto worldI = XMMatrixInverse(nullptr, world);
-	const auto worldViewProj = world * viewProj;
-
-	// Screen space matrices
-	const auto pCbPerObject = reinterpret_cast<CBPerObject*>(m_cbPerObject->Map(frameIndex));
-	pCbPerObject->localSpaceLightPt = XMVector3TransformCoord(XMVectorSet(-10.0f, 45.0f, -75.0f, 0.0f), worldI);
-	pCbPerObject->localSpaceEyePt = XMVector3TransformCoord(eyePt, worldI);
-
-	const auto mToScreen = XMMATRIX
-	(
-		0.5f * m_viewport.x, 0.0f, 0.0f, 0.0f,
-		0.0f, -0.5f * m_viewport.y, 0.0f, 0.0f,
-		0.0f, 0.0f, 1.0f, 0.0f,
-		0.5f * m_viewport.x, 0.5f * m_viewport.y, 0.0f, 1.0f
-	);
-	const auto localToScreen = XMMatrixMultiply(worldViewProj, mToScreen);
-	const auto screenToLocal = XMMatrixInverse(nullptr, localToScreen);
-	pCbPerObject->screenToLocal = XMMatrixTranspose(screenToLocal);
+	Recorder recorder(this, pCommandList, frameIndex, pRenderTarget);
+	m_scheduler.Schedule(&recorder);
 }
 
-void Voxelizer::Render(RayTracing::CommandList* pCommandList, uint8_t frameIndex,
-	const Descriptor& rtv, const Descriptor& dsv)
+void Voxelizer::Voxelize(RayTracing::CommandList* pCommandList)
 {
-	voxelize(pCommandList, frameIndex);
-	renderRayCast(pCommandList, frameIndex, rtv, dsv);
+	voxelize(pCommandList);
+}
+
+void Voxelizer::RayCast(RayTracing::CommandList* pCommandList, uint8_t frameIndex)
+{
+	renderRayCast(pCommandList, frameIndex);
+}
+
+const char* Voxelizer::GetName() const
+{
+	return "XUSGCore";
+}
+
+Voxelizer::Recorder::Recorder(Voxelizer* pVoxelizer, RayTracing::CommandList* pCommandList,
+	uint8_t frameIndex, RenderTarget* pRenderTarget) :
+	m_pVoxelizer(pVoxelizer),
+	m_pCommandList(pCommandList),
+	m_frameIndex(frameIndex),
+	m_pRenderTarget(pRenderTarget)
+{
+}
+
+void Voxelizer::Recorder::Voxelize()
+{
+	m_pVoxelizer->voxelize(m_pCommandList);
+}
+
+void Voxelizer::Recorder::RayCast()
+{
+	m_pVoxelizer->renderRayCast(m_pCommandList, m_frameIndex);
+}
+
+void Voxelizer::Recorder::CopyImage()
+{
+	m_pVoxelizer->copyImage(m_pCommandList, m_pRenderTarget);
 }
 
 bool Voxelizer::createVB(RayTracing::CommandList* pCommandList, uint32_t numVert,
@@ -118,6 +119,7 @@ bool Voxelizer::createVB(RayTracing::CommandList* pCommandList, uint32_t numVert
 	m_vertexBuffer = VertexBuffer::MakeUnique();
 	XUSG_N_RETURN(m_vertexBuffer->Create(pCommandList->GetDevice(), numVert, stride,
 		ResourceFlag::NONE, MemoryType::DEFAULT), false);
+	trackMemory(MemoryRegistry::GPU_GEOMETRY, static_cast<uint64_t>(stride) * numVert);
 	uploaders.emplace_back(Resource::MakeUnique());
 
 	return m_vertexBuffer->Upload(pCommandList, uploaders.back().get(), pData,
@@ -131,19 +133,13 @@ bool Voxelizer::createIB(RayTracing::CommandList* pCommandList, uint32_t numIndi
 	m_indexBuffer = IndexBuffer::MakeUnique();
 	XUSG_N_RETURN(m_indexBuffer->Create(pCommandList->GetDevice(), byteWidth, Format::R32_UINT,
 		ResourceFlag::NONE, MemoryType::DEFAULT), false);
+	trackMemory(MemoryRegistry::GPU_GEOMETRY, byteWidth);
 	uploaders.emplace_back(Resource::MakeUnique());
 
 	return m_indexBuffer->Upload(pCommandList, uploaders.back().get(), pData,
 		byteWidth, 0, ResourceState::NON_PIXEL_SHADER_RESOURCE);
 }
 
-bool Voxelizer::createCB(const XUSG::Device* pDevice)
-{
-	m_cbPerObject = ConstantBuffer::MakeUnique();
-
-	return m_cbPerObject->Create(pDevice, sizeof(CBPerObject) * FrameCount, FrameCount);
-}
-
 bool Voxelizer::createPipelineLayouts(const RayTracing::Device* pDevice)
 {
 	// Global pipeline layout
@@ -211,12 +207,11 @@ bool Voxelizer::createPipelines(Format rtFormat, Format dsFormat)
 
 bool Voxelizer::createDescriptorTables()
 {
-	for (uint8_t i = 0; i < FrameCount; ++i)
+	// Output UAV
 	{
-		// Output UAV
 		const auto descriptorTable = Util::DescriptorTable::MakeUnique();
-		descriptorTable->SetDescriptors(0, 1, &m_grids[i]->GetUAV());
-		XUSG_X_RETURN(m_uavTables[i], descriptorTable->GetCbvSrvUavTable(m_descriptorTableLib.get()), false);
+		descriptorTable->SetDescriptors(0, 1, &m_grid->GetUAV());
+		XUSG_X_RETURN(m_uavTable, descriptorTable->GetCbvSrvUavTable(m_descriptorTableLib.get()), false);
 	}
 
 	// Index buffer SRV
@@ -240,14 +235,13 @@ bool Voxelizer::createDescriptorTables()
 		const auto descriptorTable = Util::DescriptorTable::MakeUnique();
 		descriptorTable->SetDescriptors(0, 1, &m_cbPerObject->GetCBV(i));
 		XUSG_X_RETURN(m_cbvTables[i], descriptorTable->GetCbvSrvUavTable(m_descriptorTableLib.get()), false);
+	}
 
-		// Get SRV
-		if (!m_srvTables[SRV_TABLE_GRID + i])
-		{
-			const auto descriptorTable = Util::DescriptorTable::MakeUnique();
-			descriptorTable->SetDescriptors(0, 1, &m_grids[i]->GetSRV());
-			XUSG_X_RETURN(m_srvTables[SRV_TABLE_GRID + i], descriptorTable->GetCbvSrvUavTable(m_descriptorTableLib.get()), false);
-		}
+	// Get SRV
+	{
+		const auto descriptorTable = Util::DescriptorTable::MakeUnique();
+		descriptorTable->SetDescriptors(0, 1, &m_grid->GetSRV());
+		XUSG_X_RETURN(m_srvTables[SRV_TABLE_GRID], descriptorTable->GetCbvSrvUavTable(m_descriptorTableLib.get()), false);
 	}
 
 	// Create the sampler table
@@ -289,6 +283,7 @@ bool Voxelizer::buildAccelerationStructures(RayTracing::CommandList* pCommandLis
 	XUSG_N_RETURN(AccelerationStructure::AllocateDestBuffer(pDevice, dstBuffer.get(),
 		dstBufferSize, 1, nullptr, static_cast<uint32_t>(size(dstBufferFirstElements)),
 		dstBufferFirstElements), false);
+	trackMemory(MemoryRegistry::GPU_RAY_TRACING, dstBufferSize);
 
 	// Set dest buffer for top-level AS and bottom-level ASes
 	m_topLevelAS->SetDestination(pDevice, dstBuffer, 0, 0, 0, m_descriptorTableLib.get());
@@ -299,6 +294,7 @@ bool Voxelizer::buildAccelerationStructures(RayTracing::CommandList* pCommandLis
 	scratchSize = (max)(m_bottomLevelAS->GetScratchDataByteSize(), scratchSize);
 	m_scratch = Buffer::MakeUnique();
 	XUSG_N_RETURN(AccelerationStructure::AllocateUAVBuffer(pDevice, m_scratch.get(), scratchSize), false);
+	trackMemory(MemoryRegistry::GPU_RAY_TRACING, scratchSize);
 
 	// Set instance
 	XMFLOAT3X4 matrix;
@@ -308,6 +304,7 @@ bool Voxelizer::buildAccelerationStructures(RayTracing::CommandList* pCommandLis
 	m_instances = Buffer::MakeUnique();
 	const BottomLevelAS* ppBottomLevelAS[] = { m_bottomLevelAS.get() };
 	TopLevelAS::SetInstances(pDevice, m_instances.get(), 1, ppBottomLevelAS, pTransform);
+	trackMemory(MemoryRegistry::GPU_RAY_TRACING, m_instances->GetWidth());
 
 	// Build bottom level AS
 	m_bottomLevelAS->Build(pCommandList, m_scratch.get());
@@ -348,38 +345,38 @@ bool Voxelizer::buildShaderTables(const RayTracing::Device* pDevice)
 	return true;
 }
 
-void Voxelizer::voxelize(RayTracing::CommandList* pCommandList, uint8_t frameIndex)
+void Voxelizer::voxelize(RayTracing::CommandList* pCommandList)
 {
 	// Set resource barrier
 	ResourceBarrier barrier;
-	const auto numBarriers = m_grids[frameIndex]->SetBarrier(&barrier, ResourceState::UNORDERED_ACCESS);
+	const auto numBarriers = m_grid->SetBarrier(&barrier, ResourceState::UNORDERED_ACCESS);
 	pCommandList->Barrier(numBarriers, &barrier);
 
 	// Set descriptor tables
 	pCommandList->SetComputePipelineLayout(m_pipelineLayouts[GLOBAL_LAYOUT]);
-	pCommandList->SetComputeDescriptorTable(OUTPUT_GRID, m_uavTables[frameIndex]);
+	pCommandList->SetComputeDescriptorTable(OUTPUT_GRID, m_uavTable);
 	pCommandList->SetTopLevelAccelerationStructure(ACCELERATION_STRUCTURE, m_topLevelAS.get());
 	pCommandList->SetComputeDescriptorTable(INDEX_BUFFERS, m_srvTables[SRV_TABLE_IB]);
 	pCommandList->SetComputeDescriptorTable(VERTEX_BUFFERS, m_srvTables[SRV_TABLE_VB]);
 
 	// Fallback layer has no depth
 	pCommandList->SetRayTracingPipeline(m_pipelines[RAY_TRACING]);
-	pCommandList->DispatchRays(GRID_SIZE, GRID_SIZE * GRID_SIZE, 1,
+	pCommandList->DispatchRays(GridSize, GridSize * GridSize, 1,
 		m_rayGenShaderTable.get(), m_hitGroupShaderTable.get(), m_missShaderTable.get());
 }
 
-void Voxelizer::renderRayCast(RayTracing::CommandList* pCommandList, uint8_t frameIndex,
-	const Descriptor& rtv, const Descriptor& dsv)
+void Voxelizer::renderRayCast(RayTracing::CommandList* pCommandList, uint8_t frameIndex)
 {
-	// Set resource barrier
-	ResourceBarrier barrier;
-	const auto numBarriers = m_grids[frameIndex]->SetBarrier(&barrier, ResourceState::PIXEL_SHADER_RESOURCE);
-	pCommandList->Barrier(numBarriers, &barrier);
+	// Set resource barriers
+	ResourceBarrier barriers[2];
+	auto numBarriers = m_grid->SetBarrier(barriers, ResourceState::PIXEL_SHADER_RESOURCE);
+	numBarriers = m_image->SetBarrier(barriers, ResourceState::RENDER_TARGET, numBarriers);
+	pCommandList->Barrier(numBarriers, barriers);
 
 	// Set descriptor tables
 	pCommandList->SetGraphicsPipelineLayout(m_pipelineLayouts[RAY_CAST_LAYOUT]);
 	pCommandList->SetGraphicsDescriptorTable(0, m_cbvTables[frameIndex]);
-	pCommandList->SetGraphicsDescriptorTable(1, m_srvTables[SRV_TABLE_GRID + frameIndex]);
+	pCommandList->SetGraphicsDescriptorTable(1, m_srvTables[SRV_TABLE_GRID]);
 	pCommandList->SetGraphicsDescriptorTable(2, m_samplerTable);
 
 	// Set pipeline state
@@ -391,9 +388,20 @@ void Voxelizer::renderRayCast(RayTracing::CommandList* pCommandList, uint8_t fra
 	pCommandList->RSSetViewports(1, &viewport);
 	pCommandList->RSSetScissorRects(1, &scissorRect);
 
-	pCommandList->OMSetRenderTargets(1, &rtv);
+	pCommandList->OMSetRenderTargets(1, &m_image->GetRTV());
 
 	// Record commands.
 	pCommandList->IASetPrimitiveTopology(PrimitiveTopology::TRIANGLESTRIP);
 	pCommandList->Draw(3, 1, 0, 0);
 }
+
+void Voxelizer::copyImage(RayTracing::CommandList* pCommandList, RenderTarget* pRenderTarget)
+{
+	// Set resource barriers
+	ResourceBarrier barriers[2];
+	auto numBarriers = m_image->SetBarrier(barriers, ResourceState::COPY_SOURCE);
+	numBarriers = pRenderTarget->SetBarrier(barriers, ResourceState::COPY_DEST, numBarriers);
+	pCommandList->Barrier(numBarriers, barriers);
+
+	pCommandList->CopyResource(pRenderTarget, m_image.get());
+}
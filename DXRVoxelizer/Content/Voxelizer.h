@@ -6,8 +6,10 @@
 
 #include "Core/XUSG.h"
 #include "RayTracing/XUSGRayTracing.h"
+#include "VoxelizerGPU.h"
 
-class Voxelizer
+class Voxelizer :
+	public VoxelizerGPU
 {
 public:
 	Voxelizer();
@@ -16,12 +18,19 @@ public:
 	bool Init(XUSG::RayTracing::CommandList* pCommandList, const XUSG::DescriptorTableLib::sptr& descriptorTableCache,
 		uint32_t width, uint32_t height, XUSG::Format rtFormat, XUSG::Format dsFormat, std::vector<XUSG::Resource::uptr>& uploaders,
 		XUSG::RayTracing::GeometryBuffer* pGeometry, const char* fileName, const DirectX::XMFLOAT4& posScale);
+	bool Init(XUSG::RayTracing::CommandList* pCommandList, const XUSG::DescriptorTableLib::sptr& descriptorTableCache,
+		uint32_t width, uint32_t height, XUSG::Format rtFormat, XUSG::Format dsFormat, std::vector<XUSG::Resource::uptr>& uploaders,
+		XUSG::RayTracing::GeometryBuffer* pGeometry, const uint8_t* pVertices, uint32_t numVertices, uint32_t stride,
+		const uint32_t* pIndices, uint32_t numIndices, const DirectX::XMFLOAT4& posScale);
 
-	void UpdateFrame(uint8_t frameIndex, DirectX::CXMVECTOR eyePt, DirectX::CXMMATRIX viewProj);
 	void Render(XUSG::RayTracing::CommandList* pCommandList, uint8_t frameIndex,
-		const XUSG::Descriptor& rtv, const XUSG::Descriptor& dsv);
+		XUSG::RenderTarget* pRenderTarget);
+
+	// Single passes, outside of the scheduler
+	void Voxelize(XUSG::RayTracing::CommandList* pCommandList);
+	void RayCast(XUSG::RayTracing::CommandList* pCommandList, uint8_t frameIndex);
 
-	static const uint8_t FrameCount = 3;
+	const char* GetName() const;
 
 protected:
 	enum PipelineLayoutIndex : uint8_t
@@ -55,7 +64,7 @@ protected:
 		SRV_TABLE_VB,
 		SRV_TABLE_GRID,
 
-		NUM_SRV_TABLE = SRV_TABLE_GRID + FrameCount
+		NUM_SRV_TABLE
 	};
 
 	enum VertexShaderID : uint8_t
@@ -68,18 +77,29 @@ protected:
 		PS_RAY_CAST
 	};
 
-	struct CBPerObject
+	// Records the passes of the scheduler into a command list
+	class Recorder :
+		public FrameScheduler::CommandRecorder
 	{
-		DirectX::XMVECTOR localSpaceLightPt;
-		DirectX::XMVECTOR localSpaceEyePt;
-		DirectX::XMMATRIX screenToLocal;
+	public:
+		Recorder(Voxelizer* pVoxelizer, XUSG::RayTracing::CommandList* pCommandList,
+			uint8_t frameIndex, XUSG::RenderTarget* pRenderTarget);
+
+		void Voxelize();
+		void RayCast();
+		void CopyImage();
+
+	protected:
+		Voxelizer* m_pVoxelizer;
+		XUSG::RayTracing::CommandList* m_pCommandList;
+		uint8_t m_frameIndex;
+		XUSG::RenderTarget* m_pRenderTarget;
 	};
 
 	bool createVB(XUSG::RayTracing::CommandList* pCommandList, uint32_t numVert,
 		uint32_t stride, const uint8_t* pData, std::vector<XUSG::Resource::uptr>& uploaders);
 	bool createIB(XUSG::RayTracing::CommandList* pCommandList, uint32_t numIndices,
 		const uint32_t* pData, std::vector<XUSG::Resource::uptr>& uploaders);
-	bool createCB(const XUSG::Device* pDevice);
 	bool createPipelineLayouts(const XUSG::RayTracing::Device* pDevice);
 	bool createPipelines(XUSG::Format rtFormat, XUSG::Format dsFormat);
 	bool createDescriptorTables();
@@ -87,9 +107,9 @@ protected:
 		XUSG::RayTracing::GeometryBuffer* pGeometries);
 	bool buildShaderTables(const XUSG::RayTracing::Device* pDevice);
 
-	void voxelize(XUSG::RayTracing::CommandList* pCommandList, uint8_t frameIndex);
-	void renderRayCast(XUSG::RayTracing::CommandList* pCommandList, uint8_t frameIndex,
-		const XUSG::Descriptor& rtv, const XUSG::Descriptor& dsv);
+	void voxelize(XUSG::RayTracing::CommandList* pCommandList);
+	void renderRayCast(XUSG::RayTracing::CommandList* pCommandList, uint8_t frameIndex);
+	void copyImage(XUSG::RayTracing::CommandList* pCommandList, XUSG::RenderTarget* pRenderTarget);
 
 	XUSG::RayTracing::BottomLevelAS::uptr m_bottomLevelAS;
 	XUSG::RayTracing::TopLevelAS::uptr m_topLevelAS;
@@ -99,16 +119,12 @@ protected:
 
 	XUSG::DescriptorTable		m_cbvTables[FrameCount];
 	XUSG::DescriptorTable		m_srvTables[NUM_SRV_TABLE];
-	XUSG::DescriptorTable		m_uavTables[FrameCount];
+	XUSG::DescriptorTable		m_uavTable;
 	XUSG::DescriptorTable		m_samplerTable;
 
 	XUSG::VertexBuffer::uptr	m_vertexBuffer;
 	XUSG::IndexBuffer::uptr		m_indexBuffer;
 
-	XUSG::ConstantBuffer::uptr	m_cbPerObject;
-
-	XUSG::Texture3D::uptr		m_grids[FrameCount];
-
 	XUSG::Buffer::uptr			m_scratch;
 	XUSG::Buffer::uptr			m_instances;
 
@@ -127,8 +143,4 @@ protected:
 	XUSG::Compute::PipelineLib::uptr	m_computePipelineLib;
 	XUSG::PipelineLayoutLib::uptr		m_pipelineLayoutLib;
 	XUSG::DescriptorTableLib::sptr		m_descriptorTableLib;
-
-	DirectX::XMFLOAT2 m_viewport;
-	DirectX::XMFLOAT4 m_bound;
-	DirectX::XMFLOAT4 m_posScale;
 };
@@ -0,0 +1,48 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <chrono>
+#include "VoxelizerBackend.h"
+
+using namespace std;
+
+VoxelizerBackend::VoxelizerBackend()
+{
+}
+
+VoxelizerBackend::~VoxelizerBackend()
+{
+}
+
+uint32_t VoxelizerBackend::SelectFastest(VoxelizerBackend* const* ppBackends, uint32_t numBackends,
+	const uint8_t* pVertices, uint32_t numVertices, uint32_t stride, const uint32_t* pIndices,
+	uint32_t numIndices, uint32_t gridSize, double* pTimes)
+{
+	// The upload is excluded, as it only copies the same inputs for every backend
+	auto fastest = numBackends;
+	auto fastestTime = 0.0;
+	for (auto i = 0u; i < numBackends; ++i)
+	{
+		const auto pBackend = ppBackends[i];
+		auto time = -1.0;
+		if (pBackend->Upload(pVertices, numVertices, stride, pIndices, numIndices))
+		{
+			const auto start = chrono::steady_clock::now();
+			if (pBackend->Build() && pBackend->Voxelize(gridSize))
+			{
+				const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+				time = elapsed.count();
+			}
+		}
+
+		if (pTimes) pTimes[i] = time;
+		if (time >= 0.0 && (fastest >= numBackends || time < fastestTime))
+		{
+			fastest = i;
+			fastestTime = time;
+		}
+	}
+
+	return fastest;
+}
@@ -0,0 +1,44 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "VectorMath.h"
+#include "VoxelGrid.h"
+
+//--------------------------------------------------------------------------------------
+// Engine-neutral interface of a voxelizer: the mesh is uploaded, its acceleration
+// structure built, and it is voxelized into a grid that can be read back or ray cast
+// into an RGBA8 image. Each call completes before it returns, so that backends can be
+// swapped, and compared, on identical inputs; a backend on a device submits and waits.
+// VoxelizerBackendCPU implements it without a device, and VoxelizerBackendCore and
+// VoxelizerBackendEZ on the D3D12 engines.
+//--------------------------------------------------------------------------------------
+class VoxelizerBackend
+{
+public:
+	VoxelizerBackend();
+	virtual ~VoxelizerBackend();
+
+	// Vertices are positions followed by normals, as loaded by ObjLoader
+	virtual bool Upload(const uint8_t* pVertices, uint32_t numVertices, uint32_t stride,
+		const uint32_t* pIndices, uint32_t numIndices) = 0;
+	virtual bool Build() = 0;
+	virtual bool Voxelize(uint32_t gridSize) = 0;
+	virtual bool ReadBack(VoxelGrid& grid) = 0;
+	// width * height * 4 bytes, with the camera and object placement of Voxelizer::UpdateFrame
+	virtual bool RenderImage(uint8_t* pImage, uint32_t width, uint32_t height, const Float3& eyePt,
+		const Float4x4& viewProj, const float posScale[4]) = 0;
+
+	virtual const char* GetName() const = 0;
+	// Center (xyz) and half extent (w) of the uploaded mesh
+	virtual const float* GetBound() const = 0;
+
+	// Builds and voxelizes the mesh on each backend and returns the index of the fastest,
+	// or numBackends if none succeeds; pTimes receives the seconds of each, or a negative
+	// value for a failure
+	static uint32_t SelectFastest(VoxelizerBackend* const* ppBackends, uint32_t numBackends,
+		const uint8_t* pVertices, uint32_t numVertices, uint32_t stride, const uint32_t* pIndices,
+		uint32_t numIndices, uint32_t gridSize, double* pTimes = nullptr);
+};
@@ -0,0 +1,83 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include "VoxelizerBackendCPU.h"
+
+using namespace std;
+
+VoxelizerBackendCPU::VoxelizerBackendCPU(VoxelizerCPU::Mode mode, uint32_t numThreads) :
+	VoxelizerBackend(),
+	m_numVertices(0),
+	m_stride(0),
+	m_mode(mode),
+	m_numThreads(numThreads),
+	m_isBuilt(false)
+{
+}
+
+VoxelizerBackendCPU::~VoxelizerBackendCPU()
+{
+}
+
+bool VoxelizerBackendCPU::Upload(const uint8_t* pVertices, uint32_t numVertices, uint32_t stride,
+	const uint32_t* pIndices, uint32_t numIndices)
+{
+	if (!pVertices || !numVertices || stride < sizeof(float[6]) || !pIndices || numIndices < 3) return false;
+
+	// Kept until the build, as the memory of a device would be
+	m_vertices.assign(pVertices, pVertices + static_cast<size_t>(stride) * numVertices);
+	m_indices.assign(pIndices, pIndices + numIndices);
+	m_numVertices = numVertices;
+	m_stride = stride;
+	m_grid = VoxelGrid();
+	m_isBuilt = false;
+
+	return true;
+}
+
+bool VoxelizerBackendCPU::Build()
+{
+	m_isBuilt = m_voxelizer.Init(m_vertices.data(), m_numVertices, m_stride, m_indices.data(),
+		static_cast<uint32_t>(m_indices.size()));
+
+	return m_isBuilt;
+}
+
+bool VoxelizerBackendCPU::Voxelize(uint32_t gridSize)
+{
+	return m_isBuilt && m_voxelizer.Voxelize(m_grid, gridSize, m_mode, m_numThreads);
+}
+
+bool VoxelizerBackendCPU::ReadBack(VoxelGrid& grid)
+{
+	if (!m_grid.GetNumVoxels()) return false;
+	grid = m_grid;
+
+	return true;
+}
+
+bool VoxelizerBackendCPU::RenderImage(uint8_t* pImage, uint32_t width, uint32_t height, const Float3& eyePt,
+	const Float4x4& viewProj, const float posScale[4])
+{
+	if (!m_rayCaster.Init(width, height, m_grid, m_voxelizer.GetBound(), posScale)) return false;
+	m_rayCaster.UpdateFrame(eyePt, viewProj);
+	m_rayCaster.Render(pImage, RayCasterCPU::FIXED_STEP, RayCasterCPU::LIGHT_MARCH, m_numThreads);
+
+	return true;
+}
+
+const char* VoxelizerBackendCPU::GetName() const
+{
+	return m_mode == VoxelizerCPU::COLUMN ? "CPU column" : "CPU per-voxel";
+}
+
+const float* VoxelizerBackendCPU::GetBound() const
+{
+	return m_voxelizer.GetBound();
+}
+
+const VoxelGrid& VoxelizerBackendCPU::GetGrid() const
+{
+	return m_grid;
+}
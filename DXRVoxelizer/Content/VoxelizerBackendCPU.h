@@ -0,0 +1,48 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "RayCasterCPU.h"
+#include "VoxelizerBackend.h"
+#include "VoxelizerCPU.h"
+
+//--------------------------------------------------------------------------------------
+// VoxelizerBackend on VoxelizerCPU and RayCasterCPU, without a device
+//--------------------------------------------------------------------------------------
+class VoxelizerBackendCPU :
+	public VoxelizerBackend
+{
+public:
+	VoxelizerBackendCPU(VoxelizerCPU::Mode mode = VoxelizerCPU::COLUMN, uint32_t numThreads = 0);
+	virtual ~VoxelizerBackendCPU();
+
+	bool Upload(const uint8_t* pVertices, uint32_t numVertices, uint32_t stride,
+		const uint32_t* pIndices, uint32_t numIndices);
+	bool Build();
+	bool Voxelize(uint32_t gridSize);
+	bool ReadBack(VoxelGrid& grid);
+	bool RenderImage(uint8_t* pImage, uint32_t width, uint32_t height, const Float3& eyePt,
+		const Float4x4& viewProj, const float posScale[4]);
+
+	const char* GetName() const;
+	const float* GetBound() const;
+
+	// The voxelized grid, without the copy of ReadBack
+	const VoxelGrid& GetGrid() const;
+
+protected:
+	VoxelizerCPU	m_voxelizer;
+	VoxelGrid		m_grid;
+	RayCasterCPU	m_rayCaster;
+
+	std::vector<uint8_t>	m_vertices;
+	std::vector<uint32_t>	m_indices;
+	uint32_t				m_numVertices;
+	uint32_t				m_stride;
+
+	VoxelizerCPU::Mode	m_mode;
+	uint32_t			m_numThreads;
+	bool				m_isBuilt;
+};
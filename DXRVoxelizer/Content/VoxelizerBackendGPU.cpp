@@ -0,0 +1,324 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <cstring>
+#include "VoxelizerBackendGPU.h"
+
+using namespace std;
+using namespace DirectX;
+using namespace XUSG;
+using namespace XUSG::RayTracing;
+
+VoxelizerBackendGPU::VoxelizerBackendGPU(const RayTracing::Device* pDevice, uint32_t width, uint32_t height) :
+	VoxelizerBackend(),
+	m_pDevice(pDevice),
+	m_fenceValue(0),
+	m_fenceEvent(nullptr),
+	m_numVertices(0),
+	m_stride(0),
+	m_width(width),
+	m_height(height),
+	m_isBuilt(false),
+	m_isVoxelized(false)
+{
+}
+
+VoxelizerBackendGPU::~VoxelizerBackendGPU()
+{
+	if (m_fenceEvent) CloseHandle(m_fenceEvent);
+}
+
+bool VoxelizerBackendGPU::Upload(const uint8_t* pVertices, uint32_t numVertices, uint32_t stride,
+	const uint32_t* pIndices, uint32_t numIndices)
+{
+	if (!pVertices || !numVertices || stride < sizeof(float[6]) || !pIndices || numIndices < 3) return false;
+
+	// Kept until the build, which records the copies into the vertex and index buffers
+	m_vertices.assign(pVertices, pVertices + static_cast<size_t>(stride) * numVertices);
+	m_indices.assign(pIndices, pIndices + numIndices);
+	m_numVertices = numVertices;
+	m_stride = stride;
+	m_isBuilt = false;
+	m_isVoxelized = false;
+
+	return true;
+}
+
+bool VoxelizerBackendGPU::Build()
+{
+	m_isBuilt = false;
+	m_isVoxelized = false;
+	if (m_indices.empty()) return false;
+	if (!m_commandQueue && !createDeviceObjects()) return false;
+
+	// The engine is created anew, with a cleared grid, and its uploaders live until the wait
+	vector<Resource::uptr> uploaders(0);
+	XUSG_N_RETURN(begin(), false);
+	if (!init(uploaders))
+	{
+		close();
+		return false;
+	}
+	m_isBuilt = submit();
+
+	return m_isBuilt;
+}
+
+bool VoxelizerBackendGPU::Voxelize(uint32_t gridSize)
+{
+	if (!m_isBuilt || gridSize != VoxelizerGPU::GridSize) return false;
+
+	XUSG_N_RETURN(begin(), false);
+	voxelize();
+	m_isVoxelized = submit();
+
+	return m_isVoxelized;
+}
+
+bool VoxelizerBackendGPU::ReadBack(VoxelGrid& grid)
+{
+	if (!m_isVoxelized) return false;
+
+	uint32_t rowPitch;
+	XUSG_N_RETURN(begin(), false);
+	if (!getVoxelizer()->ReadBackGrid(m_commandList.get(), m_readBuffer.get(), &rowPitch))
+	{
+		close();
+		return false;
+	}
+	XUSG_N_RETURN(submit(), false);
+
+	// The alpha of R10G10B10A2_UNORM is the density, which the hits set to 1
+	const auto size = VoxelizerGPU::GridSize;
+	const auto pData = static_cast<const uint8_t*>(m_readBuffer->Map(nullptr));
+	if (!pData || !grid.Create(size, size, size)) return false;
+	for (auto z = 0u; z < size; ++z)
+		for (auto y = 0u; y < size; ++y)
+		{
+			const auto pRow = reinterpret_cast<const uint32_t*>(&pData[static_cast<size_t>(rowPitch) * (size * z + y)]);
+			for (auto x = 0u; x < size; ++x) grid.Set(x, y, z, (pRow[x] >> 30) ? 0xff : 0);
+		}
+	m_readBuffer->Unmap();
+
+	return true;
+}
+
+bool VoxelizerBackendGPU::RenderImage(uint8_t* pImage, uint32_t width, uint32_t height, const Float3& eyePt,
+	const Float4x4& viewProj, const float posScale[4])
+{
+	if (!m_isVoxelized || width != m_width || height != m_height) return false;
+
+	// Every call waits, so the constants of frame 0 are never in flight
+	const auto pVoxelizer = getVoxelizer();
+	pVoxelizer->SetPosScale(XMFLOAT4(posScale));
+	pVoxelizer->UpdateFrame(0, XMVectorSet(eyePt.x, eyePt.y, eyePt.z, 1.0f), XMMATRIX(&viewProj.m[0][0]));
+
+	uint32_t rowPitch;
+	XUSG_N_RETURN(begin(), false);
+	rayCast();
+	if (!pVoxelizer->ReadBackImage(m_commandList.get(), m_readBuffer.get(), &rowPitch))
+	{
+		close();
+		return false;
+	}
+	XUSG_N_RETURN(submit(), false);
+
+	const auto pData = static_cast<const uint8_t*>(m_readBuffer->Map(nullptr));
+	if (!pData) return false;
+	for (auto i = 0u; i < height; ++i)
+		memcpy(&pImage[sizeof(uint32_t) * width * i], &pData[static_cast<size_t>(rowPitch) * i], sizeof(uint32_t) * width);
+	m_readBuffer->Unmap();
+
+	return true;
+}
+
+const char* VoxelizerBackendGPU::GetName() const
+{
+	return getVoxelizer()->GetName();
+}
+
+const float* VoxelizerBackendGPU::GetBound() const
+{
+	return &getVoxelizer()->GetBound().x;
+}
+
+bool VoxelizerBackendGPU::createDeviceObjects()
+{
+	m_commandQueue = CommandQueue::MakeUnique();
+	XUSG_N_RETURN(m_commandQueue->Create(m_pDevice, CommandListType::DIRECT, CommandQueueFlag::NONE,
+		0, 0, L"BackendQueue"), false);
+
+	m_commandAllocator = CommandAllocator::MakeUnique();
+	XUSG_N_RETURN(m_commandAllocator->Create(m_pDevice, CommandListType::DIRECT, L"BackendAllocator"), false);
+
+	m_fence = Fence::MakeUnique();
+	XUSG_N_RETURN(m_fence->Create(m_pDevice, m_fenceValue, FenceFlag::NONE, L"BackendFence"), false);
+	m_fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	if (!m_fenceEvent) return false;
+
+	m_readBuffer = Buffer::MakeUnique();
+
+	// Created open, and closed so that every call begins with a reset
+	XUSG_N_RETURN(createCommandList(), false);
+
+	return close();
+}
+
+bool VoxelizerBackendGPU::begin()
+{
+	XUSG_N_RETURN(m_commandAllocator->Reset(), false);
+
+	return reset();
+}
+
+bool VoxelizerBackendGPU::submit()
+{
+	XUSG_N_RETURN(close(), false);
+	m_commandQueue->ExecuteCommandList(m_commandList.get());
+
+	XUSG_N_RETURN(m_commandQueue->Signal(m_fence.get(), ++m_fenceValue), false);
+	if (m_fence->GetCompletedValue() < m_fenceValue)
+	{
+		XUSG_N_RETURN(m_fence->SetEventOnCompletion(m_fenceValue, m_fenceEvent), false);
+		WaitForSingleObject(m_fenceEvent, INFINITE);
+	}
+
+	return true;
+}
+
+bool VoxelizerBackendGPU::createCommandList()
+{
+	m_commandList = RayTracing::CommandList::MakeUnique();
+	XUSG_N_RETURN(m_commandList->Create(m_pDevice, 0, CommandListType::DIRECT,
+		m_commandAllocator.get(), nullptr), false);
+
+	return m_commandList->CreateInterface();
+}
+
+//--------------------------------------------------------------------------------------
+// Core
+//--------------------------------------------------------------------------------------
+
+VoxelizerBackendCore::VoxelizerBackendCore(const RayTracing::Device* pDevice, uint32_t width, uint32_t height) :
+	VoxelizerBackendGPU(pDevice, width, height)
+{
+	m_voxelizer = make_unique<Voxelizer>();
+}
+
+VoxelizerBackendCore::~VoxelizerBackendCore()
+{
+}
+
+bool VoxelizerBackendCore::createCommandList()
+{
+	XUSG_N_RETURN(VoxelizerBackendGPU::createCommandList(), false);
+	m_descriptorTableLib = DescriptorTableLib::MakeShared(m_pDevice, L"BackendDescriptorTableLib");
+
+	return true;
+}
+
+bool VoxelizerBackendCore::init(vector<Resource::uptr>& uploaders)
+{
+	const XMFLOAT4 posScale(0.0f, 0.0f, 0.0f, 1.0f);
+	m_voxelizer = make_unique<Voxelizer>();
+
+	return m_voxelizer->Init(m_commandList.get(), m_descriptorTableLib, m_width, m_height,
+		Format::R8G8B8A8_UNORM, Format::D24_UNORM_S8_UINT, uploaders, &m_geometry,
+		m_vertices.data(), m_numVertices, m_stride, m_indices.data(),
+		static_cast<uint32_t>(m_indices.size()), posScale);
+}
+
+bool VoxelizerBackendCore::reset()
+{
+	XUSG_N_RETURN(m_commandList->Reset(m_commandAllocator.get(), nullptr), false);
+
+	// The heaps exist once Init has created the descriptor tables
+	if (!m_isBuilt) return true;
+	const DescriptorHeap descriptorHeaps[] =
+	{
+		m_descriptorTableLib->GetDescriptorHeap(CBV_SRV_UAV_HEAP),
+		m_descriptorTableLib->GetDescriptorHeap(SAMPLER_HEAP)
+	};
+	m_commandList->SetDescriptorHeaps(static_cast<uint32_t>(size(descriptorHeaps)), descriptorHeaps);
+
+	return true;
+}
+
+bool VoxelizerBackendCore::close()
+{
+	return m_commandList->Close();
+}
+
+void VoxelizerBackendCore::voxelize()
+{
+	m_voxelizer->Voxelize(m_commandList.get());
+}
+
+void VoxelizerBackendCore::rayCast()
+{
+	m_voxelizer->RayCast(m_commandList.get(), 0);
+}
+
+VoxelizerGPU* VoxelizerBackendCore::getVoxelizer() const
+{
+	return m_voxelizer.get();
+}
+
+//--------------------------------------------------------------------------------------
+// EZ
+//--------------------------------------------------------------------------------------
+
+VoxelizerBackendEZ::VoxelizerBackendEZ(const RayTracing::Device* pDevice, uint32_t width, uint32_t height) :
+	VoxelizerBackendGPU(pDevice, width, height)
+{
+	m_voxelizer = make_unique<VoxelizerEZ>();
+}
+
+VoxelizerBackendEZ::~VoxelizerBackendEZ()
+{
+}
+
+bool VoxelizerBackendEZ::createCommandList()
+{
+	XUSG_N_RETURN(VoxelizerBackendGPU::createCommandList(), false);
+	m_commandListEZ = RayTracing::EZ::CommandList::MakeUnique();
+
+	return m_commandListEZ->Create(m_commandList.get(), 1, 16);
+}
+
+bool VoxelizerBackendEZ::init(vector<Resource::uptr>& uploaders)
+{
+	const XMFLOAT4 posScale(0.0f, 0.0f, 0.0f, 1.0f);
+	m_voxelizer = make_unique<VoxelizerEZ>();
+
+	return m_voxelizer->Init(m_commandListEZ.get(), m_width, m_height,
+		Format::R8G8B8A8_UNORM, Format::D24_UNORM_S8_UINT, uploaders, &m_geometry,
+		m_vertices.data(), m_numVertices, m_stride, m_indices.data(),
+		static_cast<uint32_t>(m_indices.size()), posScale);
+}
+
+bool VoxelizerBackendEZ::reset()
+{
+	return m_commandListEZ->Reset(m_commandAllocator.get(), nullptr);
+}
+
+bool VoxelizerBackendEZ::close()
+{
+	return m_commandListEZ->Close();
+}
+
+void VoxelizerBackendEZ::voxelize()
+{
+	m_voxelizer->Voxelize(m_commandListEZ.get());
+}
+
+void VoxelizerBackendEZ::rayCast()
+{
+	m_voxelizer->RayCast(m_commandListEZ.get(), 0);
+}
+
+VoxelizerGPU* VoxelizerBackendEZ::getVoxelizer() const
+{
+	return m_voxelizer.get();
+}
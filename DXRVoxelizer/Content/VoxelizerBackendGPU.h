@@ -0,0 +1,114 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "Voxelizer.h"
+#include "VoxelizerBackend.h"
+#include "VoxelizerEZ.h"
+
+//--------------------------------------------------------------------------------------
+// VoxelizerBackend on a D3D12 engine, with a queue, a command list and a fence of its
+// own: each call records its commands, submits them and waits for the fence. The grid
+// has the fixed size of VoxelizerGPU::GridSize, and images the size of the construction.
+//--------------------------------------------------------------------------------------
+class VoxelizerBackendGPU :
+	public VoxelizerBackend
+{
+public:
+	VoxelizerBackendGPU(const XUSG::RayTracing::Device* pDevice, uint32_t width, uint32_t height);
+	virtual ~VoxelizerBackendGPU();
+
+	bool Upload(const uint8_t* pVertices, uint32_t numVertices, uint32_t stride,
+		const uint32_t* pIndices, uint32_t numIndices);
+	bool Build();
+	bool Voxelize(uint32_t gridSize);
+	bool ReadBack(VoxelGrid& grid);
+	bool RenderImage(uint8_t* pImage, uint32_t width, uint32_t height, const Float3& eyePt,
+		const Float4x4& viewProj, const float posScale[4]);
+
+	const char* GetName() const;
+	const float* GetBound() const;
+
+protected:
+	bool createDeviceObjects();
+	bool begin();
+	bool submit();
+
+	// The engine-specific parts, recorded between begin and submit
+	virtual bool createCommandList();
+	virtual bool init(std::vector<XUSG::Resource::uptr>& uploaders) = 0;
+	virtual bool reset() = 0;
+	virtual bool close() = 0;
+	virtual void voxelize() = 0;
+	virtual void rayCast() = 0;
+	virtual VoxelizerGPU* getVoxelizer() const = 0;
+
+	const XUSG::RayTracing::Device* m_pDevice;
+	XUSG::CommandQueue::uptr		m_commandQueue;
+	XUSG::CommandAllocator::uptr	m_commandAllocator;
+	XUSG::RayTracing::CommandList::uptr m_commandList;
+	XUSG::Fence::uptr				m_fence;
+	uint64_t						m_fenceValue;
+	void*							m_fenceEvent;
+
+	XUSG::RayTracing::GeometryBuffer m_geometry;
+	XUSG::Buffer::uptr				m_readBuffer;
+
+	std::vector<uint8_t>	m_vertices;
+	std::vector<uint32_t>	m_indices;
+	uint32_t				m_numVertices;
+	uint32_t				m_stride;
+
+	uint32_t	m_width;
+	uint32_t	m_height;
+	bool		m_isBuilt;
+	bool		m_isVoxelized;
+};
+
+//--------------------------------------------------------------------------------------
+// VoxelizerBackendGPU on Voxelizer, which records into the core command list
+//--------------------------------------------------------------------------------------
+class VoxelizerBackendCore :
+	public VoxelizerBackendGPU
+{
+public:
+	VoxelizerBackendCore(const XUSG::RayTracing::Device* pDevice, uint32_t width, uint32_t height);
+	virtual ~VoxelizerBackendCore();
+
+protected:
+	bool createCommandList();
+	bool init(std::vector<XUSG::Resource::uptr>& uploaders);
+	bool reset();
+	bool close();
+	void voxelize();
+	void rayCast();
+	VoxelizerGPU* getVoxelizer() const;
+
+	std::unique_ptr<Voxelizer>		m_voxelizer;
+	XUSG::DescriptorTableLib::sptr	m_descriptorTableLib;
+};
+
+//--------------------------------------------------------------------------------------
+// VoxelizerBackendGPU on VoxelizerEZ, which records into an EZ command list
+//--------------------------------------------------------------------------------------
+class VoxelizerBackendEZ :
+	public VoxelizerBackendGPU
+{
+public:
+	VoxelizerBackendEZ(const XUSG::RayTracing::Device* pDevice, uint32_t width, uint32_t height);
+	virtual ~VoxelizerBackendEZ();
+
+protected:
+	bool createCommandList();
+	bool init(std::vector<XUSG::Resource::uptr>& uploaders);
+	bool reset();
+	bool close();
+	void voxelize();
+	void rayCast();
+	VoxelizerGPU* getVoxelizer() const;
+
+	std::unique_ptr<VoxelizerEZ>		m_voxelizer;
+	XUSG::RayTracing::EZ::CommandList::uptr m_commandListEZ;
+};
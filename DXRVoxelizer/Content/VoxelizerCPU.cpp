@@ -0,0 +1,210 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include "ParallelFor.h"
+#include "Profiler.h"
+#include "VoxelizerCPU.h"
+
+using namespace std;
+
+// Same as THRESHOLD in DXRVoxelizer.hlsl
+const float VoxelizerCPU::Threshold = 0.12f;
+
+VoxelizerCPU::VoxelizerCPU() :
+	m_memory(MemoryRegistry::MESH),
+	m_bound()
+{
+}
+
+VoxelizerCPU::~VoxelizerCPU()
+{
+}
+
+bool VoxelizerCPU::Init(const uint8_t* pVertices, uint32_t numVertices, uint32_t stride,
+	const uint32_t* pIndices, uint32_t numIndices)
+{
+	if (!pVertices || !numVertices || stride < sizeof(float[6]) || !pIndices || numIndices < 3) return false;
+
+	const auto getVertex = [pVertices, stride](uint32_t i)
+	{
+		return reinterpret_cast<const float*>(&pVertices[static_cast<size_t>(stride) * i]);
+	};
+
+	// Extract boundary
+	auto aabbMin = Float3(FLT_MAX, FLT_MAX, FLT_MAX);
+	auto aabbMax = Float3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for (auto i = 0u; i < numVertices; ++i)
+	{
+		const Float3 pos(getVertex(i));
+		aabbMin = Min(aabbMin, pos);
+		aabbMax = Max(aabbMax, pos);
+	}
+
+	const auto ext = aabbMax - aabbMin;
+	m_bound[0] = (aabbMax.x + aabbMin.x) / 2.0f;
+	m_bound[1] = (aabbMax.y + aabbMin.y) / 2.0f;
+	m_bound[2] = (aabbMax.z + aabbMin.z) / 2.0f;
+	m_bound[3] = (max)(ext.x, (max)(ext.y, ext.z)) / 2.0f;
+	if (m_bound[3] <= 0.0f) return false;
+
+	// Normalize the positions to [-1, 1] as the instance transform of the top-level AS
+	const Float3 center(m_bound);
+	const auto scale = 1.0f / m_bound[3];
+	vector<Float3> positions(numVertices);
+	m_normals.resize(numVertices);
+	for (auto i = 0u; i < numVertices; ++i)
+	{
+		const auto pVertex = getVertex(i);
+		positions[i] = (Float3(pVertex) - center) * scale;
+		m_normals[i] = Float3(&pVertex[3]);
+	}
+	m_indices.assign(pIndices, pIndices + numIndices);
+	m_memory.Set(sizeof(Float3) * m_normals.capacity() + sizeof(uint32_t) * m_indices.capacity());
+
+	return m_bvh.Build(reinterpret_cast<const uint8_t*>(positions.data()), sizeof(Float3),
+		numVertices, pIndices, numIndices);
+}
+
+bool VoxelizerCPU::Voxelize(VoxelGrid& grid, uint32_t gridSize, Mode mode, uint32_t numThreads) const
+{
+	PROFILE_ZONE("voxelize");
+	if (!m_bvh.GetNumTriangles()) return false;
+
+	const auto layout = VoxelGrid::IsMortonCompatible(gridSize, gridSize, gridSize) ? grid.GetLayout() : VoxelGrid::LINEAR;
+	if (!grid.Create(gridSize, gridSize, gridSize, layout)) return false;
+
+	if (mode == COLUMN)
+	{
+		ParallelFor(0, gridSize, numThreads, [&](uint32_t z)
+		{
+			PROFILE_ZONE("voxelize slice");
+			vector<RLEGrid::Run> runs;
+			vector<BVH::Hit> hits;
+			for (auto y = 0u; y < gridSize; ++y)
+			{
+				runs.clear();
+				voxelizeColumn(runs, hits, y, z, gridSize);
+				for (const auto& run : runs)
+					for (uint32_t x = run.Begin; x < run.End; ++x) grid.Set(x, y, z, 0xff);
+			}
+		});
+
+		return true;
+	}
+
+	// Generate a ray in grid space for each voxel, and classify the voxel by the
+	// facing of the closest hit, as raygenMain and closestHitMain do.
+	ParallelFor(0, gridSize, numThreads, [&](uint32_t z)
+	{
+		PROFILE_ZONE("voxelize slice");
+		BVH::Hit hit;
+		for (auto y = 0u; y < gridSize; ++y)
+		{
+			for (auto x = 0u; x < gridSize; ++x)
+			{
+				Float3 pos((x + 0.5f) / gridSize * 2.0f - 1.0f, (y + 0.5f) / gridSize * 2.0f - 1.0f,
+					(z + 0.5f) / gridSize * 2.0f - 1.0f);
+
+				// Invert Y for Y-up-style NDC.
+				pos.y = -pos.y;
+
+				const auto dir = Normalize(pos);
+				if (m_bvh.Intersect(pos, dir, 0.0f, 10000.0f, hit) && Dot(getNormal(hit), dir) > Threshold)
+					grid.Set(x, y, z, 0xff);
+			}
+		}
+	});
+
+	return true;
+}
+
+bool VoxelizerCPU::Voxelize(RLEGrid& grid, uint32_t gridSize, Mode mode, uint32_t numThreads) const
+{
+	PROFILE_ZONE("voxelize RLE");
+	if (!m_bvh.GetNumTriangles()) return false;
+
+	if (mode != COLUMN)
+	{
+		VoxelGrid denseGrid;
+
+		return Voxelize(denseGrid, gridSize, mode, numThreads) && grid.FromDense(denseGrid);
+	}
+
+	// Emit the runs directly, one ray per column
+	if (!grid.Create(gridSize, gridSize, gridSize)) return false;
+	vector<vector<RLEGrid::Run>> columns(static_cast<size_t>(gridSize) * gridSize);
+	ParallelFor(0, gridSize, numThreads, [&](uint32_t z)
+	{
+		PROFILE_ZONE("voxelize slice");
+		vector<BVH::Hit> hits;
+		for (auto y = 0u; y < gridSize; ++y)
+			voxelizeColumn(columns[static_cast<size_t>(gridSize) * z + y], hits, y, z, gridSize);
+	});
+	grid.SetColumns(columns);
+
+	return true;
+}
+
+const float* VoxelizerCPU::GetBound() const
+{
+	return m_bound;
+}
+
+const char* VoxelizerCPU::GetModeName(Mode mode)
+{
+	static const char* names[] = { "per-voxel", "column" };
+
+	return mode < NUM_MODE ? names[mode] : "unknown";
+}
+
+Float3 VoxelizerCPU::getNormal(const BVH::Hit& hit) const
+{
+	const auto baseIdx = hit.PrimitiveIndex * 3;
+	const auto& n0 = m_normals[m_indices[baseIdx]];
+	const auto& n1 = m_normals[m_indices[baseIdx + 1]];
+	const auto& n2 = m_normals[m_indices[baseIdx + 2]];
+
+	return Normalize(n0 + hit.U * (n1 - n0) + hit.V * (n2 - n0));
+}
+
+//--------------------------------------------------------------------------------------
+// Trace a single ray along +x through the whole column and collect every hit. A voxel
+// is inside when the first hit beyond its center faces away from the ray, i.e. the
+// per-voxel test of closestHitMain restricted to the +x direction, so the voxels
+// between two consecutive hits share one classification and form a run.
+//--------------------------------------------------------------------------------------
+void VoxelizerCPU::voxelizeColumn(vector<RLEGrid::Run>& runs, vector<BVH::Hit>& hits,
+	uint32_t y, uint32_t z, uint32_t gridSize) const
+{
+	const Float3 origin(-2.0f, 1.0f - (y + 0.5f) / gridSize * 2.0f, (z + 0.5f) / gridSize * 2.0f - 1.0f);
+	const Float3 dir(1.0f, 0.0f, 0.0f);
+
+	hits.clear();
+	m_bvh.IntersectAll(origin, dir, 0.0f, 4.0f, hits);
+	sort(hits.begin(), hits.end(), [](const BVH::Hit& a, const BVH::Hit& b) { return a.T < b.T; });
+
+	// First voxel whose center is beyond grid-space x
+	const auto halfSize = gridSize * 0.5f;
+	const auto firstVoxelAfter = [halfSize, gridSize](float x)
+	{
+		const auto f = floorf((x + 1.0f) * halfSize - 0.5f) + 1.0f;
+
+		return static_cast<uint16_t>((min)((max)(f, 0.0f), static_cast<float>(gridSize)));
+	};
+
+	uint16_t begin = 0;
+	for (const auto& hit : hits)
+	{
+		const auto end = firstVoxelAfter(hit.T - 2.0f);
+		if (getNormal(hit).x > Threshold && begin < end)
+		{
+			if (!runs.empty() && runs.back().End >= begin) runs.back().End = end;
+			else runs.push_back({ begin, end });
+		}
+		begin = end;
+	}
+}
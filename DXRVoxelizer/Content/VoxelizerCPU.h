@@ -0,0 +1,57 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "BVH.h"
+#include "RLEGrid.h"
+#include "VoxelGrid.h"
+
+//--------------------------------------------------------------------------------------
+// CPU solid voxelizer over a BVH, in the normalized [-1, 1] grid space of the DXR path
+//--------------------------------------------------------------------------------------
+class VoxelizerCPU
+{
+public:
+	enum Mode : uint8_t
+	{
+		PER_VOXEL,	// One ray per voxel, as raygenMain in DXRVoxelizer.hlsl
+		COLUMN,		// One ray per column along x, classifying voxels between hits
+
+		NUM_MODE
+	};
+
+	VoxelizerCPU();
+	virtual ~VoxelizerCPU();
+
+	// Vertices are positions followed by normals, as loaded by ObjLoader
+	bool Init(const uint8_t* pVertices, uint32_t numVertices, uint32_t stride,
+		const uint32_t* pIndices, uint32_t numIndices);
+
+	bool Voxelize(VoxelGrid& grid, uint32_t gridSize, Mode mode = PER_VOXEL, uint32_t numThreads = 0) const;
+	bool Voxelize(RLEGrid& grid, uint32_t gridSize, Mode mode = COLUMN, uint32_t numThreads = 0) const;
+
+	// Center (xyz) and half extent (w) of the mesh, as m_bound of Voxelizer
+	const float* GetBound() const;
+
+	static const float Threshold;
+	static const char* GetModeName(Mode mode);
+
+	// Bumped with any change to the voxels that Voxelize makes, which the goldens catch, so
+	// that VoxelCache keys of the older grids miss
+	static const uint32_t AlgorithmVersion = 2;
+
+protected:
+	Float3 getNormal(const BVH::Hit& hit) const;
+	void voxelizeColumn(std::vector<RLEGrid::Run>& runs, std::vector<BVH::Hit>& hits,
+		uint32_t y, uint32_t z, uint32_t gridSize) const;
+
+	BVH m_bvh;
+
+	std::vector<Float3>		m_normals;
+	std::vector<uint32_t>	m_indices;
+	MemoryRegistry::Allocation m_memory;
+
+	float m_bound[4];
+};
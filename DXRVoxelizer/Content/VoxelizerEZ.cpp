@@ -5,8 +5,6 @@
 #include "Optional/XUSGObjLoader.h"
 #include "VoxelizerEZ.h"
 
-#define GRID_SIZE 64
-
 using namespace std;
 using namespace DirectX;
 using namespace XUSG;
@@ -18,6 +16,7 @@ const wchar_t* VoxelizerEZ::ClosestHitShaderName = L"closestHitMain";
 const wchar_t* VoxelizerEZ::MissShaderName = L"missMain";
 
 VoxelizerEZ::VoxelizerEZ() :
+	VoxelizerGPU(),
 	m_instances()
 {
 	m_shaderLib = ShaderLib::MakeUnique();
@@ -31,35 +30,26 @@ bool VoxelizerEZ::Init(RayTracing::EZ::CommandList* pCommandList, uint32_t width
 	Format rtFormat, Format dsFormat, vector<Resource::uptr>& uploaders, GeometryBuffer* pGeometry,
 	const char* fileName, const XMFLOAT4& posScale)
 {
-	const auto pDevice = pCommandList->GetRTDevice();
-
-	m_viewport.x = static_cast<float>(width);
-	m_viewport.y = static_cast<float>(height);
-	m_posScale = posScale;
-
 	// Load inputs
 	ObjLoader objLoader;
 	if (!objLoader.Import(fileName, true, true)) return false;
-	XUSG_N_RETURN(createVB(pCommandList, objLoader.GetNumVertices(), objLoader.GetVertexStride(), objLoader.GetVertices(), uploaders), false);
-	XUSG_N_RETURN(createIB(pCommandList, objLoader.GetNumIndices(), objLoader.GetIndices(), uploaders), false);
 
-	// Extract boundary
-	const auto& aabb = objLoader.GetAABB();
-	const XMFLOAT3 ext(aabb.Max.x - aabb.Min.x, aabb.Max.y - aabb.Min.y, aabb.Max.z - aabb.Min.z);
-	m_bound.x = (aabb.Max.x + aabb.Min.x) / 2.0f;
-	m_bound.y = (aabb.Max.y + aabb.Min.y) / 2.0f;
-	m_bound.z = (aabb.Max.z + aabb.Min.z) / 2.0f;
-	m_bound.w = (max)(ext.x, (max)(ext.y, ext.z)) / 2.0f;
+	return Init(pCommandList, width, height, rtFormat, dsFormat, uploaders, pGeometry,
+		objLoader.GetVertices(), objLoader.GetNumVertices(), objLoader.GetVertexStride(),
+		objLoader.GetIndices(), objLoader.GetNumIndices(), posScale);
+}
+
+bool VoxelizerEZ::Init(RayTracing::EZ::CommandList* pCommandList, uint32_t width, uint32_t height,
+	Format rtFormat, Format dsFormat, vector<Resource::uptr>& uploaders, GeometryBuffer* pGeometry,
+	const uint8_t* pVertices, uint32_t numVertices, uint32_t stride, const uint32_t* pIndices,
+	uint32_t numIndices, const XMFLOAT4& posScale)
+{
+	const auto pDevice = pCommandList->GetRTDevice();
 
-	XUSG_N_RETURN(createCB(pDevice), false);
+	XUSG_N_RETURN(createVB(pCommandList, numVertices, stride, pVertices, uploaders), false);
+	XUSG_N_RETURN(createIB(pCommandList, numIndices, pIndices, uploaders), false);
 
-	// Create output grids and build acceleration structures
-	for (auto& grid : m_grids)
-	{
-		grid = Texture3D::MakeUnique();
-		XUSG_N_RETURN(grid->Create(pDevice, GRID_SIZE, GRID_SIZE, GRID_SIZE, Format::R10G10B10A2_UNORM,
-			ResourceFlag::ALLOW_UNORDERED_ACCESS), false);
-	}
+	XUSG_N_RETURN(createResources(pDevice, width, height, rtFormat, pVertices, numVertices, stride, posScale), false);
 
 	// Build and create pipeline layouts for m_commandListEZ
 	const uint32_t maxSrvSpaces[Shader::Stage::NUM_STAGE] = { 1, 1, 0, 0, 0, 2 };
@@ -72,38 +62,49 @@ bool VoxelizerEZ::Init(RayTracing::EZ::CommandList* pCommandList, uint32_t width
 	return createShaders();
 }
 
-void VoxelizerEZ::UpdateFrame(uint8_t frameIndex, CXMVECTOR eyePt, CXMMATRIX viewProj)
+void VoxelizerEZ::Render(RayTracing::EZ::CommandList* pCommandList, uint8_t frameIndex, RenderTarget* pRenderTarget)
+{
+	Recorder recorder(this, pCommandList, frameIndex, pRenderTarget);
+	m_scheduler.Schedule(&recorder);
+}
+
+void VoxelizerEZ::Voxelize(RayTracing::EZ::CommandList* pCommandList)
+{
+	voxelize(pCommandList);
+}
+
+void VoxelizerEZ::RayCast(RayTracing::EZ::CommandList* pCommandList, uint8_t frameIndex)
+{
+	renderRayCast(pCommandList, frameIndex);
+}
+
+const char* VoxelizerEZ::GetName() const
+{
+	return "XUSG-EZ";
+}
+
+VoxelizerEZ::Recorder::Recorder(VoxelizerEZ* pVoxelizer, RayTracing::EZ::CommandList* pCommandList,
+	uint8_t frameIndex, RenderTarget* pRenderTarget) :
+	m_pVoxelizer(pVoxelizer),
+	m_pCommandList(pCommandList),
+	m_frameIndex(frameIndex),
+	m_pRenderTarget(pRenderTarget)
+{
+}
+
+void VoxelizerEZ::Recorder::Voxelize()
+{
+	m_pVoxelizer->voxelize(m_pCommandList);
+}
+
+void VoxelizerEZ::Recorder::RayCast()
 {
-	// General matrices
-	const auto world = XMMatrixScaling(m_bound.w, m_bound.w, m_bound.w) *
-		XMMatrixTranslation(m_bound.x, m_bound.y, m_bound.z) *
-		XMMatrixScaling(m_posScale.w, m_posScale.w, m_posScale.w) *
-		XMMatrixTranslation(m_posScale.x, m_posScale.y, m_posScale.z);
-	const auto worldI = XMMatrixInverse(nullptr, world);
-	const auto worldViewProj = world * viewProj;
-
-	// Screen space matrices
-	const auto pCbPerObject = reinterpret_cast<CBPerObject*>(m_cbPerObject->Map(frameIndex));
-	pCbPerObject->localSpaceLightPt = XMVector3TransformCoord(XMVectorSet(-10.0f, 45.0f, -75.0f, 0.0f), worldI);
-	pCbPerObject->localSpaceEyePt = XMVector3TransformCoord(eyePt, worldI);
-
-	const auto mToScreen = XMMATRIX
-	(
-		0.5f * m_viewport.x, 0.0f, 0.0f, 0.0f,
-		0.0f, -0.5f * m_viewport.y, 0.0f, 0.0f,
-		0.0f, 0.0f, 1.0f, 0.0f,
-		0.5f * m_viewport.x, 0.5f * m_viewport.y, 0.0f, 1.0f
-	);
-	const auto localToScreen = XMMatrixMultiply(worldViewProj, mToScreen);
-	const auto screenToLocal = XMMatrixInverse(nullptr, localToScreen);
-	pCbPerObject->screenToLocal = XMMatrixTranspose(screenToLocal);
+	m_pVoxelizer->renderRayCast(m_pCommandList, m_frameIndex);
 }
 
-void VoxelizerEZ::Render(RayTracing::EZ::CommandList* pCommandList, uint8_t frameIndex,
-	RenderTarget* pRenderTarget, DepthStencil* pDepthStencil)
+void VoxelizerEZ::Recorder::CopyImage()
 {
-	voxelize(pCommandList, frameIndex);
-	renderRayCast(pCommandList, frameIndex, pRenderTarget, pDepthStencil);
+	m_pVoxelizer->copyImage(m_pCommandList, m_pRenderTarget);
 }
 
 bool VoxelizerEZ::createVB(RayTracing::EZ::CommandList* pCommandList, uint32_t numVert,
@@ -112,6 +113,7 @@ bool VoxelizerEZ::createVB(RayTracing::EZ::CommandList* pCommandList, uint32_t n
 	m_vertexBuffer = VertexBuffer::MakeUnique();
 	XUSG_N_RETURN(m_vertexBuffer->Create(pCommandList->GetDevice(), numVert, stride,
 		ResourceFlag::NONE, MemoryType::DEFAULT), false);
+	trackMemory(MemoryRegistry::GPU_GEOMETRY, static_cast<uint64_t>(stride) * numVert);
 	uploaders.emplace_back(Resource::MakeUnique());
 
 	return m_vertexBuffer->Upload(pCommandList->AsCommandList(),
@@ -125,19 +127,13 @@ bool VoxelizerEZ::createIB(RayTracing::EZ::CommandList* pCommandList, uint32_t n
 	m_indexBuffer = IndexBuffer::MakeUnique();
 	XUSG_N_RETURN(m_indexBuffer->Create(pCommandList->GetDevice(), byteWidth, Format::R32_UINT,
 		ResourceFlag::NONE, MemoryType::DEFAULT), false);
+	trackMemory(MemoryRegistry::GPU_GEOMETRY, byteWidth);
 	uploaders.emplace_back(Resource::MakeUnique());
 
 	return m_indexBuffer->Upload(pCommandList->AsCommandList(),
 		uploaders.back().get(), pData, byteWidth);
 }
 
-bool VoxelizerEZ::createCB(const XUSG::Device* pDevice)
-{
-	m_cbPerObject = ConstantBuffer::MakeUnique();
-
-	return m_cbPerObject->Create(pDevice, sizeof(CBPerObject) * FrameCount, FrameCount);
-}
-
 bool VoxelizerEZ::createShaders()
 {
 	auto vsIndex = 0u;
@@ -184,6 +180,7 @@ bool VoxelizerEZ::buildAccelerationStructures(RayTracing::EZ::CommandList* pComm
 	XUSG_N_RETURN(AccelerationStructure::AllocateDestBuffer(pDevice, dstBuffer.get(),
 		dstBufferSize, 1, nullptr, static_cast<uint32_t>(size(dstBufferFirstElements)),
 		dstBufferFirstElements), false);
+	trackMemory(MemoryRegistry::GPU_RAY_TRACING, dstBufferSize);
 
 	// Set dest buffer for top-level AS and bottom-level ASes
 	pCommandList->SetTLASDestination(m_topLevelAS.get(), dstBuffer, 0, 0, 0);
@@ -197,6 +194,7 @@ bool VoxelizerEZ::buildAccelerationStructures(RayTracing::EZ::CommandList* pComm
 	m_instances = Buffer::MakeUnique();
 	const BottomLevelAS* const ppBottomLevelAS[] = { m_bottomLevelAS.get() };
 	TopLevelAS::SetInstances(pDevice, m_instances.get(), 1, &ppBottomLevelAS[0], &pTransform[0]);
+	trackMemory(MemoryRegistry::GPU_RAY_TRACING, m_instances->GetWidth());
 
 	// Build bottom level AS
 	pCommandList->BuildBLAS(m_bottomLevelAS.get());
@@ -207,7 +205,7 @@ bool VoxelizerEZ::buildAccelerationStructures(RayTracing::EZ::CommandList* pComm
 	return true;
 }
 
-void VoxelizerEZ::voxelize(RayTracing::EZ::CommandList* pCommandList, uint8_t frameIndex)
+void VoxelizerEZ::voxelize(RayTracing::EZ::CommandList* pCommandList)
 {
 	// Set pipeline state
 	static const wchar_t* shaderNames[] = { RaygenShaderName, ClosestHitShaderName, MissShaderName };
@@ -220,7 +218,7 @@ void VoxelizerEZ::voxelize(RayTracing::EZ::CommandList* pCommandList, uint8_t fr
 	pCommandList->SetTopLevelAccelerationStructure(0, m_topLevelAS.get());
 
 	// Set UAV
-	const auto uav = XUSG::EZ::GetUAV(m_grids[frameIndex].get());
+	const auto uav = XUSG::EZ::GetUAV(m_grid.get());
 	pCommandList->SetResources(Shader::Stage::CS, DescriptorType::UAV, 0, 1, &uav);
 
 	// Set SRVs
@@ -233,12 +231,11 @@ void VoxelizerEZ::voxelize(RayTracing::EZ::CommandList* pCommandList, uint8_t fr
 	pCommandList->SetResources(Shader::Stage::CS, DescriptorType::SRV, 0, 1, &srvs[1], 1);
 
 	// Dispatch command
-	pCommandList->DispatchRays(GRID_SIZE, GRID_SIZE * GRID_SIZE, 1,
+	pCommandList->DispatchRays(GridSize, GridSize * GridSize, 1,
 		RaygenShaderName, &MissShaderName, 1);
 }
 
-void VoxelizerEZ::renderRayCast(RayTracing::EZ::CommandList* pCommandList, uint8_t frameIndex,
-	RenderTarget* pRenderTarget, DepthStencil* pDepthStencil)
+void VoxelizerEZ::renderRayCast(RayTracing::EZ::CommandList* pCommandList, uint8_t frameIndex)
 {
 	// set pipeline state
 	pCommandList->SetGraphicsShader(Shader::Stage::VS, m_shaders[VS_SCREEN_QUAD]);
@@ -246,16 +243,15 @@ void VoxelizerEZ::renderRayCast(RayTracing::EZ::CommandList* pCommandList, uint8
 	pCommandList->DSSetState(XUSG::Graphics::DepthStencilPreset::DEPTH_STENCIL_NONE);
 
 	// Set render target
-	auto rtv = XUSG::EZ::GetRTV(pRenderTarget);
-	auto dsv = XUSG::EZ::GetDSV(pDepthStencil);
-	pCommandList->OMSetRenderTargets(1, &rtv, &dsv);
+	auto rtv = XUSG::EZ::GetRTV(m_image.get());
+	pCommandList->OMSetRenderTargets(1, &rtv);
 
 	// Set CBV
-	const auto cbv = XUSG::EZ::GetCBV(m_cbPerObject.get());
+	const auto cbv = XUSG::EZ::GetCBV(m_cbPerObject.get(), frameIndex);
 	pCommandList->SetResources(Shader::Stage::PS, DescriptorType::CBV, 0, 1, &cbv);
 
 	// Set SRV
-	const auto srv = XUSG::EZ::GetSRV(m_grids[frameIndex].get());
+	const auto srv = XUSG::EZ::GetSRV(m_grid.get());
 	pCommandList->SetResources(Shader::Stage::PS, DescriptorType::SRV, 0, 1, &srv);
 
 	// Set sampler
@@ -274,3 +270,8 @@ void VoxelizerEZ::renderRayCast(RayTracing::EZ::CommandList* pCommandList, uint8
 	// Draw command
 	pCommandList->Draw(3, 1, 0, 0);
 }
+
+void VoxelizerEZ::copyImage(RayTracing::EZ::CommandList* pCommandList, RenderTarget* pRenderTarget)
+{
+	pCommandList->CopyResource(pRenderTarget, m_image.get());
+}
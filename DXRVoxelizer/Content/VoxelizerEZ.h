@@ -7,8 +7,10 @@
 #include "Core/XUSG.h"
 #include "Helper/XUSGRayTracing-EZ.h"
 #include "RayTracing/XUSGRayTracing.h"
+#include "VoxelizerGPU.h"
 
-class VoxelizerEZ
+class VoxelizerEZ :
+	public VoxelizerGPU
 {
 public:
 	VoxelizerEZ();
@@ -17,34 +19,52 @@ public:
 	bool Init(XUSG::RayTracing::EZ::CommandList* pCommandList, uint32_t width, uint32_t height,
 		XUSG::Format rtFormat, XUSG::Format dsFormat, std::vector<XUSG::Resource::uptr>& uploaders,
 		XUSG::RayTracing::GeometryBuffer* pGeometry, const char* fileName, const DirectX::XMFLOAT4& posScale);
+	bool Init(XUSG::RayTracing::EZ::CommandList* pCommandList, uint32_t width, uint32_t height,
+		XUSG::Format rtFormat, XUSG::Format dsFormat, std::vector<XUSG::Resource::uptr>& uploaders,
+		XUSG::RayTracing::GeometryBuffer* pGeometry, const uint8_t* pVertices, uint32_t numVertices, uint32_t stride,
+		const uint32_t* pIndices, uint32_t numIndices, const DirectX::XMFLOAT4& posScale);
 
-	void UpdateFrame(uint8_t frameIndex, DirectX::CXMVECTOR eyePt, DirectX::CXMMATRIX viewProj);
 	void Render(XUSG::RayTracing::EZ::CommandList* pCommandList, uint8_t frameIndex,
-		XUSG::RenderTarget* pRenderTarget, XUSG::DepthStencil* pDepthStencil);
+		XUSG::RenderTarget* pRenderTarget);
+
+	// Single passes, outside of the scheduler
+	void Voxelize(XUSG::RayTracing::EZ::CommandList* pCommandList);
+	void RayCast(XUSG::RayTracing::EZ::CommandList* pCommandList, uint8_t frameIndex);
 
-	static const uint8_t FrameCount = 3;
+	const char* GetName() const;
 
 protected:
-	struct CBPerObject
+	// Records the passes of the scheduler into a command list
+	class Recorder :
+		public FrameScheduler::CommandRecorder
 	{
-		DirectX::XMVECTOR localSpaceLightPt;
-		DirectX::XMVECTOR localSpaceEyePt;
-		DirectX::XMMATRIX screenToLocal;
+	public:
+		Recorder(VoxelizerEZ* pVoxelizer, XUSG::RayTracing::EZ::CommandList* pCommandList,
+			uint8_t frameIndex, XUSG::RenderTarget* pRenderTarget);
+
+		void Voxelize();
+		void RayCast();
+		void CopyImage();
+
+	protected:
+		VoxelizerEZ* m_pVoxelizer;
+		XUSG::RayTracing::EZ::CommandList* m_pCommandList;
+		uint8_t m_frameIndex;
+		XUSG::RenderTarget* m_pRenderTarget;
 	};
 
 	bool createVB(XUSG::RayTracing::EZ::CommandList* pCommandList, uint32_t numVert,
 		uint32_t stride, const uint8_t* pData, std::vector<XUSG::Resource::uptr>& uploaders);
 	bool createIB(XUSG::RayTracing::EZ::CommandList* pCommandList, uint32_t numIndices,
 		const uint32_t* pData, std::vector<XUSG::Resource::uptr>& uploaders);
-	bool createCB(const XUSG::Device* pDevice);
 	bool createShaders();
 	bool buildAccelerationStructures(XUSG::RayTracing::EZ::CommandList* pCommandList,
 		const XUSG::RayTracing::Device* pDevice,
 		XUSG::RayTracing::GeometryBuffer* pGeometries);
 
-	void voxelize(XUSG::RayTracing::EZ::CommandList* pCommandList, uint8_t frameIndex);
-	void renderRayCast(XUSG::RayTracing::EZ::CommandList* pCommandList, uint8_t frameIndex,
-		XUSG::RenderTarget* pRenderTarget, XUSG::DepthStencil* pDepthStencil);
+	void voxelize(XUSG::RayTracing::EZ::CommandList* pCommandList);
+	void renderRayCast(XUSG::RayTracing::EZ::CommandList* pCommandList, uint8_t frameIndex);
+	void copyImage(XUSG::RayTracing::EZ::CommandList* pCommandList, XUSG::RenderTarget* pRenderTarget);
 
 	XUSG::RayTracing::BottomLevelAS::uptr m_bottomLevelAS;
 	XUSG::RayTracing::TopLevelAS::uptr m_topLevelAS;
@@ -52,10 +72,6 @@ protected:
 	XUSG::VertexBuffer::uptr	m_vertexBuffer;
 	XUSG::IndexBuffer::uptr		m_indexBuffer;
 
-	XUSG::ConstantBuffer::uptr	m_cbPerObject;
-
-	XUSG::Texture3D::uptr		m_grids[FrameCount];
-
 	XUSG::Buffer::uptr			m_instances;
 
 	// Shader tables
@@ -75,8 +91,4 @@ protected:
 
 	XUSG::ShaderLib::uptr	m_shaderLib;
 	XUSG::Blob m_shaders[NUM_SHADER];
-
-	DirectX::XMFLOAT2		m_viewport;
-	DirectX::XMFLOAT4		m_bound;
-	DirectX::XMFLOAT4		m_posScale;
 };
@@ -0,0 +1,129 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <cfloat>
+#include "VoxelizerGPU.h"
+
+using namespace std;
+using namespace DirectX;
+using namespace XUSG;
+
+VoxelizerGPU::VoxelizerGPU()
+{
+}
+
+VoxelizerGPU::~VoxelizerGPU()
+{
+}
+
+void VoxelizerGPU::UpdateFrame(uint8_t frameIndex, CXMVECTOR eyePt, CXMMATRIX viewProj)
+{
+	// General matrices
+	const auto world = XMMatrixScaling(m_bound.w, m_bound.w, m_bound.w) *
+		XMMatrixTranslation(m_bound.x, m_bound.y, m_bound.z) *
+		XMMatrixScaling(m_posScale.w, m_posScale.w, m_posScale.w) *
+		XMMatrixTranslation(m_posScale.x, m_posScale.y, m_posScale.z);
+	const auto worldI = XMMatrixInverse(nullptr, world);
+	const auto worldViewProj = world * viewProj;
+
+	// Screen space matrices
+	CBPerObject cbPerObject;
+	cbPerObject.localSpaceLightPt = XMVector3TransformCoord(XMVectorSet(-10.0f, 45.0f, -75.0f, 0.0f), worldI);
+	cbPerObject.localSpaceEyePt = XMVector3TransformCoord(eyePt, worldI);
+
+	const auto mToScreen = XMMATRIX
+	(
+		0.5f * m_viewport.x, 0.0f, 0.0f, 0.0f,
+		0.0f, -0.5f * m_viewport.y, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.5f * m_viewport.x, 0.5f * m_viewport.y, 0.0f, 1.0f
+	);
+	const auto localToScreen = XMMatrixMultiply(worldViewProj, mToScreen);
+	const auto screenToLocal = XMMatrixInverse(nullptr, localToScreen);
+	cbPerObject.screenToLocal = XMMatrixTranspose(screenToLocal);
+
+	// The constants cover everything the ray cast sees of the camera and the light
+	*reinterpret_cast<CBPerObject*>(m_cbPerObject->Map(frameIndex)) = cbPerObject;
+	m_scheduler.SetView(&cbPerObject, sizeof(cbPerObject));
+}
+
+void VoxelizerGPU::SetPosScale(const XMFLOAT4& posScale)
+{
+	m_posScale = posScale;
+}
+
+bool VoxelizerGPU::ReadBackGrid(CommandList* pCommandList, Buffer* pReadBuffer, uint32_t* pRowPitch)
+{
+	return m_grid->ReadBack(pCommandList, pReadBuffer, pRowPitch);
+}
+
+bool VoxelizerGPU::ReadBackImage(CommandList* pCommandList, Buffer* pReadBuffer, uint32_t* pRowPitch)
+{
+	return m_image->ReadBack(pCommandList, pReadBuffer, pRowPitch);
+}
+
+const FrameScheduler& VoxelizerGPU::GetScheduler() const
+{
+	return m_scheduler;
+}
+
+const XMFLOAT4& VoxelizerGPU::GetBound() const
+{
+	return m_bound;
+}
+
+bool VoxelizerGPU::createResources(const Device* pDevice, uint32_t width, uint32_t height, Format rtFormat,
+	const uint8_t* pVertices, uint32_t numVertices, uint32_t stride, const XMFLOAT4& posScale)
+{
+	m_viewport.x = static_cast<float>(width);
+	m_viewport.y = static_cast<float>(height);
+	m_posScale = posScale;
+
+	// Extract boundary
+	auto aabbMin = XMVectorReplicate(FLT_MAX);
+	auto aabbMax = XMVectorReplicate(-FLT_MAX);
+	for (auto i = 0u; i < numVertices; ++i)
+	{
+		const auto pos = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&pVertices[static_cast<size_t>(stride) * i]));
+		aabbMin = XMVectorMin(aabbMin, pos);
+		aabbMax = XMVectorMax(aabbMax, pos);
+	}
+
+	XMFLOAT3 ext;
+	XMStoreFloat3(&ext, aabbMax - aabbMin);
+	XMStoreFloat4(&m_bound, (aabbMax + aabbMin) / 2.0f);
+	m_bound.w = (max)(ext.x, (max)(ext.y, ext.z)) / 2.0f;
+
+	XUSG_N_RETURN(createCB(pDevice), false);
+
+	// Create the output grid, which every frame in flight reads, and the image that
+	// the back buffers are copied from
+	m_grid = Texture3D::MakeUnique();
+	XUSG_N_RETURN(m_grid->Create(pDevice, GridSize, GridSize, GridSize, Format::R10G10B10A2_UNORM,
+		ResourceFlag::ALLOW_UNORDERED_ACCESS), false);
+	m_image = RenderTarget::MakeUnique();
+	XUSG_N_RETURN(m_image->Create(pDevice, width, height, rtFormat), false);
+	trackMemory(MemoryRegistry::GPU_TEXTURE, sizeof(uint32_t) * GridSize * GridSize * GridSize);
+	trackMemory(MemoryRegistry::GPU_TEXTURE, sizeof(uint32_t) * width * height);	// 8-bit RGBA or 10-bit RGB formats
+
+	// The mesh is fixed after loading, so the grid only depends on its bound and size
+	const struct { XMFLOAT4 Bound; uint32_t GridSize; } geometry = { m_bound, GridSize };
+	m_scheduler.SetGeometry(&geometry, sizeof(geometry));
+
+	return true;
+}
+
+bool VoxelizerGPU::createCB(const Device* pDevice)
+{
+	m_cbPerObject = ConstantBuffer::MakeUnique();
+	XUSG_N_RETURN(m_cbPerObject->Create(pDevice, sizeof(CBPerObject) * FrameCount, FrameCount), false);
+	trackMemory(MemoryRegistry::GPU_CONSTANT, sizeof(CBPerObject) * FrameCount);
+
+	return true;
+}
+
+void VoxelizerGPU::trackMemory(MemoryRegistry::Subsystem subsystem, uint64_t bytes)
+{
+	m_memory.emplace_back(subsystem, bytes);
+}
@@ -0,0 +1,63 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "Core/XUSG.h"
+#include "FrameScheduler.h"
+#include "MemoryRegistry.h"
+
+//--------------------------------------------------------------------------------------
+// State and frame logic shared by Voxelizer and VoxelizerEZ, which differ only in the
+// command list that they record into: the bound of the mesh, the per-frame constants,
+// the grid, the persistent image and the scheduling of their passes
+//--------------------------------------------------------------------------------------
+class VoxelizerGPU
+{
+public:
+	VoxelizerGPU();
+	virtual ~VoxelizerGPU();
+
+	void UpdateFrame(uint8_t frameIndex, DirectX::CXMVECTOR eyePt, DirectX::CXMMATRIX viewProj);
+
+	void SetPosScale(const DirectX::XMFLOAT4& posScale);
+
+	// Copy the grid or the image into a read-back buffer, for VoxelizerBackendGPU
+	bool ReadBackGrid(XUSG::CommandList* pCommandList, XUSG::Buffer* pReadBuffer, uint32_t* pRowPitch);
+	bool ReadBackImage(XUSG::CommandList* pCommandList, XUSG::Buffer* pReadBuffer, uint32_t* pRowPitch);
+
+	const FrameScheduler& GetScheduler() const;
+	const DirectX::XMFLOAT4& GetBound() const;
+	virtual const char* GetName() const = 0;
+
+	static const uint8_t FrameCount = 3;
+	static const uint32_t GridSize = 64;
+
+protected:
+	struct CBPerObject
+	{
+		DirectX::XMVECTOR localSpaceLightPt;
+		DirectX::XMVECTOR localSpaceEyePt;
+		DirectX::XMMATRIX screenToLocal;
+	};
+
+	// Everything of Init that does not record commands, after the mesh is loaded
+	bool createResources(const XUSG::Device* pDevice, uint32_t width, uint32_t height, XUSG::Format rtFormat,
+		const uint8_t* pVertices, uint32_t numVertices, uint32_t stride, const DirectX::XMFLOAT4& posScale);
+	bool createCB(const XUSG::Device* pDevice);
+	void trackMemory(MemoryRegistry::Subsystem subsystem, uint64_t bytes);
+
+	XUSG::ConstantBuffer::uptr	m_cbPerObject;
+
+	XUSG::Texture3D::uptr		m_grid;
+	XUSG::RenderTarget::uptr	m_image;
+
+	DirectX::XMFLOAT2			m_viewport;
+	DirectX::XMFLOAT4			m_bound;
+	DirectX::XMFLOAT4			m_posScale;
+
+	FrameScheduler				m_scheduler;
+
+	std::vector<MemoryRegistry::Allocation> m_memory;	// Of the GPU resources, until destruction
+};
@@ -10,6 +10,7 @@
 //*********************************************************
 
 #include "DXRVoxelizer.h"
+#include "Profiler.h"
 #include "stb_image_write.h"
 
 using namespace std;
@@ -35,6 +36,7 @@ DXRVoxelizer::DXRVoxelizer(uint32_t width, uint32_t height, std::wstring name) :
 	m_tracking(false),
 	m_meshFileName("Assets/bunny.obj"),
 	m_meshPosScale(0.0f, 0.0f, 0.0f, 1.0f),
+	m_readBufferMemory(MemoryRegistry::GPU_READBACK),
 	m_screenShot(0)
 {
 #if defined (_DEBUG)
@@ -198,6 +200,11 @@ void DXRVoxelizer::LoadAssets()
 		m_depth->GetFormat(), uploaders, &geometries[1], m_meshFileName.c_str(),
 		m_meshPosScale), ThrowIfFailed(E_FAIL));
 
+	// The upload buffers are released with the uploaders, once the copies complete
+	uint64_t uploadSize = 0;
+	for (const auto& uploader : uploaders) uploadSize += uploader->GetWidth();
+	const MemoryRegistry::Allocation uploadMemory(MemoryRegistry::GPU_UPLOAD, uploadSize);
+
 	// Close the command list and execute it to begin the initial GPU setup.
 	XUSG_N_RETURN(pCommandList->Close(), ThrowIfFailed(E_FAIL));
 	m_commandQueue->ExecuteCommandList(pCommandList);
@@ -232,6 +239,12 @@ void DXRVoxelizer::LoadAssets()
 	const auto eyePt = XMLoadFloat3(&m_eyePt);
 	const auto view = XMMatrixLookAtLH(eyePt, focusPt, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
 	XMStoreFloat4x4(&m_view, view);
+
+	// In the order of FrameStage
+	m_frameStats.AddStage("frame");
+	m_frameStats.AddStage("update");
+	m_frameStats.AddStage("record");
+	m_frameStats.AddStage("present");
 }
 
 // Update frame-based values.
@@ -241,6 +254,8 @@ void DXRVoxelizer::OnUpdate()
 	static auto time = 0.0, pauseTime = 0.0;
 
 	m_timer.Tick();
+	if (m_timer.GetFrameCount() > 1) m_frameStats.Record(STAGE_FRAME, m_timer.GetRawElapsedSeconds());
+	const FrameStats::Scope stageScope(m_frameStats, STAGE_UPDATE);
 	const auto totalTime = CalculateFrameStats();
 	pauseTime = m_isPaused ? totalTime - time : pauseTime;
 	time = totalTime - pauseTime;
@@ -250,20 +265,25 @@ void DXRVoxelizer::OnUpdate()
 	const auto view = XMLoadFloat4x4(&m_view);
 	const auto proj = XMLoadFloat4x4(&m_proj);
 
-	if (m_useEZ) m_voxelizerEZ->UpdateFrame(m_frameIndex, eyePt, view * proj);
-	else m_voxelizer->UpdateFrame(m_frameIndex, eyePt, view * proj);
+	GetVoxelizer()->UpdateFrame(m_frameIndex, eyePt, view * proj);
 }
 
 // Render the scene.
 void DXRVoxelizer::OnRender()
 {
 	// Record all the commands we need to render the scene into the command list.
-	PopulateCommandList();
+	{
+		PROFILE_ZONE("record commands");
+		const FrameStats::Scope stageScope(m_frameStats, STAGE_RECORD);
+		PopulateCommandList();
+	}
 
 	// Execute the command list.
 	m_commandQueue->ExecuteCommandList(m_commandList.get());
 
-	// Present the frame.
+	// Present the frame, and wait until a frame in flight is free.
+	PROFILE_ZONE("present");
+	const FrameStats::Scope stageScope(m_frameStats, STAGE_PRESENT);
 	XUSG_N_RETURN(m_swapChain->Present(0, PresentFlag::ALLOW_TEARING), ThrowIfFailed(E_FAIL));
 
 	MoveToNextFrame();
@@ -276,6 +296,8 @@ void DXRVoxelizer::OnDestroy()
 	WaitForGpu();
 
 	CloseHandle(m_fenceEvent);
+
+	OutputDebugStringA(MemoryRegistry::GetReport().c_str());
 }
 
 // User hot-key interactions.
@@ -289,6 +311,13 @@ void DXRVoxelizer::OnKeyUp(uint8_t key)
 	case VK_F1:
 		m_showFPS = !m_showFPS;
 		break;
+	case VK_F10:
+		Profiler::WriteChromeTrace("DXRVoxelizer.json");
+		break;
+	case VK_F9:
+		m_frameStats.WriteCSV("DXRVoxelizer_frames.csv");
+		m_frameStats.WriteJSON("DXRVoxelizer_frames.json");
+		break;
 	case VK_F11:
 		m_screenShot = 1;
 		break;
@@ -427,13 +456,14 @@ void DXRVoxelizer::PopulateCommandList()
 
 		const auto dsv = XUSG::EZ::GetDSV(m_depth.get());
 		pCommandList->ClearDepthStencilView(dsv, ClearFlag::DEPTH, 1.0f);
-		m_voxelizerEZ->Render(pCommandList, m_frameIndex, pRenderTarget, m_depth.get());
+		m_voxelizerEZ->Render(pCommandList, m_frameIndex, pRenderTarget);
 
 		// Screen-shot helper
 		if (m_screenShot == 1)
 		{
 			if (!m_readBuffer) m_readBuffer = Buffer::MakeUnique();
 			pRenderTarget->ReadBack(pCommandList->AsCommandList(), m_readBuffer.get(), &m_rowPitch);
+			m_readBufferMemory.Set(m_readBuffer->GetWidth());
 			m_screenShot = 2;
 		}
 
@@ -454,19 +484,17 @@ void DXRVoxelizer::PopulateCommandList()
 		};
 		pCommandList->SetDescriptorHeaps(static_cast<uint32_t>(size(descriptorHeaps)), descriptorHeaps);
 
-		ResourceBarrier barrier;
-		auto numBarriers = pRenderTarget->SetBarrier(&barrier, ResourceState::RENDER_TARGET);
-		pCommandList->Barrier(numBarriers, &barrier);
-
 		// Record commands.
 		//const float clearColor[] = { 0.0f, 0.2f, 0.4f, 1.0f };
 		//m_commandList.ClearRenderTargetView(*m_rtvTables[m_frameIndex], clearColor);
 		pCommandList->ClearDepthStencilView(m_depth->GetDSV(), ClearFlag::DEPTH, 1.0f);
 
-		m_voxelizer->Render(pCommandList, m_frameIndex, pRenderTarget->GetRTV(), m_depth->GetDSV());
+		// The voxelizer copies its image into the back buffer
+		m_voxelizer->Render(pCommandList, m_frameIndex, pRenderTarget);
 
 		// Indicate that the back buffer will now be used to present.
-		numBarriers = pRenderTarget->SetBarrier(&barrier, ResourceState::PRESENT);
+		ResourceBarrier barrier;
+		const auto numBarriers = pRenderTarget->SetBarrier(&barrier, ResourceState::PRESENT);
 		pCommandList->Barrier(numBarriers, &barrier);
 
 		// Screen-shot helper
@@ -474,6 +502,7 @@ void DXRVoxelizer::PopulateCommandList()
 		{
 			if (!m_readBuffer) m_readBuffer = Buffer::MakeUnique();
 			pRenderTarget->ReadBack(pCommandList, m_readBuffer.get(), &m_rowPitch);
+			m_readBufferMemory.Set(m_readBuffer->GetWidth());
 			m_screenShot = 2;
 		}
 
@@ -533,6 +562,8 @@ void DXRVoxelizer::SaveImage(char const* fileName, Buffer* pImageBuffer, uint32_
 	assert(comp == 3 || comp == 4);
 	const auto pData = static_cast<const uint8_t*>(pImageBuffer->Map(nullptr));
 
+	PROFILE_ZONE("PNG encode");
+
 	//stbi_write_png_compression_level = 1024;
 	vector<uint8_t> imageData(comp * w * h);
 	const auto sw = rowPitch / 4; // Byte to pixel
@@ -569,10 +600,20 @@ double DXRVoxelizer::CalculateFrameStats(float* pTimeStep)
 
 		wstringstream windowText;
 		windowText << L"    fps: ";
-		if (m_showFPS) windowText << setprecision(2) << fixed << fps;
+		if (m_showFPS)
+		{
+			// The tail of the window shows the stalls that the average hides
+			const auto frameTimes = m_frameStats.GetSummary(STAGE_FRAME);
+			windowText << setprecision(2) << fixed << fps;
+			windowText << L"    p99: " << frameTimes.P99 * 1000.0 << L" ms";
+			windowText << L"    max: " << frameTimes.Max * 1000.0 << L" ms";
+		}
 		else windowText << L"[F1]";
 
-		windowText << L"    [X] " << (m_useEZ ? "XUSG-EZ" : "XUSGCore");
+		windowText << L"    mem: " << setprecision(1) << fixed << MemoryRegistry::GetTotalUsage().Live / 1048576.0 << L" MB";
+		windowText << L"    [X] " << GetVoxelizer()->GetName();
+		windowText << L"    [F9] frame stats";
+		windowText << L"    [F10] trace";
 		windowText << L"    [F11] screen shot";
 
 		SetCustomWindowText(windowText.str().c_str());
@@ -583,6 +624,12 @@ double DXRVoxelizer::CalculateFrameStats(float* pTimeStep)
 	return totalTime;
 }
 
+// The voxelizer of the code path in use
+VoxelizerGPU* DXRVoxelizer::GetVoxelizer() const
+{
+	return m_useEZ ? static_cast<VoxelizerGPU*>(m_voxelizerEZ.get()) : m_voxelizer.get();
+}
+
 //--------------------------------------------------------------------------------------
 // Ray tracing
 //--------------------------------------------------------------------------------------
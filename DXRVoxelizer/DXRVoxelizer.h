@@ -12,7 +12,9 @@
 #pragma once
 
 #include "DXFramework.h"
-#include "StepTimer.h"
+#include "FrameTimer.h"
+#include "FrameStats.h"
+#include "MemoryRegistry.h"
 #include "Voxelizer.h"
 #include "VoxelizerEZ.h"
 
@@ -52,6 +54,14 @@ private:
 		DEVICE_WARP
 	};
 
+	enum FrameStage : uint8_t
+	{
+		STAGE_FRAME,
+		STAGE_UPDATE,
+		STAGE_RECORD,
+		STAGE_PRESENT
+	};
+
 	static const uint8_t FrameCount = Voxelizer::FrameCount;
 
 	// Pipeline objects.
@@ -88,7 +98,8 @@ private:
 
 	// Application state
 	DeviceType	m_deviceType;
-	StepTimer	m_timer;
+	FrameTimer	m_timer;
+	FrameStats	m_frameStats;
 	bool		m_useEZ;
 	bool		m_showFPS;
 	bool		m_isPaused;
@@ -103,6 +114,7 @@ private:
 
 	// Screen-shot helpers and state
 	XUSG::Buffer::uptr	m_readBuffer;
+	MemoryRegistry::Allocation m_readBufferMemory;
 	uint32_t			m_rowPitch;
 	uint8_t				m_screenShot;
 
@@ -114,6 +126,7 @@ private:
 	void SaveImage(char const* fileName, XUSG::Buffer* pImageBuffer,
 		uint32_t w, uint32_t h, uint32_t rowPitch, uint8_t comp = 3);
 	double CalculateFrameStats(float* fTimeStep = nullptr);
+	VoxelizerGPU* GetVoxelizer() const;
 
 	// Ray tracing
 	void EnableDirectXRaytracing(IDXGIAdapter1* adapter);
@@ -2,12 +2,48 @@
 // Copyright (c) XU, Tianchen. All rights reserved.
 //--------------------------------------------------------------------------------------
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "Profiler.h"
 #include "XUSGObjLoader.h"
 
+// Other compilers lack the secure CRT of MSVC; of the formats read, only %s takes a size
+// argument in fscanf_s
+#if !defined(_MSC_VER)
+#define fscanf_s fscanf
+#define sscanf_s sscanf
+#endif
+
+namespace
+{
+	FILE* openFile(const char* fileName, const char* mode)
+	{
+#if defined(_MSC_VER)
+		FILE* pFile;
+
+		return fopen_s(&pFile, fileName, mode) ? nullptr : pFile;
+#else
+		return fopen(fileName, mode);
+#endif
+	}
+
+	// Reads a whitespace-delimited token of at most 255 characters
+	int scanToken(FILE* pFile, char(&buffer)[256])
+	{
+#if defined(_MSC_VER)
+		return fscanf_s(pFile, "%255s", buffer, static_cast<uint32_t>(sizeof(buffer)));
+#else
+		return fscanf(pFile, "%255s", buffer);
+#endif
+	}
+}
+
 using namespace std;
 using namespace XUSG;
 
-ObjLoader::ObjLoader()
+ObjLoader::ObjLoader() :
+	m_memory(MemoryRegistry::MESH)
 {
 }
 
@@ -17,9 +53,8 @@ ObjLoader::~ObjLoader()
 
 bool ObjLoader::Import(const char* pszFilename, bool needNorm, bool needAABB, bool forDX, bool swapYZ)
 {
-	FILE* pFile;
-	fopen_s(&pFile, pszFilename, "r");
-
+	PROFILE_ZONE("OBJ import");
+	const auto pFile = openFile(pszFilename, "r");
 	if (!pFile) return false;
 
 	m_stride = sizeof(float3);
@@ -27,14 +62,28 @@ bool ObjLoader::Import(const char* pszFilename, bool needNorm, bool needAABB, bo
 
 	// Import the OBJ file.
 	uint32_t numTexc, numNorm;
-	importGeometryFirstPass(pFile, numTexc, numNorm);
+	{
+		PROFILE_ZONE("OBJ first pass");
+		importGeometryFirstPass(pFile, numTexc, numNorm);
+	}
 	rewind(pFile);
-	importGeometrySecondPass(pFile, numTexc, numNorm, forDX, swapYZ);
+	{
+		PROFILE_ZONE("OBJ second pass");
+		importGeometrySecondPass(pFile, numTexc, numNorm, forDX, swapYZ);
+	}
 	fclose(pFile);
 
+	// A file without geometry, e.g. not an OBJ, has nothing to post-process
+	if (m_vertices.empty() || m_indices.empty()) return false;
+
 	// Perform post import tasks.
-	if (needNorm && !numNorm) recomputeNormals();
+	if (needNorm && !numNorm)
+	{
+		PROFILE_ZONE("OBJ normals");
+		recomputeNormals();
+	}
 	if (needAABB) computeAABB();
+	m_memory.Set(m_vertices.capacity() + sizeof(uint32_t) * m_indices.capacity());
 
 	return true;
 }
@@ -81,12 +130,12 @@ void ObjLoader::importGeometryFirstPass(FILE* pFile, uint32_t& numTexc, uint32_t
 	numTexc = 0;
 	numNorm = 0;
 
-	while (fscanf_s(pFile, "%s", buffer, static_cast<uint32_t>(sizeof(buffer))) != EOF)
+	while (scanToken(pFile, buffer) != EOF)
 	{
 		switch (buffer[0])
 		{
 		case 'f':   // v, v//vn, v/vt, v/vt/vn.
-			fscanf_s(pFile, "%s", buffer, static_cast<uint32_t>(sizeof(buffer)));
+			scanToken(pFile, buffer);
 
 			if (strstr(buffer, "//")) // v//vn
 			{
@@ -175,7 +224,7 @@ void ObjLoader::importGeometrySecondPass(FILE* pFile, uint32_t numTexc, uint32_t
 	if (numNorm) nIndices.resize(m_indices.size());
 	normals.reserve(numNorm);
 
-	while (fscanf_s(pFile, "%s", buffer, static_cast<uint32_t>(sizeof(buffer))) != EOF)
+	while (scanToken(pFile, buffer) != EOF)
 	{
 		switch (buffer[0])
 		{
@@ -230,7 +279,7 @@ void ObjLoader::importGeometrySecondPass(FILE* pFile, uint32_t numTexc, uint32_t
 void ObjLoader::loadIndices(FILE* pFile, uint32_t& numTri, uint32_t numTexc,
 	uint32_t numNorm, vector<uint32_t>& nIndices, vector<uint32_t>& tIndices)
 {
-	int64_t vi;
+	long long vi;	// As %lld on every platform
 	uint32_t v[3] = { 0 };
 	uint32_t vt[3] = { 0 };
 	uint32_t vn[3] = { 0 };
@@ -4,6 +4,11 @@
 
 #pragma once
 
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "MemoryRegistry.h"
+
 namespace XUSG
 {
 	class ObjLoader
@@ -57,6 +62,7 @@ namespace XUSG
 
 		std::vector<uint8_t>	m_vertices;
 		std::vector<uint32_t>	m_indices;
+		MemoryRegistry::Allocation m_memory;
 
 		uint32_t	m_stride;
 
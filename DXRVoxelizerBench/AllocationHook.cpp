@@ -0,0 +1,87 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <atomic>
+#include <new>
+#include "Bench.h"
+
+using namespace std;
+
+//--------------------------------------------------------------------------------------
+// Replacements of the global operator new and delete, which count on top of malloc and
+// free. They take the place of the default ones throughout the executable, so every
+// suite pays 2 relaxed atomic adds per allocation. Over-aligned new and the allocations
+// of the C runtime itself, e.g. the buffer of a FILE, are not seen.
+//--------------------------------------------------------------------------------------
+namespace
+{
+	atomic<uint64_t> g_numAllocations(0);
+	atomic<uint64_t> g_numBytes(0);
+
+	void* allocate(size_t size)
+	{
+		g_numAllocations.fetch_add(1, memory_order_relaxed);
+		g_numBytes.fetch_add(size, memory_order_relaxed);
+
+		return malloc(size ? size : 1);
+	}
+}
+
+Bench::AllocationCounts Bench::GetAllocationCounts()
+{
+	return { g_numAllocations.load(memory_order_relaxed), g_numBytes.load(memory_order_relaxed) };
+}
+
+void* operator new(size_t size)
+{
+	const auto p = allocate(size);
+	if (!p) throw bad_alloc();
+
+	return p;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept
+{
+	return allocate(size);
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept
+{
+	return allocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, const nothrow_t&) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p, const nothrow_t&) noexcept
+{
+	free(p);
+}
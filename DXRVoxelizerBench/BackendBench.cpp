@@ -0,0 +1,91 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <vector>
+#include "Bench.h"
+#include "Optional/XUSGObjLoader.h"
+#include "VoxelizerBackendCPU.h"
+
+using namespace std;
+
+int RunBackendBench(int argc, char* argv[])
+{
+	const auto meshFileName = Bench::ParseString(argc, argv, "mesh", "Assets/bunny.obj");
+	const auto size = Bench::ParseUInt(argc, argv, "size", 128);
+	const auto width = Bench::ParseUInt(argc, argv, "width", 640);
+	const auto height = Bench::ParseUInt(argc, argv, "height", 360);
+	const auto threads = Bench::ParseUInt(argc, argv, "threads", 0);
+	const auto repeats = Bench::ParseUInt(argc, argv, "repeats", 3);
+
+	XUSG::ObjLoader objLoader;
+	if (!objLoader.Import(meshFileName, true, true))
+	{
+		fprintf(stderr, "Failed to load %s.\n", meshFileName);
+
+		return 1;
+	}
+
+	// The backends available in this build; the first is the reference of the others
+	VoxelizerBackendCPU perVoxel(VoxelizerCPU::PER_VOXEL, threads);
+	VoxelizerBackendCPU column(VoxelizerCPU::COLUMN, threads);
+	VoxelizerBackend* const backends[] = { &perVoxel, &column };
+	const auto numBackends = static_cast<uint32_t>(sizeof(backends) / sizeof(backends[0]));
+
+	double times[numBackends];
+	const auto fastest = VoxelizerBackend::SelectFastest(backends, numBackends, objLoader.GetVertices(),
+		objLoader.GetNumVertices(), objLoader.GetVertexStride(), objLoader.GetIndices(), objLoader.GetNumIndices(),
+		size, times);
+	if (fastest >= numBackends)
+	{
+		fprintf(stderr, "No backend voxelized %s.\n", meshFileName);
+
+		return 1;
+	}
+
+	const float posScale[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	const Float3 eyePt(8.0f, 12.0f, -14.0f);
+	const auto view = LookAtLH(eyePt, Float3(0.0f, 4.0f, 0.0f), Float3(0.0f, 1.0f, 0.0f));
+	const auto proj = PerspectiveFovLH(0.785398163f, width / static_cast<float>(height), 1.0f, 1000.0f);
+
+	printf("Voxelizer backends, %s at %u^3, %ux%u image, best of %u; fastest: %s\n\n", meshFileName, size,
+		width, height, repeats, backends[fastest]->GetName());
+	printf("%-16s %12s %12s %12s %12s %10s\n", "Backend", "Select ms", "Voxelize ms", "Diff voxels", "Render ms", "PSNR (dB)");
+
+	VoxelGrid reference, grid;
+	vector<uint8_t> referenceImage(static_cast<size_t>(width) * height * 4), image(referenceImage.size());
+	for (auto i = 0u; i < numBackends; ++i)
+	{
+		const auto pBackend = backends[i];
+		if (times[i] < 0.0)
+		{
+			printf("%-16s %12s\n", pBackend->GetName(), "failed");
+			continue;
+		}
+
+		auto& target = i ? grid : reference;
+		auto& targetImage = i ? image : referenceImage;
+		auto isDone = true;
+		const auto tVoxelize = Bench::Measure(repeats, [&]() { isDone = pBackend->Voxelize(size) && isDone; });
+		const auto tRender = Bench::Measure(repeats, [&]()
+		{
+			isDone = pBackend->RenderImage(targetImage.data(), width, height, eyePt, view * proj, posScale) && isDone;
+		});
+		if (!isDone || !pBackend->ReadBack(target))
+		{
+			printf("%-16s %12s\n", pBackend->GetName(), "failed");
+			continue;
+		}
+
+		size_t numDiffs = 0;
+		for (auto z = 0u; z < size && reference.GetNumVoxels(); ++z)
+			for (auto y = 0u; y < size; ++y)
+				for (auto x = 0u; x < size; ++x)
+					numDiffs += target.Get(x, y, z) != reference.Get(x, y, z) ? 1 : 0;
+
+		printf("%-16s %12.2f %12.2f %12zu %12.2f %10.2f\n", pBackend->GetName(), times[i] * 1.0e3, tVoxelize * 1.0e3,
+			numDiffs, tRender * 1.0e3, Bench::ComputePSNR(targetImage.data(), referenceImage.data(), image.size() / 4));
+	}
+
+	return 0;
+}
@@ -0,0 +1,207 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+//--------------------------------------------------------------------------------------
+// Shared helpers of the benchmark suites
+//--------------------------------------------------------------------------------------
+namespace Bench
+{
+	// Best-of-N wall time in seconds; the minimum is the most stable estimate
+	// for short CPU-bound kernels.
+	template<typename Fn>
+	double Measure(uint32_t numRepeats, Fn fn)
+	{
+		auto best = 1.0e30;
+		for (auto i = 0u; i < numRepeats; ++i)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			fn();
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			best = (std::min)(best, elapsed.count());
+		}
+
+		return best;
+	}
+
+	// Keeps results alive so that the optimizer cannot drop the measured work
+	inline void DoNotOptimize(double value)
+	{
+		static volatile double sink = 0.0;
+		sink = sink + value;
+	}
+
+	// PSNR in dB over the color channels of two RGBA8 images, infinite if identical; the
+	// alpha is coverage and not compared
+	inline double ComputePSNR(const uint8_t* pImage, const uint8_t* pReference, size_t numPixels, int* pMaxDiff = nullptr)
+	{
+		auto maxDiff = 0;
+		auto sqErr = 0.0;
+		for (size_t i = 0; i < numPixels * 4; ++i)
+		{
+			if (i % 4 == 3) continue;
+			const auto diff = abs(pImage[i] - pReference[i]);
+			maxDiff = (std::max)(maxDiff, diff);
+			sqErr += diff * diff;
+		}
+		if (pMaxDiff) *pMaxDiff = maxDiff;
+
+		const auto mse = sqErr / (numPixels * 3.0);
+
+		return mse > 0.0 ? 10.0 * log10(255.0 * 255.0 / mse) : INFINITY;
+	}
+
+	// Mean SSIM of the luminance over 8x8 windows at a stride of 4, 1 if identical; it
+	// weighs structure, so a shifted edge costs more than the same error spread as noise
+	inline double ComputeSSIM(const uint8_t* pImage, const uint8_t* pReference, uint32_t width, uint32_t height)
+	{
+		const auto getLuma = [](const uint8_t* p) { return 0.299 * p[0] + 0.587 * p[1] + 0.114 * p[2]; };
+		const auto c1 = (0.01 * 255.0) * (0.01 * 255.0);
+		const auto c2 = (0.03 * 255.0) * (0.03 * 255.0);
+
+		auto sum = 0.0;
+		auto numWindows = 0u;
+		for (auto y = 0u; y + 8 <= height; y += 4)
+			for (auto x = 0u; x + 8 <= width; x += 4)
+			{
+				auto meanA = 0.0, meanB = 0.0, sqA = 0.0, sqB = 0.0, prod = 0.0;
+				for (auto j = 0u; j < 8; ++j)
+					for (auto i = 0u; i < 8; ++i)
+					{
+						const auto offset = (static_cast<size_t>(width) * (y + j) + x + i) * 4;
+						const auto a = getLuma(&pImage[offset]);
+						const auto b = getLuma(&pReference[offset]);
+						meanA += a;
+						meanB += b;
+						sqA += a * a;
+						sqB += b * b;
+						prod += a * b;
+					}
+				meanA /= 64.0;
+				meanB /= 64.0;
+				const auto varA = sqA / 64.0 - meanA * meanA;
+				const auto varB = sqB / 64.0 - meanB * meanB;
+				const auto covar = prod / 64.0 - meanA * meanB;
+				sum += (2.0 * meanA * meanB + c1) * (2.0 * covar + c2) /
+					((meanA * meanA + meanB * meanB + c1) * (varA + varB + c2));
+				++numWindows;
+			}
+
+		return numWindows ? sum / numWindows : 1.0;
+	}
+
+	inline uint32_t ParseUInt(int argc, char* argv[], const char* name, uint32_t defaultValue)
+	{
+		for (auto i = 1; i + 1 < argc; ++i)
+			if (argv[i][0] == '-' && !strcmp(&argv[i][1], name))
+				return static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+
+		return defaultValue;
+	}
+
+	inline const char* ParseString(int argc, char* argv[], const char* name, const char* defaultValue)
+	{
+		for (auto i = 1; i + 1 < argc; ++i)
+			if (argv[i][0] == '-' && !strcmp(&argv[i][1], name)) return argv[i + 1];
+
+		return defaultValue;
+	}
+
+	// Comma-separated values, e.g. -sizes 64,128,256
+	inline std::vector<std::string> ParseList(int argc, char* argv[], const char* name, const char* defaultValue)
+	{
+		std::vector<std::string> values;
+		const std::string list = ParseString(argc, argv, name, defaultValue);
+		for (size_t begin = 0, end; begin <= list.size(); begin = end + 1)
+		{
+			end = (std::min)(list.find(',', begin), list.size());
+			if (end > begin) values.emplace_back(list, begin, end - begin);
+		}
+
+		return values;
+	}
+
+	// Heap allocations through operator new since the start of the process, counted by the
+	// replacement operators in AllocationHook.cpp
+	struct AllocationCounts
+	{
+		uint64_t NumAllocations;
+		uint64_t NumBytes;
+	};
+
+	AllocationCounts GetAllocationCounts();
+
+	// High-water mark of the resident memory of the process, in bytes
+	inline uint64_t GetPeakRSS()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters = { sizeof(counters) };
+
+		return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.PeakWorkingSetSize : 0;
+#else
+		rusage usage = {};
+		getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+		return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+		return static_cast<uint64_t>(usage.ru_maxrss) << 10;
+#endif
+#endif
+	}
+
+	// Lowers the high-water mark to the current resident memory, so that the next GetPeakRSS
+	// is of the work in between; only Linux can, elsewhere the peak stays of the process.
+	inline bool ResetPeakRSS()
+	{
+#if defined(__linux__)
+		const auto pFile = fopen("/proc/self/clear_refs", "w");
+		const auto isReset = pFile && fputs("5", pFile) >= 0;
+		if (pFile) fclose(pFile);
+
+		return isReset;
+#else
+		return false;
+#endif
+	}
+}
+
+// Suites
+int RunBackendBench(int argc, char* argv[]);
+int RunBlueNoiseBench(int argc, char* argv[]);
+int RunCacheBench(int argc, char* argv[]);
+int RunExportBench(int argc, char* argv[]);
+int RunGoldenBench(int argc, char* argv[]);
+int RunIOBench(int argc, char* argv[]);
+int RunLayoutBench(int argc, char* argv[]);
+int RunLoaderBench(int argc, char* argv[]);
+int RunMipBench(int argc, char* argv[]);
+int RunProfileBench(int argc, char* argv[]);
+int RunProgressiveBench(int argc, char* argv[]);
+int RunRenderBench(int argc, char* argv[]);
+int RunRLEBench(int argc, char* argv[]);
+int RunScheduleBench(int argc, char* argv[]);
+int RunSchedulerBench(int argc, char* argv[]);
+int RunTimerBench(int argc, char* argv[]);
+int RunVoxelizeBench(int argc, char* argv[]);
@@ -0,0 +1,134 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <complex>
+#include <random>
+#include <vector>
+#include "Bench.h"
+#include "BlueNoise.h"
+#include "stb_image_write.h"
+
+using namespace std;
+
+namespace
+{
+	// Radially averaged power of the frequencies below a quarter of the Nyquist rate,
+	// relative to the power of all nonzero frequencies; white noise has 1/16th of the
+	// frequencies there and the same share of the power
+	double computeLowFrequencyRatio(const vector<uint8_t>& texture, uint32_t size)
+	{
+		const auto pi = 3.14159265358979;
+		auto mean = 0.0;
+		for (const auto& v : texture) mean += v;
+		mean /= texture.size();
+
+		// Separable DFT of the rows, then of the columns
+		vector<complex<double>> pixels(texture.size()), rows(texture.size()), spectrum(texture.size());
+		const auto dft = [&](const complex<double>* pIn, complex<double>* pOut, uint32_t stride)
+		{
+			for (auto k = 0u; k < size; ++k)
+			{
+				complex<double> sum = 0.0;
+				for (auto n = 0u; n < size; ++n) sum += pIn[stride * n] * polar(1.0, -2.0 * pi * k * n / size);
+				pOut[stride * k] = sum;
+			}
+		};
+		for (auto i = 0u; i < texture.size(); ++i) pixels[i] = texture[i] - mean;
+		for (auto y = 0u; y < size; ++y) dft(&pixels[size * y], &rows[size * y], 1);
+		for (auto x = 0u; x < size; ++x) dft(&rows[x], &spectrum[x], size);
+
+		auto lowPower = 0.0, totalPower = 0.0;
+		auto numLow = 0u, numTotal = 0u;
+		for (auto v = 0u; v < size; ++v)
+			for (auto u = 0u; u < size; ++u)
+			{
+				if (!u && !v) continue;
+				const auto fu = (min)(u, size - u) / static_cast<double>(size);
+				const auto fv = (min)(v, size - v) / static_cast<double>(size);
+				const auto power = norm(spectrum[size * v + u]);
+				totalPower += power;
+				++numTotal;
+				if (fu * fu + fv * fv < 0.125 * 0.125)
+				{
+					lowPower += power;
+					++numLow;
+				}
+			}
+
+		return (lowPower / numLow) / (totalPower / numTotal);
+	}
+
+	bool writeHeader(const char* fileName, const vector<uint8_t>& texture, uint32_t size, float sigma, uint32_t seed)
+	{
+		const auto pFile = fopen(fileName, "w");
+		if (!pFile) return false;
+
+		fprintf(pFile, "//--------------------------------------------------------------------------------------\n");
+		fprintf(pFile, "// Copyright (c) XU, Tianchen. All rights reserved.\n");
+		fprintf(pFile, "//--------------------------------------------------------------------------------------\n\n");
+		fprintf(pFile, "// Generated by DXRVoxelizerBench bluenoise -size %u -sigma %g -seed %u; do not edit.\n\n",
+			size, sigma, seed);
+		fprintf(pFile, "#pragma once\n\n#include <cstdint>\n\n");
+		fprintf(pFile, "namespace BlueNoise\n{\n\t// %u x %u void-and-cluster ranks, row major\n", size, size);
+		fprintf(pFile, "\tstatic const uint8_t Texture[] =\n\t{\n");
+		for (auto i = 0u; i < texture.size(); ++i)
+			fprintf(pFile, "%s%u%s", i % 16 ? " " : "\t\t", texture[i],
+				i + 1 == texture.size() ? "\n" : (i % 16 == 15 ? ",\n" : ","));
+		fprintf(pFile, "\t};\n}\n");
+
+		return fclose(pFile) == 0;
+	}
+}
+
+int RunBlueNoiseBench(int argc, char* argv[])
+{
+	const auto outFileName = Bench::ParseString(argc, argv, "out", "BlueNoiseTexture.h");
+	const auto pngFileName = Bench::ParseString(argc, argv, "png", "");
+	const auto sigma = static_cast<float>(atof(Bench::ParseString(argc, argv, "sigma", "1.5")));
+	const auto size = Bench::ParseUInt(argc, argv, "size", BlueNoise::TextureSize);
+	const auto seed = Bench::ParseUInt(argc, argv, "seed", 1);
+
+	vector<uint8_t> texture;
+	auto isGenerated = false;
+	const auto t = Bench::Measure(1, [&]() { isGenerated = BlueNoise::Generate(texture, size, sigma, seed); });
+	if (!isGenerated)
+	{
+		fprintf(stderr, "Failed to generate a blue-noise texture of %u^2 texels.\n", size);
+
+		return 1;
+	}
+
+	// White noise of the same histogram for comparison
+	auto whiteNoise = texture;
+	shuffle(whiteNoise.begin(), whiteNoise.end(), mt19937(seed));
+
+	printf("Void-and-cluster blue noise, %u^2 texels, sigma %.2f, seed %u, generated in %.2f ms\n", size, sigma, seed,
+		t * 1.0e3);
+	printf("Low-frequency power ratio: %.4f (white noise of the same values: %.4f)\n",
+		computeLowFrequencyRatio(texture, size), computeLowFrequencyRatio(whiteNoise, size));
+
+	if (!writeHeader(outFileName, texture, size, sigma, seed))
+	{
+		fprintf(stderr, "Failed to write %s.\n", outFileName);
+
+		return 1;
+	}
+	printf("Wrote %s\n", outFileName);
+	if (size != BlueNoise::TextureSize)
+		printf("Note: BlueNoise::TextureSize is %u, so this texture does not replace the built-in one\n",
+			BlueNoise::TextureSize);
+
+	if (*pngFileName)
+	{
+		if (!stbi_write_png(pngFileName, size, size, 1, texture.data(), size))
+		{
+			fprintf(stderr, "Failed to write %s.\n", pngFileName);
+
+			return 1;
+		}
+		printf("Wrote %s\n", pngFileName);
+	}
+
+	return 0;
+}
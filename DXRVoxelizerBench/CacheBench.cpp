@@ -0,0 +1,96 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include "Bench.h"
+#include "Optional/XUSGObjLoader.h"
+#include "VoxelCache.h"
+#include "VoxelizerCPU.h"
+
+using namespace std;
+
+int RunCacheBench(int argc, char* argv[])
+{
+	const auto meshFileName = Bench::ParseString(argc, argv, "mesh", "Assets/bunny.obj");
+	const auto directory = Bench::ParseString(argc, argv, "dir", "DXRVoxelizerCache");
+	const auto size = Bench::ParseUInt(argc, argv, "size", 256);
+	const auto threads = Bench::ParseUInt(argc, argv, "threads", 0);
+	const auto repeats = Bench::ParseUInt(argc, argv, "repeats", 3);
+	const auto maxMB = Bench::ParseUInt(argc, argv, "maxmb", 256);
+	const auto mode = VoxelizerCPU::COLUMN;
+	const float posScale[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+	VoxelCache cache;
+	if (!cache.Init(directory, static_cast<uint64_t>(maxMB) << 20))
+	{
+		fprintf(stderr, "Failed to open cache directory %s.\n", directory);
+
+		return 1;
+	}
+
+	printf("Voxelization cache benchmark, %s at %u^3 (%s), best of %u\n\n", meshFileName, size,
+		VoxelizerCPU::GetModeName(mode), repeats);
+	printf("%-32s %10s\n", "Startup", "ms");
+
+	// Cold: every stage that a hit skips, then the store
+	auto isSucceeded = true;
+	VoxelCache::Key key = {};
+	const auto tKey = Bench::Measure(repeats, [&]()
+	{
+		isSucceeded = VoxelCache::MakeKey(key, meshFileName, size, VoxelizerCPU::Threshold, posScale, mode) && isSucceeded;
+	});
+
+	// A previous run may have left the entry behind, which then counts as a hit
+	VoxelGridReader reader;
+	const auto isCached = cache.Find(key, reader);
+	reader.Close();
+
+	VoxelGrid grid;
+	float bound[4] = {};
+	const auto tCold = Bench::Measure(repeats, [&]()
+	{
+		XUSG::ObjLoader objLoader;
+		VoxelizerCPU voxelizer;
+		isSucceeded = objLoader.Import(meshFileName, true, true) &&
+			voxelizer.Init(objLoader.GetVertices(), objLoader.GetNumVertices(), objLoader.GetVertexStride(),
+				objLoader.GetIndices(), objLoader.GetNumIndices()) &&
+			voxelizer.Voxelize(grid, size, mode, threads) && isSucceeded;
+		memcpy(bound, voxelizer.GetBound(), sizeof(bound));
+	});
+
+	const auto tStore = Bench::Measure(repeats, [&]()
+	{
+		isSucceeded = cache.Store(key, grid, bound, threads) && isSucceeded;
+	});
+
+	// Warm: map the entry and decode it into a dense grid
+	VoxelGrid cachedGrid;
+	const auto tWarm = Bench::Measure(repeats, [&]()
+	{
+		VoxelGridReader reader;
+		isSucceeded = cache.Find(key, reader) && reader.Read(cachedGrid, threads) &&
+			!memcmp(reader.GetBound(), bound, sizeof(bound)) && isSucceeded;
+	});
+
+	if (!isSucceeded || cachedGrid.GetNumVoxels() != grid.GetNumVoxels() ||
+		memcmp(cachedGrid.GetData(), grid.GetData(), grid.GetNumVoxels()))
+	{
+		fprintf(stderr, "Cache round trip failed.\n");
+
+		return 1;
+	}
+
+	printf("%-32s %10.2f\n", "Key (hash mesh and settings)", tKey * 1.0e3);
+	printf("%-32s %10.2f\n", "Miss (load and voxelize)", (tKey + tCold) * 1.0e3);
+	printf("%-32s %10.2f\n", "Store", tStore * 1.0e3);
+	printf("%-32s %10.2f\n", "Hit (map and decode)", (tKey + tWarm) * 1.0e3);
+	printf("\nSpeedup %.1fx%s\n", (tKey + tCold) / (tKey + tWarm), isCached ? ", entry was already cached" : "");
+
+	const auto stats = cache.GetStats();
+	printf("Hits %llu, misses %llu, stores %llu, evictions %llu, %.2f MB in %s\n",
+		static_cast<unsigned long long>(stats.Hits), static_cast<unsigned long long>(stats.Misses),
+		static_cast<unsigned long long>(stats.Stores), static_cast<unsigned long long>(stats.Evictions),
+		cache.GetSize() / 1.0e6, cache.GetFileName(key).c_str());
+
+	return 0;
+}
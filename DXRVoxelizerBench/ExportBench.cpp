@@ -0,0 +1,93 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <string>
+#include "Bench.h"
+#include "Optional/XUSGObjLoader.h"
+#include "VoxelExporter.h"
+#include "VoxelGridIO.h"
+#include "VoxelizerCPU.h"
+
+using namespace std;
+
+int RunExportBench(int argc, char* argv[])
+{
+	const auto meshFileName = Bench::ParseString(argc, argv, "mesh", "Assets/bunny.obj");
+	const auto size = Bench::ParseUInt(argc, argv, "size", 512);
+	const auto threads = Bench::ParseUInt(argc, argv, "threads", 0);
+	const auto repeats = Bench::ParseUInt(argc, argv, "repeats", 1);
+
+	XUSG::ObjLoader objLoader;
+	VoxelizerCPU voxelizer;
+	if (!objLoader.Import(meshFileName, true, true) ||
+		!voxelizer.Init(objLoader.GetVertices(), objLoader.GetNumVertices(), objLoader.GetVertexStride(),
+			objLoader.GetIndices(), objLoader.GetNumIndices()))
+	{
+		fprintf(stderr, "Failed to load %s.\n", meshFileName);
+
+		return 1;
+	}
+
+	VoxelGrid grid;
+	RLEGrid rleGrid;
+	voxelizer.Voxelize(grid, size, VoxelizerCPU::COLUMN, threads);
+	voxelizer.Voxelize(rleGrid, size, VoxelizerCPU::COLUMN, threads);
+
+	const auto chunkFileName = "DXRVoxelizerBench.vxgz";
+	VoxelGridWriter writer;
+	VoxelGridReader reader;
+	if (!writer.Write(chunkFileName, rleGrid, threads) || !reader.Open(chunkFileName))
+	{
+		fprintf(stderr, "Failed to write %s.\n", chunkFileName);
+
+		return 1;
+	}
+
+	const DenseSliceSource denseSource(grid);
+	const RLESliceSource rleSource(rleGrid);
+	const ChunkFileSliceSource chunkSource(reader);
+	const struct
+	{
+		const char* Name;
+		const VoxelSliceSource* pSource;
+	} sources[] =
+	{
+		{ "dense", &denseSource },
+		{ "RLE", &rleSource },
+		{ "chunk file", &chunkSource }
+	};
+
+	const auto numVoxels = static_cast<double>(grid.GetNumVoxels());
+	printf("Voxel export benchmark, %s at %u^3 (%.1f MB), best of %u\n\n", meshFileName, size, numVoxels / 1.0e6, repeats);
+	printf("%-12s %-12s %10s %10s %12s\n", "Format", "Source", "MB", "ms", "GB/s");
+
+	auto isSucceeded = true;
+	VoxelExporter exporter;
+	for (auto f = 0u; f < VoxelExporter::NUM_FORMAT; ++f)
+	{
+		const auto format = static_cast<VoxelExporter::Format>(f);
+		const auto fileName = string("DXRVoxelizerBench") + VoxelExporter::GetFileExtension(format);
+		for (const auto& source : sources)
+		{
+			const auto t = Bench::Measure(repeats, [&]()
+			{
+				isSucceeded = exporter.Export(fileName.c_str(), *source.pSource, format, threads) && isSucceeded;
+			});
+			printf("%-12s %-12s %10.2f %10.2f %12.2f\n", VoxelExporter::GetFormatName(format), source.Name,
+				exporter.GetFileSize() / 1.0e6, t * 1.0e3, numVoxels / t / 1.0e9);
+		}
+		remove(fileName.c_str());
+	}
+	reader.Close();
+	remove(chunkFileName);
+
+	if (!isSucceeded)
+	{
+		fprintf(stderr, "Export failed.\n");
+
+		return 1;
+	}
+
+	return 0;
+}
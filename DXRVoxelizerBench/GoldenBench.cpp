@@ -0,0 +1,316 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include "Bench.h"
+#include "LZCodec.h"
+#include "Optional/XUSGObjLoader.h"
+#include "ParallelFor.h"
+#include "RayCasterCPU.h"
+#include "stb_image_write.h"
+#include "VoxelGridIO.h"
+#include "VoxelizerCPU.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace
+{
+	struct Mesh
+	{
+		string Name;	// File name without the extension
+		XUSG::ObjLoader Loader;
+		VoxelizerCPU Voxelizer;
+		bool IsLoaded;
+	};
+
+	struct Case
+	{
+		uint32_t MeshIndex;
+		VoxelizerCPU::Mode Mode;	// Of a grid case
+		int Camera;					// Of an image case, -1 for a grid case
+		string Name;
+		string FileName;			// Of the golden, in the golden directory
+
+		bool IsPassed;
+		string Message;
+		double Seconds;
+	};
+
+	// The initial camera of the app and one from the side, both looking at its focus
+	const Float3 g_eyePts[] = { Float3(8.0f, 12.0f, -14.0f), Float3(-16.0f, 4.0f, 6.0f) };
+	const Float3 g_focusPt(0.0f, 4.0f, 0.0f);
+	const float g_posScale[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+	// Raw RGBA8 behind a magic, the size and the LZ block size, as no PNG decoder is at hand
+	const char g_imageMagic[] = { 'G', 'I', 'M', 'G' };
+
+	bool writeImage(const string& fileName, const vector<uint8_t>& image, uint32_t width, uint32_t height)
+	{
+		vector<uint8_t> block(LZCodec::GetMaxCompressedSize(image.size()));
+		const auto blockSize = LZCodec::Compress(image.data(), image.size(), block.data(), block.size());
+		const uint32_t header[] = { width, height, static_cast<uint32_t>(blockSize) };
+
+		ofstream file(fileName, ios::binary | ios::trunc);
+		file.write(g_imageMagic, sizeof(g_imageMagic));
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(block.data()), blockSize);
+
+		return blockSize && static_cast<bool>(file);
+	}
+
+	bool readImage(const string& fileName, vector<uint8_t>& image, uint32_t width, uint32_t height)
+	{
+		ifstream file(fileName, ios::binary);
+		char magic[sizeof(g_imageMagic)];
+		uint32_t header[3];
+		file.read(magic, sizeof(magic));
+		file.read(reinterpret_cast<char*>(header), sizeof(header));
+		if (!file || memcmp(magic, g_imageMagic, sizeof(magic)) || header[0] != width || header[1] != height)
+			return false;
+
+		vector<uint8_t> block(header[2]);
+		file.read(reinterpret_cast<char*>(block.data()), block.size());
+		image.resize(static_cast<size_t>(width) * height * 4);
+
+		return file && LZCodec::Decompress(block.data(), block.size(), image.data(), image.size());
+	}
+
+	// The golden dimmed to gray, with the difference in red, amplified 8 times
+	bool writeImageDiff(const string& fileName, const vector<uint8_t>& image, const vector<uint8_t>& golden,
+		uint32_t width, uint32_t height)
+	{
+		vector<uint8_t> diff(image.size());
+		for (size_t i = 0; i < image.size(); i += 4)
+		{
+			auto maxDiff = 0;
+			for (auto k = 0u; k < 3; ++k) maxDiff = (max)(maxDiff, abs(image[i + k] - golden[i + k]));
+			const auto gray = static_cast<uint8_t>((golden[i] + golden[i + 1] + golden[i + 2]) / 12);
+			diff[i] = static_cast<uint8_t>((min)(gray + maxDiff * 8, 255));
+			diff[i + 1] = gray;
+			diff[i + 2] = gray;
+			diff[i + 3] = 255;
+		}
+
+		return stbi_write_png(fileName.c_str(), width, height, 4, diff.data(), 0) != 0;
+	}
+
+	// Projected along z and scaled 4 times: red where golden voxels are missing, green
+	// where voxels are extra, yellow for both, and gray where the golden is solid
+	bool writeGridDiff(const string& fileName, const VoxelGrid& grid, const VoxelGrid& golden)
+	{
+		const auto size = golden.GetWidth();
+		const auto scale = 4u, width = size * scale;
+		vector<uint8_t> diff(static_cast<size_t>(width) * width * 4);
+		for (auto y = 0u; y < size; ++y)
+			for (auto x = 0u; x < size; ++x)
+			{
+				auto isMissing = false, isExtra = false, isSolid = false;
+				for (auto z = 0u; z < size; ++z)
+				{
+					const auto a = grid.Get(x, y, z) != 0, b = golden.Get(x, y, z) != 0;
+					isMissing = isMissing || (b && !a);
+					isExtra = isExtra || (a && !b);
+					isSolid = isSolid || b;
+				}
+				const uint8_t gray = isSolid ? 64 : 0;
+				const uint8_t color[] = { isMissing ? uint8_t(255) : gray, isExtra ? uint8_t(255) : gray, gray, 255 };
+				for (auto j = 0u; j < scale; ++j)
+					for (auto i = 0u; i < scale; ++i)
+						memcpy(&diff[(static_cast<size_t>(width) * (y * scale + j) + x * scale + i) * 4], color, 4);
+			}
+
+		return stbi_write_png(fileName.c_str(), width, width, 4, diff.data(), 0) != 0;
+	}
+}
+
+int RunGoldenBench(int argc, char* argv[])
+{
+	const auto meshFileNames = Bench::ParseList(argc, argv, "meshes", "Assets/bunny.obj,Assets/dragon.obj,Assets/TuringBowl.obj");
+	const string goldenDir = Bench::ParseString(argc, argv, "golden", "Golden");
+	const string diffDir = Bench::ParseString(argc, argv, "diff", "GoldenDiff");
+	const auto size = Bench::ParseUInt(argc, argv, "size", 64);
+	const auto width = Bench::ParseUInt(argc, argv, "width", 320);
+	const auto height = Bench::ParseUInt(argc, argv, "height", 180);
+	const auto threads = Bench::ParseUInt(argc, argv, "threads", 0);
+	const auto maxVoxels = Bench::ParseUInt(argc, argv, "maxvoxels", 0);	// Hamming distance
+	const auto minPSNR = atof(Bench::ParseString(argc, argv, "minpsnr", "40"));
+	const auto minSSIM = atof(Bench::ParseString(argc, argv, "minssim", "0.99"));
+	// -update 1 rewrites the goldens; new grid goldens go with a bump of VoxelizerCPU::AlgorithmVersion
+	const auto isUpdating = Bench::ParseUInt(argc, argv, "update", 0) != 0;
+
+	// The cases run in parallel, each on a single thread, which is also deterministic
+	const auto numMeshes = static_cast<uint32_t>(meshFileNames.size());
+	vector<unique_ptr<Mesh>> meshes(numMeshes);
+	ParallelFor(0, numMeshes, threads, [&](uint32_t i)
+	{
+		auto& mesh = *(meshes[i] = make_unique<Mesh>());
+		mesh.Name = fs::path(meshFileNames[i]).stem().string();
+		mesh.IsLoaded = mesh.Loader.Import(meshFileNames[i].c_str(), true, true) &&
+			mesh.Voxelizer.Init(mesh.Loader.GetVertices(), mesh.Loader.GetNumVertices(),
+				mesh.Loader.GetVertexStride(), mesh.Loader.GetIndices(), mesh.Loader.GetNumIndices());
+	});
+
+	vector<Case> gridCases, imageCases;
+	char suffix[64];
+	for (auto i = 0u; i < numMeshes; ++i)
+	{
+		if (!meshes[i]->IsLoaded)
+		{
+			fprintf(stderr, "Failed to load %s.\n", meshFileNames[i].c_str());
+
+			return 1;
+		}
+
+		for (auto m = 0u; m < VoxelizerCPU::NUM_MODE; ++m)
+		{
+			const auto mode = static_cast<VoxelizerCPU::Mode>(m);
+			snprintf(suffix, sizeof(suffix), "_%s_%u", VoxelizerCPU::GetModeName(mode), size);
+			gridCases.push_back({ i, mode, -1, meshes[i]->Name + suffix, meshes[i]->Name + suffix + ".vxgz",
+				false, "", 0.0 });
+		}
+
+		for (auto c = 0; c < static_cast<int>(sizeof(g_eyePts) / sizeof(g_eyePts[0])); ++c)
+		{
+			snprintf(suffix, sizeof(suffix), "_camera%d_%u_%ux%u", c, size, width, height);
+			imageCases.push_back({ i, VoxelizerCPU::PER_VOXEL, c, meshes[i]->Name + suffix,
+				meshes[i]->Name + suffix + ".rgba.lz", false, "", 0.0 });
+		}
+	}
+
+	error_code error;
+	if (isUpdating) fs::create_directories(goldenDir, error);
+	const auto getDiffFileName = [&](const Case& c, const char* suffix)
+	{
+		error_code error;
+		fs::create_directories(diffDir, error);
+
+		return diffDir + "/" + c.Name + suffix;
+	};
+
+	// The grids first, as the images render the per-voxel grids
+	vector<VoxelGrid> grids(gridCases.size());
+	ParallelFor(0, static_cast<uint32_t>(gridCases.size()), threads, [&](uint32_t i)
+	{
+		auto& c = gridCases[i];
+		auto& grid = grids[i];
+		const auto& mesh = *meshes[c.MeshIndex];
+		const auto goldenFileName = goldenDir + "/" + c.FileName;
+		const auto start = chrono::steady_clock::now();
+
+		c.IsPassed = mesh.Voxelizer.Voxelize(grid, size, c.Mode, 1);
+		if (!c.IsPassed) c.Message = "voxelization failed";
+		else if (isUpdating)
+		{
+			VoxelGridWriter writer;
+			writer.SetBound(mesh.Voxelizer.GetBound());
+			c.IsPassed = writer.Write(goldenFileName.c_str(), grid, 1);
+			c.Message = c.IsPassed ? "written" : "write failed";
+		}
+		else
+		{
+			VoxelGridReader reader;
+			VoxelGrid golden;
+			if (!reader.Open(goldenFileName.c_str()) || !reader.Read(golden, 1) || golden.GetWidth() != size)
+			{
+				c.IsPassed = false;
+				c.Message = "no golden";
+			}
+			else
+			{
+				// Hamming distance of the occupancy; 0 is voxel-exact, which holds as long as
+				// BVH.cpp and VoxelizerCPU.cpp are built without FMA contraction, as the
+				// projects and CMakeLists.txt pin them, or the goldens are rewritten
+				size_t distance = 0;
+				for (auto z = 0u; z < size; ++z)
+					for (auto y = 0u; y < size; ++y)
+						for (auto x = 0u; x < size; ++x)
+							distance += (grid.Get(x, y, z) != 0) != (golden.Get(x, y, z) != 0) ? 1 : 0;
+
+				char message[64];
+				snprintf(message, sizeof(message), distance ? "%zu voxels differ" : "voxel-exact", distance);
+				c.Message = message;
+				c.IsPassed = distance <= maxVoxels;
+				if (!c.IsPassed) writeGridDiff(getDiffFileName(c, "_diff.png"), grid, golden);
+			}
+		}
+
+		const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+		c.Seconds = elapsed.count();
+	});
+
+	ParallelFor(0, static_cast<uint32_t>(imageCases.size()), threads, [&](uint32_t i)
+	{
+		auto& c = imageCases[i];
+		const auto& mesh = *meshes[c.MeshIndex];
+		const auto& grid = grids[c.MeshIndex * VoxelizerCPU::NUM_MODE + VoxelizerCPU::PER_VOXEL];
+		const auto goldenFileName = goldenDir + "/" + c.FileName;
+		const auto start = chrono::steady_clock::now();
+
+		const auto& eyePt = g_eyePts[c.Camera];
+		const auto view = LookAtLH(eyePt, g_focusPt, Float3(0.0f, 1.0f, 0.0f));
+		const auto proj = PerspectiveFovLH(0.785398163f, width / static_cast<float>(height), 1.0f, 1000.0f);
+
+		RayCasterCPU rayCaster;
+		vector<uint8_t> image(static_cast<size_t>(width) * height * 4), golden;
+		c.IsPassed = rayCaster.Init(width, height, grid, mesh.Voxelizer.GetBound(), g_posScale);
+		if (c.IsPassed)
+		{
+			rayCaster.UpdateFrame(eyePt, view * proj);
+			rayCaster.Render(image.data(), RayCasterCPU::FIXED_STEP, RayCasterCPU::LIGHT_MARCH, 1);
+		}
+
+		if (!c.IsPassed) c.Message = "render failed";
+		else if (isUpdating)
+		{
+			c.IsPassed = writeImage(goldenFileName, image, width, height);
+			c.Message = c.IsPassed ? "written" : "write failed";
+		}
+		else if (!readImage(goldenFileName, golden, width, height))
+		{
+			c.IsPassed = false;
+			c.Message = "no golden";
+		}
+		else
+		{
+			const auto psnr = Bench::ComputePSNR(image.data(), golden.data(), image.size() / 4);
+			const auto ssim = Bench::ComputeSSIM(image.data(), golden.data(), width, height);
+
+			char message[64];
+			snprintf(message, sizeof(message), "PSNR %.2f dB, SSIM %.5f", psnr, ssim);
+			c.Message = message;
+			c.IsPassed = psnr >= minPSNR && ssim >= minSSIM;
+			if (!c.IsPassed)
+			{
+				writeImageDiff(getDiffFileName(c, "_diff.png"), image, golden, width, height);
+				stbi_write_png(getDiffFileName(c, ".png").c_str(), width, height, 4, image.data(), 0);
+			}
+		}
+
+		const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+		c.Seconds = elapsed.count();
+	});
+
+	printf("Golden outputs in %s, %u^3 grids, %ux%u images; pass at %u voxels, %g dB and SSIM %g\n\n",
+		goldenDir.c_str(), size, width, height, maxVoxels, minPSNR, minSSIM);
+	printf("%-36s %-6s %10s  %s\n", "Case", "Result", "ms", "Check");
+
+	auto numFailed = 0u;
+	for (const auto pCases : { &gridCases, &imageCases })
+		for (const auto& c : *pCases)
+		{
+			printf("%-36s %-6s %10.2f  %s\n", c.Name.c_str(), c.IsPassed ? "pass" : "FAIL", c.Seconds * 1.0e3,
+				c.Message.c_str());
+			numFailed += c.IsPassed ? 0 : 1;
+		}
+
+	const auto numCases = gridCases.size() + imageCases.size();
+	if (isUpdating) printf("\n%zu goldens written to %s\n", numCases - numFailed, goldenDir.c_str());
+	else printf("\n%zu of %zu cases passed%s%s\n", numCases - numFailed, numCases,
+		numFailed ? "; diffs in " : "", numFailed ? diffDir.c_str() : "");
+
+	return numFailed ? 1 : 0;
+}
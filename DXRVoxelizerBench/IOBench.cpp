@@ -0,0 +1,140 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <vector>
+#include "Bench.h"
+#include "Optional/XUSGObjLoader.h"
+#include "VoxelGridIO.h"
+#include "VoxelizerCPU.h"
+
+using namespace std;
+using namespace VoxelGridFile;
+
+int RunIOBench(int argc, char* argv[])
+{
+	const auto meshFileName = Bench::ParseString(argc, argv, "mesh", "Assets/bunny.obj");
+	const auto fileName = Bench::ParseString(argc, argv, "file", "DXRVoxelizerBench.vxgz");
+	const auto size = Bench::ParseUInt(argc, argv, "size", 512);
+	const auto threads = Bench::ParseUInt(argc, argv, "threads", 0);
+	const auto repeats = Bench::ParseUInt(argc, argv, "repeats", 3);
+
+	XUSG::ObjLoader objLoader;
+	VoxelizerCPU voxelizer;
+	if (!objLoader.Import(meshFileName, true, true) ||
+		!voxelizer.Init(objLoader.GetVertices(), objLoader.GetNumVertices(), objLoader.GetVertexStride(),
+			objLoader.GetIndices(), objLoader.GetNumIndices()))
+	{
+		fprintf(stderr, "Failed to load %s.\n", meshFileName);
+
+		return 1;
+	}
+
+	VoxelGrid grid;
+	RLEGrid rleGrid;
+	voxelizer.Voxelize(grid, size, VoxelizerCPU::COLUMN, threads);
+	voxelizer.Voxelize(rleGrid, size, VoxelizerCPU::COLUMN, threads);
+	const auto numVoxels = static_cast<double>(grid.GetNumVoxels());
+
+	printf("Voxel grid file benchmark, %s at %u^3 (%.1f MB), %u-voxel chunks, best of %u\n\n",
+		meshFileName, size, numVoxels / 1.0e6, ChunkSize, repeats);
+
+	// Writing
+	VoxelGridWriter writer;
+	auto isSucceeded = true;
+	const auto tWriteRLE = Bench::Measure(repeats, [&]() { isSucceeded = writer.Write(fileName, rleGrid, threads) && isSucceeded; });
+	const auto tWrite = Bench::Measure(repeats, [&]() { isSucceeded = writer.Write(fileName, grid, threads) && isSucceeded; });
+
+	// Reading
+	VoxelGridReader reader;
+	VoxelGrid readGrid;
+	isSucceeded = reader.Open(fileName) && isSucceeded;
+	const auto tRead = Bench::Measure(repeats, [&]() { isSucceeded = reader.Read(readGrid, threads) && isSucceeded; });
+	const auto isMatched = readGrid.GetNumVoxels() == grid.GetNumVoxels() &&
+		!memcmp(readGrid.GetData(), grid.GetData(), grid.GetNumVoxels());
+
+	// Random access, over the chunks that hold data
+	vector<uint32_t> chunks;
+	for (auto i = 0u; i < reader.GetNumChunks(); ++i)
+	{
+		const auto cx = i % reader.GetNumChunksX();
+		const auto cy = i / reader.GetNumChunksX() % reader.GetNumChunksY();
+		const auto cz = i / reader.GetNumChunksX() / reader.GetNumChunksY();
+		if (reader.GetChunkEntry(cx, cy, cz).Encoding != UNIFORM) chunks.push_back(i);
+	}
+
+	uint32_t seed = 12345;
+	const auto numRandomReads = 4096u;
+	vector<uint8_t> chunk(ChunkVoxels);
+	const auto tRandom = Bench::Measure(repeats, [&]()
+	{
+		auto sum = 0.0;
+		for (auto i = 0u; i < numRandomReads && !chunks.empty(); ++i)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			const auto c = chunks[(seed >> 8) % chunks.size()];
+			const auto cx = c % reader.GetNumChunksX();
+			const auto cy = c / reader.GetNumChunksX() % reader.GetNumChunksY();
+			const auto cz = c / reader.GetNumChunksX() / reader.GetNumChunksY();
+			isSucceeded = reader.ReadChunk(cx, cy, cz, chunk.data()) && isSucceeded;
+			sum += chunk[ChunkVoxels / 2];
+		}
+		Bench::DoNotOptimize(sum);
+	});
+	const auto numChunks = reader.GetNumChunks();
+	reader.Close();
+
+	// A header whose chunk counts wrap in 32 bits, or whose grid exceeds the address space,
+	// has to fail to open rather than to allocate
+	auto isRejected = true;
+	const auto checkCrafted = [&](uint32_t width, uint32_t numChunksX, uint32_t depth)
+	{
+		Header header = {};
+		auto pFile = fopen(fileName, "r+b");
+		if (!pFile || fread(&header, sizeof(Header), 1, pFile) != 1)
+		{
+			if (pFile) fclose(pFile);
+			isRejected = false;
+			return;
+		}
+		header.Width = width;
+		header.NumChunks[0] = numChunksX;
+		header.Depth = depth;
+		fseek(pFile, 0, SEEK_SET);
+		fwrite(&header, sizeof(Header), 1, pFile);
+		fclose(pFile);
+		isRejected = !reader.Open(fileName) && isRejected;
+		reader.Close();
+	};
+	const auto numChunksMax = static_cast<uint32_t>((0xffffffffull + ChunkSize - 1) / ChunkSize);
+	checkCrafted(0xffffffff, 0, size);
+	checkCrafted(0xffffffff, numChunksMax, size);
+	checkCrafted(0xffffffff, numChunksMax, 0xffffffff);
+	remove(fileName);
+
+	if (!isSucceeded || !isMatched)
+	{
+		fprintf(stderr, "Round trip failed.\n");
+
+		return 1;
+	}
+
+	if (!isRejected)
+	{
+		fprintf(stderr, "A crafted header was accepted.\n");
+
+		return 1;
+	}
+
+	printf("File: %.2f MB (%.1fx), %u of %u chunks uniform\n\n", writer.GetFileSize() / 1.0e6,
+		numVoxels / writer.GetFileSize(), writer.GetNumUniformChunks(), numChunks);
+	printf("%-32s %10s %12s\n", "Operation", "ms", "GB/s");
+	printf("%-32s %10.2f %12.2f\n", "write (dense source)", tWrite * 1.0e3, numVoxels / tWrite / 1.0e9);
+	printf("%-32s %10.2f %12.2f\n", "write (RLE source)", tWriteRLE * 1.0e3, numVoxels / tWriteRLE / 1.0e9);
+	printf("%-32s %10.2f %12.2f\n", "read (whole grid)", tRead * 1.0e3, numVoxels / tRead / 1.0e9);
+	printf("%-32s %10.2f %12.2f\n", "round trip", (tWrite + tRead) * 1.0e3, numVoxels / (tWrite + tRead) / 1.0e9);
+	printf("%-32s %10.2f %12.2f\n", "random chunk reads (4096)", tRandom * 1.0e3,
+		numRandomReads * static_cast<double>(ChunkVoxels) / tRandom / 1.0e9);
+
+	return 0;
+}
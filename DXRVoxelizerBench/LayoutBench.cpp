@@ -0,0 +1,266 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <cmath>
+#include <vector>
+#include "Bench.h"
+#include "Morton.h"
+#include "VoxelGrid.h"
+
+using namespace std;
+
+namespace
+{
+	struct Vec3
+	{
+		float x, y, z;
+	};
+
+	Vec3 operator+(const Vec3& a, const Vec3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+	Vec3 operator-(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	Vec3 operator*(const Vec3& a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+	Vec3 cross(const Vec3& a, const Vec3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+	Vec3 normalize(const Vec3& a) { return a * (1.0f / sqrtf(a.x * a.x + a.y * a.y + a.z * a.z)); }
+}
+
+// A solid sphere with a noisy shell and some floating blobs, similar in
+// occupancy to the voxelized bundled meshes
+static void fillTestGrid(VoxelGrid& grid)
+{
+	const auto n = grid.GetWidth();
+	uint32_t seed = 12345;
+	for (auto z = 0u; z < n; ++z)
+		for (auto y = 0u; y < n; ++y)
+			for (auto x = 0u; x < n; ++x)
+			{
+				const auto px = (x + 0.5f) / n * 2.0f - 1.0f;
+				const auto py = (y + 0.5f) / n * 2.0f - 1.0f;
+				const auto pz = (z + 0.5f) / n * 2.0f - 1.0f;
+				const auto r = sqrtf(px * px + py * py + pz * pz);
+				seed = seed * 1664525u + 1013904223u;
+				const auto noise = (seed >> 24) / 255.0f * 0.1f;
+				const auto blob = sinf(px * 9.0f) * sinf(py * 7.0f) * sinf(pz * 11.0f) > 0.6f;
+				grid.Set(x, y, z, r + noise < 0.7f || blob ? 255 : 0);
+			}
+}
+
+static size_t countMismatches(const uint8_t* pA, const uint8_t* pB, size_t numVoxels)
+{
+	size_t numMismatches = 0;
+	for (size_t i = 0; i < numVoxels; ++i) numMismatches += pA[i] != pB[i];
+
+	return numMismatches;
+}
+
+// 3x3x3 max filter (binary dilation) over the interior voxels
+static double stencilLinear(const VoxelGrid& src, VoxelGrid& dst)
+{
+	const auto n = src.GetWidth();
+	const auto pSrc = src.GetData();
+	const auto pDst = dst.GetData();
+	const size_t pitch = n, slicePitch = static_cast<size_t>(n) * n;
+	size_t numSet = 0;
+	for (auto z = 1u; z + 1 < n; ++z)
+		for (auto y = 1u; y + 1 < n; ++y)
+			for (auto x = 1u; x + 1 < n; ++x)
+			{
+				const auto i = slicePitch * z + pitch * y + x;
+				uint8_t v = 0;
+				for (auto dz = -1; dz <= 1; ++dz)
+					for (auto dy = -1; dy <= 1; ++dy)
+					{
+						const auto j = i + slicePitch * dz + pitch * dy;
+						v = (max)(v, (max)(pSrc[j - 1], (max)(pSrc[j], pSrc[j + 1])));
+					}
+				pDst[i] = v;
+				numSet += v != 0;
+			}
+
+	return static_cast<double>(numSet);
+}
+
+// Same filter in Morton order, with the neighbourhood built from per-axis
+// partial codes out of small lookup tables instead of full encodes
+static double stencilMorton(const VoxelGrid& src, VoxelGrid& dst)
+{
+	const auto n = src.GetWidth();
+	const auto pSrc = src.GetData();
+	const auto pDst = dst.GetData();
+	vector<uint32_t> mx(n), my(n), mz(n);
+	for (auto i = 0u; i < n; ++i)
+	{
+		mx[i] = Morton::Encode(i, 0, 0);
+		my[i] = Morton::Encode(0, i, 0);
+		mz[i] = Morton::Encode(0, 0, i);
+	}
+
+	size_t numSet = 0;
+	for (auto z = 1u; z + 1 < n; ++z)
+		for (auto y = 1u; y + 1 < n; ++y)
+		{
+			uint32_t myz[9];
+			for (auto dz = 0u; dz < 3; ++dz)
+				for (auto dy = 0u; dy < 3; ++dy)
+					myz[dz * 3 + dy] = mz[z + dz - 1] | my[y + dy - 1];
+
+			for (auto x = 1u; x + 1 < n; ++x)
+			{
+				const auto x0 = mx[x - 1], x1 = mx[x], x2 = mx[x + 1];
+				uint8_t v = 0;
+				for (const auto m : myz)
+					v = (max)(v, (max)(pSrc[x0 | m], (max)(pSrc[x1 | m], pSrc[x2 | m])));
+				pDst[x1 | myz[4]] = v;
+				numSet += v != 0;
+			}
+		}
+
+	return static_cast<double>(numSet);
+}
+
+// Fixed-step absorption-only marcher with light rays, following the access
+// pattern of PSRayCast.hlsl
+static double rayMarch(const VoxelGrid& grid, uint32_t res, uint64_t& numFetches)
+{
+	const uint32_t numSamples = 128, numLightSamples = 32;
+	const auto maxDist = 2.0f * sqrtf(3.0f);
+	const auto stepScale = maxDist / numSamples;
+	const auto lightStepScale = maxDist / numLightSamples;
+
+	const Vec3 eye = { 2.2f, 1.6f, -2.8f };
+	const auto forward = normalize(Vec3{ 0.0f, 0.0f, 0.0f } - eye);
+	const auto right = normalize(cross(Vec3{ 0.0f, 1.0f, 0.0f }, forward));
+	const auto up = cross(forward, right);
+	const auto lightStep = normalize(Vec3{ -10.0f, 45.0f, -75.0f }) * lightStepScale;
+
+	const auto isOutside = [](const Vec3& p) { return fabsf(p.x) > 1.0f || fabsf(p.y) > 1.0f || fabsf(p.z) > 1.0f; };
+	const auto sample = [&grid, &numFetches](const Vec3& p)
+	{
+		++numFetches;
+		return (min)(grid.Sample(0.5f * p.x + 0.5f, -0.5f * p.y + 0.5f, 0.5f * p.z + 0.5f) * 8.0f, 16.0f);
+	};
+
+	auto sum = 0.0;
+	for (auto j = 0u; j < res; ++j)
+		for (auto i = 0u; i < res; ++i)
+		{
+			const auto sx = ((i + 0.5f) / res * 2.0f - 1.0f) * 0.45f;
+			const auto sy = (1.0f - (j + 0.5f) / res * 2.0f) * 0.45f;
+			const auto rayDir = normalize(forward + right * sx + up * sy);
+
+			// March from the eye to the first point inside the unit cube
+			auto pos = eye;
+			auto t = 0.0f;
+			while (isOutside(pos) && t < 8.0f)
+			{
+				t += stepScale;
+				pos = eye + rayDir * t;
+			}
+
+			auto transmit = 1.0f, scatter = 0.0f;
+			const auto step = rayDir * stepScale;
+			for (auto s = 0u; s < numSamples && !isOutside(pos); ++s, pos = pos + step)
+			{
+				const auto density = sample(pos);
+				if (density <= 0.01f) continue;
+
+				const auto scaledDens = density * stepScale;
+				transmit *= (max)(1.0f - scaledDens, 0.0f);
+				if (transmit < 0.01f) break;
+
+				auto lightTrans = 1.0f;
+				auto lightPos = pos + lightStep;
+				for (auto k = 0u; k < numLightSamples && !isOutside(lightPos); ++k, lightPos = lightPos + lightStep)
+				{
+					lightTrans *= (max)(1.0f - lightStepScale * sample(lightPos), 0.0f);
+					if (lightTrans < 0.01f) break;
+				}
+
+				scatter += lightTrans * transmit * scaledDens;
+			}
+
+			sum += scatter;
+		}
+
+	return sum;
+}
+
+int RunLayoutBench(int argc, char* argv[])
+{
+	const auto size = Bench::ParseUInt(argc, argv, "size", 256);
+	const auto repeats = Bench::ParseUInt(argc, argv, "repeats", 3);
+	const auto res = Bench::ParseUInt(argc, argv, "res", 256);
+	if (!VoxelGrid::IsMortonCompatible(size, size, size))
+	{
+		fprintf(stderr, "Grid size must be a power of two in [1, 1024].\n");
+
+		return 1;
+	}
+
+	VoxelGrid linear, morton, dstLinear, dstMorton;
+	linear.Create(size, size, size);
+	fillTestGrid(linear);
+	morton = linear;
+	morton.SetLayout(VoxelGrid::MORTON);
+	const auto numVoxels = static_cast<double>(linear.GetNumVoxels());
+
+	printf("Voxel layout benchmark, %u^3 grid (%.1f MB), best of %u\n\n", size, numVoxels / 1.0e6, repeats);
+
+	// Transposition kernels vs. per-voxel encoding
+	vector<uint8_t> buffer(linear.GetNumVoxels());
+	const auto tL2M = Bench::Measure(repeats, [&]() { VoxelGrid::LinearToMorton(buffer.data(), linear.GetData(), size); });
+	const auto tM2L = Bench::Measure(repeats, [&]() { VoxelGrid::MortonToLinear(buffer.data(), morton.GetData(), size); });
+	const auto tNaive = Bench::Measure(repeats, [&]()
+	{
+		auto pSrc = linear.GetData();
+		for (auto z = 0u; z < size; ++z)
+			for (auto y = 0u; y < size; ++y)
+				for (auto x = 0u; x < size; ++x)
+					buffer[Morton::Encode(x, y, z)] = *pSrc++;
+	});
+
+	// The kernel against the per-voxel transposition, which ran last, and its round trip
+	const auto reference = buffer;
+	vector<uint8_t> roundTrip(buffer.size());
+	VoxelGrid::LinearToMorton(buffer.data(), linear.GetData(), size);
+	VoxelGrid::MortonToLinear(roundTrip.data(), buffer.data(), size);
+	const auto numL2MMismatches = countMismatches(buffer.data(), reference.data(), buffer.size());
+	const auto numM2LMismatches = countMismatches(roundTrip.data(), linear.GetData(), buffer.size());
+
+	printf("%-32s %10s %12s %12s\n", "Transposition", "ms", "GB/s", "Mismatches");
+	printf("%-32s %10.2f %12.2f %12zu\n", "linear -> Morton (kernel)", tL2M * 1.0e3, numVoxels / tL2M / 1.0e9, numL2MMismatches);
+	printf("%-32s %10.2f %12.2f %12zu\n", "Morton -> linear (kernel)", tM2L * 1.0e3, numVoxels / tM2L / 1.0e9, numM2LMismatches);
+	printf("%-32s %10.2f %12.2f\n\n", "linear -> Morton (per voxel)", tNaive * 1.0e3, numVoxels / tNaive / 1.0e9);
+
+	// 3x3x3 stencil, compared voxel by voxel once back in linear order
+	auto checkLinear = 0.0, checkMorton = 0.0;
+	dstLinear.Create(size, size, size);
+	const auto tStencilL = Bench::Measure(repeats, [&]() { checkLinear = stencilLinear(linear, dstLinear); });
+	dstMorton.Create(size, size, size, VoxelGrid::MORTON);
+	const auto tStencilM = Bench::Measure(repeats, [&]() { checkMorton = stencilMorton(morton, dstMorton); });
+	dstMorton.SetLayout(VoxelGrid::LINEAR);
+	const auto numStencilMismatches = countMismatches(dstLinear.GetData(), dstMorton.GetData(), buffer.size());
+	printf("%-32s %10s %12s\n", "3x3x3 max stencil", "ms", "Mvoxel/s");
+	printf("%-32s %10.2f %12.1f\n", "linear", tStencilL * 1.0e3, numVoxels / tStencilL / 1.0e6);
+	printf("%-32s %10.2f %12.1f\n", "Morton", tStencilM * 1.0e3, numVoxels / tStencilM / 1.0e6);
+	if (checkLinear != checkMorton || numStencilMismatches)
+		printf("Stencil results differ (%.0f vs. %.0f set, %zu mismatches)\n", checkLinear, checkMorton, numStencilMismatches);
+	printf("\n");
+
+	// Ray marching with trilinear fetches
+	uint64_t fetchesL = 0, fetchesM = 0;
+	auto sumL = 0.0, sumM = 0.0;
+	const auto tMarchL = Bench::Measure(repeats, [&]() { fetchesL = 0; sumL = rayMarch(linear, res, fetchesL); });
+	const auto tMarchM = Bench::Measure(repeats, [&]() { fetchesM = 0; sumM = rayMarch(morton, res, fetchesM); });
+	Bench::DoNotOptimize(sumL + sumM);
+	printf("%-32s %10s %12s\n", "Ray marching", "ms", "Mfetch/s");
+	printf("%-32s %10.2f %12.1f\n", "linear", tMarchL * 1.0e3, fetchesL / tMarchL / 1.0e6);
+	printf("%-32s %10.2f %12.1f\n", "Morton", tMarchM * 1.0e3, fetchesM / tMarchM / 1.0e6);
+	if (sumL != sumM) printf("Ray marching results differ (%f vs. %f)\n", sumL, sumM);
+
+	const auto isPassed = !numL2MMismatches && !numM2LMismatches && checkLinear == checkMorton &&
+		!numStencilMismatches && sumL == sumM;
+	printf("\n%s\n", isPassed ? "All checks passed" : "FAILED");
+
+	return isPassed ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <fstream>
+#include "Bench.h"
+#include "Optional/XUSGObjLoader.h"
+#include "Profiler.h"
+
+using namespace std;
+
+namespace
+{
+	struct Result
+	{
+		string Mesh;
+		uint64_t FileSize;
+		uint32_t NumTriangles;
+		double Seconds;
+		double FirstPassSeconds;
+		double SecondPassSeconds;
+		double NormalSeconds;
+		uint64_t NumAllocations;
+		uint64_t NumAllocatedBytes;
+		uint64_t PeakRSS;
+	};
+
+	uint64_t getFileSize(const char* fileName)
+	{
+		ifstream file(fileName, ios::binary | ios::ate);
+
+		return file ? static_cast<uint64_t>(file.tellg()) : 0;
+	}
+
+	// A torus of about numTriangles indexed triangles without normals, so that the loader
+	// also runs its normal pass, formatted in blocks as the file can be gigabytes
+	bool writeTorus(const char* fileName, uint32_t numTriangles)
+	{
+		const auto numRings = (max)(static_cast<uint32_t>(sqrt(numTriangles / 2.0)), 3u);
+		const auto numSides = (max)((numTriangles / 2 + numRings - 1) / numRings, 3u);
+
+		const auto pFile = fopen(fileName, "wb");
+		if (!pFile) return false;
+
+		string text;
+		char line[96];
+		const auto flush = [&](bool isForced)
+		{
+			if (!isForced && text.size() < (1 << 20)) return;
+			fwrite(text.data(), 1, text.size(), pFile);
+			text.clear();
+		};
+
+		const auto twoPi = 6.28318530718;
+		for (auto i = 0u; i < numRings; ++i)
+		{
+			const auto u = twoPi * i / numRings;
+			for (auto j = 0u; j < numSides; ++j)
+			{
+				const auto v = twoPi * j / numSides;
+				const auto r = 1.0 + 0.4 * cos(v);
+				snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", r * cos(u), 0.4 * sin(v), r * sin(u));
+				text += line;
+				flush(false);
+			}
+		}
+
+		for (auto i = 0u; i < numRings; ++i)
+		{
+			const auto i1 = (i + 1) % numRings;
+			for (auto j = 0u; j < numSides; ++j)
+			{
+				const auto j1 = (j + 1) % numSides;
+				const auto a = i * numSides + j + 1, b = i1 * numSides + j + 1;
+				const auto c = i1 * numSides + j1 + 1, d = i * numSides + j1 + 1;
+				snprintf(line, sizeof(line), "f %u %u %u\nf %u %u %u\n", a, b, c, a, c, d);
+				text += line;
+				flush(false);
+			}
+		}
+		flush(true);
+
+		return !fclose(pFile);
+	}
+
+	bool writeJSON(const char* fileName, const vector<Result>& results)
+	{
+		ofstream file(fileName, ios::trunc);
+		if (!file) return false;
+
+		char buffer[512];
+		file << "{\"profiler\":" << (ENABLE_PROFILER ? "true" : "false") << ",\"results\":[";
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const auto& r = results[i];
+			snprintf(buffer, sizeof(buffer), "%s\n{\"mesh\":\"%s\",\"bytes\":%llu,\"triangles\":%u,\"ms\":%.3f,"
+				"\"mbPerSecond\":%.2f,\"firstPassMs\":%.3f,\"secondPassMs\":%.3f,\"normalsMs\":%.3f,"
+				"\"allocations\":%llu,\"allocatedBytes\":%llu,\"peakRSS\":%llu}", i ? "," : "", r.Mesh.c_str(),
+				static_cast<unsigned long long>(r.FileSize), r.NumTriangles, r.Seconds * 1.0e3,
+				r.FileSize / r.Seconds / 1048576.0, r.FirstPassSeconds * 1.0e3, r.SecondPassSeconds * 1.0e3,
+				r.NormalSeconds * 1.0e3, static_cast<unsigned long long>(r.NumAllocations),
+				static_cast<unsigned long long>(r.NumAllocatedBytes), static_cast<unsigned long long>(r.PeakRSS));
+			file << buffer;
+		}
+		file << "\n]}\n";
+
+		return static_cast<bool>(file);
+	}
+}
+
+int RunLoaderBench(int argc, char* argv[])
+{
+	const auto meshFileNames = Bench::ParseList(argc, argv, "meshes", "Assets/bunny.obj,Assets/dragon.obj,Assets/TuringBowl.obj");
+	const auto triangleList = Bench::ParseList(argc, argv, "triangles", "1000000,10000000");
+	const auto syntheticFileName = Bench::ParseString(argc, argv, "synthetic", "DXRVoxelizerBench_synthetic.obj");
+	const auto repeats = Bench::ParseUInt(argc, argv, "repeats", 3);
+	const auto jsonFileName = Bench::ParseString(argc, argv, "json", nullptr);
+
+	// The inputs: the meshes as they are, then a synthetic torus per triangle count
+	vector<string> inputs(meshFileNames);
+	inputs.insert(inputs.end(), triangleList.cbegin(), triangleList.cend());
+
+	printf("OBJ loading, best of %u; pass times %s\n\n", repeats,
+		ENABLE_PROFILER ? "from the profiling zones" : "need ENABLE_PROFILER");
+	printf("%-22s %9s %11s %9s %8s %9s %9s %9s %10s %9s %9s\n", "Mesh", "File MB", "Triangles", "ms", "MB/s",
+		"Pass 1 ms", "Pass 2 ms", "Normal ms", "Allocs", "Alloc MB", "Peak MB");
+
+	// Takes the ring of this thread up front, so that it is not an allocation of a load
+	{
+		const Profiler::Zone zone("loader bench");
+	}
+
+	vector<Result> results;
+	for (size_t n = 0; n < inputs.size(); ++n)
+	{
+		const auto isSynthetic = n >= meshFileNames.size();
+		const auto fileName = isSynthetic ? syntheticFileName : inputs[n].c_str();
+		if (isSynthetic && !writeTorus(fileName, static_cast<uint32_t>(strtoul(inputs[n].c_str(), nullptr, 10))))
+		{
+			fprintf(stderr, "Failed to write %s.\n", fileName);
+
+			return 1;
+		}
+
+		Result r = {};
+		r.Mesh = isSynthetic ? "torus " + inputs[n] : inputs[n];
+		r.FileSize = getFileSize(fileName);
+		r.Seconds = 1.0e30;
+
+		// The pass times and counts of the fastest run; the peak of any
+		auto isSucceeded = true;
+		for (auto i = 0u; i < repeats && isSucceeded; ++i)
+		{
+			Profiler::Clear();
+			Bench::ResetPeakRSS();
+			const auto counts = Bench::GetAllocationCounts();
+			const auto start = chrono::steady_clock::now();
+
+			XUSG::ObjLoader objLoader;
+			isSucceeded = objLoader.Import(fileName, true, true);
+
+			const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+			const auto newCounts = Bench::GetAllocationCounts();
+			r.PeakRSS = (max)(r.PeakRSS, Bench::GetPeakRSS());
+			if (elapsed.count() >= r.Seconds) continue;
+
+			r.Seconds = elapsed.count();
+			r.NumTriangles = objLoader.GetNumIndices() / 3;
+			r.FirstPassSeconds = Profiler::GetZoneSeconds("OBJ first pass");
+			r.SecondPassSeconds = Profiler::GetZoneSeconds("OBJ second pass");
+			r.NormalSeconds = Profiler::GetZoneSeconds("OBJ normals");
+			r.NumAllocations = newCounts.NumAllocations - counts.NumAllocations;
+			r.NumAllocatedBytes = newCounts.NumBytes - counts.NumBytes;
+		}
+		if (isSynthetic) remove(fileName);
+		if (!isSucceeded)
+		{
+			fprintf(stderr, "Failed to load %s.\n", r.Mesh.c_str());
+
+			return 1;
+		}
+
+		printf("%-22s %9.2f %11u %9.2f %8.2f %9.2f %9.2f %9.2f %10llu %9.2f %9.1f\n", r.Mesh.c_str(),
+			r.FileSize / 1048576.0, r.NumTriangles, r.Seconds * 1.0e3, r.FileSize / r.Seconds / 1048576.0,
+			r.FirstPassSeconds * 1.0e3, r.SecondPassSeconds * 1.0e3, r.NormalSeconds * 1.0e3,
+			static_cast<unsigned long long>(r.NumAllocations), r.NumAllocatedBytes / 1048576.0, r.PeakRSS / 1048576.0);
+		results.push_back(r);
+	}
+
+	return !jsonFileName || writeJSON(jsonFileName, results) ? 0 : 1;
+}
@@ -0,0 +1,45 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include "Bench.h"
+
+struct Suite
+{
+	const char* Name;
+	int (*Run)(int argc, char* argv[]);
+	const char* Description;
+};
+
+static const Suite g_suites[] =
+{
+	{ "backend", RunBackendBench, "Voxelizer backends on identical inputs: selection of the fastest, voxels and images compared" },
+	{ "bluenoise", RunBlueNoiseBench, "Void-and-cluster blue-noise texture: generates BlueNoiseTexture.h of the ray caster" },
+	{ "cache", RunCacheBench, "Content-addressed voxelization cache: cold vs. warm startup" },
+	{ "export", RunExportBench, "Raw, NRRD and MagicaVoxel .vox export from dense, RLE and chunk file sources" },
+	{ "golden", RunGoldenBench, "Golden-output regression: CPU voxel grids and renders of fixed cameras against checked-in goldens" },
+	{ "io", RunIOBench, "Chunked LZ voxel grid file: write and random-access read throughput" },
+	{ "layout", RunLayoutBench, "Linear vs. Morton voxel layout: transposition, 3x3x3 stencil and ray marching" },
+	{ "loader", RunLoaderBench, "OBJ loading of the meshes and of synthetic tori: MB/s, passes, heap allocations and peak RSS" },
+	{ "mip", RunMipBench, "Voxel mip chain: box and max pyramid build, and level of detail of the CPU ray caster" },
+	{ "profile", RunProfileBench, "Scoped profiling zones: cost per zone on 1..N threads and Chrome trace export" },
+	{ "progressive", RunProgressiveBench, "Progressive CPU ray casting: convergence vs. time, still and moving camera" },
+	{ "render", RunRenderBench, "CPU reference of PSRayCast: marchers and light march vs. transmittance volume, to PNG" },
+	{ "rle", RunRLEBench, "Run-length column grid: wire format round trip, union and intersection against dense, corrupt headers" },
+	{ "schedule", RunScheduleBench, "Frame scheduling of the voxelizers: passes recorded on state changes and idle frames" },
+	{ "scheduler", RunSchedulerBench, "Work-stealing task scheduler: ParallelFor overhead, uneven and nested work, steals and idle time" },
+	{ "timer", RunTimerBench, "Frame timer and stats: cost per frame, and percentiles of frames with stalls vs. the average" },
+	{ "voxelize", RunVoxelizeBench, "CPU voxelization over meshes, sizes, modes and 1..N threads, against a stored baseline" }
+};
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1)
+		for (const auto& suite : g_suites)
+			if (!strcmp(argv[1], suite.Name)) return suite.Run(argc - 1, &argv[1]);
+
+	printf("Usage: DXRVoxelizerBench <suite> [options]\n\nSuites:\n");
+	for (const auto& suite : g_suites) printf("  %-12s %s\n", suite.Name, suite.Description);
+
+	return argc > 1 ? 1 : 0;
+}
@@ -0,0 +1,165 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <cfloat>
+#include <cstring>
+#include <vector>
+#include "Bench.h"
+#include "Optional/XUSGObjLoader.h"
+#include "RayCasterCPU.h"
+#include "VoxelizerCPU.h"
+
+using namespace std;
+
+namespace
+{
+	// Level 1 of the chain against the reduction of each block by VoxelGrid::Get
+	bool checkLevel(const VoxelMipChain& mips, const VoxelGrid& grid)
+	{
+		const auto& level = mips.GetLevel(1);
+		for (auto z = 0u; z < level.GetDepth(); ++z)
+			for (auto y = 0u; y < level.GetHeight(); ++y)
+				for (auto x = 0u; x < level.GetWidth(); ++x)
+				{
+					auto value = 0u;
+					for (auto i = 0u; i < 8; ++i)
+					{
+						const auto v = grid.Get((min)(2 * x + (i & 1), grid.GetWidth() - 1),
+							(min)(2 * y + (i >> 1 & 1), grid.GetHeight() - 1), (min)(2 * z + (i >> 2), grid.GetDepth() - 1));
+						value = mips.GetFilter() == VoxelMipChain::MAX ? (max)(value, static_cast<uint32_t>(v)) : value + v;
+					}
+					value = mips.GetFilter() == VoxelMipChain::MAX ? value : (value + 4) >> 3;
+					if (level.Get(x, y, z) != value) return false;
+				}
+
+		return true;
+	}
+}
+
+int RunMipBench(int argc, char* argv[])
+{
+	const auto meshFileName = Bench::ParseString(argc, argv, "mesh", "Assets/bunny.obj");
+	const auto posScaleString = Bench::ParseString(argc, argv, "posscale", "0,0,0,1");
+	const auto distance = static_cast<float>(atof(Bench::ParseString(argc, argv, "distance", "1")));	// Of the eye
+	const auto size = Bench::ParseUInt(argc, argv, "size", 256);
+	const auto width = Bench::ParseUInt(argc, argv, "width", 640);
+	const auto height = Bench::ParseUInt(argc, argv, "height", 360);
+	const auto threads = Bench::ParseUInt(argc, argv, "threads", 0);
+	const auto repeats = Bench::ParseUInt(argc, argv, "repeats", 3);
+
+	float posScale[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	sscanf(posScaleString, "%f,%f,%f,%f", &posScale[0], &posScale[1], &posScale[2], &posScale[3]);
+
+	XUSG::ObjLoader objLoader;
+	VoxelizerCPU voxelizer;
+	VoxelGrid grid;
+	if (!objLoader.Import(meshFileName, true, true) ||
+		!voxelizer.Init(objLoader.GetVertices(), objLoader.GetNumVertices(), objLoader.GetVertexStride(),
+			objLoader.GetIndices(), objLoader.GetNumIndices()) ||
+		!voxelizer.Voxelize(grid, size, VoxelizerCPU::PER_VOXEL, threads))
+	{
+		fprintf(stderr, "Failed to voxelize %s.\n", meshFileName);
+
+		return 1;
+	}
+
+	printf("Voxel mip chain benchmark, %s at %u^3, best of %u\n\n", meshFileName, size, repeats);
+	printf("%-8s %8s %12s %10s %12s %8s\n", "Filter", "Levels", "Level bytes", "ms", "MB/s", "Check");
+
+	static const char* filterNames[] = { "box", "max" };
+	VoxelMipChain mips;
+	for (auto f = 0u; f < 2; ++f)
+	{
+		const auto filter = static_cast<VoxelMipChain::Filter>(f);
+		auto isCreated = true;
+		const auto t = Bench::Measure(repeats, [&]() { isCreated = mips.Create(grid, filter, 0, threads) && isCreated; });
+		if (!isCreated)
+		{
+			fprintf(stderr, "Failed to build the %s mip chain.\n", filterNames[f]);
+
+			return 1;
+		}
+
+		printf("%-8s %8u %12zu %10.2f %12.1f %8s\n", filterNames[f], mips.GetNumLevels(), mips.GetNumBytes(),
+			t * 1.0e3, grid.GetNumVoxels() / t / 1.0e6, checkLevel(mips, grid) ? "ok" : "FAILED");
+	}
+
+	// The box filter for shading; the camera of the app, moved away by the distance
+	if (!mips.Create(grid, VoxelMipChain::BOX, 0, threads))
+	{
+		fprintf(stderr, "Failed to build the box mip chain.\n");
+
+		return 1;
+	}
+
+	RayCasterCPU rayCaster;
+	if (!rayCaster.Init(width, height, grid, voxelizer.GetBound(), posScale))
+	{
+		fprintf(stderr, "Failed to set up the ray caster.\n");
+
+		return 1;
+	}
+
+	const Float3 focusPt(0.0f, 4.0f, 0.0f);
+	const auto eyePt = focusPt + (Float3(8.0f, 12.0f, -14.0f) - focusPt) * distance;
+	const auto view = LookAtLH(eyePt, focusPt, Float3(0.0f, 1.0f, 0.0f));
+	const auto proj = PerspectiveFovLH(0.785398163f, width / static_cast<float>(height), 1.0f, 1000.0f);
+	rayCaster.UpdateFrame(eyePt, view * proj);
+
+	// Distinct bricks of BrickSize^3 voxels read per level, for the memory traffic; counted
+	// in a render of their own, as the counting is not free
+	const auto numPixels = static_cast<double>(width) * height;
+	printf("\nLevel of detail of %s, %s, %ux%u, eye at %.2fx the distance\n\n",
+		RayCasterCPU::GetMarcherName(RayCasterCPU::FIXED_STEP), RayCasterCPU::GetLightingName(RayCasterCPU::LIGHT_MARCH),
+		width, height, distance);
+	printf("%-8s %10s %10s %14s %20s %10s %10s %10s\n", "LOD bias", "ms", "Speedup", "Samples/pixel",
+		"Bricks per level", "KB read", "Max diff", "PSNR (dB)");
+
+	vector<uint8_t> reference(static_cast<size_t>(width) * height * 4), image(reference.size());
+	const float biases[] = { 0.0f, 1.0f, 2.0f };
+	const auto setCase = [&](int i) { rayCaster.SetLevelOfDetail(i ? &mips : nullptr, i ? biases[i - 1] : 0.0f); };
+
+	// The cases take turns in each repeat, so that a drift of the clock slows them alike
+	double times[] = { DBL_MAX, DBL_MAX, DBL_MAX, DBL_MAX };
+	for (auto r = 0u; r < repeats; ++r)
+		for (auto i = 0; i <= 3; ++i)
+		{
+			setCase(i);
+			auto& target = i ? image : reference;
+			times[i] = (min)(times[i], Bench::Measure(1, [&]() { rayCaster.Render(target.data(),
+				RayCasterCPU::FIXED_STEP, RayCasterCPU::LIGHT_MARCH, threads); }));
+		}
+
+	for (auto i = 0; i <= 3; ++i)
+	{
+		setCase(i);
+		rayCaster.SetBrickCounting(true);
+		rayCaster.Render(image.data(), RayCasterCPU::FIXED_STEP, RayCasterCPU::LIGHT_MARCH, threads);
+		rayCaster.SetBrickCounting(false);
+
+		auto maxDiff = 0;
+		const auto psnr = Bench::ComputePSNR(image.data(), reference.data(), image.size() / 4, &maxDiff);
+		const auto samplesPerPixel = rayCaster.GetNumSamples() / numPixels;
+
+		char bricks[64] = "";
+		uint64_t numBricks = 0;
+		for (auto level = 0u; level < (i ? mips.GetNumLevels() : 1); ++level)
+		{
+			const auto n = rayCaster.GetNumBricks(level);
+			if (level && !n) continue;
+			const auto length = strlen(bricks);
+			snprintf(bricks + length, sizeof(bricks) - length, "%s%u:%llu", level ? " " : "", level,
+				static_cast<unsigned long long>(n));
+			numBricks += n;
+		}
+		const auto brickBytes = RayCasterCPU::BrickSize * RayCasterCPU::BrickSize * RayCasterCPU::BrickSize;
+
+		char bias[16];
+		if (i) snprintf(bias, sizeof(bias), "%+.1f", biases[i - 1]);
+		printf("%-8s %10.2f %10.2f %14.1f %20s %10.1f %10d %10.2f\n", i ? bias : "off", times[i] * 1.0e3,
+			times[0] / times[i], samplesPerPixel, bricks, numBricks * brickBytes / 1024.0, maxDiff, psnr);
+	}
+
+	return 0;
+}
@@ -0,0 +1,87 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <thread>
+#include "Bench.h"
+#include "ParallelFor.h"
+#include "Profiler.h"
+#include "TaskScheduler.h"
+
+using namespace std;
+
+namespace
+{
+	// Nested as the zones of a parallel pass are
+	void recordZones(uint32_t numZones)
+	{
+		for (auto i = 0u; i < numZones; i += 2)
+		{
+			const Profiler::Zone outer("bench outer");
+			const Profiler::Zone inner("bench inner");
+		}
+	}
+}
+
+int RunProfileBench(int argc, char* argv[])
+{
+	const auto numZones = Bench::ParseUInt(argc, argv, "zones", 1 << 20);
+	const auto threads = Bench::ParseUInt(argc, argv, "threads", 0);
+	const auto repeats = Bench::ParseUInt(argc, argv, "repeats", 5);
+	const auto traceFileName = Bench::ParseString(argc, argv, "trace", nullptr);
+	const auto budget = atof(Bench::ParseString(argc, argv, "budget", "50"));	// ns per zone
+	const auto numThreads = threads ? threads : (max)(thread::hardware_concurrency(), 1u);
+	if (numThreads > TaskScheduler::GetNumWorkers() + 1) TaskScheduler::Init(numThreads - 1);
+
+	// Profiler::Zone records whether or not ENABLE_PROFILER compiles PROFILE_ZONE in
+	printf("Profiling zones, %u zones per thread, best of %u; PROFILE_ZONE is %s in this build\n\n",
+		numZones, repeats, ENABLE_PROFILER ? "on" : "compiled out");
+	printf("%-22s %10s %12s %12s\n", "Case", "ms", "Mzones/s", "ns/zone");
+
+	// The time of a zone is of the thread that records it, as if each had a core
+	const auto numCores = (max)(thread::hardware_concurrency(), 1u);
+	const auto print = [&](const char* name, double t, uint32_t numThreads)
+	{
+		const auto total = static_cast<double>(numZones) * numThreads;
+		const auto nsPerZone = t * (min)(numThreads, numCores) / total * 1.0e9;
+		printf("%-22s %10.2f %12.2f %12.2f\n", name, t * 1.0e3, total / t / 1.0e6, nsPerZone);
+
+		return nsPerZone;
+	};
+
+	uint64_t sink = 0;
+	print("steady_clock", Bench::Measure(repeats, [&]()
+	{
+		for (auto i = 0u; i < numZones; ++i) sink += Profiler::GetNanoseconds();
+	}), 1);
+	print("timestamp", Bench::Measure(repeats, [&]()
+	{
+		for (auto i = 0u; i < numZones; ++i) sink += Profiler::GetTicks();
+	}), 1);
+	Bench::DoNotOptimize(static_cast<double>(sink));
+
+	auto nsPerZone = print("zone, 1 thread", Bench::Measure(repeats, [&]() { recordZones(numZones); }), 1);
+
+	// Every thread records into its own ring, so the time per zone should hold
+	if (numThreads > 1)
+	{
+		char label[32];
+		snprintf(label, sizeof(label), "zone, %u threads", numThreads);
+		nsPerZone = (max)(nsPerZone, print(label, Bench::Measure(repeats, [&]()
+		{
+			ParallelFor(0, numThreads, numThreads, [&](uint32_t) { recordZones(numZones); });
+		}), numThreads));
+	}
+
+	const auto fileName = traceFileName ? traceFileName : "DXRVoxelizerBench.json";
+	auto isWritten = true;
+	const auto tExport = Bench::Measure(1, [&]() { isWritten = Profiler::WriteChromeTrace(fileName); });
+	printf("\n%u rings, %llu zones recorded, the last %u of each ring exported in %.2f ms\n", Profiler::GetNumRings(),
+		static_cast<unsigned long long>(Profiler::GetNumEvents()), Profiler::RingSize, tExport * 1.0e3);
+	if (!traceFileName) remove(fileName);
+
+	const auto isInBudget = nsPerZone <= budget;
+	printf("%.2f ns per zone, %s the budget of %g ns\n", nsPerZone, isInBudget ? "within" : "OVER", budget);
+
+	return isWritten && isInBudget ? 0 : 1;
+}
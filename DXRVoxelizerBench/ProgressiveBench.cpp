@@ -0,0 +1,149 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <vector>
+#include "Bench.h"
+#include "Optional/XUSGObjLoader.h"
+#include "ProgressiveRayCaster.h"
+#include "stb_image_write.h"
+#include "VoxelizerCPU.h"
+
+using namespace std;
+
+int RunProgressiveBench(int argc, char* argv[])
+{
+	const auto meshFileName = Bench::ParseString(argc, argv, "mesh", "Assets/bunny.obj");
+	const auto outFileName = Bench::ParseString(argc, argv, "out", "DXRVoxelizerBenchProgressive.png");
+	const auto posScaleString = Bench::ParseString(argc, argv, "posscale", "0,0,0,1");
+	const auto orbit = static_cast<float>(atof(Bench::ParseString(argc, argv, "orbit", "0.25")));	// Degrees per frame
+	const auto size = Bench::ParseUInt(argc, argv, "size", 64);
+	const auto width = Bench::ParseUInt(argc, argv, "width", 1280);
+	const auto height = Bench::ParseUInt(argc, argv, "height", 720);
+	const auto samples = Bench::ParseUInt(argc, argv, "samples", 16);
+	const auto frames = Bench::ParseUInt(argc, argv, "frames", 64);
+	const auto threads = Bench::ParseUInt(argc, argv, "threads", 0);
+	const auto minPSNR = atof(Bench::ParseString(argc, argv, "minpsnr", "40"));	// Of the still image
+
+	float posScale[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	sscanf(posScaleString, "%f,%f,%f,%f", &posScale[0], &posScale[1], &posScale[2], &posScale[3]);
+
+	XUSG::ObjLoader objLoader;
+	VoxelizerCPU voxelizer;
+	if (!objLoader.Import(meshFileName, true, true) ||
+		!voxelizer.Init(objLoader.GetVertices(), objLoader.GetNumVertices(), objLoader.GetVertexStride(),
+			objLoader.GetIndices(), objLoader.GetNumIndices()))
+	{
+		fprintf(stderr, "Failed to load %s.\n", meshFileName);
+
+		return 1;
+	}
+
+	VoxelGrid grid;
+	MacroCellGrid macroCells;
+	ProgressiveRayCaster rayCaster;
+	if (!voxelizer.Voxelize(grid, size, VoxelizerCPU::PER_VOXEL, threads) ||
+		!macroCells.Create(grid, 4, threads) ||
+		!rayCaster.Init(width, height, grid, voxelizer.GetBound(), posScale, &macroCells, nullptr, samples))
+	{
+		fprintf(stderr, "Failed to set up %s with %u samples per frame.\n", meshFileName, samples);
+
+		return 1;
+	}
+
+	// The initial camera of the app, orbiting the focus about the y axis
+	const Float3 focusPt(0.0f, 4.0f, 0.0f);
+	const auto proj = PerspectiveFovLH(0.785398163f, width / static_cast<float>(height), 1.0f, 1000.0f);
+	const auto setCamera = [&](float degrees)
+	{
+		const auto angle = degrees * 3.14159265f / 180.0f;
+		const auto c = cosf(angle), s = sinf(angle);
+		const Float3 offset(8.0f, 8.0f, -14.0f);
+		const auto eyePt = focusPt + Float3(offset.x * c - offset.z * s, offset.y, offset.x * s + offset.z * c);
+		rayCaster.UpdateFrame(eyePt, LookAtLH(eyePt, focusPt, Float3(0.0f, 1.0f, 0.0f)) * proj);
+	};
+
+	const auto numPixels = static_cast<size_t>(width) * height;
+	vector<uint8_t> reference(numPixels * 4), image(numPixels * 4);
+	const auto renderReference = [&]()
+	{
+		return Bench::Measure(1, [&]() { rayCaster.Render(reference.data(), RayCasterCPU::FIXED_STEP); });
+	};
+
+	setCamera(0.0f);
+	const auto tReference = renderReference();
+
+	printf("Progressive CPU ray casting, %s at %u^3, %ux%u, %u of %u samples per frame\n", meshFileName, size,
+		width, height, samples, RayCasterCPU::NumSamples);
+	printf("Full-rate fixed step: %.2f ms per frame\n\n", tReference * 1.0e3);
+
+	// Still camera: convergence to the full-rate image over time
+	printf("%-8s %12s %12s %14s %12s %10s\n", "Frames", "Frame ms", "Total ms", "Samples/pixel", "PSNR (dB)",
+		"Max diff");
+
+	auto tTotal = 0.0;
+	auto framesToMin = 0u;
+	auto tToMin = 0.0;
+	auto psnr = 0.0;
+	for (auto f = 1u; f <= frames; ++f)
+	{
+		const auto t = Bench::Measure(1, [&]() { rayCaster.RenderFrame(image.data(), RayCasterCPU::LIGHT_MARCH, threads); });
+		tTotal += t;
+
+		auto maxDiff = 0;
+		psnr = Bench::ComputePSNR(image.data(), reference.data(), numPixels, &maxDiff);
+		if (!framesToMin && psnr >= minPSNR)
+		{
+			framesToMin = f;
+			tToMin = tTotal;
+		}
+		if (!(f & (f - 1)) || f == frames)
+			printf("%-8u %12.2f %12.2f %14.1f %12.2f %10d\n", f, t * 1.0e3, tTotal * 1.0e3,
+				rayCaster.GetNumSamples() / static_cast<double>(numPixels), psnr, maxDiff);
+	}
+
+	// The still image has to converge and stay converged, and then stop marching once each
+	// subset of the pixels has marched its full ray at the camera
+	const auto isConverged = framesToMin && psnr >= minPSNR;
+	const auto isIdle = frames <= RayCasterCPU::NumSamples / samples + 1 || !rayCaster.GetNumSamples();
+	if (framesToMin)
+		printf("\n%g dB after %u frames, %.2f ms (%.2fx a full-rate frame)\n", minPSNR, framesToMin, tToMin * 1.0e3,
+			tToMin / tReference);
+	printf("%s, %s\n", isConverged ? "Converged" : "NOT CONVERGED",
+		isIdle ? "the last frame only resolved the history" : "the last frame STILL MARCHED");
+
+	if (!stbi_write_png(outFileName, width, height, 4, image.data(), width * 4))
+	{
+		fprintf(stderr, "Failed to write %s.\n", outFileName);
+
+		return 1;
+	}
+	printf("Wrote the still image of %u frames to %s\n\n", frames, outFileName);
+
+	// Moving camera: reprojected history vs. a single frame at the final position
+	const auto numMoves = 16u;
+	const auto numResets = rayCaster.GetNumResets();
+	for (auto f = 1u; f <= numMoves; ++f)
+	{
+		setCamera(orbit * f);
+		rayCaster.RenderFrame(image.data(), RayCasterCPU::LIGHT_MARCH, threads);
+	}
+	renderReference();
+	const auto psnrMoving = Bench::ComputePSNR(image.data(), reference.data(), numPixels);
+	const auto movingResets = rayCaster.GetNumResets() - numResets;
+
+	rayCaster.Reset();
+	rayCaster.RenderFrame(image.data(), RayCasterCPU::LIGHT_MARCH, threads);
+	const auto psnrSingle = Bench::ComputePSNR(image.data(), reference.data(), numPixels);
+
+	printf("Orbiting %.2f degrees per frame for %u frames: %.2f dB reprojected (%u reset(s)), %.2f dB from one frame\n",
+		orbit, numMoves, psnrMoving, movingResets, psnrSingle);
+
+	// A jump beyond the motion threshold restarts the accumulation
+	const auto resetsBeforeJump = rayCaster.GetNumResets();
+	setCamera(orbit * numMoves + 30.0f);
+	rayCaster.RenderFrame(image.data(), RayCasterCPU::LIGHT_MARCH, threads);
+	printf("Jump of 30 degrees: %s\n", rayCaster.GetNumResets() > resetsBeforeJump ? "history reset" : "history kept");
+
+	return isConverged && isIdle ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <stdexcept>
+#include <utility>
+#include "Bench.h"
+#include "Optional/XUSGObjLoader.h"
+#include "RLEGrid.h"
+#include "VoxelGrid.h"
+#include "VoxelizerCPU.h"
+
+using namespace std;
+
+namespace
+{
+	bool voxelize(RLEGrid& grid, const char* meshFileName, uint32_t size, uint32_t threads)
+	{
+		XUSG::ObjLoader objLoader;
+		VoxelizerCPU voxelizer;
+
+		return objLoader.Import(meshFileName, true, true) &&
+			voxelizer.Init(objLoader.GetVertices(), objLoader.GetNumVertices(), objLoader.GetVertexStride(),
+				objLoader.GetIndices(), objLoader.GetNumIndices()) &&
+			voxelizer.Voxelize(grid, size, VoxelizerCPU::COLUMN, threads);
+	}
+
+	// Voxels whose occupancy differs from that of op over the two dense grids
+	template<typename Op>
+	size_t countMismatches(const RLEGrid& result, const VoxelGrid& a, const VoxelGrid& b, Op op)
+	{
+		VoxelGrid dense;
+		if (!result.ToDense(dense) || dense.GetNumVoxels() != a.GetNumVoxels()) return a.GetNumVoxels();
+
+		size_t numMismatches = 0;
+		for (size_t i = 0; i < a.GetNumVoxels(); ++i)
+			numMismatches += (dense.GetData()[i] != 0) != op(a.GetData()[i] != 0, b.GetData()[i] != 0) ? 1 : 0;
+
+		return numMismatches;
+	}
+
+	// Corrupt data must be rejected, not thrown on or allocated for
+	bool isRejected(const uint8_t* pData, size_t size)
+	{
+		try
+		{
+			RLEGrid grid;
+
+			return !grid.Deserialize(pData, size);
+		}
+		catch (const exception&)
+		{
+			return false;
+		}
+	}
+}
+
+int RunRLEBench(int argc, char* argv[])
+{
+	const auto meshFileNameA = Bench::ParseString(argc, argv, "mesh", "Assets/bunny.obj");
+	const auto meshFileNameB = Bench::ParseString(argc, argv, "mesh2", "Assets/dragon.obj");
+	const auto size = Bench::ParseUInt(argc, argv, "size", 256);
+	const auto threads = Bench::ParseUInt(argc, argv, "threads", 0);
+	const auto repeats = Bench::ParseUInt(argc, argv, "repeats", 5);
+
+	RLEGrid a, b;
+	if (!voxelize(a, meshFileNameA, size, threads) || !voxelize(b, meshFileNameB, size, threads))
+	{
+		fprintf(stderr, "Failed to voxelize %s or %s.\n", meshFileNameA, meshFileNameB);
+
+		return 1;
+	}
+
+	VoxelGrid denseA, denseB;
+	a.ToDense(denseA);
+	b.ToDense(denseB);
+	const auto numVoxels = static_cast<double>(denseA.GetNumVoxels());
+
+	printf("Run-length grid, %s and %s at %u^3 (%zu and %zu runs), best of %u\n\n",
+		meshFileNameA, meshFileNameB, size, a.GetNumRuns(), b.GetNumRuns(), repeats);
+	printf("%-22s %10s %12s %12s\n", "Operation", "ms", "Gvoxels/s", "Mismatches");
+	const auto print = [&](const char* name, double t, size_t numMismatches)
+	{
+		printf("%-22s %10.2f %12.2f %12zu\n", name, t * 1.0e3, numVoxels / t / 1.0e9, numMismatches);
+	};
+
+	// Wire format round trip
+	vector<uint8_t> data;
+	RLEGrid readGrid;
+	auto isRead = true;
+	const auto tSerialize = Bench::Measure(repeats, [&]() { a.Serialize(data); });
+	const auto tDeserialize = Bench::Measure(repeats, [&]()
+	{
+		isRead = readGrid.Deserialize(data.data(), data.size()) && isRead;
+	});
+	const auto numRoundTripMismatches = isRead ? countMismatches(readGrid, denseA, denseA,
+		[](bool a, bool) { return a; }) : denseA.GetNumVoxels();
+	print("serialize", tSerialize, 0);
+	print("deserialize", tDeserialize, numRoundTripMismatches);
+
+	// Set operations against the dense equivalent
+	RLEGrid result;
+	auto isMerged = true;
+	const auto tUnion = Bench::Measure(repeats, [&]() { isMerged = RLEGrid::Union(result, a, b) && isMerged; });
+	const auto numUnionMismatches = countMismatches(result, denseA, denseB, [](bool a, bool b) { return a || b; });
+	print("union", tUnion, numUnionMismatches);
+
+	const auto tIntersect = Bench::Measure(repeats, [&]() { isMerged = RLEGrid::Intersect(result, a, b) && isMerged; });
+	const auto numIntersectMismatches = countMismatches(result, denseA, denseB, [](bool a, bool b) { return a && b; });
+	print("intersect", tIntersect, numIntersectMismatches);
+
+	// Corrupt headers: truncated data, dimensions or run counts that the data cannot
+	// hold, and height and depth of 65536, whose 2^32 columns wrap to 0 in 32 bits
+	const auto corrupt = [&](initializer_list<pair<uint32_t, uint32_t>> words)
+	{
+		auto corrupted = data;
+		for (const auto& word : words) memcpy(&corrupted[sizeof(uint32_t) * word.first], &word.second, sizeof(uint32_t));
+
+		return corrupted;
+	};
+
+	struct Case
+	{
+		const char* Name;
+		vector<uint8_t> Data;
+		size_t Size;
+	};
+
+	const size_t headerSize = sizeof(uint32_t) * 6;
+	const Case cases[] =
+	{
+		{ "empty", data, 0 },
+		{ "truncated header", data, headerSize - 1 },
+		{ "header only", data, headerSize },
+		{ "truncated runs", data, data.size() - 1 },
+		{ "bad FourCC", corrupt({ { 0, 0 } }), data.size() },
+		{ "oversized width", corrupt({ { 2, 1u << 16 } }), data.size() },
+		{ "oversized height", corrupt({ { 3, UINT32_MAX } }), data.size() },
+		{ "wrapping columns", corrupt({ { 3, 1u << 16 }, { 4, 1u << 16 } }), data.size() },
+		{ "oversized run count", corrupt({ { 5, UINT32_MAX } }), data.size() }
+	};
+
+	auto numRejected = 0u;
+	printf("\n%-22s %10s\n", "Corrupt data", "Rejected");
+	for (const auto& c : cases)
+	{
+		const auto isCaseRejected = isRejected(c.Data.data(), c.Size);
+		printf("%-22s %10s\n", c.Name, isCaseRejected ? "yes" : "NO");
+		numRejected += isCaseRejected ? 1 : 0;
+	}
+	const auto numCases = static_cast<uint32_t>(sizeof(cases) / sizeof(cases[0]));
+
+	const auto isPassed = isRead && isMerged && !numRoundTripMismatches && !numUnionMismatches &&
+		!numIntersectMismatches && numRejected == numCases;
+	printf("\n%s\n", isPassed ? "All checks passed" : "FAILED");
+
+	return isPassed ? 0 : 1;
+}
@@ -0,0 +1,276 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <thread>
+#include <vector>
+#include "Bench.h"
+#include "Optional/XUSGObjLoader.h"
+#include "ScaledRayCaster.h"
+#include "stb_image_write.h"
+#include "VoxelizerCPU.h"
+
+using namespace std;
+
+namespace
+{
+	// Box filter of the color channels over blocks of n x n pixels, which averages the
+	// noise of jittered steps out but keeps their banding
+	vector<uint8_t> downsample(const vector<uint8_t>& image, uint32_t width, uint32_t height, uint32_t n)
+	{
+		const auto w = width / n, h = height / n;
+		vector<uint8_t> result(static_cast<size_t>(w) * h * 4);
+		for (auto y = 0u; y < h; ++y)
+			for (auto x = 0u; x < w; ++x)
+				for (auto k = 0u; k < 4; ++k)
+				{
+					auto sum = 0u;
+					for (auto j = 0u; j < n; ++j)
+						for (auto i = 0u; i < n; ++i)
+							sum += image[(static_cast<size_t>(width) * (n * y + j) + n * x + i) * 4 + k];
+					result[(static_cast<size_t>(w) * y + x) * 4 + k] = static_cast<uint8_t>((sum + n * n / 2) / (n * n));
+				}
+
+		return result;
+	}
+}
+
+int RunRenderBench(int argc, char* argv[])
+{
+	const auto meshFileName = Bench::ParseString(argc, argv, "mesh", "Assets/bunny.obj");
+	const auto meshFileName2 = Bench::ParseString(argc, argv, "mesh2", "Assets/dragon.obj");
+	const auto outFileName = Bench::ParseString(argc, argv, "out", "DXRVoxelizerBench.png");
+	const auto posScaleString = Bench::ParseString(argc, argv, "posscale", "0,0,0,1");
+	const auto size = Bench::ParseUInt(argc, argv, "size", 64);
+	const auto cellSize = Bench::ParseUInt(argc, argv, "cell", 4);
+	const auto width = Bench::ParseUInt(argc, argv, "width", 1280);
+	const auto height = Bench::ParseUInt(argc, argv, "height", 720);
+	const auto threads = Bench::ParseUInt(argc, argv, "threads", 0);
+	const auto repeats = Bench::ParseUInt(argc, argv, "repeats", 3);
+	const auto maxThreads = Bench::ParseUInt(argc, argv, "maxthreads", (max)(thread::hardware_concurrency(), 1u));
+	const auto refSamples = Bench::ParseUInt(argc, argv, "refsamples", 512);
+	const auto refLightSamples = Bench::ParseUInt(argc, argv, "reflightsamples", 4 * RayCasterCPU::NumLightSamples);	// Of +light
+
+	// Same as -mesh <file> x y z scale of the app, comma separated
+	float posScale[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	sscanf(posScaleString, "%f,%f,%f,%f", &posScale[0], &posScale[1], &posScale[2], &posScale[3]);
+
+	XUSG::ObjLoader objLoader;
+	VoxelizerCPU voxelizer;
+	if (!objLoader.Import(meshFileName, true, true) ||
+		!voxelizer.Init(objLoader.GetVertices(), objLoader.GetNumVertices(), objLoader.GetVertexStride(),
+			objLoader.GetIndices(), objLoader.GetNumIndices()))
+	{
+		fprintf(stderr, "Failed to load %s.\n", meshFileName);
+
+		return 1;
+	}
+
+	// Per-voxel mode reproduces the grid of the GPU voxelizer
+	VoxelGrid grid;
+	MacroCellGrid macroCells;
+	TransmittanceVolume transmittance;
+	RayCasterCPU rayCaster;
+	if (!voxelizer.Voxelize(grid, size, VoxelizerCPU::PER_VOXEL, threads) ||
+		!macroCells.Create(grid, cellSize, threads) ||
+		!rayCaster.Init(width, height, grid, voxelizer.GetBound(), posScale, &macroCells, &transmittance))
+	{
+		fprintf(stderr, "Failed to voxelize %s.\n", meshFileName);
+
+		return 1;
+	}
+
+	// Initial camera of the app
+	const Float3 eyePt(8.0f, 12.0f, -14.0f);
+	const auto view = LookAtLH(eyePt, Float3(0.0f, 4.0f, 0.0f), Float3(0.0f, 1.0f, 0.0f));
+	const auto proj = PerspectiveFovLH(0.785398163f, width / static_cast<float>(height), 1.0f, 1000.0f);
+	rayCaster.UpdateFrame(eyePt, view * proj);
+
+	// Build once, then every later update only finds the volume valid
+	auto isBuilt = true;
+	const auto tBuild = Bench::Measure(1, [&]()
+	{
+		isBuilt = transmittance.Update(grid, rayCaster.GetLocalSpaceLightPt(), threads);
+	});
+	const auto tUpdate = Bench::Measure(repeats, [&]()
+	{
+		isBuilt = transmittance.Update(grid, rayCaster.GetLocalSpaceLightPt(), threads) && isBuilt;
+	});
+	if (!isBuilt)
+	{
+		fprintf(stderr, "Failed to build the transmittance volume.\n");
+
+		return 1;
+	}
+
+	const auto numPixels = static_cast<double>(width) * height;
+	const auto numCells = macroCells.GetWidth() * macroCells.GetHeight() * macroCells.GetDepth();
+	printf("CPU ray caster benchmark, %s at %u^3, %ux%u, best of %u\n", meshFileName, size, width, height, repeats);
+	printf("Macro cells of %u^3 voxels, %.1f%% empty\n", cellSize, 100.0 * macroCells.GetNumEmptyCells() / numCells);
+	printf("Transmittance volume built in %.2f ms, %.4f ms per update without changes, %u build(s)\n\n",
+		tBuild * 1.0e3, tUpdate * 1.0e3, transmittance.GetNumBuilds());
+	printf("%-14s %-13s %10s %10s %14s %10s %10s %10s\n", "Marcher", "Lighting", "ms", "Mpixel/s", "Samples/pixel",
+		"Speedup", "Max diff", "PSNR (dB)");
+
+	// The first marcher with the light marched is the reference of the image comparison
+	vector<uint8_t> images[RayCasterCPU::NUM_LIGHTING][RayCasterCPU::NUM_MARCHER];
+	const auto& reference = images[0][0];
+	double tReference = 0.0;
+	for (auto l = 0u; l < RayCasterCPU::NUM_LIGHTING; ++l)
+	{
+		const auto lighting = static_cast<RayCasterCPU::Lighting>(l);
+		for (auto m = 0u; m < RayCasterCPU::NUM_MARCHER; ++m)
+		{
+			const auto marcher = static_cast<RayCasterCPU::Marcher>(m);
+			auto& image = images[l][m];
+			image.resize(static_cast<size_t>(width) * height * 4);
+			const auto t = Bench::Measure(repeats, [&]() { rayCaster.Render(image.data(), marcher, lighting, threads); });
+			tReference = l || m ? tReference : t;
+
+			auto maxDiff = 0;
+			const auto psnr = Bench::ComputePSNR(image.data(), reference.data(), image.size() / 4, &maxDiff);
+
+			printf("%-14s %-13s %10.2f %10.2f %14.1f %10.2f %10d %10.2f\n", RayCasterCPU::GetMarcherName(marcher),
+				RayCasterCPU::GetLightingName(lighting), t * 1.0e3, numPixels / t / 1.0e6,
+				rayCaster.GetNumSamples() / numPixels, tReference / t, maxDiff, psnr);
+		}
+	}
+
+	// Scalar pixels vs. packets of the same fixed-step march, doubling the threads
+	printf("\nThread scaling of %s vs. %s, %s\n\n", RayCasterCPU::GetMarcherName(RayCasterCPU::FIXED_STEP),
+		RayCasterCPU::GetMarcherName(RayCasterCPU::FIXED_STEP_X8), RayCasterCPU::GetLightingName(RayCasterCPU::LIGHT_MARCH));
+	printf("%-8s %12s %12s %12s %12s %12s\n", "Threads", "Scalar ms", "x8 ms", "x8 speedup", "Scalar scale", "x8 scale");
+
+	vector<uint8_t> scratch(static_cast<size_t>(width) * height * 4);
+	double tScalar1 = 0.0, tPacket1 = 0.0;
+	for (auto n = 1u; n <= maxThreads; n = n < maxThreads && n * 2 > maxThreads ? maxThreads : n * 2)
+	{
+		const auto tScalar = Bench::Measure(repeats, [&]()
+		{
+			rayCaster.Render(scratch.data(), RayCasterCPU::FIXED_STEP, RayCasterCPU::LIGHT_MARCH, n);
+		});
+		const auto tPacket = Bench::Measure(repeats, [&]()
+		{
+			rayCaster.Render(scratch.data(), RayCasterCPU::FIXED_STEP_X8, RayCasterCPU::LIGHT_MARCH, n);
+		});
+		tScalar1 = n > 1 ? tScalar1 : tScalar;
+		tPacket1 = n > 1 ? tPacket1 : tPacket;
+
+		printf("%-8u %12.2f %12.2f %12.2f %12.2f %12.2f\n", n, tScalar * 1.0e3, tPacket * 1.0e3,
+			tScalar / tPacket, tScalar1 / tScalar, tPacket1 / tPacket);
+		if (n == maxThreads) break;
+	}
+
+	// Reduced resolution, upsampled with and without the edges marched at full resolution
+	printf("\nRender scale of %s, %s, vs. the full-resolution reference\n\n",
+		RayCasterCPU::GetMarcherName(RayCasterCPU::FIXED_STEP), RayCasterCPU::GetLightingName(RayCasterCPU::LIGHT_MARCH));
+	printf("%-8s %-8s %10s %10s %14s %10s %10s %10s\n", "Scale", "Edges", "ms", "Speedup", "Samples/pixel",
+		"Refined %", "Max diff", "PSNR (dB)");
+
+	for (auto scale = 2u; scale <= 4; scale *= 2)
+		for (auto refine = 0; refine < 2; ++refine)
+		{
+			ScaledRayCaster scaledRayCaster;
+			if (!scaledRayCaster.Init(width, height, grid, voxelizer.GetBound(), posScale, &macroCells,
+				&transmittance, scale, refine != 0))
+			{
+				fprintf(stderr, "Failed to set up the render scale of 1/%u.\n", scale);
+
+				return 1;
+			}
+			scaledRayCaster.UpdateFrame(eyePt, view * proj);
+
+			const auto t = Bench::Measure(repeats, [&]()
+			{
+				scaledRayCaster.RenderScaled(scratch.data(), RayCasterCPU::FIXED_STEP, RayCasterCPU::LIGHT_MARCH, threads);
+			});
+
+			auto maxDiff = 0;
+			const auto psnr = Bench::ComputePSNR(scratch.data(), reference.data(), scratch.size() / 4, &maxDiff);
+
+			printf("1/%-6u %-8s %10.2f %10.2f %14.1f %10.2f %10d %10.2f\n", scale, refine ? "marched" : "filtered",
+				t * 1.0e3, tReference / t, scaledRayCaster.GetNumSamples() / numPixels,
+				100.0 * scaledRayCaster.GetNumRefinedPixels() / numPixels, maxDiff, psnr);
+		}
+
+	// Fewer samples with fixed and jittered steps vs. a reference of many more primary
+	// samples; the PSNR of the 4x4 averages exposes banding. Each column changes one thing:
+	// the primary steps are compared at the light samples that they march, and only the
+	// jittered light steps against a reference of more light samples, which fixed light
+	// steps would otherwise match by construction.
+	printf("\nSampling of %s, %s, %u light samples, vs. %u samples and %u (+light: %u) light samples\n\n",
+		RayCasterCPU::GetMarcherName(RayCasterCPU::FIXED_STEP_X8), RayCasterCPU::GetLightingName(RayCasterCPU::LIGHT_MARCH),
+		RayCasterCPU::NumLightSamples, refSamples, RayCasterCPU::NumLightSamples, refLightSamples);
+	printf("%-8s %-8s %10s %10s %14s %10s %10s %12s\n", "Samples", "Steps", "ms", "Speedup", "Samples/pixel",
+		"Max diff", "PSNR (dB)", "4x4 PSNR");
+
+	vector<uint8_t> sampleReferences[2];
+	vector<uint8_t> lowReferences[2];
+	for (auto i = 0; i < 2; ++i)
+	{
+		sampleReferences[i].resize(scratch.size());
+		rayCaster.SetSampling(refSamples, i ? refLightSamples : RayCasterCPU::NumLightSamples);
+		rayCaster.Render(sampleReferences[i].data(), RayCasterCPU::FIXED_STEP_X8, RayCasterCPU::LIGHT_MARCH, threads);
+		lowReferences[i] = downsample(sampleReferences[i], width, height, 4);
+	}
+
+	const uint32_t sampleCounts[] = { 16, 32, 48, 64, RayCasterCPU::NumSamples };
+	static const char* jitterNames[] = { "fixed", "jittered", "+light" };
+	for (const auto& samples : sampleCounts)
+		for (auto jitter = 0; jitter < 3; ++jitter)
+		{
+			rayCaster.SetSampling(samples, RayCasterCPU::NumLightSamples, jitter > 0, jitter > 1);
+			const auto t = Bench::Measure(repeats, [&]()
+			{
+				rayCaster.Render(scratch.data(), RayCasterCPU::FIXED_STEP_X8, RayCasterCPU::LIGHT_MARCH, threads);
+			});
+
+			const auto& sampleReference = sampleReferences[jitter > 1 ? 1 : 0];
+			const auto& lowReference = lowReferences[jitter > 1 ? 1 : 0];
+			auto maxDiff = 0;
+			const auto psnr = Bench::ComputePSNR(scratch.data(), sampleReference.data(), scratch.size() / 4, &maxDiff);
+			const auto low = downsample(scratch, width, height, 4);
+			const auto lowPSNR = Bench::ComputePSNR(low.data(), lowReference.data(), low.size() / 4);
+
+			printf("%-8u %-8s %10.2f %10.2f %14.1f %10d %10.2f %12.2f\n", samples, jitterNames[jitter],
+				t * 1.0e3, tReference / t, rayCaster.GetNumSamples() / numPixels, maxDiff, psnr, lowPSNR);
+		}
+	rayCaster.SetSampling();
+
+	// Another mesh voxelized into the same grid reuses its buffer, which must not keep the
+	// volume of the first mesh valid
+	XUSG::ObjLoader objLoader2;
+	VoxelizerCPU voxelizer2;
+	const auto pGridData = static_cast<const VoxelGrid&>(grid).GetData();
+	const auto numBuilds = transmittance.GetNumBuilds();
+	if (!objLoader2.Import(meshFileName2, true, true) ||
+		!voxelizer2.Init(objLoader2.GetVertices(), objLoader2.GetNumVertices(), objLoader2.GetVertexStride(),
+			objLoader2.GetIndices(), objLoader2.GetNumIndices()) ||
+		!voxelizer2.Voxelize(grid, size, VoxelizerCPU::PER_VOXEL, threads))
+	{
+		fprintf(stderr, "Failed to voxelize %s.\n", meshFileName2);
+
+		return 1;
+	}
+
+	const auto isStale = !transmittance.IsValid(grid, rayCaster.GetLocalSpaceLightPt());
+	isBuilt = transmittance.Update(grid, rayCaster.GetLocalSpaceLightPt(), threads) &&
+		transmittance.Update(grid, rayCaster.GetLocalSpaceLightPt(), threads);
+	const auto isRebuilt = isStale && isBuilt && numBuilds == 1 && transmittance.GetNumBuilds() == numBuilds + 1;
+	printf("\nTransmittance volume after %s into the same grid (buffer %s): %s\n", meshFileName2,
+		static_cast<const VoxelGrid&>(grid).GetData() == pGridData ? "reused" : "reallocated",
+		isRebuilt ? "rebuilt once" : "NOT REBUILT");
+	if (!isRebuilt) return 1;
+
+	const auto& image = images[RayCasterCPU::NUM_LIGHTING - 1][RayCasterCPU::NUM_MARCHER - 1];
+
+	if (!stbi_write_png(outFileName, width, height, 4, image.data(), width * 4))
+	{
+		fprintf(stderr, "Failed to write %s.\n", outFileName);
+
+		return 1;
+	}
+	printf("\nWrote %s\n", outFileName);
+
+	return 0;
+}
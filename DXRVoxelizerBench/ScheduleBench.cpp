@@ -0,0 +1,119 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <string>
+#include "Bench.h"
+#include "FrameScheduler.h"
+
+using namespace std;
+
+namespace
+{
+	// Stands in for the command list of the voxelizers, recording the passes as letters
+	class CommandLog :
+		public FrameScheduler::CommandRecorder
+	{
+	public:
+		void Voxelize() { Log += 'V'; }
+		void RayCast() { Log += 'R'; }
+		void CopyImage() { Log += 'C'; }
+
+		string Log;
+	};
+
+	struct GeometryState
+	{
+		float Bound[4];
+		uint32_t GridSize;
+	};
+
+	struct ViewState
+	{
+		float EyePt[3];
+		float LightPt[3];
+	};
+
+	struct Step
+	{
+		const char* Description;
+		GeometryState Geometry;
+		ViewState View;
+		bool Invalidate;
+		const char* Expected;
+	};
+}
+
+int RunScheduleBench(int argc, char* argv[])
+{
+	const auto idleFrames = Bench::ParseUInt(argc, argv, "idle", 240);
+	const auto moveFrames = Bench::ParseUInt(argc, argv, "move", 60);
+
+	const GeometryState bunny = { { 0.0f, 0.5f, 0.0f, 1.0f }, 64 };
+	const GeometryState bunny128 = { { 0.0f, 0.5f, 0.0f, 1.0f }, 128 };
+	const ViewState view = { { 8.0f, 12.0f, -14.0f }, { -10.0f, 45.0f, -75.0f } };
+	const ViewState moved = { { 9.0f, 12.0f, -14.0f }, { -10.0f, 45.0f, -75.0f } };
+	const ViewState lit = { { 9.0f, 12.0f, -14.0f }, { 10.0f, 45.0f, -75.0f } };
+
+	// Each step is a frame with its states and the passes it must record
+	const Step steps[] =
+	{
+		{ "First frame", bunny, view, false, "VRC" },
+		{ "Idle", bunny, view, false, "C" },
+		{ "Camera moved", bunny, moved, false, "RC" },
+		{ "Idle", bunny, moved, false, "C" },
+		{ "Light moved", bunny, lit, false, "RC" },
+		{ "Grid size changed", bunny128, lit, false, "VRC" },
+		{ "Idle", bunny128, lit, false, "C" },
+		{ "Grid size restored", bunny, lit, false, "VRC" },
+		{ "Device reset", bunny, lit, true, "VRC" },
+		{ "Idle", bunny, lit, false, "C" }
+	};
+
+	printf("Frame scheduling against a recording command list\n\n");
+	printf("%-20s %-10s %-10s %s\n", "Frame", "Expected", "Recorded", "Result");
+
+	FrameScheduler scheduler;
+	auto numFailures = 0u;
+	for (const auto& step : steps)
+	{
+		CommandLog log;
+		scheduler.SetGeometry(&step.Geometry, sizeof(step.Geometry));
+		scheduler.SetView(&step.View, sizeof(step.View));
+		if (step.Invalidate) scheduler.Invalidate();
+		scheduler.Schedule(&log);
+
+		const auto isPassed = log.Log == step.Expected;
+		numFailures += isPassed ? 0 : 1;
+		printf("%-20s %-10s %-10s %s\n", step.Description, step.Expected, log.Log.c_str(), isPassed ? "ok" : "FAILED");
+	}
+
+	// A session of an idle camera, a drag of moveFrames frames and idling again, against
+	// voxelizing and ray casting every frame as before
+	FrameScheduler session;
+	CommandLog log;
+	const auto numFrames = idleFrames * 2 + moveFrames;
+	for (auto i = 0u; i < numFrames; ++i)
+	{
+		auto v = view;
+		if (i >= idleFrames) v.EyePt[0] += static_cast<float>((min)(i - idleFrames + 1, moveFrames));
+		session.SetGeometry(&bunny, sizeof(bunny));
+		session.SetView(&v, sizeof(v));
+		session.Schedule(&log);
+	}
+
+	printf("\nSession of %u frames (%u idle, %u moving, %u idle):\n", numFrames, idleFrames, moveFrames, idleFrames);
+	printf("  Voxelizations: %u (%u before)\n", session.GetNumVoxelizations(), numFrames);
+	printf("  Ray casts:     %u (%u before)\n", session.GetNumRayCasts(), numFrames);
+	printf("  Image copies:  %u\n", session.GetNumFrames());
+
+	if (numFailures)
+	{
+		fprintf(stderr, "%u frame(s) recorded unexpected passes.\n", numFailures);
+
+		return 1;
+	}
+
+	return 0;
+}
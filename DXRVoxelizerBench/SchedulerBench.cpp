@@ -0,0 +1,141 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <atomic>
+#include <thread>
+#include "Bench.h"
+#include "ParallelFor.h"
+#include "TaskScheduler.h"
+
+using namespace std;
+
+namespace
+{
+	// Work of about n times a few nanoseconds that the optimizer cannot drop
+	uint32_t spin(uint32_t n)
+	{
+		auto x = n | 1;
+		for (auto i = 0u; i < n; ++i)
+		{
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+		}
+
+		return x;
+	}
+
+	// As ParallelFor was before the scheduler: a thread per call, each with an equal share
+	template<typename Fn>
+	void spawnFor(uint32_t begin, uint32_t end, uint32_t numThreads, const Fn& fn)
+	{
+		const auto count = end - begin;
+		vector<thread> threads;
+		for (auto t = 1u; t < numThreads; ++t)
+			threads.emplace_back([&, t]()
+			{
+				for (auto i = begin + count * t / numThreads; i < begin + count * (t + 1) / numThreads; ++i) fn(i);
+			});
+		for (auto i = begin; i < begin + count / numThreads; ++i) fn(i);
+		for (auto& thread : threads) thread.join();
+	}
+
+	// A binary tree of nested groups, with the work at the leaves
+	void runTree(uint32_t depth, uint32_t work, atomic<uint32_t>& numLeaves)
+	{
+		if (!depth)
+		{
+			if (spin(work)) numLeaves.fetch_add(1, memory_order_relaxed);
+
+			return;
+		}
+
+		TaskScheduler::TaskGroup group;
+		group.Run([&]() { runTree(depth - 1, work, numLeaves); });
+		runTree(depth - 1, work, numLeaves);
+		group.Wait();
+	}
+}
+
+int RunSchedulerBench(int argc, char* argv[])
+{
+	const auto numWorkers = Bench::ParseUInt(argc, argv, "workers", 0);
+	const auto isPinned = Bench::ParseUInt(argc, argv, "pin", 0) != 0;
+	const auto numCalls = Bench::ParseUInt(argc, argv, "calls", 1000);
+	const auto size = Bench::ParseUInt(argc, argv, "size", 4096);
+	const auto depth = Bench::ParseUInt(argc, argv, "depth", 12);
+	const auto repeats = Bench::ParseUInt(argc, argv, "repeats", 5);
+
+	TaskScheduler::Init(numWorkers ? numWorkers : TaskScheduler::DefaultNumWorkers, isPinned);
+	const auto numThreads = TaskScheduler::GetNumWorkers() + 1;
+	printf("Task scheduler, %u workers%s and the caller, best of %u\n\n", numThreads - 1, isPinned ? " pinned" : "", repeats);
+	printf("%-24s %10s %10s %10s %10s %10s %10s %7s\n", "Case", "ms", "us/call", "Tasks", "Steals", "Failed",
+		"Idle ms", "Depth");
+
+	// The scheduler counts are of the best and the other repeats alike, so they are averaged
+	const auto run = [&](const char* name, uint32_t numCallsPerRun, function<void()> fn)
+	{
+		TaskScheduler::ResetStats();
+		const auto t = Bench::Measure(repeats, fn);
+
+		vector<TaskScheduler::WorkerStats> stats;
+		TaskScheduler::GetStats(stats);
+		TaskScheduler::WorkerStats total = {};
+		for (const auto& worker : stats)
+		{
+			total.NumTasks += worker.NumTasks;
+			total.NumSteals += worker.NumSteals;
+			total.NumFailedSteals += worker.NumFailedSteals;
+			total.IdleSeconds += worker.IdleSeconds;
+			total.MaxQueueDepth = (max)(total.MaxQueueDepth, worker.MaxQueueDepth);
+		}
+		printf("%-24s %10.2f %10.2f %10llu %10llu %10llu %10.2f %7u\n", name, t * 1.0e3, t / numCallsPerRun * 1.0e6,
+			static_cast<unsigned long long>(total.NumTasks / repeats), static_cast<unsigned long long>(total.NumSteals / repeats),
+			static_cast<unsigned long long>(total.NumFailedSteals / repeats), total.IdleSeconds / repeats * 1.0e3,
+			total.MaxQueueDepth);
+	};
+
+	// The cost of a call without work, which bounds how fine a pass may be split
+	atomic<uint32_t> sink(0);
+	run("empty, spawned threads", numCalls, [&]()
+	{
+		for (auto i = 0u; i < numCalls; ++i) spawnFor(0, numThreads, numThreads, [&](uint32_t j) { sink += j; });
+	});
+	run("empty, ParallelFor", numCalls, [&]()
+	{
+		for (auto i = 0u; i < numCalls; ++i) ParallelFor(0, numThreads, 0, [&](uint32_t j) { sink += j; });
+	});
+
+	// Work growing with the index, as of the rows of a mesh that fills only part of the
+	// grid: equal shares leave the thread of the last one as the tail
+	run("uneven, spawned threads", 1, [&]()
+	{
+		spawnFor(0, size, numThreads, [&](uint32_t i) { sink += spin(i); });
+	});
+	run("uneven, ParallelFor", 1, [&]()
+	{
+		ParallelFor(0, size, 0, [&](uint32_t i) { sink += spin(i); });
+	});
+
+	// A pass inside a pass, as the voxelizer over meshes in the golden suite
+	const auto numOuter = (max)(size / 64, 1u);
+	atomic<uint32_t> numInner(0);
+	run("nested ParallelFor", 1, [&]()
+	{
+		ParallelFor(0, numOuter, 0, [&](uint32_t)
+		{
+			ParallelFor(0, 64, 0, [&](uint32_t i) { if (spin(i * 64)) numInner.fetch_add(1, memory_order_relaxed); });
+		});
+	});
+
+	atomic<uint32_t> numLeaves(0);
+	run("task tree", 1, [&]() { runTree(depth, 1024, numLeaves); });
+	Bench::DoNotOptimize(sink.load());
+
+	const auto isNestedDone = numInner.load() == numOuter * 64 * repeats;
+	const auto isTreeDone = numLeaves.load() == (1u << depth) * repeats;
+	printf("\nNested passes %s, task tree %s\n", isNestedDone ? "complete" : "INCOMPLETE", isTreeDone ? "complete" : "INCOMPLETE");
+
+	return isNestedDone && isTreeDone ? 0 : 1;
+}
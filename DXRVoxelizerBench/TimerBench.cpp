@@ -0,0 +1,103 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <random>
+#include <thread>
+#include "Bench.h"
+#include "FrameStats.h"
+
+using namespace std;
+
+namespace
+{
+	void printSummary(const char* name, const FrameStats::Summary& summary)
+	{
+		printf("%-22s %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f\n", name, 1.0 / summary.Mean, summary.Mean * 1.0e3,
+			summary.P50 * 1.0e3, summary.P95 * 1.0e3, summary.P99 * 1.0e3, summary.Max * 1.0e3);
+	}
+}
+
+int RunTimerBench(int argc, char* argv[])
+{
+	const auto numFrames = Bench::ParseUInt(argc, argv, "frames", 1 << 20);
+	const auto windowSize = Bench::ParseUInt(argc, argv, "window", FrameStats::DefaultWindowSize);
+	const auto stallPeriod = Bench::ParseUInt(argc, argv, "stall", 60);
+	const auto numSleeps = Bench::ParseUInt(argc, argv, "sleeps", 200);
+	const auto repeats = Bench::ParseUInt(argc, argv, "repeats", 5);
+	const auto csvFileName = Bench::ParseString(argc, argv, "csv", nullptr);
+	const auto jsonFileName = Bench::ParseString(argc, argv, "json", nullptr);
+
+	printf("Frame timer and stats, %u frames, window of %u, best of %u\n\n", numFrames, windowSize, repeats);
+	printf("%-22s %10s %12s\n", "Case", "ms", "ns/call");
+	const auto print = [&](const char* name, double t, uint32_t numCalls)
+	{
+		printf("%-22s %10.2f %12.2f\n", name, t * 1.0e3, t / numCalls * 1.0e9);
+	};
+
+	FrameTimer timer;
+	print("Tick", Bench::Measure(repeats, [&]()
+	{
+		for (auto i = 0u; i < numFrames; ++i) timer.Tick();
+	}), numFrames);
+
+	FrameStats stats(windowSize);
+	const auto benchStage = stats.AddStage("bench");
+	print("Record", Bench::Measure(repeats, [&]()
+	{
+		for (auto i = 0u; i < numFrames; ++i) stats.Record(benchStage, i * 1.0e-9);
+	}), numFrames);
+	print("Scope", Bench::Measure(repeats, [&]()
+	{
+		for (auto i = 0u; i < numFrames; ++i) const FrameStats::Scope scope(stats, benchStage);
+	}), numFrames);
+
+	// Once a second in the window title, so it only has to be well under a frame
+	const auto numSummaries = (max)(numFrames / 1024, 1u);
+	auto sink = 0.0;
+	print("GetSummary", Bench::Measure(repeats, [&]()
+	{
+		for (auto i = 0u; i < numSummaries; ++i) sink += stats.GetSummary(benchStage).P99;
+	}), numSummaries);
+	Bench::DoNotOptimize(sink);
+
+	// 60 Hz with jitter, and a 100 ms stall every second: the average frame
+	// rate barely moves, while the tail shows the hitches
+	FrameStats frameStats(windowSize);
+	const auto steadyStage = frameStats.AddStage("steady 60 Hz");
+	const auto stallStage = frameStats.AddStage("with stalls");
+	mt19937 rng(1);
+	normal_distribution<double> jitter(0.0, 0.5e-3);
+	for (auto i = 0u; i < windowSize; ++i)
+	{
+		const auto frameTime = 1.0 / 60.0 + jitter(rng);
+		frameStats.Record(steadyStage, frameTime);
+		frameStats.Record(stallStage, stallPeriod && i % stallPeriod == stallPeriod - 1 ? 0.1 : frameTime);
+	}
+
+	// Real frames of a 1 ms sleep, through the timer as the app does
+	const auto sleepStage = frameStats.AddStage("sleep 1 ms");
+	timer.Tick();
+	for (auto i = 0u; i < numSleeps; ++i)
+	{
+		this_thread::sleep_for(chrono::milliseconds(1));
+		timer.Tick();
+		frameStats.Record(sleepStage, timer.GetRawElapsedSeconds());
+	}
+
+	printf("\n%-22s %8s %8s %8s %8s %8s %8s\n", "Frames (ms)", "fps", "mean", "p50", "p95", "p99", "max");
+	for (auto i = 0u; i < frameStats.GetNumStages(); ++i)
+		printSummary(frameStats.GetStageName(i), frameStats.GetSummary(i));
+
+	uint32_t counts[FrameStats::NumBuckets];
+	frameStats.GetHistogram(stallStage, counts);
+	printf("\nHistogram of \"%s\":\n", frameStats.GetStageName(stallStage));
+	for (auto b = 0u; b < FrameStats::NumBuckets; ++b)
+		if (counts[b]) printf("  < %8.2f ms %6u\n", FrameStats::GetBucketBound(b) * 1.0e3, counts[b]);
+
+	auto isWritten = true;
+	if (csvFileName) isWritten = frameStats.WriteCSV(csvFileName) && isWritten;
+	if (jsonFileName) isWritten = frameStats.WriteJSON(jsonFileName) && isWritten;
+
+	return isWritten ? 0 : 1;
+}
@@ -0,0 +1,246 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <fstream>
+#include <thread>
+#include "Bench.h"
+#include "Optional/XUSGObjLoader.h"
+#include "TaskScheduler.h"
+#include "VoxelizerCPU.h"
+
+using namespace std;
+
+namespace
+{
+	struct Result
+	{
+		string Mesh;
+		uint32_t Size;
+		string Mode;
+		uint32_t NumThreads;
+		double Seconds;
+		double VoxelsPerSecond;
+		double RaysPerSecond;
+		uint64_t PeakRSS;
+		double Efficiency;	// Speedup over 1 thread, per thread
+		uint64_t NumSolid;	// Has to match the baseline, whatever the time
+	};
+
+	const char* g_csvHeader = "mesh,size,mode,threads,ms,mvoxels_per_s,mrays_per_s,peak_rss_mb,efficiency,solid";
+
+	string getBaseName(const string& path)
+	{
+		const auto pos = path.find_last_of("/\\");
+
+		return pos == string::npos ? path : path.substr(pos + 1);
+	}
+
+	// 1, 2, 4, ... and the maximum itself
+	vector<uint32_t> getThreadCounts(uint32_t maxThreads)
+	{
+		vector<uint32_t> threadCounts;
+		for (auto n = 1u; n < maxThreads; n *= 2) threadCounts.push_back(n);
+		threadCounts.push_back(maxThreads);
+
+		return threadCounts;
+	}
+
+	bool writeCSV(const char* fileName, const vector<Result>& results)
+	{
+		ofstream file(fileName, ios::trunc);
+		if (!file) return false;
+
+		char buffer[512];
+		file << g_csvHeader << "\n";
+		for (const auto& r : results)
+		{
+			snprintf(buffer, sizeof(buffer), "%s,%u,%s,%u,%.3f,%.3f,%.3f,%.1f,%.3f,%llu\n", r.Mesh.c_str(), r.Size,
+				r.Mode.c_str(), r.NumThreads, r.Seconds * 1.0e3, r.VoxelsPerSecond / 1.0e6, r.RaysPerSecond / 1.0e6,
+				r.PeakRSS / 1048576.0, r.Efficiency, static_cast<unsigned long long>(r.NumSolid));
+			file << buffer;
+		}
+
+		return static_cast<bool>(file);
+	}
+
+	bool writeJSON(const char* fileName, const vector<Result>& results)
+	{
+		ofstream file(fileName, ios::trunc);
+		if (!file) return false;
+
+		char buffer[512];
+		file << "{\"hardwareThreads\":" << thread::hardware_concurrency() << ",\"results\":[";
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const auto& r = results[i];
+			snprintf(buffer, sizeof(buffer), "%s\n{\"mesh\":\"%s\",\"size\":%u,\"mode\":\"%s\",\"threads\":%u,"
+				"\"ms\":%.3f,\"voxelsPerSecond\":%.0f,\"raysPerSecond\":%.0f,\"peakRSS\":%llu,\"efficiency\":%.3f,"
+				"\"solid\":%llu}", i ? "," : "", r.Mesh.c_str(), r.Size, r.Mode.c_str(), r.NumThreads, r.Seconds * 1.0e3,
+				r.VoxelsPerSecond, r.RaysPerSecond, static_cast<unsigned long long>(r.PeakRSS), r.Efficiency,
+				static_cast<unsigned long long>(r.NumSolid));
+			file << buffer;
+		}
+		file << "\n]}\n";
+
+		return static_cast<bool>(file);
+	}
+
+	// Reads back what writeCSV wrote; only the key, the time and the solid count matter
+	bool readCSV(const char* fileName, vector<Result>& results)
+	{
+		ifstream file(fileName);
+		string line;
+		if (!getline(file, line) || line != g_csvHeader) return false;
+
+		while (getline(file, line))
+		{
+			char mesh[256], mode[32];
+			unsigned long long numSolid;
+			double ms;
+			Result r = {};
+			if (sscanf(line.c_str(), "%255[^,],%u,%31[^,],%u,%lf,%*f,%*f,%*f,%*f,%llu", mesh, &r.Size, mode,
+				&r.NumThreads, &ms, &numSolid) != 6) return false;
+			r.Mesh = mesh;
+			r.Mode = mode;
+			r.Seconds = ms / 1.0e3;
+			r.NumSolid = numSolid;
+			results.push_back(r);
+		}
+
+		return true;
+	}
+
+	const Result* findResult(const vector<Result>& results, const Result& key)
+	{
+		for (const auto& r : results)
+			if (r.Mesh == key.Mesh && r.Size == key.Size && r.Mode == key.Mode && r.NumThreads == key.NumThreads)
+				return &r;
+
+		return nullptr;
+	}
+}
+
+int RunVoxelizeBench(int argc, char* argv[])
+{
+	const auto meshFileNames = Bench::ParseList(argc, argv, "meshes", "Assets/bunny.obj,Assets/dragon.obj,Assets/TuringBowl.obj");
+	const auto sizeList = Bench::ParseList(argc, argv, "sizes", "64,128,256,512");
+	const auto modeList = Bench::ParseList(argc, argv, "modes", "per-voxel,column");
+	const auto maxThreads = Bench::ParseUInt(argc, argv, "maxthreads", (max)(thread::hardware_concurrency(), 1u));
+	const auto repeats = Bench::ParseUInt(argc, argv, "repeats", 3);
+	const auto csvFileName = Bench::ParseString(argc, argv, "csv", nullptr);
+	const auto jsonFileName = Bench::ParseString(argc, argv, "json", nullptr);
+	const auto baselineFileName = Bench::ParseString(argc, argv, "baseline", nullptr);
+	const auto tolerance = Bench::ParseUInt(argc, argv, "tolerance", 10);	// Percent slower than the baseline
+
+	vector<VoxelizerCPU::Mode> modes;
+	for (const auto& name : modeList)
+	{
+		auto mode = VoxelizerCPU::PER_VOXEL;
+		while (mode < VoxelizerCPU::NUM_MODE && name != VoxelizerCPU::GetModeName(mode))
+			mode = static_cast<VoxelizerCPU::Mode>(mode + 1);
+		if (mode >= VoxelizerCPU::NUM_MODE)
+		{
+			fprintf(stderr, "Unknown mode %s.\n", name.c_str());
+
+			return 1;
+		}
+		modes.push_back(mode);
+	}
+
+	vector<Result> baseline;
+	if (baselineFileName && !readCSV(baselineFileName, baseline))
+	{
+		fprintf(stderr, "Failed to read baseline %s.\n", baselineFileName);
+
+		return 1;
+	}
+
+	// Enough workers for the most threads, as ParallelFor runs on at most all of them
+	const auto threadCounts = getThreadCounts((max)(maxThreads, 1u));
+	if (threadCounts.back() > TaskScheduler::GetNumWorkers() + 1) TaskScheduler::Init(threadCounts.back() - 1);
+	const auto canResetPeak = Bench::ResetPeakRSS();
+	printf("CPU voxelization, 1..%u threads, best of %u; peak RSS %s\n\n", threadCounts.back(), repeats,
+		canResetPeak ? "per case" : "of the process so far");
+	printf("%-16s %5s %-10s %7s %10s %10s %10s %9s %6s %10s\n", "Mesh", "Size", "Mode", "Threads",
+		"ms", "Mvoxels/s", "Mrays/s", "Peak MB", "Eff", "Baseline");
+
+	vector<Result> results;
+	auto numRegressions = 0u;
+	for (const auto& meshFileName : meshFileNames)
+	{
+		XUSG::ObjLoader objLoader;
+		VoxelizerCPU voxelizer;
+		if (!objLoader.Import(meshFileName.c_str(), true, true) ||
+			!voxelizer.Init(objLoader.GetVertices(), objLoader.GetNumVertices(), objLoader.GetVertexStride(),
+				objLoader.GetIndices(), objLoader.GetNumIndices()))
+		{
+			fprintf(stderr, "Failed to load %s.\n", meshFileName.c_str());
+
+			return 1;
+		}
+
+		for (const auto& sizeString : sizeList)
+		{
+			const auto size = static_cast<uint32_t>(strtoul(sizeString.c_str(), nullptr, 10));
+			const auto numVoxels = static_cast<double>(size) * size * size;
+
+			for (const auto mode : modes)
+			{
+				// A ray per voxel, or a ray per column that collects all of its hits
+				const auto numRays = mode == VoxelizerCPU::COLUMN ? static_cast<double>(size) * size : numVoxels;
+
+				auto tSingle = 0.0;
+				for (const auto numThreads : threadCounts)
+				{
+					VoxelGrid grid;
+					Bench::ResetPeakRSS();
+					auto isSucceeded = true;
+					const auto t = Bench::Measure(repeats, [&]()
+					{
+						isSucceeded = voxelizer.Voxelize(grid, size, mode, numThreads) && isSucceeded;
+					});
+					if (!isSucceeded)
+					{
+						fprintf(stderr, "Failed to voxelize %s at %u^3.\n", meshFileName.c_str(), size);
+
+						return 1;
+					}
+					if (numThreads == 1) tSingle = t;
+
+					Result r = { getBaseName(meshFileName), size, VoxelizerCPU::GetModeName(mode), numThreads, t,
+						numVoxels / t, numRays / t, Bench::GetPeakRSS(), tSingle / (t * numThreads), 0 };
+					const auto pData = grid.GetData();
+					for (size_t i = 0; i < grid.GetNumVoxels(); ++i) r.NumSolid += pData[i] ? 1 : 0;
+
+					char comparison[32] = "-";
+					const auto pBase = findResult(baseline, r);
+					if (pBase)
+					{
+						const auto change = (r.Seconds / pBase->Seconds - 1.0) * 100.0;
+						const auto isRegressed = r.NumSolid != pBase->NumSolid || change > tolerance;
+						snprintf(comparison, sizeof(comparison), "%s%+.1f%%", r.NumSolid != pBase->NumSolid ?
+							"voxels! " : isRegressed ? "slower! " : "", change);
+						numRegressions += isRegressed ? 1 : 0;
+					}
+
+					printf("%-16s %5u %-10s %7u %10.2f %10.2f %10.2f %9.1f %6.2f %10s\n", r.Mesh.c_str(), r.Size,
+						r.Mode.c_str(), r.NumThreads, r.Seconds * 1.0e3, r.VoxelsPerSecond / 1.0e6,
+						r.RaysPerSecond / 1.0e6, r.PeakRSS / 1048576.0, r.Efficiency, comparison);
+					results.push_back(r);
+				}
+			}
+		}
+	}
+
+	auto isWritten = true;
+	if (csvFileName) isWritten = writeCSV(csvFileName, results) && isWritten;
+	if (jsonFileName) isWritten = writeJSON(jsonFileName, results) && isWritten;
+
+	// A nonzero exit on a regression, so that a script can gate on it
+	if (baselineFileName)
+		printf("\n%u of %zu cases regressed beyond %u%% or changed voxels against %s\n",
+			numRegressions, results.size(), tolerance, baselineFileName);
+
+	return isWritten && !numRegressions ? 0 : 1;
+}
@@ -0,0 +1,596 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) XU, Tianchen. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MemoryRegistry.h"
+#include "Optional/XUSGObjLoader.h"
+#include "Profiler.h"
+#include "StagePipeline.h"
+#include "TaskScheduler.h"
+#include "VoxelCache.h"
+#include "VoxelExporter.h"
+#include "VoxelGridIO.h"
+#include "VoxelSliceSource.h"
+#include "VoxelizerCPU.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+//--------------------------------------------------------------------------------------
+// Headless batch voxelizer: loads an OBJ, voxelizes it on the CPU and writes the grid,
+// without a window, a swap chain or a D3D12 device, and reports the time of each stage.
+// With -batch, it does so for a directory of OBJs, with the stages overlapped across them.
+// With -cache, a mesh voxelized before with the same settings is written from the cache.
+//--------------------------------------------------------------------------------------
+namespace
+{
+	const char* g_formatNames[] = { "vxgz", "raw", "nrrd", "nrrd-gzip", "vox" };
+	const char* g_formatExtensions[] = { ".vxgz", ".raw", ".nrrd", ".nrrd", ".vox" };
+	const uint32_t g_numFormats = static_cast<uint32_t>(sizeof(g_formatNames) / sizeof(g_formatNames[0]));
+
+	// The CLI voxelizes in the normalized space of the mesh, with no extra transform
+	const float g_posScale[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+	struct Stage
+	{
+		const char* Name;
+		double Time;
+	};
+
+	const char* parseString(int argc, char* argv[], const char* name, const char* defaultValue)
+	{
+		for (auto i = 1; i + 1 < argc; ++i)
+			if (argv[i][0] == '-' && !strcmp(&argv[i][1], name)) return argv[i + 1];
+
+		return defaultValue;
+	}
+
+	uint32_t parseUInt(int argc, char* argv[], const char* name, uint32_t defaultValue)
+	{
+		const auto value = parseString(argc, argv, name, nullptr);
+
+		return value ? static_cast<uint32_t>(strtoul(value, nullptr, 10)) : defaultValue;
+	}
+
+	// Index of the name, or count if there is none
+	uint32_t findName(const char* name, const char* const* names, uint32_t count)
+	{
+		for (auto i = 0u; i < count; ++i)
+			if (!strcmp(name, names[i])) return i;
+
+		return count;
+	}
+
+	// The first format with the extension of the file name, vxgz by default
+	uint32_t getFormatOfFile(const char* fileName)
+	{
+		const auto pExt = strrchr(fileName, '.');
+		for (auto i = 0u; pExt && i < g_numFormats; ++i)
+			if (!strcmp(pExt, g_formatExtensions[i])) return i;
+
+		return 0;
+	}
+
+	template<typename Fn>
+	bool runStage(vector<Stage>& stages, const char* name, Fn fn)
+	{
+		PROFILE_ZONE(name);
+		const auto start = chrono::steady_clock::now();
+		const auto isDone = fn();
+		const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+		stages.push_back({ name, elapsed.count() });
+
+		return isDone;
+	}
+
+	// The grid in the format, either dense or as runs
+	bool writeGrid(const char* fileName, uint32_t format, const float* bound, const VoxelGrid& grid,
+		const RLEGrid& rleGrid, bool isRLE, uint32_t threads, uint64_t& fileSize)
+	{
+		if (!format)
+		{
+			VoxelGridWriter writer;
+			writer.SetBound(bound);
+			const auto isWritten = isRLE ? writer.Write(fileName, rleGrid, threads) : writer.Write(fileName, grid, threads);
+			fileSize = writer.GetFileSize();
+
+			return isWritten;
+		}
+
+		const DenseSliceSource denseSource(grid);
+		const RLESliceSource rleSource(rleGrid);
+		VoxelExporter exporter;
+		const auto isWritten = exporter.Export(fileName, isRLE ? static_cast<const VoxelSliceSource&>(rleSource) :
+			denseSource, static_cast<VoxelExporter::Format>(format - 1), threads);
+		fileSize = exporter.GetFileSize();
+
+		return isWritten;
+	}
+
+	// A cache entry in the format: a copy of the entry for vxgz, which it already is, and
+	// otherwise exported from its chunks without a dense copy
+	bool writeCached(const char* fileName, uint32_t format, const VoxelCache& cache, const VoxelCache::Key& key,
+		const VoxelGridReader& reader, uint32_t threads, uint64_t& fileSize)
+	{
+		if (!format)
+		{
+			error_code error;
+			fs::copy_file(cache.GetFileName(key), fileName, fs::copy_options::overwrite_existing, error);
+			fileSize = error ? 0 : static_cast<uint64_t>(fs::file_size(fileName, error));
+
+			return !error;
+		}
+
+		const ChunkFileSliceSource source(reader);
+		VoxelExporter exporter;
+		const auto isWritten = exporter.Export(fileName, source, static_cast<VoxelExporter::Format>(format - 1), threads);
+		fileSize = exporter.GetFileSize();
+
+		return isWritten;
+	}
+
+	// The cache of -cache, if any
+	bool initCache(VoxelCache& cache, const char* cacheDir, int argc, char* argv[])
+	{
+		const auto maxMB = parseUInt(argc, argv, "cachemb", static_cast<uint32_t>(VoxelCache::DefaultMaxBytes >> 20));
+		if (cache.Init(cacheDir, static_cast<uint64_t>(maxMB) << 20)) return true;
+		fprintf(stderr, "Failed to open the cache directory %s.\n", cacheDir);
+
+		return false;
+	}
+
+	void reportCache(const VoxelCache& cache)
+	{
+		const auto stats = cache.GetStats();
+		printf("\nCache: %llu hits, %llu misses, %llu stores, %llu evictions, %.2f MB\n",
+			static_cast<unsigned long long>(stats.Hits), static_cast<unsigned long long>(stats.Misses),
+			static_cast<unsigned long long>(stats.Stores), static_cast<unsigned long long>(stats.Evictions),
+			cache.GetSize() / 1048576.0);
+	}
+
+	// The output of a mesh: the mesh name with the extension of the format, in outDir if any
+	string getOutFileName(const string& meshFileName, uint32_t format, const char* outDir)
+	{
+		auto outFileName = meshFileName;
+		const auto slash = outFileName.find_last_of("/\\");
+		const auto dot = outFileName.find_last_of('.');
+		if (dot != string::npos && (slash == string::npos || dot > slash)) outFileName.resize(dot);
+		if (outDir) outFileName = string(outDir) + "/" + outFileName.substr(slash == string::npos ? 0 : slash + 1);
+
+		return outFileName + g_formatExtensions[format];
+	}
+
+	// A list of subsystem=MB, e.g. "dense-grid=256,bvh=64"
+	bool setBudgets(const char* budgets)
+	{
+		string list(budgets);
+		for (size_t begin = 0; begin < list.size();)
+		{
+			auto end = list.find(',', begin);
+			if (end == string::npos) end = list.size();
+			const auto item = list.substr(begin, end - begin);
+			const auto equal = item.find('=');
+			if (equal == string::npos) return false;
+
+			const auto subsystem = MemoryRegistry::FindSubsystem(item.substr(0, equal).c_str());
+			if (subsystem >= MemoryRegistry::NUM_SUBSYSTEM) return false;
+			MemoryRegistry::SetBudget(subsystem, static_cast<uint64_t>(atof(&item[equal + 1]) * 1048576.0));
+			begin = end + 1;
+		}
+
+		return true;
+	}
+
+	// One positive count for each of the 4 stages of -batch
+	bool parseWorkers(const char* workerList, uint32_t workers[4])
+	{
+		auto pWorker = workerList;
+		for (auto i = 0u; i < 4; ++i)
+		{
+			if (!isdigit(static_cast<unsigned char>(*pWorker))) return false;
+
+			char* pEnd;
+			workers[i] = static_cast<uint32_t>(strtoul(pWorker, &pEnd, 10));
+			if (!workers[i] || *pEnd != (i + 1 < 4 ? ',' : '\0')) return false;
+			pWorker = pEnd + 1;
+		}
+
+		return true;
+	}
+
+	// Writes the profiling zones if -trace is given
+	bool writeTrace(int argc, char* argv[])
+	{
+		const auto traceFileName = parseString(argc, argv, "trace", nullptr);
+		if (!traceFileName) return true;
+		if (!Profiler::WriteChromeTrace(traceFileName))
+		{
+			fprintf(stderr, "Failed to write %s.\n", traceFileName);
+
+			return false;
+		}
+		printf("\nWrote %llu zones to %s\n", static_cast<unsigned long long>(Profiler::GetNumEvents()), traceFileName);
+
+		return true;
+	}
+
+	// Prints the report; fails if a peak exceeds its budget
+	bool reportMemory()
+	{
+		printf("\n%s", MemoryRegistry::GetReport().c_str());
+		for (auto i = 0u; i < MemoryRegistry::NUM_SUBSYSTEM; ++i)
+		{
+			const auto subsystem = static_cast<MemoryRegistry::Subsystem>(i);
+			if (!MemoryRegistry::IsOverBudget(subsystem)) continue;
+			fprintf(stderr, "Over the budget of %s.\n", MemoryRegistry::GetSubsystemName(subsystem));
+
+			return false;
+		}
+
+		return true;
+	}
+
+	// Totals of the task scheduler over all threads
+	void reportScheduler(uint32_t threads)
+	{
+		// A single thread runs everything on the caller, and never starts the pool
+		if (threads == 1)
+		{
+			printf("\nScheduler: not used, 1 thread\n");
+
+			return;
+		}
+
+		vector<TaskScheduler::WorkerStats> stats;
+		TaskScheduler::GetStats(stats);
+		TaskScheduler::WorkerStats total = {};
+		for (const auto& worker : stats)
+		{
+			total.NumTasks += worker.NumTasks;
+			total.NumSteals += worker.NumSteals;
+			total.NumFailedSteals += worker.NumFailedSteals;
+			total.IdleSeconds += worker.IdleSeconds;
+			total.MaxQueueDepth = (max)(total.MaxQueueDepth, worker.MaxQueueDepth);
+		}
+
+		printf("\nScheduler: %u workers%s, %llu tasks, %llu steals (%llu failed), %.2f s idle, max queue depth %u\n",
+			TaskScheduler::GetNumWorkers(), TaskScheduler::IsPinned() ? " pinned" : "",
+			static_cast<unsigned long long>(total.NumTasks), static_cast<unsigned long long>(total.NumSteals),
+			static_cast<unsigned long long>(total.NumFailedSteals), total.IdleSeconds, total.MaxQueueDepth);
+	}
+
+	// A mesh in flight through the batch stages; each stage frees what the next ones no
+	// longer need, so that the memory in flight is bounded by the queues
+	struct BatchJob
+	{
+		string MeshFileName;
+		unique_ptr<XUSG::ObjLoader> ObjLoader;
+		unique_ptr<VoxelizerCPU> Voxelizer;
+		float Bound[4];
+		VoxelGrid Grid;
+		RLEGrid Runs;
+		VoxelCache::Key Key;
+		unique_ptr<VoxelGridReader> Cached;	// On a hit, which skips to the write stage
+	};
+
+	// Voxelizes every OBJ of the directory, loading, building, voxelizing and writing
+	// different meshes at once
+	int runBatch(int argc, char* argv[], const char* batchDir, uint32_t size, VoxelizerCPU::Mode mode,
+		uint32_t format, uint32_t threads, const uint32_t workers[4])
+	{
+		const auto outDir = parseString(argc, argv, "outdir", nullptr);
+		const auto queueCapacity = parseUInt(argc, argv, "queue", 4);
+
+		vector<unique_ptr<BatchJob>> jobs;
+		error_code error;
+		for (fs::directory_iterator it(batchDir, error), end; !error && it != end; it.increment(error))
+		{
+			if (!it->is_regular_file() || it->path().extension() != ".obj") continue;
+			jobs.emplace_back(new BatchJob);
+			jobs.back()->MeshFileName = it->path().string();
+		}
+		if (error || jobs.empty())
+		{
+			fprintf(stderr, "No OBJ files in %s.\n", batchDir);
+
+			return 1;
+		}
+		sort(jobs.begin(), jobs.end(), [](const unique_ptr<BatchJob>& a, const unique_ptr<BatchJob>& b)
+			{ return a->MeshFileName < b->MeshFileName; });
+		if (outDir) fs::create_directories(outDir, error);
+
+		const auto cacheDir = parseString(argc, argv, "cache", nullptr);
+		VoxelCache cache;
+		if (cacheDir && !initCache(cache, cacheDir, argc, argv)) return 1;
+
+		const auto isRLE = mode == VoxelizerCPU::COLUMN;
+		atomic<uint64_t> numBytes(0);
+		StagePipeline<unique_ptr<BatchJob>> pipeline(queueCapacity);
+		pipeline.AddStage("load", workers[0], [&](unique_ptr<BatchJob>& job)
+		{
+			if (cacheDir && VoxelCache::MakeKey(job->Key, job->MeshFileName.c_str(), size, VoxelizerCPU::Threshold,
+				g_posScale, mode))
+			{
+				job->Cached.reset(new VoxelGridReader);
+				if (cache.Find(job->Key, *job->Cached)) return true;
+				job->Cached.reset();
+			}
+
+			job->ObjLoader.reset(new XUSG::ObjLoader);
+			if (job->ObjLoader->Import(job->MeshFileName.c_str(), true, true)) return true;
+			fprintf(stderr, "Failed to load %s.\n", job->MeshFileName.c_str());
+
+			return false;
+		});
+		pipeline.AddStage("build BVH", workers[1], [](unique_ptr<BatchJob>& job)
+		{
+			if (job->Cached) return true;
+
+			const auto& objLoader = *job->ObjLoader;
+			job->Voxelizer.reset(new VoxelizerCPU);
+			const auto isBuilt = job->Voxelizer->Init(objLoader.GetVertices(), objLoader.GetNumVertices(),
+				objLoader.GetVertexStride(), objLoader.GetIndices(), objLoader.GetNumIndices());
+			job->ObjLoader.reset();
+			if (isBuilt) return true;
+			fprintf(stderr, "Failed to build the BVH of %s.\n", job->MeshFileName.c_str());
+
+			return false;
+		});
+		pipeline.AddStage("voxelize", workers[2], [&](unique_ptr<BatchJob>& job)
+		{
+			if (job->Cached) return true;
+
+			const auto& voxelizer = *job->Voxelizer;
+			const auto isVoxelized = isRLE ? voxelizer.Voxelize(job->Runs, size, mode, threads) :
+				voxelizer.Voxelize(job->Grid, size, mode, threads);
+			copy(voxelizer.GetBound(), voxelizer.GetBound() + 4, job->Bound);
+			job->Voxelizer.reset();
+			if (isVoxelized) return true;
+			fprintf(stderr, "Failed to voxelize %s at %u^3.\n", job->MeshFileName.c_str(), size);
+
+			return false;
+		});
+		pipeline.AddStage("write", workers[3], [&](unique_ptr<BatchJob>& job)
+		{
+			const auto outFileName = getOutFileName(job->MeshFileName, format, outDir);
+			uint64_t fileSize = 0;
+			const auto isWritten = job->Cached ?
+				writeCached(outFileName.c_str(), format, cache, job->Key, *job->Cached, threads, fileSize) :
+				writeGrid(outFileName.c_str(), format, job->Bound, job->Grid, job->Runs, isRLE, threads, fileSize);
+			numBytes += fileSize;
+			if (!isWritten)
+			{
+				fprintf(stderr, "Failed to write %s.\n", outFileName.c_str());
+
+				return false;
+			}
+
+			// A failed store only costs the next run the voxelization
+			if (cacheDir && !job->Cached && !(isRLE ? cache.Store(job->Key, job->Runs, job->Bound, threads) :
+				cache.Store(job->Key, job->Grid, job->Bound, threads)))
+				fprintf(stderr, "Failed to cache %s.\n", job->MeshFileName.c_str());
+
+			return true;
+		});
+
+		const auto numMeshes = static_cast<uint32_t>(jobs.size());
+		const auto seconds = pipeline.Run(jobs);
+		const auto& stats = pipeline.GetStats();
+		const auto numWritten = stats.back().NumItems;
+
+		printf("%s: %u meshes, %u^3 voxels, %s mode, %u written (%.2f MB), %u failed\n", batchDir, numMeshes, size,
+			VoxelizerCPU::GetModeName(mode), numWritten, numBytes / 1048576.0, numMeshes - numWritten);
+		printf("%.2f s, %.1f meshes/min\n\n", seconds, numWritten * 60.0 / seconds);
+		printf("%-10s %8s %8s %8s %10s %10s %10s %7s\n", "Stage", "Workers", "Meshes", "Failed",
+			"Busy s", "Starved s", "Blocked s", "Util %");
+		for (auto i = 0u; i < stats.size(); ++i)
+		{
+			const auto& stage = stats[i];
+			printf("%-10s %8u %8u %8u %10.2f %10.2f %10.2f %7.1f\n", stage.Name.c_str(), stage.NumWorkers,
+				stage.NumItems, stage.NumDropped, stage.BusySeconds, stage.StarvedSeconds, stage.BlockedSeconds,
+				100.0 * pipeline.GetUtilization(i));
+		}
+		if (!writeTrace(argc, argv)) return 1;
+
+		if (cacheDir) reportCache(cache);
+		reportScheduler(threads);
+
+		return reportMemory() && numWritten == numMeshes ? 0 : 1;
+	}
+
+	void printUsage()
+	{
+		printf("Usage: DXRVoxelizerCLI -mesh <file.obj> [options]\n");
+		printf("       DXRVoxelizerCLI -batch <dir> [options]\n\n");
+		printf("  -out <file>       Output file; by default the mesh name with the extension of the format\n");
+		printf("  -size <n>         Grid resolution, n^3 voxels (default 128)\n");
+		printf("  -mode <mode>      per-voxel or column (default column)\n");
+		printf("  -format <format>  vxgz, raw, nrrd, nrrd-gzip or vox (default from -out, else vxgz)\n");
+		printf("  -threads <n>      Threads of the task scheduler, 0 for one per hardware thread (default 0)\n");
+		printf("  -pin <0|1>        Pins the workers of the task scheduler to cores (default 0)\n");
+		printf("  -trace <file>     Chrome trace JSON of the profiling zones, for chrome://tracing or Perfetto\n");
+		printf("  -batch <dir>      Voxelizes every OBJ of the directory instead of -mesh, pipelining the stages\n");
+		printf("                    across meshes; outputs are named after the meshes\n");
+		printf("  -outdir <dir>     Output directory of -batch; by default that of the meshes\n");
+		printf("  -workers <list>   Workers of the load, build BVH, voxelize and write stages of -batch (default 1,1,1,1)\n");
+		printf("  -queue <n>        Meshes that may wait between two stages of -batch (default 4, rounded up to a power of 2)\n");
+		printf("  -cache <dir>      Content-addressed cache of the grids: a mesh voxelized before with the same size\n");
+		printf("                    and mode is written from the cache without loading or voxelizing it\n");
+		printf("  -cachemb <n>      Size cap of the cache, evicting the least recently used grids (default 256)\n");
+		printf("  -budget <list>    Memory budgets as subsystem=MB, comma separated, e.g. dense-grid=256,bvh=64;\n");
+		printf("                    exits with 1 when a peak exceeds its budget\n");
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const auto meshFileName = parseString(argc, argv, "mesh", nullptr);
+	const auto modeName = parseString(argc, argv, "mode", "column");
+	const auto size = parseUInt(argc, argv, "size", 128);
+	const auto threads = parseUInt(argc, argv, "threads", 0);
+	const auto batchDir = parseString(argc, argv, "batch", nullptr);
+	const auto budgets = parseString(argc, argv, "budget", nullptr);
+	const auto isPinned = parseUInt(argc, argv, "pin", 0) != 0;
+	const auto workerList = parseString(argc, argv, "workers", "1,1,1,1");
+	if (!meshFileName && !batchDir)
+	{
+		printUsage();
+
+		return 1;
+	}
+	if (budgets && !setBudgets(budgets))
+	{
+		fprintf(stderr, "Invalid budget list %s.\n\n", budgets);
+		printUsage();
+
+		return 1;
+	}
+	uint32_t workers[4];
+	if (!parseWorkers(workerList, workers))
+	{
+		fprintf(stderr, "Invalid worker list %s.\n\n", workerList);
+		printUsage();
+
+		return 1;
+	}
+
+	// Mode and format
+	static const char* modeNames[] = { VoxelizerCPU::GetModeName(VoxelizerCPU::PER_VOXEL),
+		VoxelizerCPU::GetModeName(VoxelizerCPU::COLUMN) };
+	const auto mode = static_cast<VoxelizerCPU::Mode>(findName(modeName, modeNames, VoxelizerCPU::NUM_MODE));
+	const auto outArg = parseString(argc, argv, "out", nullptr);
+	const auto formatName = parseString(argc, argv, "format", nullptr);
+	const auto format = formatName ? findName(formatName, g_formatNames, g_numFormats) :
+		(outArg ? getFormatOfFile(outArg) : 0);
+	if (mode >= VoxelizerCPU::NUM_MODE || format >= g_numFormats || !size)
+	{
+		fprintf(stderr, "Invalid mode, format or size.\n\n");
+		printUsage();
+
+		return 1;
+	}
+
+	// The caller is one of the threads, so a single thread needs no pool
+	if (threads != 1 && (threads || isPinned))
+		TaskScheduler::Init(threads ? threads - 1 : TaskScheduler::DefaultNumWorkers, isPinned);
+
+	if (batchDir) return runBatch(argc, argv, batchDir, size, mode, format, threads, workers);
+
+	const auto outFileName = outArg ? string(outArg) : getOutFileName(meshFileName, format, nullptr);
+
+	const auto cacheDir = parseString(argc, argv, "cache", nullptr);
+	VoxelCache cache;
+	if (cacheDir && !initCache(cache, cacheDir, argc, argv)) return 1;
+
+	// Column mode fills runs, which stay compact up to large resolutions
+	vector<Stage> stages;
+	XUSG::ObjLoader objLoader;
+	VoxelizerCPU voxelizer;
+	VoxelGrid grid;
+	RLEGrid rleGrid;
+	const auto isRLE = mode == VoxelizerCPU::COLUMN;
+
+	// A hit skips loading, building the BVH and voxelizing
+	VoxelCache::Key key = {};
+	VoxelGridReader cachedReader;
+	auto isCached = false;
+	if (cacheDir && !runStage(stages, "find", [&]()
+	{
+		if (!VoxelCache::MakeKey(key, meshFileName, size, VoxelizerCPU::Threshold, g_posScale, mode)) return false;
+		isCached = cache.Find(key, cachedReader);
+
+		return true;
+	}))
+	{
+		fprintf(stderr, "Failed to load %s.\n", meshFileName);
+
+		return 1;
+	}
+
+	if (!isCached && !runStage(stages, "load", [&]() { return objLoader.Import(meshFileName, true, true); }))
+	{
+		fprintf(stderr, "Failed to load %s.\n", meshFileName);
+
+		return 1;
+	}
+
+	if (!isCached && !runStage(stages, "build BVH", [&]()
+	{
+		return voxelizer.Init(objLoader.GetVertices(), objLoader.GetNumVertices(), objLoader.GetVertexStride(),
+			objLoader.GetIndices(), objLoader.GetNumIndices());
+	}))
+	{
+		fprintf(stderr, "Failed to build the BVH of %s.\n", meshFileName);
+
+		return 1;
+	}
+
+	if (!isCached && !runStage(stages, "voxelize", [&]()
+	{
+		return isRLE ? voxelizer.Voxelize(rleGrid, size, mode, threads) : voxelizer.Voxelize(grid, size, mode, threads);
+	}))
+	{
+		fprintf(stderr, "Failed to voxelize %s at %u^3.\n", meshFileName, size);
+
+		return 1;
+	}
+
+	uint64_t fileSize = 0;
+	if (!runStage(stages, "write", [&]()
+	{
+		return isCached ? writeCached(outFileName.c_str(), format, cache, key, cachedReader, threads, fileSize) :
+			writeGrid(outFileName.c_str(), format, voxelizer.GetBound(), grid, rleGrid, isRLE, threads, fileSize);
+	}))
+	{
+		fprintf(stderr, "Failed to write %s.\n", outFileName.c_str());
+
+		return 1;
+	}
+
+	// A failed store only costs the next run the voxelization
+	if (cacheDir && !isCached && !runStage(stages, "store", [&]()
+	{
+		return isRLE ? cache.Store(key, rleGrid, voxelizer.GetBound(), threads) :
+			cache.Store(key, grid, voxelizer.GetBound(), threads);
+	}))
+		fprintf(stderr, "Failed to cache %s.\n", meshFileName);
+
+	auto total = 0.0;
+	for (const auto& stage : stages) total += stage.Time;
+
+	if (isCached) printf("%s: cached, %u^3 voxels, %s mode\n", meshFileName, size, VoxelizerCPU::GetModeName(mode));
+	else
+	{
+		// Occupancy of the grid
+		size_t numOccupied = 0;
+		if (isRLE) numOccupied = rleGrid.GetNumOccupied();
+		else for (auto i = 0u; i < grid.GetNumVoxels(); ++i) numOccupied += grid.GetData()[i] ? 1 : 0;
+
+		printf("%s: %u triangles, %u^3 voxels, %s mode, %zu occupied\n", meshFileName, objLoader.GetNumIndices() / 3,
+			size, VoxelizerCPU::GetModeName(mode), numOccupied);
+	}
+	printf("Wrote %s (%s, %llu bytes)\n\n", outFileName.c_str(), g_formatNames[format],
+		static_cast<unsigned long long>(fileSize));
+	printf("%-10s %10s %8s\n", "Stage", "ms", "%");
+	for (const auto& stage : stages)
+		printf("%-10s %10.2f %8.1f\n", stage.Name, stage.Time * 1.0e3, 100.0 * stage.Time / total);
+	printf("%-10s %10.2f %8.1f\n", "total", total * 1.0e3, 100.0);
+
+	if (!writeTrace(argc, argv)) return 1;
+
+	if (cacheDir) reportCache(cache);
+	reportScheduler(threads);
+
+	// The objects are alive, so the live column is what the run holds at its end
+	return reportMemory() ? 0 : 1;
+}